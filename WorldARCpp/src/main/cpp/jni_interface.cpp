@@ -50,10 +50,15 @@ jint JNI_OnLoad(JavaVM *vm, void *)
 #endif
 
 JNIEXPORT jlong JNICALL Java_com_huawei_arengine_demos_cworld_JniInterface_createNativeApplication(
-    JNIEnv *env, jclass, jobject javaAssetManager)
+    JNIEnv *env, jclass, jobject javaAssetManager, jstring programCacheDirectory)
 {
     AAssetManager *assetManager = AAssetManager_fromJava(env, javaAssetManager);
-    return Jptr(new gWorldAr::WorldArApplication(assetManager));
+    const char *directory = env->GetStringUTFChars(programCacheDirectory, nullptr);
+    jlong application = Jptr(new gWorldAr::WorldArApplication(assetManager, directory != nullptr ? directory : ""));
+    if (directory != nullptr) {
+        env->ReleaseStringUTFChars(programCacheDirectory, directory);
+    }
+    return application;
 }
 
 JNIEXPORT void JNICALL Java_com_huawei_arengine_demos_cworld_JniInterface_destroyNativeApplication(
@@ -110,6 +115,12 @@ JNIEXPORT jboolean JNICALL Java_com_huawei_arengine_demos_cworld_JniInterface_ha
     return static_cast<jboolean>(Native(nativeApplication)->HasDetectedPlanes() ? JNI_TRUE : JNI_FALSE);
 }
 
+JNIEXPORT jboolean JNICALL Java_com_huawei_arengine_demos_cworld_JniInterface_setGlErrorCheckMode(
+    JNIEnv *, jclass, jlong nativeApplication, jint mode)
+{
+    return static_cast<jboolean>(Native(nativeApplication)->SetGlErrorCheckMode(mode) ? JNI_TRUE : JNI_FALSE);
+}
+
 JNIEnv *GetJniEnv()
 {
     JNIEnv *env = nullptr;
@@ -117,6 +128,11 @@ JNIEnv *GetJniEnv()
     return (result == JNI_OK) ? env : nullptr;
 }
 
+void DetachJniEnv()
+{
+    g_vm->DetachCurrentThread();
+}
+
 jclass FindClass(const char *classname)
 {
     JNIEnv *env = GetJniEnv();
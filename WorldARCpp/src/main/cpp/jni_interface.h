@@ -22,12 +22,16 @@
 extern "C" {
 /*
  * Helper function for accessing the JNI environment on the current thread.
- * In this example, the separation of threads upon thread exit is not considered.
- * This can lead to memory leaks,
- * so the production app should be separated when threads no longer need to access the JVM.
+ * Native threads attached by it must call DetachJniEnv before they exit,
+ * otherwise the JVM keeps their resources alive.
  */
 JNIEnv *GetJniEnv();
 
+/*
+ * Detach the current native thread from the JVM.
+ */
+void DetachJniEnv();
+
 jclass FindClass(const char *classname);
 }
 #endif
@@ -50,21 +50,31 @@ namespace gWorldAr {
         })";
     }
 
-    void WorldBackgroundRenderer::InitializeBackGroundGlContent()
+    void WorldBackgroundRenderer::SubmitPrograms(util::ProgramBuilder &builder)
     {
-        shaderProgram = util::CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        programId = builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER);
+    }
+
+    void WorldBackgroundRenderer::InitializeBackGroundGlContent(util::ProgramBuilder &builder)
+    {
+        shaderProgram = builder.Take(programId);
         if (!shaderProgram) {
             LOGE("Could not create program.");
         }
 
+        util::GlStateCache &state = util::GetGlState();
         glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
+        state.BindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
         glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_EXTERNAL_OES, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         uniformTexture = glGetUniformLocation(shaderProgram, "texture");
         attributeVertices = glGetAttribLocation(shaderProgram, "vertex");
         attributeUvs = glGetAttribLocation(shaderProgram, "textureCoords");
+
+        // The camera texture is always read from unit 1.
+        state.UseProgram(shaderProgram);
+        glUniform1i(uniformTexture, 1);
     }
 
     void WorldBackgroundRenderer::Draw(const HwArSession *session, const HwArFrame *frame)
@@ -90,25 +100,23 @@ namespace gWorldAr {
             uvsInitialized = true;
         }
 
-        glUseProgram(shaderProgram);
-        glDepthMask(GL_FALSE);
-
-        glUniform1i(uniformTexture, 1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
+        util::GlStateCache &state = util::GetGlState();
+        state.UseProgram(shaderProgram);
+        state.DepthMask(GL_FALSE);
+        state.ActiveTexture(GL_TEXTURE1);
+        state.BindTexture(GL_TEXTURE_EXTERNAL_OES, textureId);
+        state.SetVertexAttribArrays(util::VertexAttribBit(attributeVertices) |
+                                    util::VertexAttribBit(attributeUvs));
+        state.BindBuffer(GL_ARRAY_BUFFER, 0);
 
         // In OpenGLES, the dimension of the vertex is 3.
-        glEnableVertexAttribArray(attributeVertices);
         glVertexAttribPointer(attributeVertices, 3, GL_FLOAT, GL_FALSE, 0,
             VERTICES);
 
         // In OpenGLES, the texture coordinate dimension is 2.
-        glEnableVertexAttribArray(attributeUvs);
         glVertexAttribPointer(attributeUvs, 2, GL_FLOAT, GL_FALSE, 0,
             transformedUvs);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // Number of points.
-        glUseProgram(0);
-        glDepthMask(GL_TRUE);
         util::CheckGlError("WorldBackgroundRenderer::Draw() error");
     }
 
@@ -31,11 +31,21 @@ namespace gWorldAr {
 
         ~WorldBackgroundRenderer() = default;
 
+        /**
+         * Submit the shader program of the camera background to the driver, which compiles it while the
+         * other programs are submitted. Must be called on the GL thread.
+         *
+         * @param builder Builder the program is taken from by InitializeBackGroundGlContent.
+         */
+        void SubmitPrograms(util::ProgramBuilder &builder);
+
         /**
          * Initialize the OpenGL status. This method must be called in the OpenGL thread,
          * and other methods must be called before the methods below.
+         *
+         * @param builder Builder SubmitPrograms submitted the program to.
          */
-        void InitializeBackGroundGlContent();
+        void InitializeBackGroundGlContent(util::ProgramBuilder &builder);
 
         /**
          * Draw a background image.
@@ -56,6 +66,7 @@ namespace gWorldAr {
     private:
         const static int VERTICES_NUM = 4; // Number of vertices.
 
+        size_t programId = 0;
         GLuint shaderProgram = 0;
         GLuint textureId = 0;
         GLuint attributeVertices = 0;
@@ -16,41 +16,122 @@
 
 #include "world_object_renderer.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "utils/glb_format.h"
+#include "utils/mesh_format.h"
+
 namespace gWorldAr {
     namespace {
         const glm::vec4 K_LIGHT_DIRECTION(0.0f, 1.0f, 0.0f, 0.0f);
 
+        // QUANTIZED_VERTICES selects the variant that reads QuantizedVertex attributes and rescales them.
+        // INSTANCED_ARRAYS reads the parameters of the object from per-instance attributes; otherwise
+        // INSTANCE_COUNT sizes a uniform array of them, indexed by the copy a vertex belongs to.
         constexpr char VERTEX_SHADER[] = R"(
-        uniform mat4 u_ModelView;
-        uniform mat4 u_ModelViewProjection;
+        uniform mat4 u_Projection;
         attribute vec4 a_Position;
-        attribute vec3 a_Normal;
         attribute vec2 a_TexCoord;
         varying vec3 v_ViewPosition;
         varying vec3 v_ViewNormal;
         varying vec2 v_TexCoord;
+        varying vec4 v_ObjColor;
+        varying vec4 v_LightingParameters;
+        #ifdef INSTANCED_ARRAYS
+        attribute mat4 a_ModelView;
+        attribute vec4 a_ObjColor;
+        attribute vec4 a_LightingParameters;
+        #else
+        // Six vectors per object: the model view matrix, the color and the lighting parameters.
+        uniform vec4 u_Instances[INSTANCE_COUNT * 6];
+        attribute float a_InstanceIndex;
+        #endif
+        #ifdef QUANTIZED_VERTICES
+        uniform vec3 u_PositionOffset;
+        uniform vec3 u_PositionScale;
+        uniform vec4 u_UvTransform;
+        attribute vec2 a_Normal;
+
+        vec3 OctDecode(vec2 encoded) {
+            vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+            if (normal.z < 0.0) {
+                vec2 signs = vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+                normal.xy = (1.0 - abs(encoded.yx)) * signs;
+            }
+            return normalize(normal);
+        }
+        #else
+        attribute vec3 a_Normal;
+        #endif
         void main() {
-            v_ViewPosition = (u_ModelView * a_Position).xyz;
-            v_ViewNormal = normalize((u_ModelView * vec4(a_Normal, 0.0)).xyz);
-            v_TexCoord = a_TexCoord;
-            gl_Position = u_ModelViewProjection * a_Position;
+        #ifdef INSTANCED_ARRAYS
+            mat4 modelView = a_ModelView;
+            v_ObjColor = a_ObjColor;
+            v_LightingParameters = a_LightingParameters;
+        #else
+            int instance = int(a_InstanceIndex) * 6;
+            mat4 modelView = mat4(u_Instances[instance], u_Instances[instance + 1], u_Instances[instance + 2],
+                u_Instances[instance + 3]);
+            v_ObjColor = u_Instances[instance + 4];
+            v_LightingParameters = u_Instances[instance + 5];
+        #endif
+        #ifdef QUANTIZED_VERTICES
+            vec4 position = vec4(u_PositionOffset + u_PositionScale * a_Position.xyz, 1.0);
+            vec3 normal = OctDecode(a_Normal);
+            vec2 texCoord = u_UvTransform.xy + u_UvTransform.zw * a_TexCoord;
+        #else
+            vec4 position = a_Position;
+            vec3 normal = a_Normal;
+            vec2 texCoord = a_TexCoord;
+        #endif
+            vec4 viewPosition = modelView * position;
+            v_ViewPosition = viewPosition.xyz;
+            v_ViewNormal = normalize((modelView * vec4(normal, 0.0)).xyz);
+            v_TexCoord = texCoord;
+            gl_Position = u_Projection * viewPosition;
         })";
 
+        constexpr char QUANTIZED_VERTICES_DEFINE[] = "#define QUANTIZED_VERTICES\n";
+
+        // Obj models loaded at runtime are packed into QuantizedVertex, which halves the vertex data
+        // sent to GL on every draw.
+        constexpr bool IS_OBJ_QUANTIZED = true;
+
+        // The mesh is drawn from buffer objects, so its CPU copy is only kept when this asks for it.
+        constexpr util::MeshCpuCopyPolicy MESH_CPU_COPY_POLICY = util::MeshCpuCopyPolicy::RELEASE;
+
+        constexpr char INSTANCED_ARRAYS_DEFINE[] = "#define INSTANCED_ARRAYS\n";
+
+        // Vectors of ObjectInstance, and attributes of the program with per-instance attributes, of
+        // which the model view matrix takes four.
+        constexpr size_t INSTANCE_VECTOR_COUNT = 6;
+        constexpr GLint INSTANCED_ATTRIB_COUNT = 9;
+
+        // Uniform vectors of the vertex shader besides u_Instances, with room for what the compiler adds.
+        constexpr GLint RESERVED_UNIFORM_VECTORS = 16;
+
+        // Bounds of the uniform array. Its size is the most objects drawn by one call without instancing.
+        constexpr size_t MAX_UNIFORM_INSTANCES = 32;
+        constexpr size_t MAX_REPLICATED_VERTEX_BYTES = 4 * 1024 * 1024;
+
         constexpr char FRAGMENT_SHADER[] = R"(
         precision mediump float;
         uniform sampler2D u_Texture;
-        uniform vec4 u_LightingParameters;
         uniform vec4 u_MaterialParameters;
         varying vec3 v_ViewPosition;
         varying vec3 v_ViewNormal;
         varying vec2 v_TexCoord;
-        uniform vec4 u_ObjColor;
+        varying vec4 v_ObjColor;
+        varying vec4 v_LightingParameters;
 
         void main() {
             const float kGamma = 0.4545454;
             const float kInverseGamma = 2.2;
-            vec3 viewLightDirection = u_LightingParameters.xyz;
-            float lightIntensity = u_LightingParameters.w;
+            vec3 viewLightDirection = v_LightingParameters.xyz;
+            float lightIntensity = v_LightingParameters.w;
 
             float materialAmbient = u_MaterialParameters.x;
             float materialDiffuse = u_MaterialParameters.y;
@@ -60,9 +141,10 @@ namespace gWorldAr {
             vec3 viewNormal = normalize(v_ViewNormal);
             vec4 objectColor = texture2D(u_Texture,
                     vec2(v_TexCoord.x, 1.0 - v_TexCoord.y));
-            if (u_ObjColor.a >= 255.0) {
+            // The alpha is 255 or 0 for every vertex, but interpolation may round it.
+            if (v_ObjColor.a >= 254.5) {
                 float intensity = objectColor.r;
-                objectColor.rgb = u_ObjColor.rgb * intensity / 255.0;
+                objectColor.rgb = v_ObjColor.rgb * intensity / 255.0;
             }
             objectColor.rgb = pow(objectColor.rgb, vec3(kInverseGamma));
             float ambient = materialAmbient;
@@ -79,100 +161,483 @@ namespace gWorldAr {
         })";
     }
 
-    void WorldObjectRenderer::InitializeObjectGlContent(AAssetManager *assetManager,
-                                                        const std::string &objFileName,
-                                                        const std::string &pngFileName)
+    bool WorldObjectRenderer::LoadObjectAssets(AAssetManager *assetManager,
+                                               const std::string &modelFileName,
+                                               const std::string &pngFileName)
     {
-        shaderProgram = util::CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        // The GL thread may still draw the model of a previous context, so a new one is loaded beside it.
+        stagedAssets = std::make_unique<ObjectAssets>();
+        if (!LoadMesh(assetManager, modelFileName, *stagedAssets)) {
+            stagedAssets.reset();
+            return false;
+        }
+        util::FileInfor fileInformation;
+        fileInformation.mgr = assetManager;
+        fileInformation.fileName = pngFileName;
+        util::LoadTextureFromAssetManager(fileInformation, stagedAssets->stagedImage);
+        return true;
+    }
+
+    void WorldObjectRenderer::SubmitPrograms(util::ProgramBuilder &builder)
+    {
+        // All objects of a level of detail are drawn with one instanced call where the context has
+        // enough attributes for it, and otherwise in batches as large as the uniform array fits.
+        GLint maxVertexAttribs = 0;
+        glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxVertexAttribs);
+        if (util::LoadInstancedArrays(instancedArrays) && maxVertexAttribs >= INSTANCED_ATTRIB_COUNT) {
+            instancingMode = InstancingMode::INSTANCED_ARRAYS;
+            instancingDefine = INSTANCED_ARRAYS_DEFINE;
+        } else {
+            GLint maxUniformVectors = 0;
+            glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &maxUniformVectors);
+            const GLint instanceCount = (maxUniformVectors - RESERVED_UNIFORM_VECTORS) /
+                static_cast<GLint>(INSTANCE_VECTOR_COUNT);
+            instancingMode = InstancingMode::UNIFORM_ARRAY;
+            uniformInstanceCount = std::min(static_cast<size_t>(std::max(instanceCount, 1)), MAX_UNIFORM_INSTANCES);
+            instancingDefine = "#define INSTANCE_COUNT " + std::to_string(uniformInstanceCount) + "\n";
+        }
+        std::string vertexShader = instancingDefine + QUANTIZED_VERTICES_DEFINE + VERTEX_SHADER;
+        quantizedProgramId = builder.Submit(vertexShader.c_str(), FRAGMENT_SHADER);
+    }
+
+    void WorldObjectRenderer::InitializeObjectGlContent(util::ProgramBuilder &builder)
+    {
+        if (!stagedAssets) {
+            LOGE("WorldObjectRenderer::InitializeObjectGlContent has no loaded model.");
+            return;
+        }
+        // The worker thread is done with the staged model, so it replaces the one drawn.
+        assets = std::move(stagedAssets);
+        mesh = assets->mesh;
+
+        // The shader variant depends on the vertex format of the mesh. The unused quantized variant is
+        // deleted with the other programs that are not taken from the builder.
+        shaderProgram = (mesh.quantization != nullptr) ? builder.Take(quantizedProgramId) :
+            builder.Take(builder.Submit((instancingDefine + VERTEX_SHADER).c_str(), FRAGMENT_SHADER));
         if (!shaderProgram) {
             LOGE("Could not create program.");
+            return;
         }
-        uniformMvpMat = glGetUniformLocation(shaderProgram, "u_ModelViewProjection");
-        uniformMvMat = glGetUniformLocation(shaderProgram, "u_ModelView");
+        uniformProjectionMat = glGetUniformLocation(shaderProgram, "u_Projection");
         uniformTexture = glGetUniformLocation(shaderProgram, "u_Texture");
 
-        uniformLightingParam =
-            glGetUniformLocation(shaderProgram, "u_LightingParameters");
         uniformMaterialParam =
             glGetUniformLocation(shaderProgram, "u_MaterialParameters");
-        uniformColor = glGetUniformLocation(shaderProgram, "u_ObjColor");
+        uniformInstances = glGetUniformLocation(shaderProgram, "u_Instances");
+        uniformPositionOffset = glGetUniformLocation(shaderProgram, "u_PositionOffset");
+        uniformPositionScale = glGetUniformLocation(shaderProgram, "u_PositionScale");
+        uniformUvTransform = glGetUniformLocation(shaderProgram, "u_UvTransform");
 
         attriVertices = glGetAttribLocation(shaderProgram, "a_Position");
         attriUvs = glGetAttribLocation(shaderProgram, "a_TexCoord");
         attriNormals = glGetAttribLocation(shaderProgram, "a_Normal");
+        attriModelView = glGetAttribLocation(shaderProgram, "a_ModelView");
+        attriColor = glGetAttribLocation(shaderProgram, "a_ObjColor");
+        attriLightingParam = glGetAttribLocation(shaderProgram, "a_LightingParameters");
+        attriInstanceIndex = glGetAttribLocation(shaderProgram, "a_InstanceIndex");
 
+        util::GlStateCache &state = util::GetGlState();
         glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        state.BindTexture(GL_TEXTURE_2D, textureId);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        if (!util::LoadPngFromAssetManager(GL_TEXTURE_2D, pngFileName)) {
-            LOGE("Could not load png texture for planes.");
+        if (!util::UploadImage(GL_TEXTURE_2D, assets->stagedImage)) {
+            LOGE("Could not load texture for object.");
         }
-        glGenerateMipmap(GL_TEXTURE_2D);
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        // The object texture is always read from unit 0.
+        state.UseProgram(shaderProgram);
+        glUniform1i(uniformTexture, 0);
+
+        // Without instanced drawing, copies of the mesh tagged with their index stand in for instances.
+        instanceCapacity = 1;
+        if (instancingMode == InstancingMode::INSTANCED_ARRAYS) {
+            glGenBuffers(1, &instanceBuffer);
+        } else {
+            const size_t copyCount = std::min(uniformInstanceCount,
+                util::GetMaxMeshCopies(mesh, MAX_REPLICATED_VERTEX_BYTES));
+            util::MeshView replicatedMesh;
+            if (copyCount > 1 && util::ReplicateMesh(mesh, copyCount, replicatedVertices, replicatedIndices,
+                                                     replicatedSubMeshes, replicatedMesh)) {
+                mesh = replicatedMesh;
+                instanceCapacity = copyCount;
+            }
+            LOGI("WorldObjectRenderer::InitializeObjectGlContent draws up to %zu objects per call.",
+                 instanceCapacity);
+        }
+
+        // Uploaded once, instead of being sent from client-side arrays by every draw.
+        const size_t uploadedBytes = util::UploadMeshBuffers(mesh);
+        if (uploadedBytes > 0) {
+            LOGI("WorldObjectRenderer::InitializeObjectGlContent uploaded %zu bytes into buffer objects.",
+                 uploadedBytes);
+            if (MESH_CPU_COPY_POLICY == util::MeshCpuCopyPolicy::RELEASE) {
+                ReleaseCpuMesh();
+            }
+        }
+
+        util::CheckGlError("WorldObjectRenderer::InitializeBackGroundGlContent()");
+    }
+
+    void WorldObjectRenderer::ReleaseCpuMesh()
+    {
+        // The draw tables may point into the mapped asset, so they are copied before it is closed.
+        ObjectAssets &loaded = *assets;
+        if (mesh.subMeshes != loaded.subMeshes.data()) {
+            loaded.subMeshes.assign(mesh.subMeshes, mesh.subMeshes + mesh.subMeshCount);
+            mesh.subMeshes = loaded.subMeshes.data();
+        }
+        if (mesh.lods != nullptr && mesh.lods != loaded.lods.data()) {
+            loaded.lods.assign(mesh.lods, mesh.lods + mesh.lodCount);
+            mesh.lods = loaded.lods.data();
+        }
+        if (mesh.quantization != nullptr && mesh.quantization != &loaded.quantization) {
+            loaded.quantization = *mesh.quantization;
+            mesh.quantization = &loaded.quantization;
+        }
+        loaded.meshAsset.Close();
+        std::vector<GLfloat>().swap(loaded.vertices);
+        std::vector<GLfloat>().swap(loaded.uvs);
+        std::vector<GLfloat>().swap(loaded.normals);
+        std::vector<GLushort>().swap(loaded.indices);
+        std::vector<GLuint>().swap(loaded.indices32);
+        std::vector<util::QuantizedVertex>().swap(loaded.quantizedVertices);
+        std::vector<GLfloat>().swap(loaded.convertedAttributes);
+        std::vector<GLubyte>().swap(replicatedVertices);
+        std::vector<GLushort>().swap(replicatedIndices);
+    }
+
+    bool WorldObjectRenderer::LoadMesh(AAssetManager *assetManager, const std::string &modelFileName,
+                                       ObjectAssets &loaded)
+    {
+        const size_t extensionStart = modelFileName.rfind('.');
+        if (extensionStart != std::string::npos &&
+            modelFileName.compare(extensionStart, std::string::npos, util::GLB_FILE_EXTENSION) == 0) {
+            util::FileInfor fileInformation;
+            fileInformation.mgr = assetManager;
+            fileInformation.fileName = modelFileName;
+            if (!util::LoadGlbFile(fileInformation, loaded.meshAsset, loaded.convertedAttributes, loaded.subMeshes,
+                                   loaded.mesh)) {
+                return false;
+            }
+            LOGI("WorldObjectRenderer::LoadMesh mapped %s.", modelFileName.c_str());
+            return true;
+        }
+        return LoadObjMesh(assetManager, modelFileName, loaded);
+    }
+
+    bool WorldObjectRenderer::LoadObjMesh(AAssetManager *assetManager, const std::string &objFileName,
+                                          ObjectAssets &loaded)
+    {
+        std::vector<GLfloat> &vertices = loaded.vertices;
+        std::vector<GLfloat> &normals = loaded.normals;
+        std::vector<GLfloat> &uvs = loaded.uvs;
         util::FileInfor fileInformation;
-        fileInformation.fileName = objFileName;
         fileInformation.mgr = assetManager;
-        util::LoadObjFile(fileInformation, vertices, normals, uvs, indices);
+        fileInformation.fileName = objFileName.substr(0, objFileName.rfind('.')) + util::MESH_FILE_EXTENSION;
+        if (util::LoadCompiledMesh(fileInformation, loaded.meshAsset, loaded.mesh)) {
+            LOGI("WorldObjectRenderer::LoadObjMesh mapped %s.", fileInformation.fileName.c_str());
+            return true;
+        }
 
-        util::CheckGlError("WorldObjectRenderer::InitializeBackGroundGlContent()");
+        // No compiled mesh is shipped, so parse the obj file instead.
+        fileInformation.fileName = objFileName;
+        std::vector<GLuint> loadedIndices;
+        if (!util::LoadObjFile(fileInformation, vertices, normals, uvs, loadedIndices)) {
+            LOGE("WorldObjectRenderer::LoadObjMesh could not load %s.", objFileName.c_str());
+            return false;
+        }
+        if (vertices.empty() || loadedIndices.empty()) {
+            LOGE("WorldObjectRenderer::LoadObjMesh found no faces in %s.", objFileName.c_str());
+            return false;
+        }
+
+        // The obj exporter's triangle order is rarely cache friendly, so reorder it before uploading.
+        util::VertexCacheStats before = util::AnalyzeVertexCache(loadedIndices, vertices.size() / 3);
+        util::OptimizeMesh(vertices, normals, uvs, loadedIndices);
+        util::VertexCacheStats after = util::AnalyzeVertexCache(loadedIndices, vertices.size() / 3);
+        LOGI("WorldObjectRenderer::LoadObjMesh optimized %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f.",
+             objFileName.c_str(), before.acmr, after.acmr, before.atvr, after.atvr);
+
+        // The vertex dimension is 3.
+        const size_t vertexCount = vertices.size() / 3;
+        float boundsMin[3] = {vertices[0], vertices[1], vertices[2]};
+        float boundsMax[3] = {vertices[0], vertices[1], vertices[2]};
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            boundsMin[i % 3] = std::min(boundsMin[i % 3], vertices[i]);
+            boundsMax[i % 3] = std::max(boundsMax[i % 3], vertices[i]);
+        }
+        util::SetMeshBounds(boundsMin, boundsMax, loaded.mesh);
+
+        // Distant objects are drawn with coarser levels, which share the vertices of the full mesh.
+        std::vector<std::vector<GLuint>> lodIndices;
+        std::vector<float> lodErrors;
+        util::GenerateLods(vertices, loadedIndices, util::MAX_LOD_COUNT, lodIndices, lodErrors);
+        LOGI("WorldObjectRenderer::LoadObjMesh generated %zu levels of detail for %s, the coarsest with %zu "
+             "triangles.", lodIndices.size(), objFileName.c_str(), lodIndices.back().size() / 3);
+
+        // 16-bit indices halve the index bandwidth of every model that fits them. Larger models use
+        // 32-bit indices, or are split into sub-meshes that fit 16-bit indices.
+        const bool isIndex32 = vertexCount > util::MAX_VERTICES_16_BIT && util::SupportsUint32Indices();
+        const size_t maxVertices = isIndex32 ? 0 : util::MAX_VERTICES_16_BIT;
+        std::vector<GLfloat> combinedVertices;
+        std::vector<GLfloat> combinedNormals;
+        std::vector<GLfloat> combinedUvs;
+        util::CombineLods(vertices, normals, uvs, lodIndices, lodErrors, maxVertices, combinedVertices,
+                          combinedNormals, combinedUvs, loadedIndices, loaded.subMeshes, loaded.lods);
+        vertices.swap(combinedVertices);
+        normals.swap(combinedNormals);
+        uvs.swap(combinedUvs);
+        if (isIndex32) {
+            loaded.indices32.swap(loadedIndices);
+            loaded.mesh.indices = loaded.indices32.data();
+            loaded.mesh.indexType = GL_UNSIGNED_INT;
+        } else {
+            loaded.indices.assign(loadedIndices.begin(), loadedIndices.end());
+            loaded.mesh.indices = loaded.indices.data();
+            loaded.mesh.indexType = GL_UNSIGNED_SHORT;
+        }
+        if (loaded.subMeshes.size() > loaded.lods.size()) {
+            LOGI("WorldObjectRenderer::LoadObjMesh split %s into %zu sub-meshes for 16-bit indices.",
+                 objFileName.c_str(), loaded.subMeshes.size());
+        }
+
+        if (IS_OBJ_QUANTIZED) {
+            util::QuantizeVertices(vertices, normals, uvs, loaded.quantizedVertices, loaded.quantization);
+            std::vector<GLfloat>().swap(vertices);
+            std::vector<GLfloat>().swap(normals);
+            std::vector<GLfloat>().swap(uvs);
+            util::SetQuantizedVertexAttribs(loaded.quantizedVertices.data(), loaded.quantization, loaded.mesh);
+        } else {
+            // The vertex and normal dimensions are 3, the texture coordinate dimension is 2.
+            loaded.mesh.position = {vertices.data(), 3, GL_FLOAT, GL_FALSE, 0};
+            loaded.mesh.normal = {normals.data(), 3, GL_FLOAT, GL_FALSE, 0};
+            loaded.mesh.uv = {uvs.data(), 2, GL_FLOAT, GL_FALSE, 0};
+        }
+        loaded.mesh.subMeshes = loaded.subMeshes.data();
+        loaded.mesh.subMeshCount = loaded.subMeshes.size();
+        loaded.mesh.lods = loaded.lods.data();
+        loaded.mesh.lodCount = loaded.lods.size();
+        return true;
     }
 
-    void WorldObjectRenderer::Draw(const glm::mat4 &projectionMat,
-                                   const glm::mat4 &viewMat,
-                                   const glm::mat4 &modelMat,
-                                   float lightIntensity,
-                                   const float *objectColor4) const
+    void WorldObjectRenderer::ResetObjectGlContent()
+    {
+        // The names were deleted with the context, and the mesh drawn is replaced once a new one is loaded.
+        shaderProgram = 0;
+        textureId = 0;
+        instanceBuffer = 0;
+        mesh = util::MeshView();
+    }
+
+    size_t WorldObjectRenderer::GetLodCount() const
+    {
+        return (mesh.lods != nullptr) ? mesh.lodCount : 1;
+    }
+
+    size_t WorldObjectRenderer::SelectLod(const glm::mat4 &projectionMat, const glm::mat4 &viewMat,
+                                          const glm::mat4 &modelMat, size_t previousLod) const
+    {
+        if (GetLodCount() == 1) {
+            return 0;
+        }
+        // The sphere radius grows with the largest scale of the model matrix.
+        const float scale = std::max(glm::length(glm::vec3(modelMat[0])),
+            std::max(glm::length(glm::vec3(modelMat[1])), glm::length(glm::vec3(modelMat[2]))));
+        const glm::vec4 viewCenter = viewMat * modelMat * glm::vec4(mesh.boundsCenter, 1.0f);
+        const float distance = -viewCenter.z;
+        const float radius = mesh.boundsRadius * scale;
+        if (distance <= radius) {
+            return 0;
+        }
+        // projectionMat[1][1] maps a height at distance 1 to normalized device coordinates, which span
+        // 2 across the viewport, so the diameter's fraction of the viewport height needs no factor.
+        const float screenSize = radius * projectionMat[1][1] / distance;
+        return util::SelectLod(screenSize, GetLodCount(), previousLod);
+    }
+
+    void WorldObjectRenderer::Submit(const glm::mat4 &projectionMat,
+                                     const glm::mat4 &viewMat,
+                                     const glm::mat4 &modelMat,
+                                     float lightIntensity,
+                                     const float *objectColor4,
+                                     size_t lod)
     {
         if (!shaderProgram) {
             LOGE("shaderProgram is null.");
             return;
         }
-        glUseProgram(shaderProgram);
-        glActiveTexture(GL_TEXTURE0);
-        glUniform1i(uniformTexture, 0);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        ObjectDraw draw;
+        draw.instance.mvMat = viewMat * modelMat;
+        std::copy(objectColor4, objectColor4 + 4, draw.instance.color);
+        const glm::vec4 viewLightDirection = glm::normalize(draw.instance.mvMat * K_LIGHT_DIRECTION);
+        draw.instance.lightingParam = glm::vec4(glm::vec3(viewLightDirection), lightIntensity);
+        static_assert(util::MAX_LOD_COUNT <= 32, "submittedLods has one bit per level of detail.");
+        draw.lod = std::min(lod, GetLodCount() - 1);
+
+        // Objects are sorted by the distance of their bounds center, which the camera looks at along -z.
+        draw.depth = -(draw.instance.mvMat * glm::vec4(mesh.boundsCenter, 1.0f)).z;
+        frameProjectionMat = projectionMat;
+        if ((submittedLods & (1u << draw.lod)) == 0) {
+            submittedLods |= 1u << draw.lod;
+            lodDepths[draw.lod] = draw.depth;
+        } else {
+            lodDepths[draw.lod] = std::min(lodDepths[draw.lod], draw.depth);
+        }
+        draws.push_back(draw);
+    }
 
-        glm::mat4 mvpMat = projectionMat * viewMat * modelMat;
-        glm::mat4 mvMat = viewMat * modelMat;
-        glm::vec4 viewLightDirection = glm::normalize(mvMat * K_LIGHT_DIRECTION);
+    void WorldObjectRenderer::SubmitPackets(util::RenderQueue &queue)
+    {
+        for (size_t lod = 0; lod < util::MAX_LOD_COUNT; ++lod) {
+            if ((submittedLods & (1u << lod)) != 0) {
+                queue.Submit(util::MakeSortKey(util::RenderPass::OPAQUE, shaderProgram, textureId, lodDepths[lod]),
+                    *this, static_cast<uint32_t>(lod));
+            }
+        }
+    }
+
+    void WorldObjectRenderer::ClearDraws()
+    {
+        draws.clear();
+        submittedLods = 0;
+    }
+
+    void WorldObjectRenderer::DrawPacket(uint32_t index)
+    {
+        // Instances are rasterized in order, so sorting them keeps the depth test rejecting hidden fragments.
+        batchDraws.clear();
+        for (const ObjectDraw &draw : draws) {
+            if (draw.lod == index) {
+                batchDraws.push_back(&draw);
+            }
+        }
+        std::stable_sort(batchDraws.begin(), batchDraws.end(), [](const ObjectDraw *a, const ObjectDraw *b) {
+            return a->depth < b->depth;
+        });
+        batchInstances.clear();
+        for (const ObjectDraw *draw : batchDraws) {
+            batchInstances.push_back(draw->instance);
+        }
+
+        util::GlStateCache &state = util::GetGlState();
+        state.UseProgram(shaderProgram);
+        state.DepthMask(GL_TRUE);
+        state.ActiveTexture(GL_TEXTURE0);
+        state.BindTexture(GL_TEXTURE_2D, textureId);
 
-        // The dimension of the light direction vector is 3.
-        glUniform4f(uniformLightingParam, viewLightDirection[0],
-            viewLightDirection[1], viewLightDirection[2], lightIntensity);
         glUniform4f(uniformMaterialParam, ambient, diffuse, specular,
             specularOower);
-        glUniform4fv(uniformColor, 1, objectColor4);
+        glUniformMatrix4fv(uniformProjectionMat, 1, GL_FALSE, glm::value_ptr(frameProjectionMat));
+        if (mesh.quantization != nullptr) {
+            const util::QuantizationParams &params = *mesh.quantization;
+            glUniform3fv(uniformPositionOffset, 1, params.positionOffset);
+            glUniform3fv(uniformPositionScale, 1, params.positionScale);
+            glUniform4f(uniformUvTransform, params.uvOffset[0], params.uvOffset[1], params.uvScale[0],
+                params.uvScale[1]);
+        }
 
-        glUniformMatrix4fv(uniformMvpMat, 1, GL_FALSE, glm::value_ptr(mvpMat));
-        glUniformMatrix4fv(uniformMvMat, 1, GL_FALSE, glm::value_ptr(mvMat));
-        glEnableVertexAttribArray(attriVertices);
+        size_t firstSubMesh = 0;
+        size_t endSubMesh = mesh.subMeshCount;
+        if (mesh.lods != nullptr) {
+            const util::MeshLod &meshLod = mesh.lods[index];
+            firstSubMesh = meshLod.firstSubMesh;
+            endSubMesh = meshLod.firstSubMesh + meshLod.subMeshCount;
+        }
+        if (instancingMode == InstancingMode::INSTANCED_ARRAYS) {
+            DrawInstancedArrays(firstSubMesh, endSubMesh);
+        } else {
+            DrawUniformArrayBatches(firstSubMesh, endSubMesh);
+        }
+        util::CheckGlError("WorldObjectRenderer::DrawPacket()");
+    }
 
-        // The vertex dimension is 3.
-        glVertexAttribPointer(attriVertices, 3, GL_FLOAT, GL_FALSE, 0,
-            vertices.data());
+    void WorldObjectRenderer::DrawInstancedArrays(size_t firstSubMesh, size_t endSubMesh)
+    {
+        util::GlStateCache &state = util::GetGlState();
+        state.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        // Respecifying the whole buffer lets the driver hand out new storage instead of waiting for the
+        // draws of the previous frame.
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(batchInstances.size() * sizeof(ObjectInstance)),
+            batchInstances.data(), GL_STREAM_DRAW);
 
-        // The size of the vertex attribute array is 3.
-        glEnableVertexAttribArray(attriNormals);
-        glVertexAttribPointer(attriNormals, 3, GL_FLOAT, GL_FALSE, 0,
-            normals.data());
+        // The model view matrix takes one attribute per column.
+        const GLsizei stride = sizeof(ObjectInstance);
+        const GLuint instanceAttribs[] = {
+            static_cast<GLuint>(attriModelView), static_cast<GLuint>(attriModelView) + 1,
+            static_cast<GLuint>(attriModelView) + 2, static_cast<GLuint>(attriModelView) + 3,
+            static_cast<GLuint>(attriColor), static_cast<GLuint>(attriLightingParam)
+        };
+        const size_t instanceOffsets[] = {
+            0, sizeof(glm::vec4), 2 * sizeof(glm::vec4), 3 * sizeof(glm::vec4),
+            offsetof(ObjectInstance, color), offsetof(ObjectInstance, lightingParam)
+        };
+        uint32_t enabledMask = util::VertexAttribBit(attriVertices) | util::VertexAttribBit(attriNormals) |
+            util::VertexAttribBit(attriUvs);
+        for (size_t i = 0; i < INSTANCE_VECTOR_COUNT; ++i) {
+            glVertexAttribPointer(instanceAttribs[i], 4, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(instanceOffsets[i]));
+            instancedArrays.vertexAttribDivisor(instanceAttribs[i], 1);
+            enabledMask |= util::VertexAttribBit(static_cast<GLint>(instanceAttribs[i]));
+        }
+        state.SetVertexAttribArrays(enabledMask);
 
-        glEnableVertexAttribArray(attriUvs);
+        // Sub-meshes have their own vertex range, so the attributes are rebased before each draw.
+        util::BindMeshBuffers(mesh);
+        const size_t indexSize = util::GetIndexSize(mesh.indexType);
+        for (size_t i = firstSubMesh; i < endSubMesh; ++i) {
+            const util::SubMesh &subMesh = mesh.subMeshes[i];
+            util::SetVertexAttribPointer(attriVertices, mesh.position, subMesh.firstVertex);
+            util::SetVertexAttribPointer(attriNormals, mesh.normal, subMesh.firstVertex);
+            util::SetVertexAttribPointer(attriUvs, mesh.uv, subMesh.firstVertex);
+            instancedArrays.drawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(subMesh.indexCount),
+                mesh.indexType, static_cast<const GLubyte *>(mesh.indices) + subMesh.firstIndex * indexSize,
+                static_cast<GLsizei>(batchInstances.size()));
+        }
 
-        // The texture attribute dimension is 2.
-        glVertexAttribPointer(attriUvs, 2, GL_FLOAT, GL_FALSE, 0, uvs.data());
+        // The other renderers read these attribute locations once per vertex.
+        for (GLuint attrib : instanceAttribs) {
+            instancedArrays.vertexAttribDivisor(attrib, 0);
+        }
+    }
 
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT,
-                       indices.data());
+    void WorldObjectRenderer::DrawUniformArrayBatches(size_t firstSubMesh, size_t endSubMesh)
+    {
+        static_assert(sizeof(ObjectInstance) == INSTANCE_VECTOR_COUNT * sizeof(glm::vec4),
+            "u_Instances is uploaded straight from batchInstances.");
+        // A mesh that could not be replicated is drawn once per object, as copy 0.
+        const bool isReplicated = mesh.copyIndex.pointer != nullptr;
+        uint32_t enabledMask = util::VertexAttribBit(attriVertices) | util::VertexAttribBit(attriNormals) |
+            util::VertexAttribBit(attriUvs);
+        if (isReplicated) {
+            enabledMask |= util::VertexAttribBit(attriInstanceIndex);
+        } else {
+            glVertexAttrib1f(attriInstanceIndex, 0.0f);
+        }
+        util::GetGlState().SetVertexAttribArrays(enabledMask);
+        util::BindMeshBuffers(mesh);
 
-        glDisableVertexAttribArray(attriVertices);
-        glDisableVertexAttribArray(attriUvs);
-        glDisableVertexAttribArray(attriNormals);
-        glUseProgram(0);
-        util::CheckGlError("WorldObjectRenderer::Draw()");
+        const size_t indexSize = util::GetIndexSize(mesh.indexType);
+        for (size_t first = 0; first < batchInstances.size(); first += instanceCapacity) {
+            const size_t count = std::min(instanceCapacity, batchInstances.size() - first);
+            glUniform4fv(uniformInstances, static_cast<GLsizei>(count * INSTANCE_VECTOR_COUNT),
+                glm::value_ptr(batchInstances[first].mvMat));
+            for (size_t i = firstSubMesh; i < endSubMesh; ++i) {
+                const util::SubMesh &subMesh = mesh.subMeshes[i];
+                util::SetVertexAttribPointer(attriVertices, mesh.position, subMesh.firstVertex);
+                util::SetVertexAttribPointer(attriNormals, mesh.normal, subMesh.firstVertex);
+                util::SetVertexAttribPointer(attriUvs, mesh.uv, subMesh.firstVertex);
+                if (isReplicated) {
+                    util::SetVertexAttribPointer(attriInstanceIndex, mesh.copyIndex, subMesh.firstVertex);
+                }
+                // The copies of a sub-mesh follow each other, so the first count of them are drawn.
+                const size_t copyIndexCount = subMesh.indexCount / instanceCapacity;
+                glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(copyIndexCount * count), mesh.indexType,
+                    static_cast<const GLubyte *>(mesh.indices) + subMesh.firstIndex * indexSize);
+            }
+        }
     }
 }
\ No newline at end of file
@@ -17,73 +17,267 @@
 #ifndef C_ARENGINE_WORLD_AR_OBJECT_RENDERER_H
 #define C_ARENGINE_WORLD_AR_OBJECT_RENDERER_H
 
+#include <memory>
+
 #include <GLES2/gl2.h>
 #include <glm.hpp>
 #include <android/asset_manager.h>
 
 #include "huawei_arengine_interface.h"
+#include "utils/gl_capabilities.h"
+#include "utils/mesh_simplifier.h"
+#include "utils/render_queue.h"
 #include "utils/util.h"
 
 namespace gWorldAr {
-    class WorldObjectRenderer {
+    class WorldObjectRenderer : public util::PacketRenderer {
     public:
         WorldObjectRenderer() = default;
 
         ~WorldObjectRenderer() = default;
 
         /**
-         * Initialize the OpenGL state, load files and textures,
-         * and set the OpenGL resources for drawing the model.
+         * Load the model files and decode the texture into CPU-side buffers of their own, which the
+         * model drawn meanwhile does not read. Makes no GL calls, so it can run on a worker thread
+         * before InitializeObjectGlContent.
          *
          * @param assetManager Wrapper of the bottom native implementation.
-         * @param objFileName Name of the virtual object file to be rendered.
+         * @param modelFileName Name of the virtual object file to be rendered, a .glb or .obj file.
+         *                      For .obj files, a compiled mesh with the same base name is preferred
+         *                      when it exists.
          * @param pngFileName Name of the image file to be drawn.
+         * @return True if the model was loaded, false otherwise.
+         */
+        bool LoadObjectAssets(AAssetManager *assetManager,
+                              const std::string &modelFileName,
+                              const std::string &pngFileName);
+
+        /**
+         * Submit the shader program of the object to the driver before the model is loaded. The
+         * program reads quantized vertices, the layout of obj models and of the shipped mesh, and
+         * per-instance attributes or a uniform array of instances, whichever the context supports.
+         * Must be called on the GL thread.
+         *
+         * @param builder Builder the program is taken from by InitializeObjectGlContent.
+         */
+        void SubmitPrograms(util::ProgramBuilder &builder);
+
+        /**
+         * Make the model loaded by LoadObjectAssets the one drawn, initialize the OpenGL state and
+         * upload its texture. This method must be called on the GL thread.
+         *
+         * @param builder Builder SubmitPrograms submitted the program to. Models with float
+         *                vertices build their own program variant with it.
+         */
+        void InitializeObjectGlContent(util::ProgramBuilder &builder);
+
+        /**
+         * Forget the program, texture and buffer names of a GL context that was destroyed, without
+         * deleting them, so the model is not drawn until InitializeObjectGlContent runs again.
+         * Must be called on the GL thread.
+         */
+        void ResetObjectGlContent();
+
+        /**
+         * Check whether the model can be drawn.
+         *
+         * @return True once InitializeObjectGlContent has run on a loaded model.
          */
-        void InitializeObjectGlContent(AAssetManager *assetManager,
-                                       const std::string &objFileName,
-                                       const std::string &pngFileName);
+        bool IsReady() const
+        {
+            return shaderProgram != 0;
+        }
 
         /**
-         * Draw a virtual object model.
+         * Add a draw of the virtual object model to the frame. The objects of one level of detail are
+         * drawn together, by one packet SubmitPackets queues, so the parameters are kept until ClearDraws.
          *
          * @param projectionMat Virtual object projection information matrix.
          * @param viewMat Virtual object view information matrix.
          * @param modelMat Virtual object model information matrix.
          * @param lightIntensity Virtual object light intensity.
          * @param objectColor4 Virtual object color parameter configuration.
+         * @param lod Level of detail to draw, from SelectLod.
+         */
+        void Submit(const glm::mat4 &projectionMat, const glm::mat4 &viewMat, const glm::mat4 &modelMat,
+                    float lightIntensity, const float *objectColor4, size_t lod = 0);
+
+        /**
+         * Queue one packet per level of detail drawn this frame, keyed by its nearest object, so the
+         * packets are sorted front to back. Call once all objects of the frame were submitted.
+         *
+         * @param queue Render queue of the frame.
+         */
+        void SubmitPackets(util::RenderQueue &queue);
+
+        // Forget the draws submitted for the previous frame, keeping their storage.
+        void ClearDraws();
+
+        /**
+         * Draw all virtual objects submitted this frame with one level of detail, front to back.
+         *
+         * @param index Level of detail, passed to the queue by Submit.
+         */
+        void DrawPacket(uint32_t index) override;
+
+        /**
+         * Number of levels of detail of the loaded model.
+         *
+         * @return 1 if the model has a single level.
+         */
+        size_t GetLodCount() const;
+
+        /**
+         * Pick the level of detail of an object from the height its bounding sphere covers on screen.
+         *
+         * @param projectionMat Virtual object projection information matrix.
+         * @param viewMat Virtual object view information matrix.
+         * @param modelMat Virtual object model information matrix.
+         * @param previousLod Level the object was drawn with last frame, 0 for new objects.
+         * @return Level of detail to pass to Draw.
          */
-        void Draw(const glm::mat4 &projectionMat, const glm::mat4 &viewMat,
-                  const glm::mat4 &modelMat, float lightIntensity,
-                  const float *objectColor4) const;
+        size_t SelectLod(const glm::mat4 &projectionMat, const glm::mat4 &viewMat,
+                         const glm::mat4 &modelMat, size_t previousLod) const;
 
     private:
+        // CPU-side data of a model, filled by LoadObjectAssets.
+        struct ObjectAssets {
+            // Define the model attribute array.
+            std::vector<GLfloat> vertices = {};
+            std::vector<GLfloat> uvs = {};
+            std::vector<GLfloat> normals = {};
+
+            // Define the triangle index of a model. Only one of the two is filled: 32-bit indices are
+            // used when the model has more vertices than 16-bit indices address and the GL context allows it.
+            std::vector<GLushort> indices = {};
+            std::vector<GLuint> indices32 = {};
+
+            // Interleaved copy of the attribute arrays above, which are released once it is filled.
+            std::vector<util::QuantizedVertex> quantizedVertices = {};
+            util::QuantizationParams quantization = {};
+
+            // Ranges of the attribute arrays and indices above that are drawn with one call each.
+            std::vector<util::SubMesh> subMeshes = {};
+
+            // Sub-mesh ranges of the levels of detail of an obj model, finest first.
+            std::vector<util::MeshLod> lods = {};
+
+            // Compiled mesh or glb asset, mapped until the mesh is uploaded when it exists.
+            util::AssetBuffer meshAsset;
+
+            // Half-float attributes of a glb asset, converted when the GL context cannot read them.
+            std::vector<GLfloat> convertedAttributes = {};
+
+            // Mesh data loaded, pointing either into meshAsset or into the attribute arrays above.
+            util::MeshView mesh = {};
+
+            // Texture decoded by LoadObjectAssets, released once it is uploaded.
+            util::StagedImage stagedImage = {};
+        };
+
+        bool LoadMesh(AAssetManager *assetManager, const std::string &modelFileName, ObjectAssets &loaded);
+
+        bool LoadObjMesh(AAssetManager *assetManager, const std::string &objFileName, ObjectAssets &loaded);
+
+        // Free the mesh data the buffer objects were filled from.
+        void ReleaseCpuMesh();
+
+        // Draw batchInstances with per-instance attributes, one call per sub-mesh.
+        void DrawInstancedArrays(size_t firstSubMesh, size_t endSubMesh);
+
+        // Draw batchInstances from the uniform array, up to instanceCapacity objects per call.
+        void DrawUniformArrayBatches(size_t firstSubMesh, size_t endSubMesh);
+
+        // How the objects of one level of detail are drawn together.
+        enum class InstancingMode {
+            // glDrawElementsInstanced with per-instance attributes read from instanceBuffer.
+            INSTANCED_ARRAYS,
+            // One call per instanceCapacity objects, whose parameters are uploaded into a uniform array
+            // and looked up by the copy index of the replicated mesh.
+            UNIFORM_ARRAY
+        };
+
+        // Parameters of one object as the shader reads them: six vectors, in the order of u_Instances.
+        struct ObjectInstance {
+            glm::mat4 mvMat;
+            float color[4];
+            // View space light direction and light intensity.
+            glm::vec4 lightingParam;
+        };
+
+        // Parameters of a draw submitted to the render queue.
+        struct ObjectDraw {
+            ObjectInstance instance;
+            float depth;
+            size_t lod;
+        };
+
+        // Draws submitted this frame. Packets are indexed by level of detail.
+        std::vector<ObjectDraw> draws = {};
+
+        // Levels of detail drawn this frame, one bit each, and the depth of the nearest object of each.
+        uint32_t submittedLods = 0;
+        float lodDepths[util::MAX_LOD_COUNT] = {};
+
+        // Projection of the draws submitted this frame.
+        glm::mat4 frameProjectionMat = glm::mat4(1.0f);
+
+        // Draws of the packet being drawn, sorted front to back, and their instance parameters.
+        std::vector<const ObjectDraw *> batchDraws = {};
+        std::vector<ObjectInstance> batchInstances = {};
+
+        InstancingMode instancingMode = InstancingMode::UNIFORM_ARRAY;
+        util::InstancedArrays instancedArrays = {};
+
+        // Instances the uniform array of the program holds, and the copies of the mesh drawn with one call.
+        size_t uniformInstanceCount = 1;
+        size_t instanceCapacity = 1;
+
+        // Per-instance attributes of the instanced draws, refilled for every packet.
+        GLuint instanceBuffer = 0;
+
+        // Copies of the mesh drawn in uniform array mode, tagged with their index.
+        std::vector<GLubyte> replicatedVertices = {};
+        std::vector<GLushort> replicatedIndices = {};
+        std::vector<util::SubMesh> replicatedSubMeshes = {};
+
         float ambient = 0.0f;
         float diffuse = 3.5f;
         float specular = 1.0f;
         float specularOower = 6.0f;
 
-        // Define the model attribute array.
-        std::vector<GLfloat> vertices = {};
-        std::vector<GLfloat> uvs = {};
-        std::vector<GLfloat> normals = {};
+        // Model being loaded by the worker thread, handed over to the GL thread by InitializeObjectGlContent.
+        std::unique_ptr<ObjectAssets> stagedAssets;
+
+        // Model drawn, whose mesh data the buffer objects were filled from.
+        std::unique_ptr<ObjectAssets> assets;
 
-        // Define the triangle index of a model.
-        std::vector<GLushort> indices = {};
+        // Mesh data drawn by GL, pointing into the assets until it is uploaded into buffer objects, or
+        // into the replicated copies of the mesh.
+        util::MeshView mesh = {};
 
         // Name of the 2D texture object.
         GLuint textureId = 0;
 
-        // Define and initialize the details of the shader program.
+        // Define and initialize the details of the shader program. The instancing define selects how
+        // the program reads the parameters of the objects.
+        std::string instancingDefine;
+        size_t quantizedProgramId = 0;
         GLuint shaderProgram = 0;
         GLuint attriVertices = 0;
         GLuint attriUvs = 0;
         GLuint attriNormals = 0;
-        GLuint uniformMvpMat = 0;
-        GLuint uniformMvMat = 0;
+        GLint attriModelView = -1;
+        GLint attriColor = -1;
+        GLint attriLightingParam = -1;
+        GLint attriInstanceIndex = -1;
+        GLuint uniformProjectionMat = 0;
         GLuint uniformTexture = 0;
-        GLuint uniformLightingParam = 0;
         GLuint uniformMaterialParam = 0;
-        GLint uniformColor = 0;
+        GLint uniformInstances = -1;
+        GLint uniformPositionOffset = -1;
+        GLint uniformPositionScale = -1;
+        GLint uniformUvTransform = -1;
     };
 }
 #endif
\ No newline at end of file
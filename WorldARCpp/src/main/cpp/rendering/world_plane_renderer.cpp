@@ -16,26 +16,39 @@
 
 #include "world_plane_renderer.h"
 
+#include <algorithm>
+#include <cstddef>
+
+#include "utils/polygon_simplifier.h"
 #include "utils/util.h"
 
 namespace gWorldAr {
     namespace {
+        // Plane boundaries are simplified before meshing: points within this distance in meters of the
+        // simplified boundary are dropped, and the tolerance grows until at most the given number of
+        // points remain, so large planes do not get denser meshes however detailed their boundary is.
+        constexpr float PLANE_SIMPLIFY_TOLERANCE = 0.01f;
+        constexpr size_t PLANE_MAX_POLYGON_POINTS = 256;
+
+        // The vertices are in world space and carry the normal and color of their plane, so planes of
+        // any pose and color are drawn with one call.
         constexpr char VERTEX_SHADER[] = R"(
         precision highp float;
         precision highp int;
-        attribute vec3 vertex;
+        attribute vec4 vertex;
+        attribute vec3 normal;
+        attribute vec3 plane_color;
         varying vec2 v_textureCoords;
         varying float v_alpha;
+        varying vec3 v_color;
 
-        uniform mat4 mvp;
-        uniform mat4 model_mat;
-        uniform vec3 normal;
+        uniform mat4 view_projection;
 
         void main() {
-            v_alpha = vertex.z;
-            vec4 local_pos = vec4(vertex.x, 0.0, vertex.y, 1.0);
-            gl_Position = mvp * local_pos;
-            vec4 world_pos = model_mat * local_pos;
+            v_alpha = vertex.w;
+            v_color = plane_color;
+            vec4 world_pos = vec4(vertex.xyz, 1.0);
+            gl_Position = view_projection * world_pos;
             const vec3 arbitrary = vec3(1.0, 1.0, 0.0);
             vec3 vec_u = normalize(cross(normal, arbitrary));
             vec3 vec_v = normalize(cross(normal, vec_u));
@@ -46,153 +59,229 @@ namespace gWorldAr {
         precision highp float;
         precision highp int;
         uniform sampler2D texture;
-        uniform vec3 color;
         varying vec2 v_textureCoords;
         varying float v_alpha;
+        varying vec3 v_color;
         void main() {
             float r = texture2D(texture, v_textureCoords).r;
-            gl_FragColor = vec4(color.xyz, r * v_alpha);
+            gl_FragColor = vec4(v_color, r * v_alpha);
         })";
     }
 
-    void WorldPlaneRenderer::InitializePlaneGlContent()
+    bool WorldPlaneRenderer::LoadPlaneAssets(AAssetManager *assetManager)
+    {
+        util::FileInfor fileInformation;
+        fileInformation.mgr = assetManager;
+        fileInformation.fileName = "trigrid.png";
+        return util::LoadTextureFromAssetManager(fileInformation, stagedImage);
+    }
+
+    void WorldPlaneRenderer::SubmitPrograms(util::ProgramBuilder &builder)
+    {
+        mProgramId = builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER);
+    }
+
+    void WorldPlaneRenderer::InitializePlaneGlContent(util::ProgramBuilder &builder)
     {
-        mShaderProgram = util::CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        mShaderProgram = builder.Take(mProgramId);
         if (!mShaderProgram) {
             LOGE("Could not create program.");
+            return;
         }
 
-        mUniformMvpMat = glGetUniformLocation(mShaderProgram, "mvp");
+        mUniformViewProjectionMat = glGetUniformLocation(mShaderProgram, "view_projection");
         mUniformTexture = glGetUniformLocation(mShaderProgram, "texture");
-        mUniformModelMat = glGetUniformLocation(mShaderProgram, "model_mat");
-        mUniformNormalVec = glGetUniformLocation(mShaderProgram, "normal");
-        mUniformColor = glGetUniformLocation(mShaderProgram, "color");
         mAttriVertices = glGetAttribLocation(mShaderProgram, "vertex");
+        mAttriNormalVec = glGetAttribLocation(mShaderProgram, "normal");
+        mAttriColor = glGetAttribLocation(mShaderProgram, "plane_color");
 
+        util::GlStateCache &state = util::GetGlState();
         glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        state.BindTexture(GL_TEXTURE_2D, textureId);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        if (!util::LoadPngFromAssetManager(GL_TEXTURE_2D, "trigrid.png")) {
-            LOGE("Could not load png texture for planes.");
+        if (!util::UploadImage(GL_TEXTURE_2D, stagedImage)) {
+            LOGE("Could not load texture for planes.");
         }
 
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        // The plane texture is always read from unit 0.
+        state.UseProgram(mShaderProgram);
+        glUniform1i(mUniformTexture, 0);
+
+        GLuint buffers[2] = {0, 0};
+        glGenBuffers(2, buffers);
+        batchVertexBuffer = buffers[0];
+        batchIndexBuffer = buffers[1];
 
         util::CheckGlError("WorldPlaneRenderer::InitializeBackGroundGlContent()");
     }
 
-    void WorldPlaneRenderer::Draw(const glm::mat4 &projectionMat,
-                                  const glm::mat4 &viewMat, const HwArSession *session,
-                                  const HwArPlane *plane, const glm::vec3 &color)
+    void WorldPlaneRenderer::ResetPlaneGlContent()
+    {
+        mShaderProgram = 0;
+        textureId = 0;
+        batchVertexBuffer = 0;
+        batchIndexBuffer = 0;
+        // The new batch buffers are empty, so they are filled again whatever planes they held.
+        batchBakeIds.clear();
+    }
+
+    void WorldPlaneRenderer::Submit(util::RenderQueue &queue, const glm::mat4 &projectionMat,
+                                    const glm::mat4 &viewMat, const HwArSession *session,
+                                    const util::PlaneStore &store, util::TrackableHandle handle)
     {
         if (!mShaderProgram) {
             LOGE("mShaderProgram is null.");
             return;
         }
-        UpdateForPlane(session, plane);
-
-        glUseProgram(mShaderProgram);
-        glDepthMask(GL_FALSE);
-
-        glActiveTexture(GL_TEXTURE0);
-        glUniform1i(mUniformTexture, 0);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-
-        // Write the final mvp matrix for this plane renderer.
-        glUniformMatrix4fv(mUniformMvpMat, 1, GL_FALSE,
-            glm::value_ptr(projectionMat * viewMat * modelMat));
-
-        glUniformMatrix4fv(mUniformModelMat, 1, GL_FALSE,
-            glm::value_ptr(modelMat));
-        glUniform3f(mUniformNormalVec, normalVec.x, normalVec.y, normalVec.z);
-        glUniform3f(mUniformColor, color.x, color.y, color.z);
-
-        glEnableVertexAttribArray(mAttriVertices);
+        if (handle.index >= planeMeshes.size()) {
+            planeMeshes.resize(handle.index + 1);
+        }
+        PlaneMesh &mesh = planeMeshes[handle.index];
+        if (mesh.generation != handle.generation) {
+            // The slot held another plane, or none; its storage is reused.
+            mesh.triangles.clear();
+            mesh.generation = handle.generation;
+            mesh.updatedFrame = 0;
+            mesh.bakeId = 0;
+        }
+        const size_t index = store.GetIndex(handle);
+        const glm::mat4 &centerPose = store.GetCenterPoses()[index];
+        const glm::vec3 &color = store.GetColors()[index];
+        // Frames are counted from one, so a new mesh is always out of date.
+        const bool isUpdated = mesh.updatedFrame != store.GetUpdatedFrames()[index];
+        if (isUpdated && !UpdatePlaneMesh(session, static_cast<const HwArPlane *>(store.GetKeys()[index]), mesh)) {
+            // The plane is left out until the engine reports it updated again, rather than queried every frame.
+            mesh.updatedFrame = store.GetUpdatedFrames()[index];
+            mesh.triangles.clear();
+            mesh.bakeId = 0;
+            return;
+        }
+        if (mesh.bakeId == 0 && !isUpdated) {
+            return;
+        }
+        if (isUpdated || mesh.color != color) {
+            mesh.color = color;
+            util::BakePlaneVertices(mesh.vertices, centerPose, store.GetNormals()[index], mesh.color,
+                                    mesh.worldVertices);
+            mesh.bakeId = ++lastBakeId;
+            mesh.updatedFrame = store.GetUpdatedFrames()[index];
+        }
 
-        // When the GL vertex attribute is a pointer, the number of vertices is 3.
-        glVertexAttribPointer(mAttriVertices, 3, GL_FLOAT, GL_FALSE, 0,
-            vertices.data());
+        // Planes are sorted by the distance of their center, which the camera looks at along -z. The
+        // batch is the only draw of the transparent pass, so its key needs no depth.
+        const float depth = -(viewMat * centerPose[3]).z;
+        if (draws.empty()) {
+            viewProjectionMat = projectionMat * viewMat;
+            queue.Submit(util::MakeSortKey(util::RenderPass::TRANSPARENT, mShaderProgram, textureId, 0.0f), *this, 0);
+        }
+        draws.push_back({handle.index, depth});
+    }
 
-        glDrawElements(GL_TRIANGLES, triangles.size(), GL_UNSIGNED_SHORT,
-            triangles.data());
+    void WorldPlaneRenderer::ClearDraws()
+    {
+        draws.clear();
+    }
 
-        glUseProgram(0);
-        glDepthMask(GL_TRUE);
-        util::CheckGlError("WorldPlaneRenderer::Draw()");
+    void WorldPlaneRenderer::ReleasePlaneMeshes(const util::PlaneStore &store)
+    {
+        for (uint32_t slot = 0; slot < planeMeshes.size(); ++slot) {
+            if (planeMeshes[slot].generation != 0 && !store.IsValid({slot, planeMeshes[slot].generation})) {
+                planeMeshes[slot] = PlaneMesh();
+            }
+        }
     }
 
-    void WorldPlaneRenderer::UpdateForPlane(const HwArSession *session,
-                                            const HwArPlane *plane)
+    void WorldPlaneRenderer::DrawPacket(uint32_t)
     {
-        vertices.clear();
-        triangles.clear();
+        UpdateBatch();
+        util::GlStateCache &state = util::GetGlState();
+        state.UseProgram(mShaderProgram);
+        state.DepthMask(GL_FALSE);
+        state.ActiveTexture(GL_TEXTURE0);
+        state.BindTexture(GL_TEXTURE_2D, textureId);
+        state.SetVertexAttribArrays(util::VertexAttribBit(mAttriVertices) | util::VertexAttribBit(mAttriNormalVec) |
+                                    util::VertexAttribBit(mAttriColor));
+        state.BindBuffer(GL_ARRAY_BUFFER, batchVertexBuffer);
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batchIndexBuffer);
+
+        glUniformMatrix4fv(mUniformViewProjectionMat, 1, GL_FALSE, glm::value_ptr(viewProjectionMat));
+
+        // Ranges have their own vertex range, so the attributes are rebased before each draw.
+        const GLsizei stride = sizeof(util::PlaneVertex);
+        for (const util::PlaneBatchRange &range : batchRanges) {
+            const size_t vertexOffset = range.firstVertex * sizeof(util::PlaneVertex);
+            glVertexAttribPointer(mAttriVertices, 4, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(vertexOffset + offsetof(util::PlaneVertex, position)));
+            glVertexAttribPointer(mAttriNormalVec, 3, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(vertexOffset + offsetof(util::PlaneVertex, normal)));
+            glVertexAttribPointer(mAttriColor, 3, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(vertexOffset + offsetof(util::PlaneVertex, color)));
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_SHORT,
+                reinterpret_cast<const GLvoid *>(range.firstIndex * sizeof(GLushort)));
+        }
+        util::CheckGlError("WorldPlaneRenderer::DrawPacket()");
+    }
 
-        int32_t polygonLength = 0;
-        HwArPlane_getPolygonSize(session, plane, &polygonLength);
-        if (polygonLength == 0) {
-            LOGE("WorldPlaneRenderer::UpdateForPlane, no valid plane polygon is found");
+    void WorldPlaneRenderer::UpdateBatch()
+    {
+        // Triangles are blended in the order they are drawn, so the planes are laid out back to front.
+        std::stable_sort(draws.begin(), draws.end(), [](const PlaneDraw &a, const PlaneDraw &b) {
+            return a.depth > b.depth;
+        });
+        frameBakeIds.clear();
+        for (const PlaneDraw &draw : draws) {
+            frameBakeIds.push_back(planeMeshes[draw.meshIndex].bakeId);
+        }
+        // Planes that neither moved nor changed order leave the buffers as they are.
+        if (frameBakeIds == batchBakeIds) {
             return;
         }
-
-        const int32_t verticesSize = polygonLength / 2;
-        std::vector<glm::vec2> raw_vertices(verticesSize);
-        HwArPlane_getPolygon(session, plane, glm::value_ptr(raw_vertices.front()));
-
-        // Fill in vertices 0 to 3. Use the vertex.
-        // xy coordinates for the x and z coordinates of the vertex.
-        // The z coordinate of the vertex is used for alpha.
-        // The alpha value of the outer polygon is 0.
-        for (int32_t i = 0; i < verticesSize; ++i) {
-            vertices.emplace_back(raw_vertices[i].x, raw_vertices[i].y, 0.0f);
+        batchBakeIds.swap(frameBakeIds);
+
+        batchVertices.clear();
+        batchIndices.clear();
+        batchRanges.clear();
+        for (const PlaneDraw &draw : draws) {
+            const PlaneMesh &mesh = planeMeshes[draw.meshIndex];
+            util::AppendPlaneToBatch(mesh.worldVertices, mesh.triangles, batchVertices, batchIndices, batchRanges);
         }
+        util::GlStateCache &state = util::GetGlState();
+        state.BindBuffer(GL_ARRAY_BUFFER, batchVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(batchVertices.size() * sizeof(util::PlaneVertex)),
+            batchVertices.data(), GL_DYNAMIC_DRAW);
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batchIndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(batchIndices.size() * sizeof(GLushort)),
+            batchIndices.data(), GL_DYNAMIC_DRAW);
+    }
 
-        util::Util scopedArPose(session);
-        HwArPlane_getCenterPose(session, plane, scopedArPose.GetArPose());
-        HwArPose_getMatrix(session, scopedArPose.GetArPose(),
-            glm::value_ptr(modelMat));
-        normalVec = util::GetPlaneNormal(*session, *scopedArPose.GetArPose());
-
-        const float kFeatherLength = 0.2f;
-
-        // Feather scale of the distance between the plane center and the vertex.
-        const float kFeatherScale = 0.2f;
-
-        // Fill vertex 0 to vertex 3, and set alpha to 1.
-        for (int32_t i = 0; i < verticesSize; ++i) {
-            glm::vec2 v = raw_vertices[i];
-            const float scale =
-                1.0f - std::min((kFeatherLength / glm::length(v)), kFeatherScale);
-            const glm::vec2 result_v = scale * v;
-            vertices.emplace_back(result_v.x, result_v.y, 1.0f);
+    bool WorldPlaneRenderer::UpdatePlaneMesh(const HwArSession *session,
+                                             const HwArPlane *plane, PlaneMesh &mesh)
+    {
+        int32_t polygonLength = 0;
+        HwArPlane_getPolygonSize(session, plane, &polygonLength);
+        if (polygonLength < 2) {
+            LOGE("WorldPlaneRenderer::UpdatePlaneMesh, no valid plane polygon is found");
+            return false;
         }
+        polygon.resize(polygonLength / 2);
+        HwArPlane_getPolygon(session, plane, glm::value_ptr(polygon.front()));
 
-        const int32_t verticesLength = vertices.size();
-
-        // Obtain the number of vertices.
-        const int32_t halfVerticesLength = verticesLength / 2;
-
-        // Generate triangles (4, 5, 6) and (4, 6, 7).
-        for (int i = halfVerticesLength + 1; i < verticesLength - 1; ++i) {
-            triangles.push_back(halfVerticesLength);
-            triangles.push_back(i);
-            triangles.push_back(i + 1);
+        // Updates often only refine the pose, which needs no new mesh.
+        const uint64_t polygonHash = util::HashPlanePolygon(polygon);
+        if (!mesh.triangles.empty() && polygonHash == mesh.polygonHash) {
+            return true;
         }
-
-        // Generate triangles (0, 1, 4), (4, 1, 5), (5, 1, 2), and (5, 2, 6).
-        // (6, 2, 3), (6, 3, 7), (7, 3, 0), (7, 0, 4)
-        for (int i = 0; i < halfVerticesLength; ++i) {
-            triangles.push_back(i);
-            triangles.push_back((i + 1) % halfVerticesLength);
-            triangles.push_back(i + halfVerticesLength);
-
-            triangles.push_back(i + halfVerticesLength);
-            triangles.push_back((i + 1) % halfVerticesLength);
-            triangles.push_back((i + halfVerticesLength + 1) % halfVerticesLength + halfVerticesLength);
+        util::SimplifyPolygon(polygon, PLANE_SIMPLIFY_TOLERANCE, PLANE_MAX_POLYGON_POINTS, simplifiedPolygon);
+        if (!util::BuildPlaneMesh(simplifiedPolygon, mesh.vertices, mesh.triangles)) {
+            LOGE("WorldPlaneRenderer::UpdatePlaneMesh, plane polygon has too many points: %zu",
+                simplifiedPolygon.size());
+            return false;
         }
+        mesh.polygonHash = polygonHash;
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -21,52 +21,158 @@
 #include <vector>
 
 #include <GLES2/gl2.h>
+#include <android/asset_manager.h>
 
 #include "huawei_arengine_interface.h"
 #include "utils/glm.h"
+#include "utils/plane_mesh.h"
+#include "utils/plane_store.h"
+#include "utils/render_queue.h"
+#include "utils/util.h"
 
 namespace gWorldAr {
-    class WorldPlaneRenderer {
+    class WorldPlaneRenderer : public util::PacketRenderer {
     public:
         WorldPlaneRenderer() = default;
 
         ~WorldPlaneRenderer() = default;
 
         /**
-         * Initialize the OpenGL state used by the plane renderer.
+         * Load the plane texture into a CPU-side buffer. Makes no GL calls, so it can run on a
+         * worker thread before InitializePlaneGlContent.
+         *
+         * @param assetManager AAssetManager pointer.
+         * @return True if the texture was decoded, false otherwise.
+         */
+        bool LoadPlaneAssets(AAssetManager *assetManager);
+
+        /**
+         * Submit the shader program of the planes to the driver, which compiles it while the
+         * other programs are submitted. Must be called on the GL thread.
+         *
+         * @param builder Builder the program is taken from by InitializePlaneGlContent.
+         */
+        void SubmitPrograms(util::ProgramBuilder &builder);
+
+        /**
+         * Initialize the OpenGL state used by the plane renderer and upload the texture loaded
+         * by LoadPlaneAssets.
+         *
+         * @param builder Builder SubmitPrograms submitted the program to.
+         */
+        void InitializePlaneGlContent(util::ProgramBuilder &builder);
+
+        /**
+         * Forget the program, texture and buffer names of a GL context that was destroyed, without
+         * deleting them, so planes are not drawn until InitializePlaneGlContent runs again.
+         */
+        void ResetPlaneGlContent();
+
+        /**
+         * Check whether planes can be drawn.
+         *
+         * @return True once InitializePlaneGlContent has run.
          */
-        void InitializePlaneGlContent();
+        bool IsReady() const
+        {
+            return mShaderProgram != 0;
+        }
 
         /**
-         * Draw the provided plane.
+         * Add a plane of the store to the batch of the frame. Its polygon is queried and meshed again
+         * only if the plane is new or its pose was updated in the store since its mesh was baked, and
+         * its polygon changed. A plane whose mesh cannot be built is left out until it is updated again.
+         * The first plane of a frame queues the draw of the batch.
          *
+         * @param queue Render queue of the frame.
          * @param projectionMat Draw the plane projection information matrix.
          * @param viewMat Draw the plane view information matrix.
          * @param session Query the sessions in the plane drawing.
-         * @param plane  Plane information of the real world in plane drawing.
-         * @param color Color configuration of a plane.
+         * @param store Planes tracked by the render manager, keyed by their HwArPlane.
+         * @param handle Valid handle of the plane in the store.
          */
-        void Draw(const glm::mat4 &projectionMat, const glm::mat4 &viewMat,
-                  const HwArSession *session, const HwArPlane *plane,
-                  const glm::vec3 &color);
+        void Submit(util::RenderQueue &queue, const glm::mat4 &projectionMat, const glm::mat4 &viewMat,
+                    const HwArSession *session, const util::PlaneStore &store, util::TrackableHandle handle);
+
+        // Forget the planes submitted for the previous frame, keeping their storage.
+        void ClearDraws();
+
+        /**
+         * Free the meshes of planes the store no longer holds, after it was compacted.
+         *
+         * @param store Planes tracked by the render manager.
+         */
+        void ReleasePlaneMeshes(const util::PlaneStore &store);
+
+        /**
+         * Draw all planes submitted this frame, back to front, with one call per 16-bit index range.
+         *
+         * @param index Unused, the frame has a single plane packet.
+         */
+        void DrawPacket(uint32_t index) override;
 
     private:
+        // Mesh of a plane, and its vertices in world space at the pose and color it is drawn with.
+        struct PlaneMesh {
+            std::vector<glm::vec3> vertices;
+            std::vector<GLushort> triangles;
+            std::vector<util::PlaneVertex> worldVertices;
+            glm::vec3 color = glm::vec3(0.0f);
+            // Hash of the polygon the mesh was built from.
+            uint64_t polygonHash = 0;
+            // Changes whenever worldVertices do, unique across all planes.
+            uint32_t bakeId = 0;
+            // Generation of the store handle the mesh belongs to, zero for an unused slot.
+            uint32_t generation = 0;
+            // Updated frame of the plane in the store when worldVertices were baked.
+            uint32_t updatedFrame = 0;
+        };
+
+        // A plane submitted this frame, by the store slot of its mesh, and its distance from the camera.
+        struct PlaneDraw {
+            uint32_t meshIndex;
+            float depth;
+        };
+
+        // Query the polygon of an updated plane, and rebuild its mesh if the polygon changed.
+        bool UpdatePlaneMesh(const HwArSession *session, const HwArPlane *plane, PlaneMesh &mesh);
+
+        // Fill the batch buffers with the planes of this frame, unless they hold them in this order already.
+        void UpdateBatch();
+
+        // Cached meshes by slot of the plane's store handle, so they are bounded by the live planes.
+        std::vector<PlaneMesh> planeMeshes;
+        uint32_t lastBakeId = 0;
+
+        std::vector<PlaneDraw> draws;
+        glm::mat4 viewProjectionMat = glm::mat4(1.0f);
+
+        // Polygon of the plane being built and its simplified copy, kept to reuse their storage.
+        std::vector<glm::vec2> polygon;
+        std::vector<glm::vec2> simplifiedPolygon;
+
+        // All planes of the frame, back to front, in one vertex buffer and one index buffer. The bake ids
+        // of the planes in the buffers tell whether they need filling again.
+        std::vector<util::PlaneVertex> batchVertices;
+        std::vector<GLushort> batchIndices;
+        std::vector<util::PlaneBatchRange> batchRanges;
+        std::vector<uint32_t> batchBakeIds;
+        std::vector<uint32_t> frameBakeIds;
+        GLuint batchVertexBuffer = 0;
+        GLuint batchIndexBuffer = 0;
 
-        void UpdateForPlane(const HwArSession *session, const HwArPlane *plane);
+        GLuint textureId = 0;
 
-        std::vector<glm::vec3> vertices;
-        std::vector<GLushort> triangles;
-        glm::mat4 modelMat = glm::mat4(1.0f);
-        glm::vec3 normalVec = glm::vec3(0.0f);
-        GLuint textureId;
+        // Texture decoded by LoadPlaneAssets, released once it is uploaded.
+        util::StagedImage stagedImage = {};
 
-        GLuint mShaderProgram;
+        size_t mProgramId = 0;
+        GLuint mShaderProgram = 0;
         GLint mAttriVertices;
-        GLint mUniformMvpMat;
+        GLint mAttriNormalVec;
+        GLint mAttriColor;
+        GLint mUniformViewProjectionMat;
         GLint mUniformTexture;
-        GLint mUniformModelMat;
-        GLint mUniformNormalVec;
-        GLint mUniformColor;
     };
 }
 #endif
@@ -35,37 +35,51 @@ namespace gWorldAr {
         })";
     }
 
-    void WorldPointCloudRenderer::InitializePointCloudGlContent()
+    void WorldPointCloudRenderer::SubmitPrograms(util::ProgramBuilder &builder)
     {
-        mShaderProgram = util::CreateProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        mProgramId = builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER);
+    }
+
+    void WorldPointCloudRenderer::InitializePointCloudGlContent(util::ProgramBuilder &builder)
+    {
+        mShaderProgram = builder.Take(mProgramId);
         CHECK(mShaderProgram);
         mAttributeVertices = glGetAttribLocation(mShaderProgram, "vertex");
         mUniformMvpMat = glGetUniformLocation(mShaderProgram, "mvp");
         util::CheckGlError("WorldPointCloudRenderer::InitializeBackGroundGlContent()");
     }
 
-    void WorldPointCloudRenderer::Draw(glm::mat4 mvpMatrix, const HwArSession *arSession,
-        const HwArPointCloud *arPointCloud)
+    void WorldPointCloudRenderer::Submit(util::RenderQueue &queue, const glm::mat4 &mvpMatrix,
+                                         const HwArSession *arSession, const HwArPointCloud *arPointCloud)
     {
         CHECK(mShaderProgram);
-        glUseProgram(mShaderProgram);
-
         int32_t numberOfPoints = 0;
         HwArPointCloud_getNumberOfPoints(arSession, arPointCloud, &numberOfPoints);
         if (numberOfPoints <= 0) {
             return;
         }
 
+        // The point dimension is 4.
         const float *pointCloudData;
         HwArPointCloud_getData(arSession, arPointCloud, &pointCloudData);
-        glUniformMatrix4fv(mUniformMvpMat, 1, GL_FALSE, glm::value_ptr(mvpMatrix));
-        glEnableVertexAttribArray(mAttributeVertices);
+        mPoints.assign(pointCloudData, pointCloudData + numberOfPoints * 4);
+        mMvpMatrix = mvpMatrix;
+        queue.Submit(util::MakeSortKey(util::RenderPass::OVERLAY, mShaderProgram, 0, 0.0f), *this, 0);
+    }
+
+    void WorldPointCloudRenderer::DrawPacket(uint32_t)
+    {
+        util::GlStateCache &state = util::GetGlState();
+        state.UseProgram(mShaderProgram);
+        state.DepthMask(GL_TRUE);
+        state.SetVertexAttribArrays(util::VertexAttribBit(mAttributeVertices));
+        state.BindBuffer(GL_ARRAY_BUFFER, 0);
+        glUniformMatrix4fv(mUniformMvpMat, 1, GL_FALSE, glm::value_ptr(mMvpMatrix));
 
         // The point dimension is 4.
         glVertexAttribPointer(mAttributeVertices, 4, GL_FLOAT, GL_FALSE, 0,
-                              pointCloudData);
-        glDrawArrays(GL_POINTS, 0, numberOfPoints);
-        glUseProgram(0);
-        util::CheckGlError("WorldPointCloudRenderer::Draw");
+                              mPoints.data());
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(mPoints.size() / 4));
+        util::CheckGlError("WorldPointCloudRenderer::DrawPacket");
     }
 }
\ No newline at end of file
@@ -25,30 +25,73 @@
 
 #include "huawei_arengine_interface.h"
 #include "utils/glm.h"
+#include "utils/program_builder.h"
+#include "utils/render_queue.h"
 
 namespace gWorldAr {
-    class WorldPointCloudRenderer {
+    class WorldPointCloudRenderer : public util::PacketRenderer {
     public:
         WorldPointCloudRenderer() = default;
 
         ~WorldPointCloudRenderer() = default;
 
+        /**
+         * Submit the shader program of the point cloud to the driver, which compiles it while the
+         * other programs are submitted. Must be called on the GL thread.
+         *
+         * @param builder Builder the program is taken from by InitializePointCloudGlContent.
+         */
+        void SubmitPrograms(util::ProgramBuilder &builder);
+
         /**
          * Initial OpenGL status, which needs to be called on the GL thread.
+         *
+         * @param builder Builder SubmitPrograms submitted the program to.
          */
-        void InitializePointCloudGlContent();
+        void InitializePointCloudGlContent(util::ProgramBuilder &builder);
+
+        // Forget the program of a GL context that was destroyed, so the point cloud is not drawn until
+        // InitializePointCloudGlContent runs again.
+        void ResetPointCloudGlContent()
+        {
+            mShaderProgram = 0;
+        }
 
         /**
-         * AR point cloud rendering.
+         * Check whether the point cloud can be drawn.
          *
+         * @return True once InitializePointCloudGlContent has run.
+         */
+        bool IsReady() const
+        {
+            return mShaderProgram != 0;
+        }
+
+        /**
+         * Copy the points of the point cloud and queue their draw in the overlay pass.
+         *
+         * @param queue Render queue of the frame.
          * @param mvpMatrix Projection matrix of the point cloud model view.
          * @param arSession Query a point cloud session.
          * @param arPointCloud Point the cloud data to the point cloud for rendering.
          */
-        void Draw(glm::mat4 mvpMatrix, const HwArSession *arSession, const HwArPointCloud *arPointCloud);
+        void Submit(util::RenderQueue &queue, const glm::mat4 &mvpMatrix, const HwArSession *arSession,
+                    const HwArPointCloud *arPointCloud);
+
+        /**
+         * AR point cloud rendering of the points copied by Submit.
+         *
+         * @param index Index passed to the queue by Submit.
+         */
+        void DrawPacket(uint32_t index) override;
 
     private:
-        GLuint mShaderProgram;
+        // Points copied by Submit, four floats each, since the point cloud is released before drawing.
+        std::vector<float> mPoints;
+        glm::mat4 mMvpMatrix = glm::mat4(1.0f);
+
+        size_t mProgramId = 0;
+        GLuint mShaderProgram = 0;
         GLuint mAttributeVertices;
         GLuint mUniformMvpMat;
     };
@@ -25,20 +25,84 @@
 #include <gtc/type_ptr.hpp>
 #include <gtx/quaternion.hpp>
 
+#include "jni_interface.h"
+#include "utils/program_cache.h"
 #include "utils/util.h"
 #include "world_ar_application.h"
 
 namespace gWorldAr {
+    namespace {
+        // Loaded assets whose GL objects are created per frame. Each one compiles a program, so
+        // creating them one at a time keeps every frame short.
+        constexpr size_t MAX_UPLOADS_PER_FRAME = 1;
+
+        // Frames between two logs of the GL state calls issued and skipped per frame.
+        constexpr size_t GL_STATE_LOG_INTERVAL = 300;
+
+        // Frames a plane that is no longer reported, or reported as stopped, keeps its state and mesh.
+        constexpr uint32_t PLANE_UNSEEN_FRAMES = 30;
+
+        // Frames between two compactions of the plane store.
+        constexpr uint32_t PLANE_COMPACT_INTERVAL = 30;
+    }
+
     void WorldRenderManager::Initialize(AAssetManager *assetManager)
     {
         LOGI("WorldRenderManager-----Initialize() start.");
-        mBackgroundRenderer.InitializeBackGroundGlContent();
-        mPointCloudRenderer.InitializePointCloudGlContent();
-        mObjectRenderer.InitializeObjectGlContent(assetManager, "AR_logo.obj", "AR_logo.png");
-        mPlaneRenderer.InitializePlaneGlContent();
+        mInitializeTime = std::chrono::steady_clock::now();
+        mIsFirstFrameDrawn = false;
+        mIsFullyLoaded = false;
+
+        // The programs, textures, buffers and GL state of the previous surface were destroyed with its
+        // context. The renderers forget their names before the worker starts loading, so none of them
+        // is drawn until its upload ran in the new context.
+        mProgramBuilder.Reset();
+        util::GetGlState().Invalidate();
+        mPointCloudRenderer.ResetPointCloudGlContent();
+        mPlaneRenderer.ResetPlaneGlContent();
+        mObjectRenderer.ResetObjectGlContent();
+
+        // The camera image is drawn from the first frame, so only the background is set up right away.
+        // Its program is taken before the others are submitted, since drivers that compile in
+        // glLinkProgram would otherwise hold it up until all of them are built.
+        mBackgroundRenderer.SubmitPrograms(mProgramBuilder);
+        mBackgroundRenderer.InitializeBackGroundGlContent(mProgramBuilder);
+
+        // The other programs are submitted together and compile while their assets load.
+        mPointCloudRenderer.SubmitPrograms(mProgramBuilder);
+        mPlaneRenderer.SubmitPrograms(mProgramBuilder);
+        mObjectRenderer.SubmitPrograms(mProgramBuilder);
+
+        // The worker thread has no GL context and cannot look up app classes, so both are cached here.
+        util::SupportsUint32Indices();
+        util::GetHalfFloatVertexType();
+        util::InitializeImageLoading();
+
+        mAssetLoader.Start(DetachJniEnv);
+        mAssetLoader.Enqueue(nullptr, [this](bool) {
+            mPointCloudRenderer.InitializePointCloudGlContent(mProgramBuilder);
+        });
+        mAssetLoader.Enqueue([this, assetManager]() {
+            return mPlaneRenderer.LoadPlaneAssets(assetManager);
+        }, [this](bool) {
+            mPlaneRenderer.InitializePlaneGlContent(mProgramBuilder);
+        });
+        mAssetLoader.Enqueue([this, assetManager]() {
+            return mObjectRenderer.LoadObjectAssets(assetManager, "AR_logo.obj", "AR_logo.png");
+        }, [this](bool isLoaded) {
+            if (isLoaded) {
+                mObjectRenderer.InitializeObjectGlContent(mProgramBuilder);
+            }
+        });
         LOGI("WorldRenderManager-----Initialize() end.");
     }
 
+    double WorldRenderManager::GetMsSinceInitialize() const
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - mInitializeTime;
+        return elapsed.count();
+    }
+
     void WorldRenderManager::OnDrawFrame(HwArSession *arSession,
                                          HwArFrame *arFrame,
                                          const std::vector<ColoredAnchor> &mColoredAnchors)
@@ -46,13 +110,48 @@ namespace gWorldAr {
         glm::mat4 viewMat;
         glm::mat4 projectionMat;
 
+        if (!mIsFullyLoaded && mAssetLoader.Poll(MAX_UPLOADS_PER_FRAME)) {
+            mIsFullyLoaded = true;
+            mProgramBuilder.Clear();
+            LOGI("WorldRenderManager::OnDrawFrame all assets ready after %.1f ms.", GetMsSinceInitialize());
+            util::ProgramCacheStats programStats = util::GetProgramCacheStats();
+            LOGI("WorldRenderManager::OnDrawFrame programs: %zu cached in %.1f ms, %zu compiled in %.1f ms, "
+                 "%zu rejected, %zu stored.", programStats.hitCount, programStats.hitMs, programStats.missCount,
+                 programStats.missMs, programStats.rejectCount, programStats.storeCount);
+        }
+
+        if (++mStateFrameCount == GL_STATE_LOG_INTERVAL) {
+            const util::GlStateStats &stateStats = util::GetGlState().GetStats();
+            LOGI("WorldRenderManager::OnDrawFrame GL state calls per frame: %.1f issued, %.1f skipped.",
+                 static_cast<double>(stateStats.issuedCalls) / mStateFrameCount,
+                 static_cast<double>(stateStats.skippedCalls) / mStateFrameCount);
+            util::GetGlState().ResetStats();
+            mStateFrameCount = 0;
+        }
+
+        // The renderers keep the draw data of their packets until the next frame.
+        mRenderQueue.Clear();
+        mObjectRenderer.ClearDraws();
+        mPlaneRenderer.ClearDraws();
+
         // If the initialization fails, AR scene rendering is not performed.
         if (!InitializeDraw(arSession, arFrame, &viewMat, &projectionMat)) {
             return;
         }
-        RenderObject(arSession, arFrame, viewMat, projectionMat, mColoredAnchors);
-        RenderPlanes(arSession, viewMat, projectionMat);
-        RenderPointCloud(arSession, arFrame, viewMat, projectionMat);
+
+        // Layers whose assets are still loading are left out of the frame.
+        if (mObjectRenderer.IsReady()) {
+            RenderObject(arSession, arFrame, viewMat, projectionMat, mColoredAnchors);
+        }
+        RenderPlanes(arSession, arFrame, viewMat, projectionMat);
+        if (mPointCloudRenderer.IsReady()) {
+            RenderPointCloud(arSession, arFrame, viewMat, projectionMat);
+        }
+
+        // Objects are drawn front to back so the depth test rejects the hidden fragments of their lit
+        // shader, then the blended planes back to front, then the point cloud.
+        mRenderQueue.Sort();
+        mRenderQueue.Execute();
     }
 
     bool WorldRenderManager::InitializeDraw(HwArSession *arSession,
@@ -60,14 +159,16 @@ namespace gWorldAr {
                                             glm::mat4 *viewMat,
                                             glm::mat4 *projectionMat)
     {
-        // Render the scene.
+        // Render the scene. The depth buffer is only cleared while it is written.
+        util::GlStateCache &state = util::GetGlState();
+        state.DepthMask(GL_TRUE);
         glClearColor(0.9f, 0.9f, 0.9f, 1.0f);
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_DEPTH_TEST);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        state.SetCapability(GL_CULL_FACE, true);
+        state.SetCapability(GL_DEPTH_TEST, true);
+        state.SetCapability(GL_BLEND, true);
+        state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         if (arSession == nullptr) {
             return false;
@@ -79,6 +180,8 @@ namespace gWorldAr {
         if (HwArSession_update(arSession, arFrame) != HWAR_SUCCESS) {
             LOGE("WorldRenderManager::InitializeDraw ArSession_update error");
         }
+        // The update binds the camera texture to the active texture unit, and may bind buffers.
+        state.InvalidateBindings();
 
         HwArCamera *arCamera = nullptr;
         HwArFrame_acquireCamera(arSession, arFrame, &arCamera);
@@ -92,6 +195,11 @@ namespace gWorldAr {
         HwArCamera_release(arCamera);
 
         mBackgroundRenderer.Draw(arSession, arFrame);
+        if (!mIsFirstFrameDrawn) {
+            mIsFirstFrameDrawn = true;
+            LOGI("WorldRenderManager::InitializeDraw first background frame after %.1f ms.",
+                 GetMsSinceInitialize());
+        }
 
         // If the camera is not in tracking state, the current frame is not drawn.
         return !(cameraTrackingState != HWAR_TRACKING_STATE_TRACKING);
@@ -102,12 +210,12 @@ namespace gWorldAr {
                                               const glm::mat4 &viewMat,
                                               const glm::mat4 &projectionMat)
     {
-        // Update and render the point cloud.
+        // Update the point cloud and submit its draw.
         HwArPointCloud *arPointCloud = nullptr;
 
         HwArStatus pointCloudStatus = HwArFrame_acquirePointCloud(arSession, arFrame, &arPointCloud);
         if (pointCloudStatus == HWAR_SUCCESS) {
-            mPointCloudRenderer.Draw(projectionMat * viewMat, arSession, arPointCloud);
+            mPointCloudRenderer.Submit(mRenderQueue, projectionMat * viewMat, arSession, arPointCloud);
             HwArPointCloud_release(arPointCloud);
         }
     }
@@ -134,6 +242,11 @@ namespace gWorldAr {
         HwArLightEstimate_destroy(arLightEstimate);
         arLightEstimate = nullptr;
 
+        // Anchors only come and go on touch, so levels of removed anchors are dropped here.
+        if (mAnchorLodMap.size() > mColoredAnchors.size()) {
+            mAnchorLodMap.clear();
+        }
+
         // Initialize the model matrix.
         glm::mat4 modelMat(1.0f);
         for (const auto &coloredAnchor :mColoredAnchors) {
@@ -146,19 +259,40 @@ namespace gWorldAr {
 
                 // The size of the drawn virtual object is 0.2 times the actual size.
                 modelMat = glm::scale(modelMat, glm::vec3(0.2f, 0.2f, 0.2f));
-                mObjectRenderer.Draw(projectionMat, viewMat, modelMat, lightIntensity, coloredAnchor.color);
+                size_t &lod = mAnchorLodMap[coloredAnchor.anchor];
+                lod = mObjectRenderer.SelectLod(projectionMat, viewMat, modelMat, lod);
+                mObjectRenderer.Submit(projectionMat, viewMat, modelMat, lightIntensity, coloredAnchor.color, lod);
             }
         }
+        // The packets are keyed once the nearest object of every level of detail is known.
+        mObjectRenderer.SubmitPackets(mRenderQueue);
     }
 
     void WorldRenderManager::RenderPlanes(HwArSession *arSession,
+                                          HwArFrame *arFrame,
                                           const glm::mat4 &viewMat,
                                           const glm::mat4 &projectionMat)
     {
-        // Update and render the plane.
+        // Update the planes and submit their draws.
         HwArTrackableList *planeList = nullptr;
         HwArTrackableList_create(arSession, &planeList);
         CHECK(planeList != nullptr);
+        ++mPlaneFrame;
+
+        // Only the planes this frame changed are queried again, the others are drawn from the store.
+        HwArFrame_getUpdatedTrackables(arSession, arFrame, HWAR_TRACKABLE_PLANE, planeList);
+        int32_t updatedListSize = 0;
+        HwArTrackableList_getSize(arSession, planeList, &updatedListSize);
+        for (int i = 0; i < updatedListSize; ++i) {
+            HwArTrackable *arTrackable = nullptr;
+            HwArTrackableList_acquireItem(arSession, planeList, i, &arTrackable);
+            HwArPlane *arPlane = HwArAsPlane(arTrackable);
+            const util::TrackableHandle handle = mPlaneStore.Find(arPlane);
+            if (mPlaneStore.IsValid(handle)) {
+                UpdatePlanePose(arSession, arPlane, handle);
+            }
+            HwArTrackable_release(arTrackable);
+        }
 
         HwArTrackableType planeTrackedType = HWAR_TRACKABLE_PLANE;
         HwArSession_getAllTrackables(arSession, planeTrackedType, planeList);
@@ -171,53 +305,85 @@ namespace gWorldAr {
             HwArTrackable *arTrackable = nullptr;
             HwArTrackableList_acquireItem(arSession, planeList, i, &arTrackable);
             HwArPlane *arPlane = HwArAsPlane(arTrackable);
-            HwArTrackingState outTrackingState;
-            HwArTrackable_getTrackingState(arSession, arTrackable,
-                &outTrackingState);
+            util::TrackableHandle handle = mPlaneStore.Find(arPlane);
 
             HwArPlane *subsumePlane = nullptr;
             HwArPlane_acquireSubsumedBy(arSession, arPlane, &subsumePlane);
-
             if (subsumePlane != nullptr) {
                 HwArTrackable_release(HwArAsTrackable(subsumePlane));
+                if (mPlaneStore.IsValid(handle)) {
+                    mPlaneStore.MarkSubsumed(handle);
+                }
+                HwArTrackable_release(arTrackable);
                 continue;
             }
 
-            if (HwArTrackingState::HWAR_TRACKING_STATE_TRACKING != outTrackingState) {
+            // A paused plane stays in the store with its color and mesh, and is only not drawn until it is
+            // tracked again. A stopped plane is never tracked again, so it is left to be evicted.
+            HwArTrackingState planeTrackingState;
+            HwArTrackable_getTrackingState(arSession, arTrackable, &planeTrackingState);
+            if (planeTrackingState == HWAR_TRACKING_STATE_PAUSED && mPlaneStore.IsValid(handle)) {
+                mPlaneStore.MarkSeen(handle, mPlaneFrame);
+            }
+            if (planeTrackingState != HWAR_TRACKING_STATE_TRACKING) {
+                HwArTrackable_release(arTrackable);
                 continue;
             }
 
-            HwArTrackingState planeTrackingState;
-            HwArTrackable_getTrackingState(arSession, HwArAsTrackable(arPlane),
-                &planeTrackingState);
-            if (planeTrackingState == HWAR_TRACKING_STATE_TRACKING) {
-                glm::vec3 color;
-                RendererPlane(arPlane, arTrackable, color);
-                mPlaneRenderer.Draw(projectionMat, viewMat, arSession, arPlane, color);
+            // The store keeps the reference acquired when the plane was added until it is removed, so the
+            // engine cannot hand the same address to another plane while the plane is stored.
+            if (mPlaneStore.IsValid(handle)) {
+                HwArTrackable_release(arTrackable);
+                mPlaneStore.MarkSeen(handle, mPlaneFrame);
+            } else {
+                handle = AddPlane(arSession, arPlane);
+            }
+            // Planes are still counted while the renderer loads, so the app knows they exist.
+            if (mPlaneRenderer.IsReady()) {
+                mPlaneRenderer.Submit(mRenderQueue, projectionMat, viewMat, arSession, mPlaneStore, handle);
             }
         }
 
         HwArTrackableList_destroy(planeList);
         planeList = nullptr;
+
+        // Subsumed planes and planes no longer reported are dropped together, a few times a second.
+        if (mPlaneFrame % PLANE_COMPACT_INTERVAL == 0) {
+            mPlaneStore.Compact(mPlaneFrame, PLANE_UNSEEN_FRAMES, mRemovedPlanes);
+            for (const void *removedPlane : mRemovedPlanes) {
+                HwArTrackable_release(HwArAsTrackable(static_cast<HwArPlane *>(const_cast<void *>(removedPlane))));
+            }
+            if (!mRemovedPlanes.empty()) {
+                mPlaneRenderer.ReleasePlaneMeshes(mPlaneStore);
+            }
+        }
     }
 
-    void WorldRenderManager::RendererPlane(HwArPlane *arPlane, HwArTrackable *arTrackable, glm::vec3 &color)
+    util::TrackableHandle WorldRenderManager::AddPlane(HwArSession *arSession, HwArPlane *arPlane)
     {
-        const auto iter = mPlaneColorMap.find(arPlane);
-        if (iter != mPlaneColorMap.end()) {
-            color = iter->second;
-
-            HwArTrackable_release(arTrackable);
-        } else {
-            // Set the plane color. The first plane is white, and the other planes are blue.
-            if (!firstPlaneHasBeenFound) {
-                firstPlaneHasBeenFound = true;
-                color = {255, 255, 255};
-            } else {
-                color = {0, 206, 209};
-            }
-            mPlaneColorMap.insert(std::pair<HwArPlane *, glm::vec3>(arPlane, color));
+        // Set the plane color. The first plane is white, and the other planes are blue.
+        glm::vec3 color = {0, 206, 209};
+        if (!firstPlaneHasBeenFound) {
+            firstPlaneHasBeenFound = true;
+            color = {255, 255, 255};
         }
+        const util::TrackableHandle handle = mPlaneStore.Insert(arPlane, color, mPlaneFrame);
+        UpdatePlanePose(arSession, arPlane, handle);
+        return handle;
+    }
+
+    void WorldRenderManager::UpdatePlanePose(HwArSession *arSession, HwArPlane *arPlane,
+                                             util::TrackableHandle handle)
+    {
+        util::Util scopedArPose(arSession);
+        HwArPlane_getCenterPose(arSession, arPlane, scopedArPose.GetArPose());
+        glm::mat4 centerPose(1.0f);
+        HwArPose_getMatrix(arSession, scopedArPose.GetArPose(), glm::value_ptr(centerPose));
+        glm::vec2 extent(0.0f);
+        HwArPlane_getExtentX(arSession, arPlane, &extent.x);
+        HwArPlane_getExtentZ(arSession, arPlane, &extent.y);
+        mPlaneStore.UpdatePose(handle, centerPose, util::GetPlaneNormal(*arSession, *scopedArPose.GetArPose()),
+                               extent, mPlaneFrame);
     }
 
     bool WorldRenderManager::HasDetectedPlanes()
@@ -17,6 +17,7 @@
 #ifndef C_ARENGINE_WORLD_AR_RENDER_MANAGER_H
 #define C_ARENGINE_WORLD_AR_RENDER_MANAGER_H
 
+#include <chrono>
 #include <unordered_map>
 
 #include <glm.hpp>
@@ -26,6 +27,10 @@
 #include "rendering/world_object_renderer.h"
 #include "rendering/world_plane_renderer.h"
 #include "rendering/world_point_cloud_renderer.h"
+#include "utils/asset_loader.h"
+#include "utils/plane_store.h"
+#include "utils/program_builder.h"
+#include "utils/render_queue.h"
 
 namespace gWorldAr {
     struct ColoredAnchor {
@@ -40,8 +45,9 @@ namespace gWorldAr {
         ~WorldRenderManager() = default;
 
         /**
-         * Initialize the OpenGL status, including the background,
-         * virtual object, point cloud, and plane drawing.
+         * Initialize the OpenGL status of the background, and start loading the virtual object,
+         * point cloud, and plane drawing in the background. Each of them is drawn from the first
+         * frame after it is loaded.
          *
          * @param assetManager Wrapper of the bottom native implementation.
          */
@@ -58,7 +64,7 @@ namespace gWorldAr {
                          const std::vector<ColoredAnchor> &coloredAnchors);
 
         /**
-         * Implement the Draw function of the virtual object module in the rendering manager.
+         * Submit the draws of the virtual objects to the render queue of the frame.
          *
          * @param arSession Implement the session function.
          * @param arFrame Information about each frame during drawing.
@@ -82,7 +88,7 @@ namespace gWorldAr {
                             glm::mat4 *viewMat, glm::mat4 *projectionMat);
 
         /**
-         * Implement the Draw function of the point cloud module in the rendering manager.
+         * Submit the draw of the point cloud to the render queue of the frame.
          *
          * @param arSession Implement the session function.
          * @param arFrame Information about each frame during point cloud drawing.
@@ -93,21 +99,30 @@ namespace gWorldAr {
                               const glm::mat4 &viewMat, const glm::mat4 &projectionMat);
 
         /**
-         * Implement the Draw function of the plane module in the rendering manager.
+         * Submit the draws of the planes to the render queue of the frame.
          *
          * @param arSession Implement the session function.
+         * @param arFrame Frame whose updated planes are meshed again.
          * @param viewMat nformation about each frame during plane drawing.
          * @param projectionMat Draw the plane projection matrix.
          */
-        void RenderPlanes(HwArSession *arSession, const glm::mat4 &viewMat, const glm::mat4 &projectionMat);
+        void RenderPlanes(HwArSession *arSession, HwArFrame *arFrame, const glm::mat4 &viewMat,
+                          const glm::mat4 &projectionMat);
 
         bool HasDetectedPlanes();
 
     private:
         int32_t mPlaneCount = 0;
 
-        // Store the randomly selected colors used by each plane.
-        std::unordered_map<HwArPlane *, glm::vec3> mPlaneColorMap = {};
+        // Color, pose and last frame seen of each plane, until it is subsumed or no longer reported.
+        util::PlaneStore mPlaneStore;
+        // Frames counted by RenderPlanes, from one.
+        uint32_t mPlaneFrame = 0;
+        // Planes removed by the last compaction of the store, kept to reuse its storage.
+        std::vector<const void *> mRemovedPlanes;
+
+        // Level of detail each anchor's object was drawn with last frame.
+        std::unordered_map<const HwArAnchor *, size_t> mAnchorLodMap = {};
 
         // The first plane is always white, and if true, a plane has been found at a point.
         bool firstPlaneHasBeenFound = false;
@@ -120,7 +135,31 @@ namespace gWorldAr {
 
         WorldObjectRenderer mObjectRenderer = gWorldAr::WorldObjectRenderer();
 
-        void RendererPlane(HwArPlane *arPlane, HwArTrackable *arTrackable, glm::vec3 &color);
+        // Draws of the object, plane and point cloud renderers, sorted before they are issued.
+        util::RenderQueue mRenderQueue;
+
+        // Programs submitted by Initialize, taken by the renderers as their assets are uploaded.
+        util::ProgramBuilder mProgramBuilder;
+
+        // Declared after the renderers, so its worker thread stops before they are destroyed.
+        util::AssetLoader mAssetLoader;
+
+        // Startup timing, logged once for the first background frame and once when everything is loaded.
+        std::chrono::steady_clock::time_point mInitializeTime;
+        bool mIsFirstFrameDrawn = false;
+        bool mIsFullyLoaded = false;
+
+        // Frames drawn since the GL state counters were last logged.
+        size_t mStateFrameCount = 0;
+
+        double GetMsSinceInitialize() const;
+
+        // Add a plane seen for the first time to the store with its color and pose. The store takes over the
+        // reference to the plane acquired by the caller.
+        util::TrackableHandle AddPlane(HwArSession *arSession, HwArPlane *arPlane);
+
+        // Query the pose of a stored plane and store it, marking the plane updated in this frame.
+        void UpdatePlanePose(HwArSession *arSession, HwArPlane *arPlane, util::TrackableHandle handle);
     };
 }
 #endif
\ No newline at end of file
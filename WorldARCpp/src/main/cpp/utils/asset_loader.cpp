@@ -0,0 +1,99 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/asset_loader.h"
+
+#include <utility>
+
+namespace gWorldAr {
+    namespace util {
+        void AssetLoader::Start(std::function<void()> onWorkerExit)
+        {
+            Stop();
+            isStopping = false;
+            worker = std::thread(&AssetLoader::Run, this, std::move(onWorkerExit));
+        }
+
+        void AssetLoader::Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                isStopping = true;
+                pendingJobs.clear();
+            }
+            condition.notify_all();
+            if (worker.joinable()) {
+                worker.join();
+            }
+            loadedJobs.clear();
+            outstandingJobs = 0;
+        }
+
+        void AssetLoader::Enqueue(LoadFunction load, UploadFunction upload)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pendingJobs.push_back({std::move(load), std::move(upload)});
+                ++outstandingJobs;
+            }
+            condition.notify_one();
+        }
+
+        bool AssetLoader::Poll(size_t maxUploads)
+        {
+            for (size_t uploads = 0; uploads < maxUploads; ++uploads) {
+                Job job;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (loadedJobs.empty()) {
+                        break;
+                    }
+                    job = std::move(loadedJobs.front());
+                    loadedJobs.pop_front();
+                }
+                // Uploads run without the lock, so the worker keeps loading meanwhile.
+                job.upload(job.isLoaded);
+                std::lock_guard<std::mutex> lock(mutex);
+                --outstandingJobs;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            return outstandingJobs == 0;
+        }
+
+        void AssetLoader::Run(std::function<void()> onWorkerExit)
+        {
+            for (;;) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [this]() { return isStopping || !pendingJobs.empty(); });
+                    if (isStopping) {
+                        break;
+                    }
+                    job = std::move(pendingJobs.front());
+                    pendingJobs.pop_front();
+                }
+                job.isLoaded = !job.load || job.load();
+                std::lock_guard<std::mutex> lock(mutex);
+                loadedJobs.push_back(std::move(job));
+            }
+            if (onWorkerExit) {
+                onWorkerExit();
+            }
+        }
+    }
+}
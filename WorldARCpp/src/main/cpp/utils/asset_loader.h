@@ -0,0 +1,105 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_ASSET_LOADER_H
+#define C_ARENGINE_HELLOE_AR_ASSET_LOADER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace gWorldAr {
+    // Platform independent background loading, shared by the app and the host-side benchmarks.
+    namespace util {
+        /**
+         * Runs the file I/O and decoding of assets on a worker thread and hands the staged results
+         * back to the GL thread, which creates the GL objects a few at a time between frames.
+         */
+        class AssetLoader {
+        public:
+            // Runs on the worker thread and fills CPU-side buffers. Returns false if loading failed.
+            using LoadFunction = std::function<bool()>;
+
+            // Runs on the GL thread once the load function returned, with its result.
+            using UploadFunction = std::function<void(bool isLoaded)>;
+
+            AssetLoader() = default;
+
+            ~AssetLoader()
+            {
+                Stop();
+            }
+
+            /**
+             * Start the worker thread.
+             *
+             * @param onWorkerExit Optional function the worker thread calls right before it exits,
+             *                     for example to detach it from the JVM.
+             */
+            void Start(std::function<void()> onWorkerExit = nullptr);
+
+            /**
+             * Drop the jobs that are not loaded yet and wait for the worker thread to exit.
+             * Uploads still pending are dropped as well.
+             */
+            void Stop();
+
+            /**
+             * Queue a job. Jobs are loaded in the order they are queued.
+             *
+             * @param load Worker thread part of the job, may be nullptr if there is nothing to load.
+             * @param upload GL thread part of the job.
+             */
+            void Enqueue(LoadFunction load, UploadFunction upload);
+
+            /**
+             * Run the upload step of loaded jobs. Call once per frame on the GL thread.
+             *
+             * @param maxUploads Largest number of uploads run by this call, to bound the frame time.
+             * @return True when every queued job has been uploaded.
+             */
+            bool Poll(size_t maxUploads);
+
+            // Delete copy constructors.
+            AssetLoader(const AssetLoader &) = delete;
+
+            void operator=(const AssetLoader &) = delete;
+
+        private:
+            struct Job {
+                LoadFunction load;
+                UploadFunction upload;
+                bool isLoaded = false;
+            };
+
+            void Run(std::function<void()> onWorkerExit);
+
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::deque<Job> pendingJobs;
+            std::deque<Job> loadedJobs;
+            // Jobs queued and not uploaded yet, including the one the worker is loading.
+            size_t outstandingJobs = 0;
+            bool isStopping = false;
+            std::thread worker;
+        };
+    }
+}
+#endif
@@ -0,0 +1,83 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/gl_capabilities.h"
+
+#include <cstring>
+
+#include <EGL/egl.h>
+
+namespace gWorldAr {
+    namespace util {
+        bool HasGlExtension(const char *extension)
+        {
+            const char *extensions = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+            if (extensions == nullptr) {
+                return false;
+            }
+            // Match whole names only, GL_OES_foo must not match GL_OES_foo_bar.
+            const size_t length = strlen(extension);
+            for (const char *match = strstr(extensions, extension); match != nullptr;
+                 match = strstr(match + length, extension)) {
+                bool isStart = (match == extensions || match[-1] == ' ');
+                bool isEnd = (match[length] == ' ' || match[length] == '\0');
+                if (isStart && isEnd) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool IsEs3Context()
+        {
+            const char *version = reinterpret_cast<const char *>(glGetString(GL_VERSION));
+            return version != nullptr && strncmp(version, "OpenGL ES 3", strlen("OpenGL ES 3")) == 0;
+        }
+
+        bool LoadInstancedArrays(InstancedArrays &outFunctions)
+        {
+            // The extensions only differ in the suffix of their entry points.
+            struct Source {
+                const char *extension;
+                const char *drawElementsInstanced;
+                const char *vertexAttribDivisor;
+            };
+            static const Source SOURCES[] = {
+                {nullptr, "glDrawElementsInstanced", "glVertexAttribDivisor"},
+                {"GL_EXT_instanced_arrays", "glDrawElementsInstancedEXT", "glVertexAttribDivisorEXT"},
+                {"GL_ANGLE_instanced_arrays", "glDrawElementsInstancedANGLE", "glVertexAttribDivisorANGLE"},
+                {"GL_NV_instanced_arrays", "glDrawElementsInstancedNV", "glVertexAttribDivisorNV"}
+            };
+            outFunctions = InstancedArrays();
+            for (const Source &source : SOURCES) {
+                bool isSupported = (source.extension == nullptr) ? IsEs3Context() : HasGlExtension(source.extension);
+                if (!isSupported) {
+                    continue;
+                }
+                outFunctions.drawElementsInstanced = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDEXTPROC>(
+                    eglGetProcAddress(source.drawElementsInstanced));
+                outFunctions.vertexAttribDivisor = reinterpret_cast<PFNGLVERTEXATTRIBDIVISOREXTPROC>(
+                    eglGetProcAddress(source.vertexAttribDivisor));
+                if (outFunctions.drawElementsInstanced != nullptr && outFunctions.vertexAttribDivisor != nullptr) {
+                    return true;
+                }
+            }
+            outFunctions = InstancedArrays();
+            return false;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_GL_CAPABILITIES_H
+#define C_ARENGINE_HELLOE_AR_GL_CAPABILITIES_H
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+namespace gWorldAr {
+    // Queries of the current GL context, shared by the app and the host-side benchmarks.
+    namespace util {
+        /**
+         * Check whether the current GL context exposes an extension.
+         *
+         * @param extension Full extension name, such as "GL_OES_element_index_uint".
+         * @return True if the extension is supported, false otherwise.
+         */
+        bool HasGlExtension(const char *extension);
+
+        /**
+         * Check whether the current GL context is OpenGL ES 3.0 or later.
+         */
+        bool IsEs3Context();
+
+        // Entry points of instanced drawing, from OpenGL ES 3.0 or an instanced arrays extension.
+        struct InstancedArrays {
+            PFNGLDRAWELEMENTSINSTANCEDEXTPROC drawElementsInstanced = nullptr;
+            PFNGLVERTEXATTRIBDIVISOREXTPROC vertexAttribDivisor = nullptr;
+        };
+
+        /**
+         * Look up the instanced drawing entry points of the current GL context. OpenGL ES 3.0 is
+         * preferred, then GL_EXT_instanced_arrays, GL_ANGLE_instanced_arrays and GL_NV_instanced_arrays.
+         *
+         * @param outFunctions Receives the entry points, or null pointers if none are found.
+         * @return True if the context can draw instances with per-instance attributes.
+         */
+        bool LoadInstancedArrays(InstancedArrays &outFunctions);
+    }
+}
+#endif
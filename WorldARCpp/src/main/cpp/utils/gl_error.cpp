@@ -0,0 +1,118 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/gl_error.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+
+#include "utils/gl_capabilities.h"
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            GlErrorCheckMode g_mode = DEFAULT_GL_ERROR_CHECK_MODE;
+
+            // The driver may call the debug callback on its own threads.
+            std::atomic<size_t> g_debugErrorCount(0);
+
+            void GL_APIENTRY OnGlDebugMessage(GLenum, GLenum type, GLuint id, GLenum severity, GLsizei,
+                                              const GLchar *message, const void *)
+            {
+                if (type == GL_DEBUG_TYPE_ERROR_KHR) {
+                    ++g_debugErrorCount;
+                    LOGE("GL debug error %u: %s", id, message);
+                } else if (severity == GL_DEBUG_SEVERITY_HIGH_KHR || severity == GL_DEBUG_SEVERITY_MEDIUM_KHR) {
+                    // Performance and portability notes of lower severity are too frequent to log.
+                    LOGI("GL debug message %u: %s", id, message);
+                }
+            }
+
+            // Install or remove the debug callback. Output is left asynchronous, so the driver does
+            // not have to report a message before the call that caused it returns.
+            bool SetDebugCallback(bool isEnabled)
+            {
+                auto debugMessageCallback = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKKHRPROC>(
+                    eglGetProcAddress("glDebugMessageCallbackKHR"));
+                if (!HasGlExtension("GL_KHR_debug") || debugMessageCallback == nullptr) {
+                    return false;
+                }
+                if (isEnabled) {
+                    debugMessageCallback(OnGlDebugMessage, nullptr);
+                    glEnable(GL_DEBUG_OUTPUT_KHR);
+                } else {
+                    glDisable(GL_DEBUG_OUTPUT_KHR);
+                    debugMessageCallback(nullptr, nullptr);
+                }
+                return true;
+            }
+
+            void CheckErrors(const char *operation)
+            {
+                for (GLint error = glGetError(); error; error = glGetError()) {
+                    LOGE("after %s() glError (0x%x)\n", operation, error);
+                    abort();
+                }
+            }
+        }
+
+        GlErrorCheckMode SetGlErrorCheckMode(GlErrorCheckMode mode)
+        {
+            // Errors raised under the previous mode are not reported under the new one.
+            while (glGetError() != GL_NO_ERROR) {
+            }
+            if (mode == GlErrorCheckMode::KHR_DEBUG && !SetDebugCallback(true)) {
+                LOGE("SetGlErrorCheckMode GL_KHR_debug is not supported, checking errors per frame.");
+                mode = GlErrorCheckMode::PER_FRAME;
+            } else if (mode != GlErrorCheckMode::KHR_DEBUG && g_mode == GlErrorCheckMode::KHR_DEBUG) {
+                SetDebugCallback(false);
+            }
+            g_mode = mode;
+            LOGI("SetGlErrorCheckMode GL error check mode %d.", static_cast<int>(mode));
+            return mode;
+        }
+
+        GlErrorCheckMode GetGlErrorCheckMode()
+        {
+            return g_mode;
+        }
+
+        void CheckGlError(const char *operation)
+        {
+            if (g_mode == GlErrorCheckMode::PER_CALL) {
+                CheckErrors(operation);
+            }
+        }
+
+        void CheckGlFrameError(const char *operation)
+        {
+            if (g_mode == GlErrorCheckMode::PER_FRAME) {
+                CheckErrors(operation);
+            }
+        }
+
+        size_t GetGlDebugErrorCount()
+        {
+            return g_debugErrorCount;
+        }
+    }
+}
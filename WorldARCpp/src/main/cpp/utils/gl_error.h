@@ -0,0 +1,81 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_GL_ERROR_H
+#define C_ARENGINE_HELLOE_AR_GL_ERROR_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gWorldAr {
+    // GL error detection, shared by the app and the host-side benchmarks.
+    namespace util {
+        // How GL errors are detected. glGetError can wait for the GPU on some drivers.
+        enum class GlErrorCheckMode : int32_t {
+            // No checks.
+            OFF = 0,
+            // One glGetError loop per frame, in CheckGlFrameError.
+            PER_FRAME = 1,
+            // A glGetError loop after every draw, in CheckGlError, which names the failing call.
+            PER_CALL = 2,
+            // Errors are reported by the driver to a GL_KHR_debug callback, which never stalls.
+            KHR_DEBUG = 3
+        };
+
+        // Mode of a new context. Builds pass WORLD_AR_GL_ERROR_CHECK=OFF, PER_FRAME, PER_CALL or
+        // KHR_DEBUG to override it; otherwise debug builds check every call and release builds every frame.
+#if defined(WORLD_AR_GL_ERROR_CHECK)
+        constexpr GlErrorCheckMode DEFAULT_GL_ERROR_CHECK_MODE = GlErrorCheckMode::WORLD_AR_GL_ERROR_CHECK;
+#elif defined(NDEBUG)
+        constexpr GlErrorCheckMode DEFAULT_GL_ERROR_CHECK_MODE = GlErrorCheckMode::PER_FRAME;
+#else
+        constexpr GlErrorCheckMode DEFAULT_GL_ERROR_CHECK_MODE = GlErrorCheckMode::PER_CALL;
+#endif
+
+        /**
+         * Select how GL errors of the current context are detected. Must be called on the GL thread,
+         * and again for every new context.
+         *
+         * @param mode Requested mode.
+         * @return Mode in effect. KHR_DEBUG falls back to PER_FRAME when the context lacks GL_KHR_debug.
+         */
+        GlErrorCheckMode SetGlErrorCheckMode(GlErrorCheckMode mode);
+
+        GlErrorCheckMode GetGlErrorCheckMode();
+
+        /**
+         * Checks for GL errors and stops if any. Only checks in PER_CALL mode.
+         *
+         * @param operation Name of the GL function call.
+         */
+        void CheckGlError(const char *operation);
+
+        /**
+         * Checks for the GL errors of a whole frame and stops if any. Only checks in PER_FRAME mode.
+         *
+         * @param operation Name of the function that drew the frame.
+         */
+        void CheckGlFrameError(const char *operation);
+
+        /**
+         * Number of errors reported to the GL_KHR_debug callback since the process started.
+         * May be called on any thread.
+         */
+        size_t GetGlDebugErrorCount();
+    }
+}
+#endif
@@ -0,0 +1,188 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/gl_state.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <GLES2/gl2ext.h>
+
+namespace gWorldAr {
+    namespace util {
+        void GlStateCache::UseProgram(GLuint newProgram)
+        {
+            if (Update(program, newProgram)) {
+                glUseProgram(newProgram);
+            }
+        }
+
+        void GlStateCache::ActiveTexture(GLenum unit)
+        {
+            if (Update(activeTexture, unit)) {
+                glActiveTexture(unit);
+            }
+        }
+
+        void GlStateCache::BindTexture(GLenum target, GLuint texture)
+        {
+            // Bindings belong to the active unit, so they can only be tracked once it is known.
+            const size_t unit = activeTexture.value - GL_TEXTURE0;
+            Tracked<GLuint> *binding = nullptr;
+            if (activeTexture.isKnown && unit < MAX_TRACKED_TEXTURE_UNITS) {
+                if (target == GL_TEXTURE_2D) {
+                    binding = &textures2d[unit];
+                } else if (target == GL_TEXTURE_EXTERNAL_OES) {
+                    binding = &texturesExternal[unit];
+                }
+            }
+            if (binding == nullptr) {
+                ++stats.issuedCalls;
+                glBindTexture(target, texture);
+            } else if (Update(*binding, texture)) {
+                glBindTexture(target, texture);
+            }
+        }
+
+        void GlStateCache::BindBuffer(GLenum target, GLuint buffer)
+        {
+            Tracked<GLuint> *binding = nullptr;
+            if (target == GL_ARRAY_BUFFER) {
+                binding = &arrayBuffer;
+            } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+                binding = &elementArrayBuffer;
+            }
+            if (binding == nullptr) {
+                ++stats.issuedCalls;
+                glBindBuffer(target, buffer);
+            } else if (Update(*binding, buffer)) {
+                glBindBuffer(target, buffer);
+            }
+        }
+
+        GlStateCache::Tracked<bool> *GlStateCache::FindCapability(GLenum capability)
+        {
+            switch (capability) {
+                case GL_BLEND:
+                    return &blend;
+                case GL_CULL_FACE:
+                    return &cullFace;
+                case GL_DEPTH_TEST:
+                    return &depthTest;
+                default:
+                    return nullptr;
+            }
+        }
+
+        void GlStateCache::SetCapability(GLenum capability, bool isEnabled)
+        {
+            Tracked<bool> *state = FindCapability(capability);
+            if (state != nullptr && !Update(*state, isEnabled)) {
+                return;
+            }
+            if (state == nullptr) {
+                ++stats.issuedCalls;
+            }
+            if (isEnabled) {
+                glEnable(capability);
+            } else {
+                glDisable(capability);
+            }
+        }
+
+        void GlStateCache::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+        {
+            // Both factors are set by one call, which is skipped only if both are current.
+            bool isSourceChanged = !blendSource.isKnown || blendSource.value != sourceFactor;
+            bool isDestinationChanged = !blendDestination.isKnown || blendDestination.value != destinationFactor;
+            if (!isSourceChanged && !isDestinationChanged) {
+                ++stats.skippedCalls;
+                return;
+            }
+            blendSource = {sourceFactor, true};
+            blendDestination = {destinationFactor, true};
+            ++stats.issuedCalls;
+            glBlendFunc(sourceFactor, destinationFactor);
+        }
+
+        void GlStateCache::DepthMask(GLboolean isWritten)
+        {
+            if (Update(depthMask, isWritten)) {
+                glDepthMask(isWritten);
+            }
+        }
+
+        void GlStateCache::SetVertexAttribArrays(uint32_t enabledMask)
+        {
+            if (existingVertexAttribs == 0) {
+                GLint maxVertexAttribs = 0;
+                glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxVertexAttribs);
+                const size_t count = std::min(static_cast<size_t>(std::max(0, maxVertexAttribs)),
+                                              MAX_TRACKED_VERTEX_ATTRIBS);
+                existingVertexAttribs = (count < 32) ? ((1u << count) - 1) : ~0u;
+            }
+            enabledMask &= existingVertexAttribs;
+            // Arrays in an unknown state are set either way, disabled ones only if they will be read.
+            const uint32_t changed = ((enabledMask ^ enabledVertexAttribs) | ~knownVertexAttribs) &
+                existingVertexAttribs;
+            for (GLuint index = 0; index < MAX_TRACKED_VERTEX_ATTRIBS; ++index) {
+                const uint32_t bit = 1u << index;
+                if ((changed & bit) == 0) {
+                    stats.skippedCalls += (enabledMask & bit) != 0 ? 1 : 0;
+                } else if ((enabledMask & bit) != 0) {
+                    ++stats.issuedCalls;
+                    glEnableVertexAttribArray(index);
+                } else {
+                    ++stats.issuedCalls;
+                    glDisableVertexAttribArray(index);
+                }
+            }
+            enabledVertexAttribs = enabledMask;
+            knownVertexAttribs = existingVertexAttribs;
+        }
+
+        void GlStateCache::Invalidate()
+        {
+            program = {};
+            activeTexture = {};
+            InvalidateBindings();
+            blend = {};
+            cullFace = {};
+            depthTest = {};
+            blendSource = {};
+            blendDestination = {};
+            depthMask = {};
+            enabledVertexAttribs = 0;
+            knownVertexAttribs = 0;
+            existingVertexAttribs = 0;
+        }
+
+        void GlStateCache::InvalidateBindings()
+        {
+            std::fill(std::begin(textures2d), std::end(textures2d), Tracked<GLuint>());
+            std::fill(std::begin(texturesExternal), std::end(texturesExternal), Tracked<GLuint>());
+            arrayBuffer = {};
+            elementArrayBuffer = {};
+        }
+
+        GlStateCache &GetGlState()
+        {
+            static GlStateCache state;
+            return state;
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_GL_STATE_H
+#define C_ARENGINE_HELLOE_AR_GL_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GLES2/gl2.h>
+
+namespace gWorldAr {
+    // Tracking of the GL state set by the renderers, shared by the app and the host-side benchmarks.
+    namespace util {
+        // Texture units whose bindings are tracked. Bindings of higher units are always issued.
+        constexpr size_t MAX_TRACKED_TEXTURE_UNITS = 8;
+
+        // Vertex attribute arrays whose enabled state is tracked, one bit each in a mask.
+        constexpr size_t MAX_TRACKED_VERTEX_ATTRIBS = 32;
+
+        // Number of state changes sent to the driver and skipped because the value was current.
+        struct GlStateStats {
+            size_t issuedCalls = 0;
+            size_t skippedCalls = 0;
+        };
+
+        /**
+         * Bit of a vertex attribute location in the mask passed to SetVertexAttribArrays.
+         *
+         * @param location Location returned by glGetAttribLocation.
+         * @return 0 for -1 and for locations that are not tracked.
+         */
+        inline uint32_t VertexAttribBit(GLint location)
+        {
+            return (location >= 0 && location < static_cast<GLint>(MAX_TRACKED_VERTEX_ATTRIBS)) ?
+                (1u << location) : 0;
+        }
+
+        /**
+         * Thin layer over the GL state calls of the renderers, which skips every call that sets the
+         * value that is already current. Renderers set the whole state they draw with instead of
+         * resetting it afterwards. Must only be used on the GL thread.
+         */
+        class GlStateCache {
+        public:
+            GlStateCache() = default;
+
+            ~GlStateCache() = default;
+
+            void UseProgram(GLuint program);
+
+            /**
+             * @param unit GL_TEXTURE0 + index of the texture unit.
+             */
+            void ActiveTexture(GLenum unit);
+
+            /**
+             * Bind a texture to the active texture unit.
+             *
+             * @param target GL_TEXTURE_2D or GL_TEXTURE_EXTERNAL_OES. Other targets are always issued.
+             * @param texture Name of the texture.
+             */
+            void BindTexture(GLenum target, GLuint texture);
+
+            /**
+             * Bind a buffer object, or 0 before drawing from client-side arrays.
+             *
+             * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER. Other targets are always issued.
+             * @param buffer Name of the buffer object.
+             */
+            void BindBuffer(GLenum target, GLuint buffer);
+
+            /**
+             * Enable or disable a capability such as GL_BLEND, GL_CULL_FACE or GL_DEPTH_TEST.
+             *
+             * @param capability Capability passed to glEnable and glDisable.
+             * @param isEnabled True to enable it.
+             */
+            void SetCapability(GLenum capability, bool isEnabled);
+
+            void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+            void DepthMask(GLboolean isWritten);
+
+            /**
+             * Enable exactly the vertex attribute arrays in a mask and disable the others.
+             *
+             * @param enabledMask VertexAttribBit of every attribute the next draw reads.
+             */
+            void SetVertexAttribArrays(uint32_t enabledMask);
+
+            /**
+             * Forget all tracked values, so the next call of each kind is issued. Call whenever a new
+             * context is current. The counters are kept.
+             */
+            void Invalidate();
+
+            /**
+             * Forget the tracked texture and buffer bindings. Call after code outside the app, such as
+             * HwArSession_update, bound textures or buffers.
+             */
+            void InvalidateBindings();
+
+            const GlStateStats &GetStats() const
+            {
+                return stats;
+            }
+
+            void ResetStats()
+            {
+                stats = GlStateStats();
+            }
+
+            // Delete copy constructors.
+            GlStateCache(const GlStateCache &) = delete;
+
+            void operator=(const GlStateCache &) = delete;
+
+        private:
+            // Value of a piece of state as far as the cache knows, unknown after Invalidate.
+            template <typename T>
+            struct Tracked {
+                T value = T();
+                bool isKnown = false;
+            };
+
+            // Return true if the call must be issued, and remember the value.
+            template <typename T>
+            bool Update(Tracked<T> &state, T value)
+            {
+                if (state.isKnown && state.value == value) {
+                    ++stats.skippedCalls;
+                    return false;
+                }
+                state.value = value;
+                state.isKnown = true;
+                ++stats.issuedCalls;
+                return true;
+            }
+
+            Tracked<bool> *FindCapability(GLenum capability);
+
+            Tracked<GLuint> program;
+            Tracked<GLenum> activeTexture;
+            Tracked<GLuint> textures2d[MAX_TRACKED_TEXTURE_UNITS];
+            Tracked<GLuint> texturesExternal[MAX_TRACKED_TEXTURE_UNITS];
+            Tracked<GLuint> arrayBuffer;
+            Tracked<GLuint> elementArrayBuffer;
+            Tracked<bool> blend;
+            Tracked<bool> cullFace;
+            Tracked<bool> depthTest;
+            Tracked<GLenum> blendSource;
+            Tracked<GLenum> blendDestination;
+            Tracked<GLboolean> depthMask;
+            uint32_t enabledVertexAttribs = 0;
+            uint32_t knownVertexAttribs = 0;
+            // Arrays of the context from GL_MAX_VERTEX_ATTRIBS, the others cannot be enabled. Queried on first use.
+            uint32_t existingVertexAttribs = 0;
+            GlStateStats stats;
+        };
+
+        /**
+         * State cache of the GL thread, used by all renderers.
+         */
+        GlStateCache &GetGlState();
+    }
+}
+#endif
@@ -0,0 +1,579 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/glb_format.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Nesting deeper than this is not produced by any exporter and would only exhaust the stack.
+            constexpr int MAX_JSON_DEPTH = 64;
+
+            // Size of the file header and of each chunk header.
+            constexpr size_t GLB_HEADER_SIZE = 12;
+            constexpr size_t GLB_CHUNK_HEADER_SIZE = 8;
+
+            // Primitive mode of triangle lists, the default.
+            constexpr uint32_t GLB_MODE_TRIANGLES = 4;
+
+            struct JsonValue {
+                enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+                Type type = NUL;
+                bool boolean = false;
+                double number = 0.0;
+                std::string string;
+                std::vector<JsonValue> items;
+                std::vector<std::pair<std::string, JsonValue>> members;
+
+                const JsonValue *Find(const char *key) const
+                {
+                    for (const auto &member : members) {
+                        if (member.first == key) {
+                            return &member.second;
+                        }
+                    }
+                    return nullptr;
+                }
+
+                const JsonValue *At(size_t index) const
+                {
+                    return (type == ARRAY && index < items.size()) ? &items[index] : nullptr;
+                }
+            };
+
+            // Recursive descent parser for the JSON chunk, which is small next to the binary chunk.
+            class JsonParser {
+            public:
+                JsonParser(const char *begin, const char *end) : cursor(begin), end(end) {}
+
+                bool ParseDocument(JsonValue &outValue)
+                {
+                    if (!ParseValue(outValue, 0)) {
+                        return false;
+                    }
+                    SkipWhitespace();
+                    // The chunk is padded with spaces, but nothing else may follow the document.
+                    return cursor == end;
+                }
+
+            private:
+                void SkipWhitespace()
+                {
+                    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+                        ++cursor;
+                    }
+                }
+
+                bool Consume(char expected)
+                {
+                    SkipWhitespace();
+                    if (cursor < end && *cursor == expected) {
+                        ++cursor;
+                        return true;
+                    }
+                    return false;
+                }
+
+                bool ConsumeWord(const char *word)
+                {
+                    size_t length = strlen(word);
+                    if (static_cast<size_t>(end - cursor) < length || memcmp(cursor, word, length) != 0) {
+                        return false;
+                    }
+                    cursor += length;
+                    return true;
+                }
+
+                bool ParseValue(JsonValue &outValue, int depth)
+                {
+                    SkipWhitespace();
+                    if (cursor == end || depth > MAX_JSON_DEPTH) {
+                        return false;
+                    }
+                    switch (*cursor) {
+                        case '{':
+                            return ParseObject(outValue, depth);
+                        case '[':
+                            return ParseArray(outValue, depth);
+                        case '"':
+                            outValue.type = JsonValue::STRING;
+                            return ParseString(outValue.string);
+                        case 't':
+                            outValue.type = JsonValue::BOOLEAN;
+                            outValue.boolean = true;
+                            return ConsumeWord("true");
+                        case 'f':
+                            outValue.type = JsonValue::BOOLEAN;
+                            return ConsumeWord("false");
+                        case 'n':
+                            return ConsumeWord("null");
+                        default:
+                            return ParseNumber(outValue);
+                    }
+                }
+
+                bool ParseObject(JsonValue &outValue, int depth)
+                {
+                    outValue.type = JsonValue::OBJECT;
+                    ++cursor;
+                    if (Consume('}')) {
+                        return true;
+                    }
+                    do {
+                        outValue.members.emplace_back();
+                        auto &member = outValue.members.back();
+                        SkipWhitespace();
+                        if (cursor == end || *cursor != '"' || !ParseString(member.first) || !Consume(':') ||
+                            !ParseValue(member.second, depth + 1)) {
+                            return false;
+                        }
+                    } while (Consume(','));
+                    return Consume('}');
+                }
+
+                bool ParseArray(JsonValue &outValue, int depth)
+                {
+                    outValue.type = JsonValue::ARRAY;
+                    ++cursor;
+                    if (Consume(']')) {
+                        return true;
+                    }
+                    do {
+                        outValue.items.emplace_back();
+                        if (!ParseValue(outValue.items.back(), depth + 1)) {
+                            return false;
+                        }
+                    } while (Consume(','));
+                    return Consume(']');
+                }
+
+                static void AppendUtf8(uint32_t codePoint, std::string &outString)
+                {
+                    if (codePoint < 0x80) {
+                        outString += static_cast<char>(codePoint);
+                    } else if (codePoint < 0x800) {
+                        outString += static_cast<char>(0xC0 | (codePoint >> 6));
+                        outString += static_cast<char>(0x80 | (codePoint & 0x3F));
+                    } else {
+                        outString += static_cast<char>(0xE0 | (codePoint >> 12));
+                        outString += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                        outString += static_cast<char>(0x80 | (codePoint & 0x3F));
+                    }
+                }
+
+                bool ParseString(std::string &outString)
+                {
+                    // The caller checked the opening quote.
+                    ++cursor;
+                    while (cursor < end && *cursor != '"') {
+                        char c = *cursor++;
+                        if (c != '\\') {
+                            outString += c;
+                            continue;
+                        }
+                        if (cursor == end) {
+                            return false;
+                        }
+                        char escaped = *cursor++;
+                        switch (escaped) {
+                            case 'b': outString += '\b'; break;
+                            case 'f': outString += '\f'; break;
+                            case 'n': outString += '\n'; break;
+                            case 'r': outString += '\r'; break;
+                            case 't': outString += '\t'; break;
+                            case 'u': {
+                                // Names the loader looks up are ASCII, so surrogate pairs are not combined.
+                                if (end - cursor < 4) {
+                                    return false;
+                                }
+                                char hex[5] = {cursor[0], cursor[1], cursor[2], cursor[3], '\0'};
+                                char *hexEnd = nullptr;
+                                uint32_t codePoint = static_cast<uint32_t>(strtoul(hex, &hexEnd, 16));
+                                if (hexEnd != hex + 4) {
+                                    return false;
+                                }
+                                AppendUtf8(codePoint, outString);
+                                cursor += 4;
+                                break;
+                            }
+                            default:
+                                outString += escaped;
+                                break;
+                        }
+                    }
+                    if (cursor == end) {
+                        return false;
+                    }
+                    ++cursor;
+                    return true;
+                }
+
+                bool ParseNumber(JsonValue &outValue)
+                {
+                    // strtod needs a terminated string and the chunk is not, so the token is copied.
+                    const char *start = cursor;
+                    while (cursor < end && (isdigit(static_cast<unsigned char>(*cursor)) || *cursor == '-' ||
+                                            *cursor == '+' || *cursor == '.' || *cursor == 'e' || *cursor == 'E')) {
+                        ++cursor;
+                    }
+                    std::string token(start, cursor);
+                    char *tokenEnd = nullptr;
+                    outValue.type = JsonValue::NUMBER;
+                    outValue.number = strtod(token.c_str(), &tokenEnd);
+                    return !token.empty() && tokenEnd == token.c_str() + token.size();
+                }
+
+                const char *cursor;
+                const char *end;
+            };
+
+            // Read an optional non-negative integer member, failing if it has another type.
+            bool GetUint(const JsonValue &object, const char *key, uint32_t defaultValue, uint32_t &outValue)
+            {
+                const JsonValue *value = object.Find(key);
+                if (value == nullptr) {
+                    outValue = defaultValue;
+                    return true;
+                }
+                if (value->type != JsonValue::NUMBER || value->number < 0.0 || value->number > UINT32_MAX ||
+                    std::floor(value->number) != value->number) {
+                    return false;
+                }
+                outValue = static_cast<uint32_t>(value->number);
+                return true;
+            }
+
+            uint32_t GetComponentCount(const std::string &type)
+            {
+                if (type == "SCALAR") {
+                    return 1;
+                }
+                if (type == "VEC2") {
+                    return 2;
+                }
+                if (type == "VEC3") {
+                    return 3;
+                }
+                return type == "VEC4" ? 4 : 0;
+            }
+
+            bool IsIndexComponentType(uint32_t componentType)
+            {
+                return componentType == GLB_COMPONENT_UNSIGNED_BYTE || componentType == GLB_COMPONENT_UNSIGNED_SHORT ||
+                    componentType == GLB_COMPONENT_UNSIGNED_INT;
+            }
+
+            bool IsVertexComponentType(uint32_t componentType)
+            {
+                // GL ES 2.0 has no 32-bit integer vertex attributes.
+                return componentType != GLB_COMPONENT_UNSIGNED_INT && GetGlbComponentSize(componentType) != 0;
+            }
+
+            bool ReadAccessor(const JsonValue &document, const uint8_t *binary, size_t binarySize,
+                              uint32_t accessorIndex, GlbAccessor &outAccessor)
+            {
+                const JsonValue *accessors = document.Find("accessors");
+                const JsonValue *accessor = (accessors != nullptr) ? accessors->At(accessorIndex) : nullptr;
+                if (accessor == nullptr || accessor->Find("sparse") != nullptr) {
+                    return false;
+                }
+                const JsonValue *type = accessor->Find("type");
+                const JsonValue *normalized = accessor->Find("normalized");
+                uint32_t bufferViewIndex = 0;
+                uint32_t accessorOffset = 0;
+                if (accessor->Find("bufferView") == nullptr || type == nullptr || type->type != JsonValue::STRING ||
+                    !GetUint(*accessor, "bufferView", 0, bufferViewIndex) ||
+                    !GetUint(*accessor, "byteOffset", 0, accessorOffset) ||
+                    !GetUint(*accessor, "componentType", 0, outAccessor.componentType) ||
+                    !GetUint(*accessor, "count", 0, outAccessor.count)) {
+                    return false;
+                }
+                outAccessor.componentCount = GetComponentCount(type->string);
+                outAccessor.normalized = (normalized != nullptr && normalized->boolean);
+                const size_t componentSize = GetGlbComponentSize(outAccessor.componentType);
+                const size_t elementSize = componentSize * outAccessor.componentCount;
+                if (elementSize == 0 || outAccessor.count == 0) {
+                    return false;
+                }
+
+                const JsonValue *bufferViews = document.Find("bufferViews");
+                const JsonValue *bufferView = (bufferViews != nullptr) ? bufferViews->At(bufferViewIndex) : nullptr;
+                uint32_t bufferIndex = 0;
+                uint32_t viewOffset = 0;
+                uint32_t viewLength = 0;
+                uint32_t viewStride = 0;
+                if (bufferView == nullptr || !GetUint(*bufferView, "buffer", 0, bufferIndex) ||
+                    !GetUint(*bufferView, "byteOffset", 0, viewOffset) ||
+                    !GetUint(*bufferView, "byteLength", 0, viewLength) ||
+                    !GetUint(*bufferView, "byteStride", 0, viewStride)) {
+                    return false;
+                }
+                // Only the buffer stored in the binary chunk is supported, external files are not.
+                const JsonValue *buffers = document.Find("buffers");
+                const JsonValue *buffer = (buffers != nullptr) ? buffers->At(bufferIndex) : nullptr;
+                if (bufferIndex != 0 || buffer == nullptr || buffer->Find("uri") != nullptr) {
+                    return false;
+                }
+
+                outAccessor.stride = (viewStride != 0) ? viewStride : static_cast<uint32_t>(elementSize);
+                const size_t span = static_cast<size_t>(outAccessor.stride) * (outAccessor.count - 1) + elementSize;
+                if (static_cast<size_t>(viewOffset) + viewLength > binarySize ||
+                    static_cast<size_t>(accessorOffset) + span > viewLength || outAccessor.stride < elementSize) {
+                    return false;
+                }
+                // GL reads components in place, so they have to be aligned to their size.
+                const size_t offset = static_cast<size_t>(viewOffset) + accessorOffset;
+                if (offset % componentSize != 0 || outAccessor.stride % componentSize != 0) {
+                    return false;
+                }
+                outAccessor.data = binary + offset;
+                return true;
+            }
+
+            template <typename Index>
+            bool AreIndicesInRange(const GlbAccessor &indices, uint32_t vertexCount)
+            {
+                const auto *bytes = static_cast<const uint8_t *>(indices.data);
+                for (uint32_t i = 0; i < indices.count; ++i) {
+                    Index index;
+                    memcpy(&index, bytes + static_cast<size_t>(i) * indices.stride, sizeof(Index));
+                    if (index >= vertexCount) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            bool ReadVertexAccessor(const JsonValue &document, const JsonValue &attributes, const char *name,
+                                    uint32_t componentCount, const uint8_t *binary, size_t binarySize,
+                                    GlbAccessor &outAccessor)
+            {
+                uint32_t accessorIndex = 0;
+                if (attributes.Find(name) == nullptr || !GetUint(attributes, name, 0, accessorIndex) ||
+                    !ReadAccessor(document, binary, binarySize, accessorIndex, outAccessor)) {
+                    LOGE("ReadGlbPrimitive: attribute %s is missing or invalid.", name);
+                    return false;
+                }
+                if (outAccessor.componentCount != componentCount || !IsVertexComponentType(outAccessor.componentType)) {
+                    LOGE("ReadGlbPrimitive: attribute %s has an unsupported type.", name);
+                    return false;
+                }
+                return true;
+            }
+        }
+
+        size_t GetGlbComponentSize(uint32_t componentType)
+        {
+            switch (componentType) {
+                case GLB_COMPONENT_BYTE:
+                case GLB_COMPONENT_UNSIGNED_BYTE:
+                    return 1;
+                case GLB_COMPONENT_SHORT:
+                case GLB_COMPONENT_UNSIGNED_SHORT:
+                case GLB_COMPONENT_HALF_FLOAT:
+                    return 2;
+                case GLB_COMPONENT_UNSIGNED_INT:
+                case GLB_COMPONENT_FLOAT:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        bool ReadGlbPrimitive(const void *data, size_t size, GlbPrimitive &outPrimitive)
+        {
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            uint32_t header[3];
+            if (size < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE) {
+                LOGE("ReadGlbPrimitive: file is too small.");
+                return false;
+            }
+            memcpy(header, bytes, sizeof(header));
+            if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION || header[2] > size ||
+                header[2] < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE) {
+                LOGE("ReadGlbPrimitive: not a glTF 2.0 binary file.");
+                return false;
+            }
+            size = header[2];
+
+            // The JSON chunk comes first and the binary chunk right after it. Chunk lengths are padded
+            // to 4 bytes, which keeps the binary chunk aligned.
+            uint32_t jsonChunk[2];
+            memcpy(jsonChunk, bytes + GLB_HEADER_SIZE, sizeof(jsonChunk));
+            const size_t jsonOffset = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE;
+            if (jsonChunk[1] != GLB_CHUNK_JSON || jsonChunk[0] > size - jsonOffset || jsonChunk[0] % 4 != 0) {
+                LOGE("ReadGlbPrimitive: JSON chunk is missing.");
+                return false;
+            }
+            const size_t binaryHeaderOffset = jsonOffset + jsonChunk[0];
+            uint32_t binaryChunk[2] = {0, 0};
+            if (binaryHeaderOffset + GLB_CHUNK_HEADER_SIZE <= size) {
+                memcpy(binaryChunk, bytes + binaryHeaderOffset, sizeof(binaryChunk));
+            }
+            const size_t binaryOffset = binaryHeaderOffset + GLB_CHUNK_HEADER_SIZE;
+            if (binaryChunk[1] != GLB_CHUNK_BIN || binaryChunk[0] > size - binaryOffset) {
+                LOGE("ReadGlbPrimitive: binary chunk is missing.");
+                return false;
+            }
+
+            JsonValue document;
+            const char *json = reinterpret_cast<const char *>(bytes + jsonOffset);
+            if (!JsonParser(json, json + jsonChunk[0]).ParseDocument(document) || document.type != JsonValue::OBJECT) {
+                LOGE("ReadGlbPrimitive: JSON chunk is malformed.");
+                return false;
+            }
+
+            const JsonValue *meshes = document.Find("meshes");
+            const JsonValue *mesh = (meshes != nullptr) ? meshes->At(0) : nullptr;
+            const JsonValue *primitives = (mesh != nullptr) ? mesh->Find("primitives") : nullptr;
+            const JsonValue *primitive = (primitives != nullptr) ? primitives->At(0) : nullptr;
+            const JsonValue *attributes = (primitive != nullptr) ? primitive->Find("attributes") : nullptr;
+            uint32_t mode = 0;
+            uint32_t indicesIndex = 0;
+            if (attributes == nullptr || !GetUint(*primitive, "mode", GLB_MODE_TRIANGLES, mode) ||
+                mode != GLB_MODE_TRIANGLES) {
+                LOGE("ReadGlbPrimitive: no triangle primitive found.");
+                return false;
+            }
+
+            const uint8_t *binary = bytes + binaryOffset;
+            const size_t binarySize = binaryChunk[0];
+            if (!ReadVertexAccessor(document, *attributes, "POSITION", 3, binary, binarySize, outPrimitive.position) ||
+                !ReadVertexAccessor(document, *attributes, "NORMAL", 3, binary, binarySize, outPrimitive.normal) ||
+                !ReadVertexAccessor(document, *attributes, "TEXCOORD_0", 2, binary, binarySize, outPrimitive.uv)) {
+                return false;
+            }
+            const uint32_t vertexCount = outPrimitive.position.count;
+            if (outPrimitive.normal.count != vertexCount || outPrimitive.uv.count != vertexCount) {
+                LOGE("ReadGlbPrimitive: attribute counts differ.");
+                return false;
+            }
+
+            if (primitive->Find("indices") == nullptr || !GetUint(*primitive, "indices", 0, indicesIndex) ||
+                !ReadAccessor(document, binary, binarySize, indicesIndex, outPrimitive.indices) ||
+                outPrimitive.indices.componentCount != 1 ||
+                !IsIndexComponentType(outPrimitive.indices.componentType) ||
+                outPrimitive.indices.count % 3 != 0) {
+                LOGE("ReadGlbPrimitive: triangle indices are missing or invalid.");
+                return false;
+            }
+            // GL reads client-side vertex arrays without bounds checks, so indices are the one thing scanned.
+            bool isInRange;
+            switch (outPrimitive.indices.componentType) {
+                case GLB_COMPONENT_UNSIGNED_BYTE:
+                    isInRange = AreIndicesInRange<uint8_t>(outPrimitive.indices, vertexCount);
+                    break;
+                case GLB_COMPONENT_UNSIGNED_SHORT:
+                    isInRange = AreIndicesInRange<uint16_t>(outPrimitive.indices, vertexCount);
+                    break;
+                default:
+                    isInRange = AreIndicesInRange<uint32_t>(outPrimitive.indices, vertexCount);
+                    break;
+            }
+            if (!isInRange || outPrimitive.indices.stride != GetGlbComponentSize(outPrimitive.indices.componentType)) {
+                LOGE("ReadGlbPrimitive: indices are out of range or not tightly packed.");
+                return false;
+            }
+            return true;
+        }
+
+        float HalfToFloat(uint16_t half)
+        {
+            const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+            const uint32_t exponent = (half >> 10) & 0x1F;
+            const uint32_t mantissa = half & 0x3FF;
+            uint32_t bits;
+            if (exponent == 0x1F) {
+                // Infinity or NaN.
+                bits = sign | 0x7F800000 | (mantissa << 13);
+            } else if (exponent != 0) {
+                bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+            } else if (mantissa != 0) {
+                // Subnormal halves are normal floats.
+                float value = std::ldexp(static_cast<float>(mantissa), -24);
+                return sign ? -value : value;
+            } else {
+                bits = sign;
+            }
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        void ReadGlbAccessor(const GlbAccessor &accessor, std::vector<float> &outValues)
+        {
+            const auto *bytes = static_cast<const uint8_t *>(accessor.data);
+            const size_t componentSize = GetGlbComponentSize(accessor.componentType);
+            outValues.resize(static_cast<size_t>(accessor.count) * accessor.componentCount);
+            for (uint32_t i = 0; i < accessor.count; ++i) {
+                for (uint32_t c = 0; c < accessor.componentCount; ++c) {
+                    const uint8_t *component = bytes + static_cast<size_t>(i) * accessor.stride + c * componentSize;
+                    float value = 0.0f;
+                    switch (accessor.componentType) {
+                        case GLB_COMPONENT_BYTE: {
+                            int8_t raw;
+                            memcpy(&raw, component, sizeof(raw));
+                            value = accessor.normalized ? std::fmax(raw / 127.0f, -1.0f) : raw;
+                            break;
+                        }
+                        case GLB_COMPONENT_UNSIGNED_BYTE:
+                            value = accessor.normalized ? *component / 255.0f : *component;
+                            break;
+                        case GLB_COMPONENT_SHORT: {
+                            int16_t raw;
+                            memcpy(&raw, component, sizeof(raw));
+                            value = accessor.normalized ? std::fmax(raw / 32767.0f, -1.0f) : raw;
+                            break;
+                        }
+                        case GLB_COMPONENT_UNSIGNED_SHORT: {
+                            uint16_t raw;
+                            memcpy(&raw, component, sizeof(raw));
+                            value = accessor.normalized ? raw / 65535.0f : raw;
+                            break;
+                        }
+                        case GLB_COMPONENT_HALF_FLOAT: {
+                            uint16_t raw;
+                            memcpy(&raw, component, sizeof(raw));
+                            value = HalfToFloat(raw);
+                            break;
+                        }
+                        case GLB_COMPONENT_UNSIGNED_INT: {
+                            uint32_t raw;
+                            memcpy(&raw, component, sizeof(raw));
+                            value = static_cast<float>(raw);
+                            break;
+                        }
+                        default:
+                            memcpy(&value, component, sizeof(value));
+                            break;
+                    }
+                    outValues[static_cast<size_t>(i) * accessor.componentCount + c] = value;
+                }
+            }
+        }
+    }
+}
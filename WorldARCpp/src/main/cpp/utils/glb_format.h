@@ -0,0 +1,104 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_GLB_FORMAT_H
+#define C_ARENGINE_HELLOE_AR_GLB_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Reader for binary glTF 2.0 (.glb) models, which points into the file content instead of copying it.
+    // All fields are little-endian, which matches every ABI the app is built for.
+    namespace util {
+        constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF" read as a little-endian word.
+        constexpr uint32_t GLB_VERSION = 2;
+        constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+        constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+
+        // Extension of binary glTF models.
+        constexpr char GLB_FILE_EXTENSION[] = ".glb";
+
+        // Accessor component types. glTF uses the values of the matching GL enums.
+        constexpr uint32_t GLB_COMPONENT_BYTE = 5120;
+        constexpr uint32_t GLB_COMPONENT_UNSIGNED_BYTE = 5121;
+        constexpr uint32_t GLB_COMPONENT_SHORT = 5122;
+        constexpr uint32_t GLB_COMPONENT_UNSIGNED_SHORT = 5123;
+        constexpr uint32_t GLB_COMPONENT_UNSIGNED_INT = 5125;
+        constexpr uint32_t GLB_COMPONENT_FLOAT = 5126;
+        // Not a glTF component type: no standard exporter writes it. Only the glb writer of the tools
+        // stores half floats, with the GL_HALF_FLOAT value, which other glTF loaders reject.
+        constexpr uint32_t GLB_COMPONENT_HALF_FLOAT = 5131;
+
+        // Elements of an accessor, inside the binary chunk of the file.
+        struct GlbAccessor {
+            const void *data = nullptr; // First element, aligned to the component size.
+            uint32_t componentType = 0; // One of the GLB_COMPONENT values.
+            uint32_t componentCount = 0; // 1 for indices, 2 for texture coordinates, 3 for positions and normals.
+            bool normalized = false; // Integer components are mapped to [0, 1] or [-1, 1].
+            uint32_t stride = 0; // Bytes from one element to the next, never 0.
+            uint32_t count = 0;
+        };
+
+        // First triangle primitive of the first mesh of a model.
+        struct GlbPrimitive {
+            GlbAccessor position;
+            GlbAccessor normal;
+            GlbAccessor uv;
+            GlbAccessor indices; // GLB_COMPONENT_UNSIGNED_BYTE, _SHORT or _INT.
+        };
+
+        /**
+         * Bytes of one component of an accessor.
+         *
+         * @param componentType One of the GLB_COMPONENT values.
+         * @return Component size, or 0 for unknown component types.
+         */
+        size_t GetGlbComponentSize(uint32_t componentType);
+
+        /**
+         * Validate the content of a .glb file and point into its binary chunk, without copying.
+         * Only the JSON chunk is parsed; vertex data is not touched apart from a bounds check of
+         * the indices. Node transforms, materials and further primitives are ignored.
+         *
+         * @param data Start of the file content, at least 4-byte aligned.
+         * @param size Size of the file content in bytes.
+         * @param outPrimitive Accessors of the first primitive, which must have indices, positions,
+         *                     normals and texture coordinates.
+         * @return True if the content is a supported model, false otherwise.
+         */
+        bool ReadGlbPrimitive(const void *data, size_t size, GlbPrimitive &outPrimitive);
+
+        /**
+         * Convert the elements of an accessor to floats, applying normalization.
+         *
+         * @param accessor Accessor of any supported component type.
+         * @param outValues Receives componentCount floats per element.
+         */
+        void ReadGlbAccessor(const GlbAccessor &accessor, std::vector<float> &outValues);
+
+        /**
+         * Convert an IEEE 754 half-precision value to a float.
+         *
+         * @param half Bits of the half.
+         * @return The same value as a float.
+         */
+        float HalfToFloat(uint16_t half);
+    }
+}
+#endif
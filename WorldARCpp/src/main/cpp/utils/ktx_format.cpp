@@ -0,0 +1,168 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/ktx_format.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            constexpr uint8_t KTX_IDENTIFIER[12] = {
+                0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+            };
+
+            // Footprints of the ASTC formats, in the order of their enum values.
+            constexpr uint8_t ASTC_BLOCK_SIZES[][2] = {
+                {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8},
+                {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}
+            };
+
+            size_t AlignTo4(size_t offset)
+            {
+                return (offset + 3) & ~static_cast<size_t>(3);
+            }
+        }
+
+        size_t GetCompressedLevelSize(uint32_t internalFormat, uint32_t width, uint32_t height)
+        {
+            uint32_t blockWidth = 4;
+            uint32_t blockHeight = 4;
+            size_t blockSize;
+            switch (internalFormat) {
+                case KTX_FORMAT_ETC1_RGB8:
+                case KTX_FORMAT_ETC2_RGB8:
+                    blockSize = 8;
+                    break;
+                case KTX_FORMAT_ETC2_RGBA8:
+                    blockSize = 16;
+                    break;
+                default:
+                    if (internalFormat < KTX_FORMAT_ASTC_4X4 || internalFormat > KTX_FORMAT_ASTC_12X12) {
+                        return 0;
+                    }
+                    blockWidth = ASTC_BLOCK_SIZES[internalFormat - KTX_FORMAT_ASTC_4X4][0];
+                    blockHeight = ASTC_BLOCK_SIZES[internalFormat - KTX_FORMAT_ASTC_4X4][1];
+                    blockSize = 16;
+                    break;
+            }
+            return static_cast<size_t>((width + blockWidth - 1) / blockWidth) *
+                   ((height + blockHeight - 1) / blockHeight) * blockSize;
+        }
+
+        uint32_t GetFullMipLevelCount(uint32_t width, uint32_t height)
+        {
+            uint32_t levelCount = 1;
+            for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+                ++levelCount;
+            }
+            return levelCount;
+        }
+
+        bool ReadKtxFile(const void *data, size_t size, KtxTexture &outTexture)
+        {
+            if (data == nullptr || size < sizeof(KtxHeader) || (reinterpret_cast<uintptr_t>(data) & 3) != 0) {
+                LOGE("ReadKtxFile: content is too small or misaligned.");
+                return false;
+            }
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            const auto *header = static_cast<const KtxHeader *>(data);
+            if (memcmp(header->identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 ||
+                header->endianness != KTX_ENDIANNESS) {
+                LOGE("ReadKtxFile: not a little-endian KTX 1.1 file.");
+                return false;
+            }
+            if (header->glType != 0 || header->glFormat != 0 ||
+                GetCompressedLevelSize(header->glInternalFormat, 1, 1) == 0) {
+                LOGE("ReadKtxFile: format 0x%x is not a supported compressed format.", header->glInternalFormat);
+                return false;
+            }
+            if (header->pixelWidth == 0 || header->pixelHeight == 0 || header->pixelDepth != 0 ||
+                header->numberOfArrayElements != 0 || header->numberOfFaces != 1 ||
+                header->numberOfMipmapLevels == 0 ||
+                header->numberOfMipmapLevels > GetFullMipLevelCount(header->pixelWidth, header->pixelHeight)) {
+                LOGE("ReadKtxFile: only 2D textures with their mip levels are supported.");
+                return false;
+            }
+
+            size_t offset = sizeof(KtxHeader) + static_cast<size_t>(header->bytesOfKeyValueData);
+            outTexture.internalFormat = header->glInternalFormat;
+            outTexture.levels.clear();
+            for (uint32_t level = 0; level < header->numberOfMipmapLevels; ++level) {
+                KtxLevel mipLevel;
+                mipLevel.width = std::max(1u, header->pixelWidth >> level);
+                mipLevel.height = std::max(1u, header->pixelHeight >> level);
+                if (offset > size || size - offset < sizeof(uint32_t)) {
+                    LOGE("ReadKtxFile: level %u is truncated.", level);
+                    return false;
+                }
+                memcpy(&mipLevel.size, bytes + offset, sizeof(uint32_t));
+                offset += sizeof(uint32_t);
+                if (mipLevel.size != GetCompressedLevelSize(header->glInternalFormat, mipLevel.width,
+                                                            mipLevel.height) || size - offset < mipLevel.size) {
+                    LOGE("ReadKtxFile: level %u has the wrong size.", level);
+                    return false;
+                }
+                mipLevel.data = bytes + offset;
+                outTexture.levels.push_back(mipLevel);
+                offset = AlignTo4(offset + mipLevel.size);
+            }
+            return true;
+        }
+
+        bool WriteKtxFile(uint32_t internalFormat, uint32_t width, uint32_t height,
+                          const std::vector<std::vector<uint8_t>> &levels, std::vector<uint8_t> &outFile)
+        {
+            if (levels.empty() || levels.size() > GetFullMipLevelCount(width, height)) {
+                LOGE("WriteKtxFile: wrong number of levels.");
+                return false;
+            }
+            KtxHeader header = {};
+            memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+            header.endianness = KTX_ENDIANNESS;
+            header.glTypeSize = 1;
+            header.glInternalFormat = internalFormat;
+            header.glBaseInternalFormat = (internalFormat == KTX_FORMAT_ETC1_RGB8 ||
+                                           internalFormat == KTX_FORMAT_ETC2_RGB8) ?
+                KTX_BASE_FORMAT_RGB : KTX_BASE_FORMAT_RGBA;
+            header.pixelWidth = width;
+            header.pixelHeight = height;
+            header.numberOfFaces = 1;
+            header.numberOfMipmapLevels = static_cast<uint32_t>(levels.size());
+
+            outFile.assign(reinterpret_cast<const uint8_t *>(&header),
+                           reinterpret_cast<const uint8_t *>(&header) + sizeof(header));
+            for (size_t level = 0; level < levels.size(); ++level) {
+                const uint32_t levelWidth = std::max(1u, width >> level);
+                const uint32_t levelHeight = std::max(1u, height >> level);
+                const auto levelSize = static_cast<uint32_t>(levels[level].size());
+                if (levelSize == 0 || levelSize != GetCompressedLevelSize(internalFormat, levelWidth, levelHeight)) {
+                    LOGE("WriteKtxFile: level %zu has the wrong size.", level);
+                    return false;
+                }
+                const auto *sizeBytes = reinterpret_cast<const uint8_t *>(&levelSize);
+                outFile.insert(outFile.end(), sizeBytes, sizeBytes + sizeof(levelSize));
+                outFile.insert(outFile.end(), levels[level].begin(), levels[level].end());
+                outFile.resize(AlignTo4(outFile.size()), 0);
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_KTX_FORMAT_H
+#define C_ARENGINE_HELLOE_AR_KTX_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Reader and writer for KTX 1.1 files holding a compressed 2D texture with its mip levels.
+    // The reader points into the file content instead of copying it. All fields are little-endian,
+    // which matches every ABI the app is built for.
+    namespace util {
+        constexpr uint32_t KTX_ENDIANNESS = 0x04030201;
+
+        // Extension of compressed textures, which replaces ".png" in the asset name. ASTC textures
+        // use the second one, so both can be shipped side by side.
+        constexpr char KTX_FILE_EXTENSION[] = ".ktx";
+        constexpr char KTX_ASTC_FILE_EXTENSION[] = ".astc.ktx";
+
+        // Internal formats of the compressed textures, with the values of the matching GL enums.
+        constexpr uint32_t KTX_FORMAT_ETC1_RGB8 = 0x8D64; // GL_ETC1_RGB8_OES
+        constexpr uint32_t KTX_FORMAT_ETC2_RGB8 = 0x9274; // GL_COMPRESSED_RGB8_ETC2
+        constexpr uint32_t KTX_FORMAT_ETC2_RGBA8 = 0x9278; // GL_COMPRESSED_RGBA8_ETC2_EAC
+        constexpr uint32_t KTX_FORMAT_ASTC_4X4 = 0x93B0; // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+        constexpr uint32_t KTX_FORMAT_ASTC_12X12 = 0x93BD; // GL_COMPRESSED_RGBA_ASTC_12x12_KHR
+        // Base internal formats of the header.
+        constexpr uint32_t KTX_BASE_FORMAT_RGB = 0x1907; // GL_RGB
+        constexpr uint32_t KTX_BASE_FORMAT_RGBA = 0x1908; // GL_RGBA
+
+        struct KtxHeader {
+            uint8_t identifier[12];
+            uint32_t endianness;
+            uint32_t glType; // 0 for compressed textures.
+            uint32_t glTypeSize;
+            uint32_t glFormat; // 0 for compressed textures.
+            uint32_t glInternalFormat;
+            uint32_t glBaseInternalFormat;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth; // 0 for 2D textures.
+            uint32_t numberOfArrayElements; // 0 for textures that are not arrays.
+            uint32_t numberOfFaces; // 1 for textures that are not cube maps.
+            uint32_t numberOfMipmapLevels;
+            uint32_t bytesOfKeyValueData;
+        };
+
+        // One mip level inside the file content.
+        struct KtxLevel {
+            const void *data = nullptr;
+            uint32_t size = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+        };
+
+        // Compressed 2D texture, finest level first.
+        struct KtxTexture {
+            uint32_t internalFormat = 0;
+            std::vector<KtxLevel> levels;
+        };
+
+        /**
+         * Bytes of one mip level of a compressed format, from its block size.
+         *
+         * @param internalFormat One of the KTX_FORMAT values, or an ASTC format between them.
+         * @param width Width of the level in pixels.
+         * @param height Height of the level in pixels.
+         * @return Level size, or 0 for unknown formats.
+         */
+        size_t GetCompressedLevelSize(uint32_t internalFormat, uint32_t width, uint32_t height);
+
+        /**
+         * Number of levels of a full mip chain, down to 1x1.
+         *
+         * @param width Width of the finest level.
+         * @param height Height of the finest level.
+         * @return Level count.
+         */
+        uint32_t GetFullMipLevelCount(uint32_t width, uint32_t height);
+
+        /**
+         * Validate the content of a .ktx file and point into its mip levels, without copying.
+         * Only compressed 2D textures of known formats are accepted, and every level must have the
+         * size its format implies.
+         *
+         * @param data Start of the file content, at least 4-byte aligned.
+         * @param size Size of the file content in bytes.
+         * @param outTexture Receives the format and the levels.
+         * @return True if the content is a supported texture, false otherwise.
+         */
+        bool ReadKtxFile(const void *data, size_t size, KtxTexture &outTexture);
+
+        /**
+         * Serialize a compressed 2D texture into a .ktx file.
+         *
+         * @param internalFormat One of the KTX_FORMAT values.
+         * @param width Width of the finest level in pixels.
+         * @param height Height of the finest level in pixels.
+         * @param levels Compressed data of each level, finest first.
+         * @param outFile Output file content.
+         * @return True if the levels match the format and size, false otherwise.
+         */
+        bool WriteKtxFile(uint32_t internalFormat, uint32_t width, uint32_t height,
+                          const std::vector<std::vector<uint8_t>> &levels, std::vector<uint8_t> &outFile);
+    }
+}
+#endif
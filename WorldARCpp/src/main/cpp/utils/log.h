@@ -0,0 +1,58 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_LOG_H
+#define C_ARENGINE_HELLOE_AR_LOG_H
+
+#include <cstdlib>
+
+// Logging macros shared by the app and the host-side tools, which build the
+// platform independent parts of utils/ without the NDK.
+#ifdef __ANDROID__
+#include <android/log.h>
+
+#ifndef LOGI
+#define LOGI(...) \
+    __android_log_print(ANDROID_LOG_INFO, "worldArCPP", __VA_ARGS__)
+#endif
+
+#ifndef LOGE
+#define LOGE(...) \
+    __android_log_print(ANDROID_LOG_ERROR, "worldArCPP", __VA_ARGS__)
+#endif
+#else
+#include <cstdio>
+
+#ifndef LOGI
+#define LOGI(...) \
+    do { fprintf(stdout, __VA_ARGS__); fputc('\n', stdout); } while (0)
+#endif
+
+#ifndef LOGE
+#define LOGE(...) \
+    do { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); } while (0)
+#endif
+#endif
+
+#ifndef CHECK
+#define CHECK(condition)                                                   \
+    if (!(condition)) {                                                      \
+        LOGE("*** CHECK FAILED at %d: %s", __LINE__, #condition); \
+        abort();                                                               \
+    }
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "utils/mesh_format.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            size_t AlignTo4(size_t offset)
+            {
+                return (offset + 3) & ~static_cast<size_t>(3);
+            }
+        }
+
+        static bool WriteMeshFileContent(const std::vector<float> &vertices,
+                                         const std::vector<float> &normals,
+                                         const std::vector<float> &uvs,
+                                         const void *indices, size_t indexCount, size_t indexSize,
+                                         const std::vector<SubMesh> &subMeshes,
+                                         const std::vector<MeshLod> &lods,
+                                         MeshVertexFormat vertexFormat,
+                                         std::vector<uint8_t> &outFile)
+        {
+            // The vertex dimension is 3.
+            const size_t vertexCount = vertices.size() / 3;
+            if (vertexCount == 0 || indexCount == 0 || subMeshes.empty()) {
+                LOGE("WriteMeshFile: mesh is empty.");
+                return false;
+            }
+            bool hasNormals = !normals.empty();
+            bool hasUvs = !uvs.empty();
+            if ((hasNormals && normals.size() != vertexCount * 3) || (hasUvs && uvs.size() != vertexCount * 2)) {
+                LOGE("WriteMeshFile: attribute sizes do not match the vertex count.");
+                return false;
+            }
+
+            MeshFileHeader header = {};
+            header.magic = MESH_FILE_MAGIC;
+            header.version = MESH_FILE_VERSION;
+            header.vertexCount = static_cast<uint32_t>(vertexCount);
+            const bool isQuantized = (vertexFormat == MESH_VERTEX_FORMAT_QUANTIZED);
+            header.vertexFormat = vertexFormat;
+            header.vertexStride = isQuantized ? sizeof(QuantizedVertex) : sizeof(MeshFileVertex);
+            header.indexCount = static_cast<uint32_t>(indexCount);
+            header.indexSize = static_cast<uint32_t>(indexSize);
+            header.subMeshCount = static_cast<uint32_t>(subMeshes.size());
+            // Without levels of detail, all sub-meshes form the only level.
+            const std::vector<MeshLod> allLods = lods.empty() ?
+                std::vector<MeshLod>{{0, static_cast<uint32_t>(subMeshes.size()), 0.0f}} : lods;
+            header.lodCount = static_cast<uint32_t>(allLods.size());
+            header.subMeshOffset = static_cast<uint32_t>(AlignTo4(sizeof(MeshFileHeader)));
+            header.lodOffset = static_cast<uint32_t>(
+                AlignTo4(header.subMeshOffset + subMeshes.size() * sizeof(SubMesh)));
+            header.vertexDataOffset = static_cast<uint32_t>(
+                AlignTo4(header.lodOffset + allLods.size() * sizeof(MeshLod)));
+            header.indexDataOffset = static_cast<uint32_t>(
+                AlignTo4(header.vertexDataOffset + vertexCount * header.vertexStride));
+            std::copy(vertices.begin(), vertices.begin() + 3, header.boundsMin);
+            std::copy(vertices.begin(), vertices.begin() + 3, header.boundsMax);
+
+            outFile.assign(header.indexDataOffset + indexCount * indexSize, 0);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    header.boundsMin[axis] = std::min(header.boundsMin[axis], vertices[i * 3 + axis]);
+                    header.boundsMax[axis] = std::max(header.boundsMax[axis], vertices[i * 3 + axis]);
+                }
+            }
+            if (isQuantized) {
+                std::vector<QuantizedVertex> quantizedVertices;
+                QuantizeVertices(vertices, normals, uvs, quantizedVertices, header.quantization);
+                memcpy(outFile.data() + header.vertexDataOffset, quantizedVertices.data(),
+                       quantizedVertices.size() * sizeof(QuantizedVertex));
+            } else {
+                auto *outVertices = reinterpret_cast<MeshFileVertex *>(outFile.data() + header.vertexDataOffset);
+                for (size_t i = 0; i < vertexCount; ++i) {
+                    MeshFileVertex &vertex = outVertices[i];
+                    for (int axis = 0; axis < 3; ++axis) {
+                        vertex.position[axis] = vertices[i * 3 + axis];
+                        vertex.normal[axis] = hasNormals ? normals[i * 3 + axis] : 0.0f;
+                    }
+                    vertex.uv[0] = hasUvs ? uvs[i * 2] : 0.0f;
+                    vertex.uv[1] = hasUvs ? uvs[i * 2 + 1] : 0.0f;
+                }
+            }
+            memcpy(outFile.data(), &header, sizeof(header));
+            memcpy(outFile.data() + header.subMeshOffset, subMeshes.data(), subMeshes.size() * sizeof(SubMesh));
+            memcpy(outFile.data() + header.lodOffset, allLods.data(), allLods.size() * sizeof(MeshLod));
+            memcpy(outFile.data() + header.indexDataOffset, indices, indexCount * indexSize);
+            return true;
+        }
+
+        bool WriteMeshFile(const std::vector<float> &vertices,
+                           const std::vector<float> &normals,
+                           const std::vector<float> &uvs,
+                           const std::vector<uint16_t> &indices,
+                           const std::vector<SubMesh> &subMeshes,
+                           const std::vector<MeshLod> &lods,
+                           MeshVertexFormat vertexFormat,
+                           std::vector<uint8_t> &outFile)
+        {
+            return WriteMeshFileContent(vertices, normals, uvs, indices.data(), indices.size(), sizeof(uint16_t),
+                                        subMeshes, lods, vertexFormat, outFile);
+        }
+
+        bool WriteMeshFile(const std::vector<float> &vertices,
+                           const std::vector<float> &normals,
+                           const std::vector<float> &uvs,
+                           const std::vector<uint32_t> &indices,
+                           const std::vector<SubMesh> &subMeshes,
+                           const std::vector<MeshLod> &lods,
+                           MeshVertexFormat vertexFormat,
+                           std::vector<uint8_t> &outFile)
+        {
+            return WriteMeshFileContent(vertices, normals, uvs, indices.data(), indices.size(), sizeof(uint32_t),
+                                        subMeshes, lods, vertexFormat, outFile);
+        }
+
+        bool ReadMeshFile(const void *data, size_t size, MeshFileView &outView)
+        {
+            if (data == nullptr || size < sizeof(MeshFileHeader) ||
+                (reinterpret_cast<uintptr_t>(data) & 3) != 0) {
+                LOGE("ReadMeshFile: content is too small or misaligned.");
+                return false;
+            }
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            const auto *header = static_cast<const MeshFileHeader *>(data);
+            if (header->magic != MESH_FILE_MAGIC || header->version != MESH_FILE_VERSION) {
+                LOGE("ReadMeshFile: unsupported mesh file version.");
+                return false;
+            }
+            const bool isQuantized = (header->vertexFormat == MESH_VERTEX_FORMAT_QUANTIZED);
+            if ((header->vertexFormat != MESH_VERTEX_FORMAT_FLOAT && !isQuantized) ||
+                header->vertexStride != (isQuantized ? sizeof(QuantizedVertex) : sizeof(MeshFileVertex)) ||
+                (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t)) ||
+                (header->vertexDataOffset & 3) != 0 || (header->indexDataOffset & 3) != 0 ||
+                (header->subMeshOffset & 3) != 0 || (header->lodOffset & 3) != 0 || header->lodCount == 0) {
+                LOGE("ReadMeshFile: unsupported mesh file layout.");
+                return false;
+            }
+            uint64_t vertexEnd = header->vertexDataOffset +
+                static_cast<uint64_t>(header->vertexCount) * header->vertexStride;
+            uint64_t indexEnd = header->indexDataOffset +
+                static_cast<uint64_t>(header->indexCount) * header->indexSize;
+            uint64_t subMeshEnd = header->subMeshOffset +
+                static_cast<uint64_t>(header->subMeshCount) * sizeof(SubMesh);
+            uint64_t lodEnd = header->lodOffset + static_cast<uint64_t>(header->lodCount) * sizeof(MeshLod);
+            if (header->vertexDataOffset < sizeof(MeshFileHeader) || header->subMeshOffset < sizeof(MeshFileHeader) ||
+                header->lodOffset < sizeof(MeshFileHeader) || vertexEnd > size || indexEnd > size ||
+                subMeshEnd > size || lodEnd > size) {
+                LOGE("ReadMeshFile: mesh file is truncated.");
+                return false;
+            }
+            const auto *subMeshes = reinterpret_cast<const SubMesh *>(bytes + header->subMeshOffset);
+            for (uint32_t i = 0; i < header->subMeshCount; ++i) {
+                const SubMesh &subMesh = subMeshes[i];
+                if (static_cast<uint64_t>(subMesh.firstVertex) + subMesh.vertexCount > header->vertexCount ||
+                    static_cast<uint64_t>(subMesh.firstIndex) + subMesh.indexCount > header->indexCount ||
+                    (header->indexSize == sizeof(uint16_t) && subMesh.vertexCount > MAX_VERTICES_16_BIT)) {
+                    LOGE("ReadMeshFile: sub-mesh %u is out of range.", i);
+                    return false;
+                }
+            }
+            const auto *lods = reinterpret_cast<const MeshLod *>(bytes + header->lodOffset);
+            for (uint32_t i = 0; i < header->lodCount; ++i) {
+                if (static_cast<uint64_t>(lods[i].firstSubMesh) + lods[i].subMeshCount > header->subMeshCount) {
+                    LOGE("ReadMeshFile: level of detail %u is out of range.", i);
+                    return false;
+                }
+            }
+            outView.header = header;
+            outView.vertices = isQuantized ? nullptr :
+                reinterpret_cast<const MeshFileVertex *>(bytes + header->vertexDataOffset);
+            outView.quantizedVertices = isQuantized ?
+                reinterpret_cast<const QuantizedVertex *>(bytes + header->vertexDataOffset) : nullptr;
+            outView.indices = bytes + header->indexDataOffset;
+            outView.subMeshes = subMeshes;
+            outView.lods = lods;
+            return true;
+        }
+    }
+}
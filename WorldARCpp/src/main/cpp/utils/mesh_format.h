@@ -0,0 +1,134 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_MESH_FORMAT_H
+#define C_ARENGINE_HELLOE_AR_MESH_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/mesh_optimizer.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/mesh_simplifier.h"
+
+namespace gWorldAr {
+    // Binary mesh format produced offline by the mesh compiler and mapped by the app without parsing.
+    // All fields are little-endian, which matches every ABI the app is built for.
+    namespace util {
+        constexpr uint32_t MESH_FILE_MAGIC = 0x48534D57; // "WMSH" read as a little-endian word.
+        constexpr uint32_t MESH_FILE_VERSION = 4;
+
+        // Extension of compiled meshes, which replaces ".obj" in the asset name.
+        constexpr char MESH_FILE_EXTENSION[] = ".mesh";
+
+        enum MeshVertexFormat : uint32_t {
+            MESH_VERTEX_FORMAT_FLOAT = 0, // MeshFileVertex, 32 bytes.
+            MESH_VERTEX_FORMAT_QUANTIZED = 1, // QuantizedVertex, 16 bytes.
+        };
+
+        struct MeshFileHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vertexCount;
+            uint32_t vertexStride;
+            uint32_t indexCount;
+            uint32_t indexSize; // Bytes per index.
+            uint32_t vertexDataOffset; // From the start of the file, 4-byte aligned.
+            uint32_t indexDataOffset; // From the start of the file, 4-byte aligned.
+            uint32_t subMeshCount;
+            uint32_t subMeshOffset; // From the start of the file, 4-byte aligned.
+            uint32_t lodCount; // Levels of detail, finest first, at least 1.
+            uint32_t lodOffset; // From the start of the file, 4-byte aligned.
+            uint32_t vertexFormat; // One of MeshVertexFormat.
+            float boundsMin[3];
+            float boundsMax[3];
+            QuantizationParams quantization; // Only used by MESH_VERTEX_FORMAT_QUANTIZED.
+        };
+
+        // Interleaved vertex, laid out exactly as the renderer feeds it to GL.
+        struct MeshFileVertex {
+            float position[3];
+            float normal[3];
+            float uv[2];
+        };
+
+        // Pointers into the content of a mesh file, valid as long as the content stays mapped.
+        struct MeshFileView {
+            const MeshFileHeader *header = nullptr;
+            const MeshFileVertex *vertices = nullptr; // Set for MESH_VERTEX_FORMAT_FLOAT.
+            const QuantizedVertex *quantizedVertices = nullptr; // Set for MESH_VERTEX_FORMAT_QUANTIZED.
+            const void *indices = nullptr; // uint16_t or uint32_t, see header->indexSize.
+            const SubMesh *subMeshes = nullptr;
+            const MeshLod *lods = nullptr;
+        };
+
+        /**
+         * Serialize a mesh with 16-bit indices into the binary mesh format.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex or empty.
+         * @param uvs Texture coordinates, two floats per vertex or empty.
+         * @param indices Triangle indices, relative to the first vertex of their sub-mesh.
+         * @param subMeshes Vertex and index ranges drawn with one call each.
+         * @param lods Sub-mesh ranges of the levels of detail, or empty for a single level.
+         * @param vertexFormat Layout the vertices are stored in.
+         * @param outFile Output file content.
+         * @return True if the mesh could be serialized, false otherwise.
+         */
+        bool WriteMeshFile(const std::vector<float> &vertices,
+                           const std::vector<float> &normals,
+                           const std::vector<float> &uvs,
+                           const std::vector<uint16_t> &indices,
+                           const std::vector<SubMesh> &subMeshes,
+                           const std::vector<MeshLod> &lods,
+                           MeshVertexFormat vertexFormat,
+                           std::vector<uint8_t> &outFile);
+
+        /**
+         * Serialize a mesh with 32-bit indices into the binary mesh format.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex or empty.
+         * @param uvs Texture coordinates, two floats per vertex or empty.
+         * @param indices Triangle indices, relative to the first vertex of their sub-mesh.
+         * @param subMeshes Vertex and index ranges drawn with one call each.
+         * @param lods Sub-mesh ranges of the levels of detail, or empty for a single level.
+         * @param vertexFormat Layout the vertices are stored in.
+         * @param outFile Output file content.
+         * @return True if the mesh could be serialized, false otherwise.
+         */
+        bool WriteMeshFile(const std::vector<float> &vertices,
+                           const std::vector<float> &normals,
+                           const std::vector<float> &uvs,
+                           const std::vector<uint32_t> &indices,
+                           const std::vector<SubMesh> &subMeshes,
+                           const std::vector<MeshLod> &lods,
+                           MeshVertexFormat vertexFormat,
+                           std::vector<uint8_t> &outFile);
+
+        /**
+         * Validate the content of a mesh file and point into it, without copying.
+         *
+         * @param data Start of the file content, at least 4-byte aligned.
+         * @param size Size of the file content in bytes.
+         * @param outView Pointers into the file content.
+         * @return True if the content is a mesh file of the supported version, false otherwise.
+         */
+        bool ReadMeshFile(const void *data, size_t size, MeshFileView &outView);
+    }
+}
+#endif
@@ -0,0 +1,475 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "utils/mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+            // Position, normal and texture coordinate of one vertex.
+            constexpr int KEY_SIZE = 8;
+
+            uint32_t HashKey(const float *key)
+            {
+                // FNV-1a over the bit patterns of the attributes.
+                uint32_t hash = 2166136261u;
+                for (int i = 0; i < KEY_SIZE; ++i) {
+                    uint32_t bits;
+                    memcpy(&bits, &key[i], sizeof(bits));
+                    hash = (hash ^ bits) * 16777619u;
+                }
+                return hash ^ (hash >> 15);
+            }
+
+            // Parameters of the Forsyth vertex score, as tuned in the original article.
+            constexpr int FORSYTH_CACHE_SIZE = 32;
+            constexpr float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+            constexpr float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+            constexpr float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+            constexpr float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+            float ForsythVertexScore(int cachePosition, uint32_t remainingTriangles)
+            {
+                if (remainingTriangles == 0) {
+                    return -1.0f;
+                }
+                float score = 0.0f;
+                if (cachePosition >= 0 && cachePosition < 3) {
+                    // The vertices of the last triangle get a fixed score, so the next triangle does
+                    // not prefer one of its edges over the others.
+                    score = FORSYTH_LAST_TRIANGLE_SCORE;
+                } else if (cachePosition >= 3) {
+                    const float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                    score = powf(1.0f - (cachePosition - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+                }
+                // Vertices with few triangles left are finished first, so they do not stay behind alone.
+                score += FORSYTH_VALENCE_BOOST_SCALE *
+                    powf(static_cast<float>(remainingTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+                return score;
+            }
+
+            // Triangles around each vertex, stored as compressed rows.
+            struct TriangleAdjacency {
+                std::vector<uint32_t> offsets;
+                std::vector<uint32_t> counts;
+                std::vector<uint32_t> triangles;
+            };
+
+            void BuildTriangleAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount,
+                                        TriangleAdjacency &adjacency)
+            {
+                adjacency.offsets.assign(vertexCount + 1, 0);
+                adjacency.counts.assign(vertexCount, 0);
+                for (uint32_t index : indices) {
+                    ++adjacency.counts[index];
+                }
+                for (size_t i = 0; i < vertexCount; ++i) {
+                    adjacency.offsets[i + 1] = adjacency.offsets[i] + adjacency.counts[i];
+                }
+                adjacency.triangles.resize(indices.size());
+                std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+                for (size_t corner = 0; corner < indices.size(); ++corner) {
+                    adjacency.triangles[fill[indices[corner]]++] = static_cast<uint32_t>(corner / 3);
+                }
+            }
+
+            void RemoveTriangle(TriangleAdjacency &adjacency, uint32_t vertex, uint32_t triangle)
+            {
+                uint32_t *begin = &adjacency.triangles[adjacency.offsets[vertex]];
+                uint32_t *end = begin + adjacency.counts[vertex];
+                uint32_t *found = std::find(begin, end, triangle);
+                if (found != end) {
+                    *found = *(end - 1);
+                    --adjacency.counts[vertex];
+                }
+            }
+
+            // Move the attributes of each vertex to the position the remap table gives it.
+            void RemapAttribute(std::vector<float> &attribute, size_t dimension, const std::vector<uint32_t> &remap,
+                                size_t newVertexCount)
+            {
+                if (attribute.empty()) {
+                    return;
+                }
+                std::vector<float> remapped(newVertexCount * dimension);
+                for (size_t vertex = 0; vertex < remap.size(); ++vertex) {
+                    if (remap[vertex] != UINT32_MAX) {
+                        std::copy_n(&attribute[vertex * dimension], dimension, &remapped[remap[vertex] * dimension]);
+                    }
+                }
+                attribute.swap(remapped);
+            }
+        }
+
+        VertexWelder::VertexWelder(std::vector<float> &outVertices, std::vector<float> &outNormals,
+                                   std::vector<float> &outUvs, size_t cornerCount)
+            : vertices(outVertices), normals(outNormals), uvs(outUvs)
+        {
+            vertices.clear();
+            normals.clear();
+            uvs.clear();
+            // Keep the table at most half full, so probe sequences stay short.
+            size_t capacity = 16;
+            while (capacity < cornerCount * 2) {
+                capacity *= 2;
+            }
+            slots.assign(capacity, EMPTY_SLOT);
+        }
+
+        bool VertexWelder::Matches(uint32_t vertex, const float *key) const
+        {
+            // Keys are canonical, so bitwise equality is value equality.
+            return memcmp(&vertices[vertex * 3], key, sizeof(float) * 3) == 0 &&
+                (!hasNormals || memcmp(&normals[vertex * 3], key + 3, sizeof(float) * 3) == 0) &&
+                (!hasUvs || memcmp(&uvs[vertex * 2], key + 6, sizeof(float) * 2) == 0);
+        }
+
+        uint32_t VertexWelder::Insert(const float *position, const float *normal, const float *uv)
+        {
+            if (vertexCount == 0) {
+                hasNormals = (normal != nullptr);
+                hasUvs = (uv != nullptr);
+            }
+
+            // Adding 0.0f turns -0.0f into 0.0f, so both weld together.
+            float key[KEY_SIZE] = {};
+            for (int i = 0; i < 3; ++i) {
+                key[i] = position[i] + 0.0f;
+                key[3 + i] = hasNormals ? normal[i] + 0.0f : 0.0f;
+            }
+            key[6] = hasUvs ? uv[0] + 0.0f : 0.0f;
+            key[7] = hasUvs ? uv[1] + 0.0f : 0.0f;
+
+            const size_t mask = slots.size() - 1;
+            for (size_t slot = HashKey(key) & mask;; slot = (slot + 1) & mask) {
+                uint32_t vertex = slots[slot];
+                if (vertex == EMPTY_SLOT) {
+                    vertex = static_cast<uint32_t>(vertexCount++);
+                    slots[slot] = vertex;
+                    vertices.insert(vertices.end(), key, key + 3);
+                    if (hasNormals) {
+                        normals.insert(normals.end(), key + 3, key + 6);
+                    }
+                    if (hasUvs) {
+                        uvs.insert(uvs.end(), key + 6, key + 8);
+                    }
+                    return vertex;
+                }
+                if (Matches(vertex, key)) {
+                    return vertex;
+                }
+            }
+        }
+
+        void SplitMesh(const std::vector<float> &vertices,
+                       const std::vector<float> &normals,
+                       const std::vector<float> &uvs,
+                       const std::vector<uint32_t> &indices,
+                       size_t maxVertices,
+                       std::vector<float> &outVertices,
+                       std::vector<float> &outNormals,
+                       std::vector<float> &outUvs,
+                       std::vector<uint16_t> &outIndices,
+                       std::vector<SubMesh> &outSubMeshes)
+        {
+            outVertices.clear();
+            outNormals.clear();
+            outUvs.clear();
+            outIndices.clear();
+            outSubMeshes.clear();
+            outIndices.reserve(indices.size());
+
+            // The vertex and normal dimensions are 3, the texture coordinate dimension is 2.
+            const size_t vertexCount = vertices.size() / 3;
+            const bool hasNormals = !normals.empty();
+            const bool hasUvs = !uvs.empty();
+
+            // Index of each source vertex in the current sub-mesh, valid when its owner is the current one.
+            std::vector<uint32_t> remap(vertexCount, 0);
+            std::vector<uint32_t> owner(vertexCount, UINT32_MAX);
+            uint32_t subMeshId = 0;
+            SubMesh current = {0, 0, 0, 0};
+
+            for (size_t triangle = 0; triangle + 2 < indices.size(); triangle += 3) {
+                const uint32_t *corners = &indices[triangle];
+                uint32_t newVertices = 0;
+                for (int i = 0; i < 3; ++i) {
+                    bool isRepeated = (i > 0 && corners[i] == corners[0]) || (i > 1 && corners[i] == corners[1]);
+                    newVertices += (owner[corners[i]] != subMeshId && !isRepeated);
+                }
+                if (current.vertexCount + newVertices > maxVertices) {
+                    outSubMeshes.push_back(current);
+                    ++subMeshId;
+                    current = {static_cast<uint32_t>(outVertices.size() / 3), 0,
+                               static_cast<uint32_t>(outIndices.size()), 0};
+                }
+                for (int i = 0; i < 3; ++i) {
+                    uint32_t source = corners[i];
+                    if (owner[source] != subMeshId) {
+                        owner[source] = subMeshId;
+                        remap[source] = current.vertexCount++;
+                        outVertices.insert(outVertices.end(), &vertices[source * 3], &vertices[source * 3] + 3);
+                        if (hasNormals) {
+                            outNormals.insert(outNormals.end(), &normals[source * 3], &normals[source * 3] + 3);
+                        }
+                        if (hasUvs) {
+                            outUvs.insert(outUvs.end(), &uvs[source * 2], &uvs[source * 2] + 2);
+                        }
+                    }
+                    outIndices.push_back(static_cast<uint16_t>(remap[source]));
+                }
+                current.indexCount += 3;
+            }
+            if (current.indexCount > 0) {
+                outSubMeshes.push_back(current);
+            }
+        }
+
+        VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, size_t cacheSize)
+        {
+            VertexCacheStats stats;
+            if (indices.empty() || vertexCount == 0) {
+                return stats;
+            }
+            // A vertex is in the FIFO cache while fewer than cacheSize misses happened since its own.
+            std::vector<size_t> missTime(vertexCount, 0);
+            size_t misses = 0;
+            for (uint32_t index : indices) {
+                if (missTime[index] == 0 || misses + 1 - missTime[index] > cacheSize) {
+                    ++misses;
+                    missTime[index] = misses;
+                }
+            }
+            stats.acmr = static_cast<float>(misses) / (indices.size() / 3);
+            stats.atvr = static_cast<float>(misses) / vertexCount;
+            return stats;
+        }
+
+        void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+        {
+            const size_t triangleCount = indices.size() / 3;
+            if (triangleCount == 0) {
+                return;
+            }
+            TriangleAdjacency adjacency;
+            BuildTriangleAdjacency(indices, vertexCount, adjacency);
+
+            std::vector<int> cachePositions(vertexCount, -1);
+            std::vector<float> vertexScores(vertexCount);
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                vertexScores[vertex] = ForsythVertexScore(-1, adjacency.counts[vertex]);
+            }
+            std::vector<float> triangleScores(triangleCount);
+            for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+                triangleScores[triangle] = vertexScores[indices[triangle * 3]] +
+                    vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+            }
+            std::vector<uint8_t> isEmitted(triangleCount, 0);
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+
+            // The cache holds FORSYTH_CACHE_SIZE vertices, plus up to three pushed out by the last triangle.
+            uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+            size_t cacheCount = 0;
+            size_t nextTriangle = 0;
+            int64_t bestTriangle = static_cast<int64_t>(
+                std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+
+            while (output.size() < indices.size()) {
+                if (bestTriangle < 0) {
+                    // Nothing adjacent to the cache is left, continue with the next triangle in input order.
+                    while (isEmitted[nextTriangle]) {
+                        ++nextTriangle;
+                    }
+                    bestTriangle = static_cast<int64_t>(nextTriangle);
+                }
+                const uint32_t *corners = &indices[bestTriangle * 3];
+                output.insert(output.end(), corners, corners + 3);
+                isEmitted[bestTriangle] = 1;
+
+                // The vertices of the emitted triangle move to the front of the cache.
+                uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+                size_t newCacheCount = 0;
+                for (int i = 0; i < 3; ++i) {
+                    RemoveTriangle(adjacency, corners[i], static_cast<uint32_t>(bestTriangle));
+                    if (std::find(newCache, newCache + newCacheCount, corners[i]) == newCache + newCacheCount) {
+                        newCache[newCacheCount++] = corners[i];
+                    }
+                }
+                for (size_t i = 0; i < cacheCount; ++i) {
+                    if (std::find(corners, corners + 3, cache[i]) == corners + 3) {
+                        newCache[newCacheCount++] = cache[i];
+                    }
+                }
+
+                // Rescore the cached and evicted vertices, and the triangles still using them.
+                for (size_t i = 0; i < newCacheCount; ++i) {
+                    uint32_t vertex = newCache[i];
+                    cachePositions[vertex] = (i < FORSYTH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+                    float score = ForsythVertexScore(cachePositions[vertex], adjacency.counts[vertex]);
+                    float delta = score - vertexScores[vertex];
+                    vertexScores[vertex] = score;
+                    const uint32_t *triangles = &adjacency.triangles[adjacency.offsets[vertex]];
+                    for (uint32_t j = 0; j < adjacency.counts[vertex]; ++j) {
+                        triangleScores[triangles[j]] += delta;
+                    }
+                }
+                cacheCount = std::min(newCacheCount, static_cast<size_t>(FORSYTH_CACHE_SIZE));
+                std::copy_n(newCache, cacheCount, cache);
+
+                // The best next triangle uses at least one cached vertex, or starts somewhere new.
+                bestTriangle = -1;
+                float bestScore = -1.0f;
+                for (size_t i = 0; i < cacheCount; ++i) {
+                    uint32_t vertex = cache[i];
+                    const uint32_t *triangles = &adjacency.triangles[adjacency.offsets[vertex]];
+                    for (uint32_t j = 0; j < adjacency.counts[vertex]; ++j) {
+                        if (triangleScores[triangles[j]] > bestScore) {
+                            bestScore = triangleScores[triangles[j]];
+                            bestTriangle = triangles[j];
+                        }
+                    }
+                }
+            }
+            indices.swap(output);
+        }
+
+        void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &vertices)
+        {
+            const size_t triangleCount = indices.size() / 3;
+            const size_t vertexCount = vertices.size() / 3;
+            if (triangleCount == 0) {
+                return;
+            }
+
+            // A new cluster starts at every triangle whose three vertices all miss the cache.
+            std::vector<uint32_t> clusterStarts;
+            std::vector<size_t> missTime(vertexCount, 0);
+            size_t misses = 0;
+            for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+                int triangleMisses = 0;
+                for (int i = 0; i < 3; ++i) {
+                    uint32_t index = indices[triangle * 3 + i];
+                    if (missTime[index] == 0 || misses + 1 - missTime[index] > VERTEX_CACHE_SIZE) {
+                        ++misses;
+                        missTime[index] = misses;
+                        ++triangleMisses;
+                    }
+                }
+                if (triangle == 0 || triangleMisses == 3) {
+                    clusterStarts.push_back(static_cast<uint32_t>(triangle));
+                }
+            }
+            const size_t clusterCount = clusterStarts.size();
+            clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+            // Area weighted centroid and normal of every cluster, and the centroid of the mesh.
+            std::vector<float> centroids(clusterCount * 3, 0.0f);
+            std::vector<float> normals(clusterCount * 3, 0.0f);
+            float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+            float meshArea = 0.0f;
+            for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+                float area = 0.0f;
+                for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle) {
+                    const float *p0 = &vertices[indices[triangle * 3] * 3];
+                    const float *p1 = &vertices[indices[triangle * 3 + 1] * 3];
+                    const float *p2 = &vertices[indices[triangle * 3 + 2] * 3];
+                    float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+                    float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+                    float normal[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                                       e1[0] * e2[1] - e1[1] * e2[0]};
+                    float triangleArea = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] +
+                                               normal[2] * normal[2]);
+                    for (int axis = 0; axis < 3; ++axis) {
+                        centroids[cluster * 3 + axis] += (p0[axis] + p1[axis] + p2[axis]) / 3.0f * triangleArea;
+                        normals[cluster * 3 + axis] += normal[axis];
+                    }
+                    area += triangleArea;
+                }
+                for (int axis = 0; axis < 3; ++axis) {
+                    meshCentroid[axis] += centroids[cluster * 3 + axis];
+                    centroids[cluster * 3 + axis] /= (area > 0.0f ? area : 1.0f);
+                }
+                meshArea += area;
+            }
+            for (float &coordinate : meshCentroid) {
+                coordinate /= (meshArea > 0.0f ? meshArea : 1.0f);
+            }
+
+            // Clusters facing away from the centre are on the outside of the mesh and go first.
+            std::vector<float> sortKeys(clusterCount);
+            for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+                const float *normal = &normals[cluster * 3];
+                float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                float key = 0.0f;
+                for (int axis = 0; axis < 3; ++axis) {
+                    key += (centroids[cluster * 3 + axis] - meshCentroid[axis]) * normal[axis];
+                }
+                sortKeys[cluster] = length > 0.0f ? key / length : 0.0f;
+            }
+            std::vector<uint32_t> order(clusterCount);
+            for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+                order[cluster] = static_cast<uint32_t>(cluster);
+            }
+            std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) {
+                return sortKeys[a] > sortKeys[b];
+            });
+
+            std::vector<uint32_t> output;
+            output.reserve(indices.size());
+            for (uint32_t cluster : order) {
+                output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3,
+                              indices.begin() + clusterStarts[cluster + 1] * 3);
+            }
+            indices.swap(output);
+        }
+
+        void OptimizeVertexFetch(std::vector<float> &vertices,
+                                 std::vector<float> &normals,
+                                 std::vector<float> &uvs,
+                                 std::vector<uint32_t> &indices)
+        {
+            // The vertex and normal dimensions are 3, the texture coordinate dimension is 2.
+            std::vector<uint32_t> remap(vertices.size() / 3, UINT32_MAX);
+            uint32_t nextVertex = 0;
+            for (uint32_t &index : indices) {
+                if (remap[index] == UINT32_MAX) {
+                    remap[index] = nextVertex++;
+                }
+                index = remap[index];
+            }
+            RemapAttribute(vertices, 3, remap, nextVertex);
+            RemapAttribute(normals, 3, remap, nextVertex);
+            RemapAttribute(uvs, 2, remap, nextVertex);
+        }
+
+        void OptimizeMesh(std::vector<float> &vertices,
+                          std::vector<float> &normals,
+                          std::vector<float> &uvs,
+                          std::vector<uint32_t> &indices)
+        {
+            OptimizeVertexCache(indices, vertices.size() / 3);
+            OptimizeOverdraw(indices, vertices);
+            OptimizeVertexFetch(vertices, normals, uvs, indices);
+        }
+    }
+}
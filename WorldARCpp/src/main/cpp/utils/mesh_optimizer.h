@@ -0,0 +1,176 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_MESH_OPTIMIZER_H
+#define C_ARENGINE_HELLOE_AR_MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Platform independent mesh processing run after loading and before GPU upload.
+    namespace util {
+        // Largest number of vertices 16-bit indices can address.
+        constexpr size_t MAX_VERTICES_16_BIT = 65536;
+
+        // Post-transform cache size assumed when measuring vertex cache efficiency.
+        constexpr size_t VERTEX_CACHE_SIZE = 16;
+
+        // Vertex cache efficiency of a triangle order, simulated with a FIFO cache.
+        struct VertexCacheStats {
+            float acmr = 0.0f; // Average cache miss ratio: vertices shaded per triangle, 0.5 at best.
+            float atvr = 0.0f; // Average transformed vertex ratio: vertices shaded per vertex, 1 at best.
+        };
+
+        // Range of a mesh that is drawn with one call. Indices are relative to firstVertex.
+        struct SubMesh {
+            uint32_t firstVertex;
+            uint32_t vertexCount;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+        };
+
+        /**
+         * Builds an indexed mesh from triangle corners, sharing one vertex between all corners whose
+         * position, normal and texture coordinate are identical.
+         */
+        class VertexWelder {
+        public:
+            /**
+             * The output arrays are cleared first.
+             *
+             * @param outVertices Receives the positions of the shared vertices.
+             * @param outNormals Receives the normals of the shared vertices.
+             * @param outUvs Receives the texture coordinates of the shared vertices.
+             * @param cornerCount Number of corners that will be inserted, used to size the hash table.
+             */
+            VertexWelder(std::vector<float> &outVertices, std::vector<float> &outNormals,
+                         std::vector<float> &outUvs, size_t cornerCount);
+
+            /**
+             * Return the index of the vertex with these attributes, appending it if it is new.
+             *
+             * @param position Three floats.
+             * @param normal Three floats, or nullptr if the mesh has no normals.
+             * @param uv Two floats, or nullptr if the mesh has no texture coordinates.
+             * @return Index of the shared vertex.
+             */
+            uint32_t Insert(const float *position, const float *normal, const float *uv);
+
+            size_t GetVertexCount() const
+            {
+                return vertexCount;
+            }
+
+        private:
+            bool Matches(uint32_t vertex, const float *key) const;
+
+            std::vector<float> &vertices;
+            std::vector<float> &normals;
+            std::vector<float> &uvs;
+            std::vector<uint32_t> slots;
+            size_t vertexCount = 0;
+            bool hasNormals = false;
+            bool hasUvs = false;
+        };
+
+        /**
+         * Split a mesh into sub-meshes of at most maxVertices vertices each, so every sub-mesh can be
+         * drawn with 16-bit indices. Triangles keep their order; vertices on the border between two
+         * sub-meshes are duplicated.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex or empty.
+         * @param uvs Texture coordinates, two floats per vertex or empty.
+         * @param indices Triangle indices.
+         * @param maxVertices Largest vertex count of a sub-mesh, at most MAX_VERTICES_16_BIT.
+         * @param outVertices Vertex positions of all sub-meshes, one after the other.
+         * @param outNormals Vertex normals of all sub-meshes.
+         * @param outUvs Texture coordinates of all sub-meshes.
+         * @param outIndices Triangle indices of all sub-meshes, relative to their firstVertex.
+         * @param outSubMeshes Vertex and index ranges of the sub-meshes.
+         */
+        void SplitMesh(const std::vector<float> &vertices,
+                       const std::vector<float> &normals,
+                       const std::vector<float> &uvs,
+                       const std::vector<uint32_t> &indices,
+                       size_t maxVertices,
+                       std::vector<float> &outVertices,
+                       std::vector<float> &outNormals,
+                       std::vector<float> &outUvs,
+                       std::vector<uint16_t> &outIndices,
+                       std::vector<SubMesh> &outSubMeshes);
+
+        /**
+         * Simulate the post-transform vertex cache for a triangle order.
+         *
+         * @param indices Triangle indices.
+         * @param vertexCount Number of vertices the indices refer to.
+         * @param cacheSize Number of entries of the simulated FIFO cache.
+         * @return Cache miss ratios of the triangle order.
+         */
+        VertexCacheStats AnalyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount,
+                                            size_t cacheSize = VERTEX_CACHE_SIZE);
+
+        /**
+         * Reorder triangles so that consecutive triangles share vertices still in the post-transform
+         * cache, using Tom Forsyth's linear-speed vertex cache optimization.
+         *
+         * @param indices Triangle indices, reordered in place.
+         * @param vertexCount Number of vertices the indices refer to.
+         */
+        void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+        /**
+         * Reorder clusters of a cache-optimized triangle order so that outward facing clusters are
+         * drawn first and hide what lies behind them. Clusters start where the simulated cache runs
+         * cold, so the cache efficiency stays the same.
+         *
+         * @param indices Triangle indices in cache-optimized order, reordered in place.
+         * @param vertices Vertex positions, three floats per vertex.
+         */
+        void OptimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &vertices);
+
+        /**
+         * Reorder vertices in the order the triangles first use them, so vertex fetches walk memory
+         * forward. Unused vertices are dropped.
+         *
+         * @param vertices Vertex positions, three floats per vertex, reordered in place.
+         * @param normals Vertex normals, three floats per vertex or empty, reordered in place.
+         * @param uvs Texture coordinates, two floats per vertex or empty, reordered in place.
+         * @param indices Triangle indices, remapped in place.
+         */
+        void OptimizeVertexFetch(std::vector<float> &vertices,
+                                 std::vector<float> &normals,
+                                 std::vector<float> &uvs,
+                                 std::vector<uint32_t> &indices);
+
+        /**
+         * Run the vertex cache, overdraw and vertex fetch optimizations, in that order.
+         *
+         * @param vertices Vertex positions, three floats per vertex, reordered in place.
+         * @param normals Vertex normals, three floats per vertex or empty, reordered in place.
+         * @param uvs Texture coordinates, two floats per vertex or empty, reordered in place.
+         * @param indices Triangle indices, reordered in place.
+         */
+        void OptimizeMesh(std::vector<float> &vertices,
+                          std::vector<float> &normals,
+                          std::vector<float> &uvs,
+                          std::vector<uint32_t> &indices);
+    }
+}
+#endif
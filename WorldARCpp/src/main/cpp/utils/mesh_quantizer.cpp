@@ -0,0 +1,129 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "utils/mesh_quantizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            constexpr float SNORM16_MAX = 32767.0f;
+            constexpr float UNORM16_MAX = 65535.0f;
+
+            int16_t ToSnorm16(float value)
+            {
+                return static_cast<int16_t>(lroundf(std::max(-1.0f, std::min(1.0f, value)) * SNORM16_MAX));
+            }
+
+            uint16_t ToUnorm16(float value)
+            {
+                return static_cast<uint16_t>(lroundf(std::max(0.0f, std::min(1.0f, value)) * UNORM16_MAX));
+            }
+
+            float SignNotZero(float value)
+            {
+                return value >= 0.0f ? 1.0f : -1.0f;
+            }
+
+            // Offset and scale mapping the range of each component to [-1, 1], or [0, 1] if isUnsigned.
+            void FitRange(const std::vector<float> &values, size_t dimension, bool isUnsigned,
+                          float *outOffset, float *outScale)
+            {
+                for (size_t axis = 0; axis < dimension; ++axis) {
+                    float minValue = values.empty() ? 0.0f : values[axis];
+                    float maxValue = minValue;
+                    for (size_t i = axis; i < values.size(); i += dimension) {
+                        minValue = std::min(minValue, values[i]);
+                        maxValue = std::max(maxValue, values[i]);
+                    }
+                    float extent = maxValue - minValue;
+                    // Flat components still need a scale the shader can multiply by.
+                    float scale = extent > 0.0f ? extent : 1.0f;
+                    outOffset[axis] = isUnsigned ? minValue : (minValue + maxValue) * 0.5f;
+                    outScale[axis] = isUnsigned ? scale : scale * 0.5f;
+                }
+            }
+        }
+
+        void OctEncode(const float *normal, int16_t *outEncoded)
+        {
+            float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+            if (length == 0.0f) {
+                outEncoded[0] = 0;
+                outEncoded[1] = 0;
+                return;
+            }
+            float x = normal[0] / length;
+            float y = normal[1] / length;
+            if (normal[2] < 0.0f) {
+                // Fold the lower hemisphere over the diagonals of the square.
+                float foldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+                float foldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+                x = foldedX;
+                y = foldedY;
+            }
+            outEncoded[0] = ToSnorm16(x);
+            outEncoded[1] = ToSnorm16(y);
+        }
+
+        void OctDecode(const int16_t *encoded, float *outNormal)
+        {
+            float x = encoded[0] / SNORM16_MAX;
+            float y = encoded[1] / SNORM16_MAX;
+            float z = 1.0f - std::fabs(x) - std::fabs(y);
+            if (z < 0.0f) {
+                float unfoldedX = (1.0f - std::fabs(y)) * SignNotZero(x);
+                float unfoldedY = (1.0f - std::fabs(x)) * SignNotZero(y);
+                x = unfoldedX;
+                y = unfoldedY;
+            }
+            float length = std::sqrt(x * x + y * y + z * z);
+            outNormal[0] = x / length;
+            outNormal[1] = y / length;
+            outNormal[2] = z / length;
+        }
+
+        void QuantizeVertices(const std::vector<float> &vertices,
+                              const std::vector<float> &normals,
+                              const std::vector<float> &uvs,
+                              std::vector<QuantizedVertex> &outVertices,
+                              QuantizationParams &outParams)
+        {
+            // The vertex and normal dimensions are 3, the texture coordinate dimension is 2.
+            const size_t vertexCount = vertices.size() / 3;
+            FitRange(vertices, 3, false, outParams.positionOffset, outParams.positionScale);
+            FitRange(uvs, 2, true, outParams.uvOffset, outParams.uvScale);
+
+            outVertices.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i) {
+                QuantizedVertex &vertex = outVertices[i];
+                for (int axis = 0; axis < 3; ++axis) {
+                    vertex.position[axis] = ToSnorm16(
+                        (vertices[i * 3 + axis] - outParams.positionOffset[axis]) / outParams.positionScale[axis]);
+                }
+                vertex.padding = 0;
+                const float upNormal[3] = {0.0f, 1.0f, 0.0f};
+                OctEncode(normals.empty() ? upNormal : &normals[i * 3], vertex.normal);
+                for (int axis = 0; axis < 2; ++axis) {
+                    vertex.uv[axis] = uvs.empty() ? 0 : ToUnorm16(
+                        (uvs[i * 2 + axis] - outParams.uvOffset[axis]) / outParams.uvScale[axis]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_MESH_QUANTIZER_H
+#define C_ARENGINE_HELLOE_AR_MESH_QUANTIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Packed vertex layout that halves the vertex size of object meshes.
+    namespace util {
+        /**
+         * Interleaved 16-byte vertex, read by GL as normalized integers.
+         * The position is a signed normalized value per axis and the normal is octahedral-encoded;
+         * both positions and texture coordinates are rescaled with QuantizationParams in the shader.
+         */
+        struct QuantizedVertex {
+            int16_t position[3];
+            int16_t padding; // Keeps the normal 4-byte aligned.
+            int16_t normal[2];
+            uint16_t uv[2];
+        };
+
+        // Dequantization: position = positionOffset + positionScale * snorm, uv = uvOffset + uvScale * unorm.
+        struct QuantizationParams {
+            float positionOffset[3];
+            float positionScale[3];
+            float uvOffset[2];
+            float uvScale[2];
+        };
+
+        /**
+         * Pack separate float attribute arrays into interleaved quantized vertices.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex or empty.
+         * @param uvs Texture coordinates, two floats per vertex or empty.
+         * @param outVertices Output quantized vertices.
+         * @param outParams Output dequantization parameters of the mesh.
+         */
+        void QuantizeVertices(const std::vector<float> &vertices,
+                              const std::vector<float> &normals,
+                              const std::vector<float> &uvs,
+                              std::vector<QuantizedVertex> &outVertices,
+                              QuantizationParams &outParams);
+
+        /**
+         * Octahedral-encode a unit vector into two signed normalized 16-bit values.
+         *
+         * @param normal Three floats.
+         * @param outEncoded Two signed normalized values.
+         */
+        void OctEncode(const float *normal, int16_t *outEncoded);
+
+        /**
+         * Decode an octahedral-encoded vector, as the object vertex shader does.
+         *
+         * @param encoded Two signed normalized values.
+         * @param outNormal Three floats, normalized.
+         */
+        void OctDecode(const int16_t *encoded, float *outNormal);
+    }
+}
+#endif
@@ -0,0 +1,390 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/mesh_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // A level that keeps more of the previous level's triangles than this is not worth storing.
+            constexpr float MIN_LOD_REDUCTION = 0.8f;
+
+            // Passes over the edges before giving up on reaching the target index count.
+            constexpr size_t MAX_SIMPLIFY_PASSES = 32;
+
+            // Sum of squared distances to the planes of a vertex's triangles, weighted by triangle area.
+            struct Quadric {
+                double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+                double ab = 0.0, ac = 0.0, ad = 0.0, bc = 0.0, bd = 0.0, cd = 0.0;
+                double weight = 0.0;
+
+                void AddPlane(double a, double b, double c, double d, double planeWeight)
+                {
+                    a2 += a * a * planeWeight;
+                    b2 += b * b * planeWeight;
+                    c2 += c * c * planeWeight;
+                    d2 += d * d * planeWeight;
+                    ab += a * b * planeWeight;
+                    ac += a * c * planeWeight;
+                    ad += a * d * planeWeight;
+                    bc += b * c * planeWeight;
+                    bd += b * d * planeWeight;
+                    cd += c * d * planeWeight;
+                    weight += planeWeight;
+                }
+
+                void Add(const Quadric &other)
+                {
+                    a2 += other.a2;
+                    b2 += other.b2;
+                    c2 += other.c2;
+                    d2 += other.d2;
+                    ab += other.ab;
+                    ac += other.ac;
+                    ad += other.ad;
+                    bc += other.bc;
+                    bd += other.bd;
+                    cd += other.cd;
+                    weight += other.weight;
+                }
+
+                // Mean squared distance of a point to the planes.
+                double Evaluate(const float *point) const
+                {
+                    const double x = point[0];
+                    const double y = point[1];
+                    const double z = point[2];
+                    double error = a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+                        2.0 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+                    return (weight > 0.0) ? std::fabs(error) / weight : 0.0;
+                }
+            };
+
+            struct Collapse {
+                double error;
+                uint32_t from;
+                uint32_t to;
+            };
+
+            void Cross(const float *a, const float *b, const float *c, float *outNormal)
+            {
+                const float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                const float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                outNormal[0] = u[1] * v[2] - u[2] * v[1];
+                outNormal[1] = u[2] * v[0] - u[0] * v[2];
+                outNormal[2] = u[0] * v[1] - u[1] * v[0];
+            }
+
+            // Vertices that have to stay where they are: those sharing their position with other
+            // vertices, which are attribute seams, and those on edges with a single triangle.
+            std::vector<bool> FindLockedVertices(const std::vector<float> &vertices,
+                                                 const std::vector<uint32_t> &indices)
+            {
+                const size_t vertexCount = vertices.size() / 3;
+                std::vector<uint32_t> order(vertexCount);
+                for (uint32_t i = 0; i < vertexCount; ++i) {
+                    order[i] = i;
+                }
+                auto compare = [&vertices](uint32_t a, uint32_t b) {
+                    return memcmp(&vertices[a * 3], &vertices[b * 3], 3 * sizeof(float)) < 0;
+                };
+                std::sort(order.begin(), order.end(), compare);
+
+                std::vector<uint32_t> positionIds(vertexCount);
+                std::vector<bool> locked(vertexCount, false);
+                for (size_t i = 0; i < vertexCount;) {
+                    size_t end = i + 1;
+                    while (end < vertexCount && !compare(order[i], order[end])) {
+                        ++end;
+                    }
+                    for (size_t j = i; j < end; ++j) {
+                        positionIds[order[j]] = order[i];
+                        locked[order[j]] = (end - i > 1);
+                    }
+                    i = end;
+                }
+
+                // Edges are matched by position, so seams do not count as borders.
+                std::unordered_map<uint64_t, uint32_t> edgeUses;
+                edgeUses.reserve(indices.size());
+                for (size_t corner = 0; corner < indices.size(); ++corner) {
+                    uint32_t a = positionIds[indices[corner]];
+                    uint32_t b = positionIds[indices[corner - corner % 3 + (corner + 1) % 3]];
+                    ++edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)];
+                }
+                for (size_t corner = 0; corner < indices.size(); ++corner) {
+                    uint32_t first = indices[corner];
+                    uint32_t second = indices[corner - corner % 3 + (corner + 1) % 3];
+                    uint32_t a = positionIds[first];
+                    uint32_t b = positionIds[second];
+                    if (edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)] == 1) {
+                        locked[first] = true;
+                        locked[second] = true;
+                    }
+                }
+                return locked;
+            }
+
+            // Whether moving vertex from onto vertex to flips or collapses a triangle around it that stays.
+            bool FlipsTriangle(const std::vector<float> &vertices, const std::vector<uint32_t> &indices,
+                               const std::vector<uint32_t> &adjacencyOffsets,
+                               const std::vector<uint32_t> &adjacentTriangles, uint32_t from, uint32_t to)
+            {
+                for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i) {
+                    const uint32_t *triangle = &indices[adjacentTriangles[i] * 3];
+                    if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                        continue;
+                    }
+                    const float *corners[3];
+                    const float *moved[3];
+                    for (int k = 0; k < 3; ++k) {
+                        corners[k] = &vertices[triangle[k] * 3];
+                        moved[k] = (triangle[k] == from) ? &vertices[to * 3] : corners[k];
+                    }
+                    float before[3];
+                    float after[3];
+                    Cross(corners[0], corners[1], corners[2], before);
+                    Cross(moved[0], moved[1], moved[2], after);
+                    if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+        }
+
+        float SimplifyMesh(const std::vector<float> &vertices,
+                           const std::vector<uint32_t> &indices,
+                           size_t targetIndexCount,
+                           std::vector<uint32_t> &outIndices)
+        {
+            const size_t vertexCount = vertices.size() / 3;
+            outIndices = indices;
+            const std::vector<bool> locked = FindLockedVertices(vertices, indices);
+
+            std::vector<Quadric> quadrics(vertexCount);
+            for (size_t corner = 0; corner < indices.size(); corner += 3) {
+                const float *a = &vertices[indices[corner] * 3];
+                float normal[3];
+                Cross(a, &vertices[indices[corner + 1] * 3], &vertices[indices[corner + 2] * 3], normal);
+                double length = std::sqrt(static_cast<double>(normal[0]) * normal[0] +
+                                          static_cast<double>(normal[1]) * normal[1] +
+                                          static_cast<double>(normal[2]) * normal[2]);
+                if (length == 0.0) {
+                    continue;
+                }
+                // The cross product is twice the area, which weights larger triangles more.
+                double nx = normal[0] / length;
+                double ny = normal[1] / length;
+                double nz = normal[2] / length;
+                double d = -(nx * a[0] + ny * a[1] + nz * a[2]);
+                for (size_t k = 0; k < 3; ++k) {
+                    quadrics[indices[corner + k]].AddPlane(nx, ny, nz, d, length * 0.5);
+                }
+            }
+
+            std::vector<uint32_t> remap(vertexCount);
+            std::vector<bool> touched(vertexCount);
+            std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+            std::vector<uint32_t> adjacentTriangles;
+            std::vector<Collapse> collapses;
+            double maxError = 0.0;
+            for (size_t pass = 0; pass < MAX_SIMPLIFY_PASSES && outIndices.size() > targetIndexCount; ++pass) {
+                // Vertex to triangle adjacency of the current triangles, in compressed rows.
+                std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+                for (uint32_t index : outIndices) {
+                    ++adjacencyOffsets[index + 1];
+                }
+                for (size_t i = 0; i < vertexCount; ++i) {
+                    adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+                }
+                adjacentTriangles.resize(outIndices.size());
+                std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                for (size_t corner = 0; corner < outIndices.size(); ++corner) {
+                    adjacentTriangles[fill[outIndices[corner]]++] = static_cast<uint32_t>(corner / 3);
+                }
+
+                collapses.clear();
+                for (size_t corner = 0; corner < outIndices.size(); ++corner) {
+                    uint32_t a = outIndices[corner];
+                    uint32_t b = outIndices[corner - corner % 3 + (corner + 1) % 3];
+                    Quadric merged = quadrics[a];
+                    merged.Add(quadrics[b]);
+                    if (!locked[a]) {
+                        collapses.push_back({merged.Evaluate(&vertices[b * 3]), a, b});
+                    }
+                    if (!locked[b]) {
+                        collapses.push_back({merged.Evaluate(&vertices[a * 3]), b, a});
+                    }
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) {
+                    return a.error < b.error;
+                });
+
+                // Each collapse of an interior edge removes two triangles.
+                const size_t collapseBudget = (outIndices.size() - targetIndexCount) / 6 + 1;
+                size_t collapseCount = 0;
+                for (uint32_t i = 0; i < vertexCount; ++i) {
+                    remap[i] = i;
+                }
+                std::fill(touched.begin(), touched.end(), false);
+                for (const Collapse &collapse : collapses) {
+                    if (collapseCount == collapseBudget) {
+                        break;
+                    }
+                    if (touched[collapse.from] || touched[collapse.to] ||
+                        FlipsTriangle(vertices, outIndices, adjacencyOffsets, adjacentTriangles, collapse.from,
+                                      collapse.to)) {
+                        continue;
+                    }
+                    // The triangles around both vertices change, so none of their vertices moves again this pass.
+                    for (uint32_t vertex : {collapse.from, collapse.to}) {
+                        for (uint32_t k = adjacencyOffsets[vertex]; k < adjacencyOffsets[vertex + 1]; ++k) {
+                            const uint32_t *triangle = &outIndices[adjacentTriangles[k] * 3];
+                            touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+                        }
+                    }
+                    remap[collapse.from] = collapse.to;
+                    quadrics[collapse.to].Add(quadrics[collapse.from]);
+                    maxError = std::max(maxError, collapse.error);
+                    ++collapseCount;
+                }
+                if (collapseCount == 0) {
+                    break;
+                }
+
+                size_t write = 0;
+                for (size_t corner = 0; corner < outIndices.size(); corner += 3) {
+                    uint32_t a = remap[outIndices[corner]];
+                    uint32_t b = remap[outIndices[corner + 1]];
+                    uint32_t c = remap[outIndices[corner + 2]];
+                    if (a != b && b != c && a != c) {
+                        outIndices[write++] = a;
+                        outIndices[write++] = b;
+                        outIndices[write++] = c;
+                    }
+                }
+                outIndices.resize(write);
+            }
+            return static_cast<float>(std::sqrt(maxError));
+        }
+
+        void GenerateLods(const std::vector<float> &vertices,
+                          const std::vector<uint32_t> &indices,
+                          size_t lodCount,
+                          std::vector<std::vector<uint32_t>> &outLodIndices,
+                          std::vector<float> &outErrors)
+        {
+            const size_t vertexCount = vertices.size() / 3;
+            outLodIndices.assign(1, indices);
+            outErrors.assign(1, 0.0f);
+            lodCount = std::min(lodCount, MAX_LOD_COUNT);
+            while (outLodIndices.size() < lodCount) {
+                const std::vector<uint32_t> &previous = outLodIndices.back();
+                std::vector<uint32_t> simplified;
+                float error = SimplifyMesh(vertices, previous, previous.size() / 6 * 3, simplified);
+                if (simplified.empty() || simplified.size() > previous.size() * MIN_LOD_REDUCTION) {
+                    break;
+                }
+                OptimizeVertexCache(simplified, vertexCount);
+                // Each level is simplified from the previous one, so their errors add up.
+                outErrors.push_back(outErrors.back() + error);
+                outLodIndices.push_back(std::move(simplified));
+            }
+        }
+
+        void CombineLods(const std::vector<float> &vertices,
+                         const std::vector<float> &normals,
+                         const std::vector<float> &uvs,
+                         const std::vector<std::vector<uint32_t>> &lodIndices,
+                         const std::vector<float> &lodErrors,
+                         size_t maxVertices,
+                         std::vector<float> &outVertices,
+                         std::vector<float> &outNormals,
+                         std::vector<float> &outUvs,
+                         std::vector<uint32_t> &outIndices,
+                         std::vector<SubMesh> &outSubMeshes,
+                         std::vector<MeshLod> &outLods)
+        {
+            const size_t vertexCount = vertices.size() / 3;
+            outIndices.clear();
+            outSubMeshes.clear();
+            outLods.clear();
+            if (maxVertices == 0 || vertexCount <= maxVertices) {
+                outVertices = vertices;
+                outNormals = normals;
+                outUvs = uvs;
+                for (size_t lod = 0; lod < lodIndices.size(); ++lod) {
+                    outLods.push_back({static_cast<uint32_t>(lod), 1, lodErrors[lod]});
+                    outSubMeshes.push_back({0, static_cast<uint32_t>(vertexCount),
+                                            static_cast<uint32_t>(outIndices.size()),
+                                            static_cast<uint32_t>(lodIndices[lod].size())});
+                    outIndices.insert(outIndices.end(), lodIndices[lod].begin(), lodIndices[lod].end());
+                }
+                return;
+            }
+
+            outVertices.clear();
+            outNormals.clear();
+            outUvs.clear();
+            std::vector<float> splitVertices;
+            std::vector<float> splitNormals;
+            std::vector<float> splitUvs;
+            std::vector<uint16_t> splitIndices;
+            std::vector<SubMesh> splitSubMeshes;
+            for (size_t lod = 0; lod < lodIndices.size(); ++lod) {
+                SplitMesh(vertices, normals, uvs, lodIndices[lod], maxVertices, splitVertices, splitNormals, splitUvs,
+                          splitIndices, splitSubMeshes);
+                outLods.push_back({static_cast<uint32_t>(outSubMeshes.size()),
+                                   static_cast<uint32_t>(splitSubMeshes.size()), lodErrors[lod]});
+                const auto firstVertex = static_cast<uint32_t>(outVertices.size() / 3);
+                const auto firstIndex = static_cast<uint32_t>(outIndices.size());
+                for (SubMesh subMesh : splitSubMeshes) {
+                    subMesh.firstVertex += firstVertex;
+                    subMesh.firstIndex += firstIndex;
+                    outSubMeshes.push_back(subMesh);
+                }
+                outVertices.insert(outVertices.end(), splitVertices.begin(), splitVertices.end());
+                outNormals.insert(outNormals.end(), splitNormals.begin(), splitNormals.end());
+                outUvs.insert(outUvs.end(), splitUvs.begin(), splitUvs.end());
+                outIndices.insert(outIndices.end(), splitIndices.begin(), splitIndices.end());
+            }
+        }
+
+        size_t SelectLod(float screenSize, size_t lodCount, size_t previousLod)
+        {
+            if (lodCount == 0) {
+                return 0;
+            }
+            size_t lod = std::min(previousLod, std::min(lodCount, MAX_LOD_COUNT) - 1);
+            // LOD_SCREEN_SIZES[lod] is the size below which level lod + 1 is drawn instead of level lod.
+            while (lod > 0 && screenSize > LOD_SCREEN_SIZES[lod - 1] * (1.0f + LOD_HYSTERESIS)) {
+                --lod;
+            }
+            while (lod + 1 < std::min(lodCount, MAX_LOD_COUNT) &&
+                   screenSize < LOD_SCREEN_SIZES[lod] * (1.0f - LOD_HYSTERESIS)) {
+                ++lod;
+            }
+            return lod;
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_MESH_SIMPLIFIER_H
+#define C_ARENGINE_HELLOE_AR_MESH_SIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "utils/mesh_optimizer.h"
+
+namespace gWorldAr {
+    // Level of detail generation and selection, shared by the app and the host-side mesh compiler.
+    namespace util {
+        // Most levels of detail generated for a mesh, the full mesh included.
+        constexpr size_t MAX_LOD_COUNT = 4;
+
+        // Screen height fraction, of the object's bounding sphere, below which each coarser level is drawn.
+        constexpr float LOD_SCREEN_SIZES[MAX_LOD_COUNT - 1] = {0.4f, 0.2f, 0.1f};
+
+        // Fraction a size has to move past a threshold before the level changes, so objects near a
+        // threshold do not pop back and forth.
+        constexpr float LOD_HYSTERESIS = 0.2f;
+
+        // Level of detail of a mesh: the sub-meshes drawn for it.
+        struct MeshLod {
+            uint32_t firstSubMesh;
+            uint32_t subMeshCount;
+            float error; // Estimated distance of its surface from the full mesh, in model units.
+        };
+
+        /**
+         * Simplify a mesh by collapsing edges in order of their quadric error (Garland and Heckbert).
+         * Each collapse moves one vertex onto the other, so the simplified triangles index the same
+         * vertex array. Vertices on mesh borders and on attribute seams are kept.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param indices Triangle indices.
+         * @param targetIndexCount Index count to stop at. It is not reached when the kept vertices
+         *                         leave nothing to collapse.
+         * @param outIndices Triangle indices of the simplified mesh.
+         * @return Estimated distance of the simplified surface from the input, in model units.
+         */
+        float SimplifyMesh(const std::vector<float> &vertices,
+                           const std::vector<uint32_t> &indices,
+                           size_t targetIndexCount,
+                           std::vector<uint32_t> &outIndices);
+
+        /**
+         * Generate levels of detail, each with about half the triangles of the previous one. Fewer
+         * levels are generated when simplification stops making progress.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param indices Triangle indices of the full mesh, which becomes the first level.
+         * @param lodCount Largest number of levels, at most MAX_LOD_COUNT.
+         * @param outLodIndices Triangle indices of each level, reordered for the vertex cache.
+         * @param outErrors Estimated error of each level, 0 for the first.
+         */
+        void GenerateLods(const std::vector<float> &vertices,
+                          const std::vector<uint32_t> &indices,
+                          size_t lodCount,
+                          std::vector<std::vector<uint32_t>> &outLodIndices,
+                          std::vector<float> &outErrors);
+
+        /**
+         * Put the levels of detail of a mesh one after the other into a single index array.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex or empty.
+         * @param uvs Texture coordinates, two floats per vertex or empty.
+         * @param lodIndices Triangle indices of each level, from GenerateLods.
+         * @param lodErrors Estimated error of each level, from GenerateLods.
+         * @param maxVertices Largest vertex count of a sub-mesh. Levels that use more are split with
+         *                    SplitMesh, which gives each level its own vertices. 0 keeps every level
+         *                    in one sub-mesh over the shared vertices.
+         * @param outVertices Vertex positions of all sub-meshes.
+         * @param outNormals Vertex normals of all sub-meshes.
+         * @param outUvs Texture coordinates of all sub-meshes.
+         * @param outIndices Triangle indices of all levels, relative to the firstVertex of their sub-mesh.
+         * @param outSubMeshes Vertex and index ranges of the sub-meshes of all levels.
+         * @param outLods Sub-mesh ranges of the levels.
+         */
+        void CombineLods(const std::vector<float> &vertices,
+                         const std::vector<float> &normals,
+                         const std::vector<float> &uvs,
+                         const std::vector<std::vector<uint32_t>> &lodIndices,
+                         const std::vector<float> &lodErrors,
+                         size_t maxVertices,
+                         std::vector<float> &outVertices,
+                         std::vector<float> &outNormals,
+                         std::vector<float> &outUvs,
+                         std::vector<uint32_t> &outIndices,
+                         std::vector<SubMesh> &outSubMeshes,
+                         std::vector<MeshLod> &outLods);
+
+        /**
+         * Pick the level of detail to draw an object with from its size on screen, moving away
+         * from the previous level only once the size is past a threshold by LOD_HYSTERESIS.
+         *
+         * @param screenSize Height of the object's bounding sphere on screen, as a fraction of the
+         *                   viewport height.
+         * @param lodCount Number of levels of the object's mesh.
+         * @param previousLod Level the object was drawn with last frame, 0 for new objects.
+         * @return Level to draw.
+         */
+        size_t SelectLod(float screenSize, size_t lodCount, size_t previousLod);
+    }
+}
+#endif
@@ -0,0 +1,361 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/mesh_view.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <GLES2/gl2ext.h>
+#include <gtc/type_ptr.hpp>
+
+#include "utils/gl_state.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Offsets of attributes in the vertex buffer are kept aligned for every component type.
+            constexpr size_t VERTEX_BUFFER_ALIGNMENT = 4;
+
+            // Marks a vertex no index of its sub-mesh refers to.
+            constexpr uint32_t UNUSED_VERTEX = UINT32_MAX;
+
+            // Memory a run of vertices reads, from the first byte of the first vertex to the last byte
+            // of the last one.
+            struct ByteRange {
+                const GLubyte *begin;
+                const GLubyte *end;
+            };
+
+            // Bytes of the components of one attribute, without the padding to the next vertex.
+            GLsizei GetVertexAttribElementSize(const VertexAttrib &attrib)
+            {
+                switch (attrib.type) {
+                    case GL_BYTE:
+                    case GL_UNSIGNED_BYTE:
+                        return attrib.size;
+                    case GL_SHORT:
+                    case GL_UNSIGNED_SHORT:
+                    case GL_HALF_FLOAT_OES:
+                    case HALF_FLOAT_ES3:
+                        return attrib.size * static_cast<GLsizei>(sizeof(GLshort));
+                    default:
+                        return attrib.size * static_cast<GLsizei>(sizeof(GLfloat));
+                }
+            }
+
+            GLsizei GetVertexAttribSize(const VertexAttrib &attrib)
+            {
+                return (attrib.stride != 0) ? attrib.stride : GetVertexAttribElementSize(attrib);
+            }
+
+            ByteRange GetAttribRange(const VertexAttrib &attrib, size_t vertexCount)
+            {
+                const auto *begin = static_cast<const GLubyte *>(attrib.pointer);
+                return {begin, begin + (vertexCount - 1) * GetVertexAttribSize(attrib) +
+                    GetVertexAttribElementSize(attrib)};
+            }
+
+            const GLvoid *ToBufferOffset(size_t offset)
+            {
+                return reinterpret_cast<const GLvoid *>(static_cast<uintptr_t>(offset));
+            }
+
+            size_t AlignVertexOffset(size_t offset)
+            {
+                return (offset + VERTEX_BUFFER_ALIGNMENT - 1) / VERTEX_BUFFER_ALIGNMENT * VERTEX_BUFFER_ALIGNMENT;
+            }
+
+            size_t GetMeshVertexCount(const MeshView &mesh)
+            {
+                size_t vertexCount = 0;
+                for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                    const SubMesh &subMesh = mesh.subMeshes[i];
+                    vertexCount = std::max<size_t>(vertexCount, subMesh.firstVertex + subMesh.vertexCount);
+                }
+                return vertexCount;
+            }
+
+            // Bytes of one vertex of ReplicateMesh: every attribute padded to the alignment, then the copy index.
+            size_t GetReplicatedVertexSize(const MeshView &mesh)
+            {
+                return AlignVertexOffset(GetVertexAttribElementSize(mesh.position)) +
+                    AlignVertexOffset(GetVertexAttribElementSize(mesh.normal)) +
+                    AlignVertexOffset(GetVertexAttribElementSize(mesh.uv)) + sizeof(GLfloat);
+            }
+
+            uint32_t ReadIndex(const MeshView &mesh, size_t index)
+            {
+                switch (mesh.indexType) {
+                    case GL_UNSIGNED_BYTE:
+                        return static_cast<const GLubyte *>(mesh.indices)[index];
+                    case GL_UNSIGNED_INT:
+                        return static_cast<const GLuint *>(mesh.indices)[index];
+                    default:
+                        return static_cast<const GLushort *>(mesh.indices)[index];
+                }
+            }
+
+            // Vertices of a sub-mesh that its indices use, in the order they are first used, and for each
+            // vertex of the sub-mesh its position among them, or UNUSED_VERTEX.
+            void CompactSubMesh(const MeshView &mesh, const SubMesh &subMesh, std::vector<uint32_t> &outUsedVertices,
+                                std::vector<uint32_t> &outRemap)
+            {
+                outUsedVertices.clear();
+                outRemap.assign(subMesh.vertexCount, UNUSED_VERTEX);
+                for (size_t index = subMesh.firstIndex; index < subMesh.firstIndex + subMesh.indexCount; ++index) {
+                    const uint32_t vertex = ReadIndex(mesh, index);
+                    if (outRemap[vertex] == UNUSED_VERTEX) {
+                        outRemap[vertex] = static_cast<uint32_t>(outUsedVertices.size());
+                        outUsedVertices.push_back(vertex);
+                    }
+                }
+            }
+        }
+
+        size_t GetIndexSize(GLenum indexType)
+        {
+            switch (indexType) {
+                case GL_UNSIGNED_BYTE:
+                    return sizeof(GLubyte);
+                case GL_UNSIGNED_INT:
+                    return sizeof(GLuint);
+                default:
+                    return sizeof(GLushort);
+            }
+        }
+
+        void SetVertexAttribPointer(GLuint location, const VertexAttrib &attrib, GLuint firstVertex)
+        {
+            const auto *start = static_cast<const GLubyte *>(attrib.pointer) +
+                static_cast<size_t>(firstVertex) * GetVertexAttribSize(attrib);
+            glVertexAttribPointer(location, attrib.size, attrib.type, attrib.normalized, attrib.stride, start);
+        }
+
+        void SetMeshBounds(const float *boundsMin, const float *boundsMax, MeshView &outMesh)
+        {
+            const glm::vec3 min = glm::make_vec3(boundsMin);
+            const glm::vec3 max = glm::make_vec3(boundsMax);
+            outMesh.boundsCenter = (min + max) * 0.5f;
+            outMesh.boundsRadius = glm::length(max - min) * 0.5f;
+        }
+
+        void SetQuantizedVertexAttribs(const QuantizedVertex *vertices, const QuantizationParams &quantization,
+                                       MeshView &outMesh)
+        {
+            const GLsizei stride = sizeof(QuantizedVertex);
+            // The position has 3 components, the octahedral normal and the texture coordinate have 2.
+            outMesh.position = {vertices->position, 3, GL_SHORT, GL_TRUE, stride};
+            outMesh.normal = {vertices->normal, 2, GL_SHORT, GL_TRUE, stride};
+            outMesh.uv = {vertices->uv, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride};
+            outMesh.quantization = &quantization;
+        }
+
+        size_t GetMaxMeshCopies(const MeshView &mesh, size_t maxVertexBytes)
+        {
+            // Every copy of a sub-mesh holds the vertices its indices use, so the coarse levels of detail
+            // take less room than the full mesh they share their vertices with.
+            std::vector<uint32_t> usedVertices;
+            std::vector<uint32_t> remap;
+            size_t largestSubMesh = 0;
+            size_t copyVertexCount = 0;
+            for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                CompactSubMesh(mesh, mesh.subMeshes[i], usedVertices, remap);
+                largestSubMesh = std::max(largestSubMesh, usedVertices.size());
+                copyVertexCount += usedVertices.size();
+            }
+            if (largestSubMesh == 0) {
+                return 0;
+            }
+            const size_t copyBytes = copyVertexCount * GetReplicatedVertexSize(mesh);
+            return std::min(MAX_VERTICES_16_BIT / largestSubMesh, maxVertexBytes / copyBytes);
+        }
+
+        bool ReplicateMesh(const MeshView &mesh, size_t copyCount, std::vector<GLubyte> &outVertices,
+                           std::vector<GLushort> &outIndices, std::vector<SubMesh> &outSubMeshes,
+                           MeshView &outMesh)
+        {
+            outVertices.clear();
+            outIndices.clear();
+            outSubMeshes.clear();
+
+            // Only the vertices the indices of a sub-mesh use are copied, renumbered in the order of use.
+            std::vector<std::vector<uint32_t>> usedVertices(mesh.subMeshCount);
+            std::vector<std::vector<uint32_t>> remaps(mesh.subMeshCount);
+            for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                CompactSubMesh(mesh, mesh.subMeshes[i], usedVertices[i], remaps[i]);
+                if (usedVertices[i].size() * copyCount > MAX_VERTICES_16_BIT) {
+                    return false;
+                }
+            }
+
+            // Each attribute keeps its component type, at an aligned offset within the vertex.
+            const VertexAttrib *attribs[] = {&mesh.position, &mesh.normal, &mesh.uv};
+            size_t attribOffsets[3] = {};
+            size_t vertexSize = 0;
+            for (size_t i = 0; i < 3; ++i) {
+                attribOffsets[i] = vertexSize;
+                vertexSize += AlignVertexOffset(GetVertexAttribElementSize(*attribs[i]));
+            }
+            const size_t copyIndexOffset = vertexSize;
+            vertexSize = GetReplicatedVertexSize(mesh);
+
+            size_t vertexCount = 0;
+            size_t indexCount = 0;
+            for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                vertexCount += usedVertices[i].size() * copyCount;
+                indexCount += mesh.subMeshes[i].indexCount * copyCount;
+            }
+            outVertices.resize(vertexCount * vertexSize);
+            outIndices.reserve(indexCount);
+            GLubyte *vertex = outVertices.data();
+            for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                const SubMesh &subMesh = mesh.subMeshes[i];
+                const size_t copyVertexCount = usedVertices[i].size();
+                outSubMeshes.push_back({static_cast<uint32_t>((vertex - outVertices.data()) / vertexSize),
+                    static_cast<uint32_t>(copyVertexCount * copyCount), static_cast<uint32_t>(outIndices.size()),
+                    static_cast<uint32_t>(subMesh.indexCount * copyCount)});
+                for (size_t copy = 0; copy < copyCount; ++copy) {
+                    const GLfloat copyIndex = static_cast<GLfloat>(copy);
+                    for (uint32_t usedVertex : usedVertices[i]) {
+                        const size_t v = subMesh.firstVertex + usedVertex;
+                        for (size_t a = 0; a < 3; ++a) {
+                            const auto *source = static_cast<const GLubyte *>(attribs[a]->pointer) +
+                                v * GetVertexAttribSize(*attribs[a]);
+                            std::copy(source, source + GetVertexAttribElementSize(*attribs[a]),
+                                vertex + attribOffsets[a]);
+                        }
+                        std::copy(reinterpret_cast<const GLubyte *>(&copyIndex),
+                            reinterpret_cast<const GLubyte *>(&copyIndex + 1), vertex + copyIndexOffset);
+                        vertex += vertexSize;
+                    }
+                    const size_t base = copy * copyVertexCount;
+                    for (size_t index = subMesh.firstIndex; index < subMesh.firstIndex + subMesh.indexCount; ++index) {
+                        outIndices.push_back(static_cast<GLushort>(base + remaps[i][ReadIndex(mesh, index)]));
+                    }
+                }
+            }
+
+            outMesh = mesh;
+            const GLsizei stride = static_cast<GLsizei>(vertexSize);
+            VertexAttrib *outAttribs[] = {&outMesh.position, &outMesh.normal, &outMesh.uv};
+            for (size_t i = 0; i < 3; ++i) {
+                outAttribs[i]->pointer = outVertices.data() + attribOffsets[i];
+                outAttribs[i]->stride = stride;
+            }
+            outMesh.copyIndex = {outVertices.data() + copyIndexOffset, 1, GL_FLOAT, GL_FALSE, stride};
+            outMesh.indices = outIndices.data();
+            outMesh.indexType = GL_UNSIGNED_SHORT;
+            outMesh.subMeshes = outSubMeshes.data();
+            outMesh.subMeshCount = outSubMeshes.size();
+            outMesh.vertexBuffer = 0;
+            outMesh.indexBuffer = 0;
+            return true;
+        }
+
+        size_t UploadMeshBuffers(MeshView &mesh)
+        {
+            const size_t vertexCount = GetMeshVertexCount(mesh);
+            size_t indexCount = 0;
+            for (size_t i = 0; i < mesh.subMeshCount; ++i) {
+                const SubMesh &subMesh = mesh.subMeshes[i];
+                indexCount = std::max<size_t>(indexCount, subMesh.firstIndex + subMesh.indexCount);
+            }
+            if (vertexCount == 0 || indexCount == 0 || mesh.vertexBuffer != 0) {
+                return 0;
+            }
+
+            // Attributes whose memory overlaps, such as the fields of interleaved vertices, are copied
+            // together, so their relative offsets stay valid.
+            VertexAttrib *attribs[] = {&mesh.position, &mesh.normal, &mesh.uv, &mesh.copyIndex};
+            std::vector<ByteRange> regions;
+            for (const VertexAttrib *attrib : attribs) {
+                if (attrib->pointer != nullptr) {
+                    regions.push_back(GetAttribRange(*attrib, vertexCount));
+                }
+            }
+            std::sort(regions.begin(), regions.end(), [](const ByteRange &a, const ByteRange &b) {
+                return a.begin < b.begin;
+            });
+            std::vector<ByteRange> mergedRegions;
+            for (const ByteRange &region : regions) {
+                if (!mergedRegions.empty() && region.begin < mergedRegions.back().end) {
+                    mergedRegions.back().end = std::max(mergedRegions.back().end, region.end);
+                } else {
+                    mergedRegions.push_back(region);
+                }
+            }
+            std::vector<size_t> regionOffsets;
+            size_t vertexBytes = 0;
+            for (const ByteRange &region : mergedRegions) {
+                vertexBytes = AlignVertexOffset(vertexBytes);
+                regionOffsets.push_back(vertexBytes);
+                vertexBytes += region.end - region.begin;
+            }
+
+            GlStateCache &state = GetGlState();
+            GLuint buffers[2] = {0, 0};
+            glGenBuffers(2, buffers);
+            state.BindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexBytes), nullptr, GL_STATIC_DRAW);
+            for (size_t i = 0; i < mergedRegions.size(); ++i) {
+                glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(regionOffsets[i]),
+                    mergedRegions[i].end - mergedRegions[i].begin, mergedRegions[i].begin);
+            }
+            for (VertexAttrib *attrib : attribs) {
+                if (attrib->pointer == nullptr) {
+                    continue;
+                }
+                const auto *begin = static_cast<const GLubyte *>(attrib->pointer);
+                for (size_t i = 0; i < mergedRegions.size(); ++i) {
+                    if (begin >= mergedRegions[i].begin && begin < mergedRegions[i].end) {
+                        attrib->pointer = ToBufferOffset(regionOffsets[i] + (begin - mergedRegions[i].begin));
+                        break;
+                    }
+                }
+            }
+
+            const size_t indexBytes = indexCount * GetIndexSize(mesh.indexType);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexBytes), mesh.indices, GL_STATIC_DRAW);
+            mesh.indices = ToBufferOffset(0);
+            mesh.vertexBuffer = buffers[0];
+            mesh.indexBuffer = buffers[1];
+            return vertexBytes + indexBytes;
+        }
+
+        void DeleteMeshBuffers(MeshView &mesh)
+        {
+            // Deleting a bound buffer unbinds it, which the state cache has to know.
+            GlStateCache &state = GetGlState();
+            state.BindBuffer(GL_ARRAY_BUFFER, 0);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            GLuint buffers[2] = {mesh.vertexBuffer, mesh.indexBuffer};
+            glDeleteBuffers(2, buffers);
+            mesh.vertexBuffer = 0;
+            mesh.indexBuffer = 0;
+        }
+
+        void BindMeshBuffers(const MeshView &mesh)
+        {
+            GlStateCache &state = GetGlState();
+            state.BindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_MESH_VIEW_H
+#define C_ARENGINE_HELLOE_AR_MESH_VIEW_H
+
+#include <cstddef>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <glm.hpp>
+
+#include "utils/mesh_optimizer.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/mesh_simplifier.h"
+
+namespace gWorldAr {
+    // How GL reads a mesh, shared by the app and the host-side benchmarks.
+    namespace util {
+        // GL_HALF_FLOAT of OpenGL ES 3.0, which the GLES2 headers do not define.
+        constexpr GLenum HALF_FLOAT_ES3 = 0x140B;
+
+        // What a renderer does with the memory a mesh view pointed at once the mesh is in buffer objects.
+        enum class MeshCpuCopyPolicy {
+            // Free it. A new context loads the assets again, so nothing reads it afterwards.
+            RELEASE,
+            // Keep it, for code that reads the mesh on the CPU.
+            KEEP
+        };
+
+        // Where and how GL reads one vertex attribute.
+        struct VertexAttrib {
+            const GLvoid *pointer = nullptr;
+            GLint size = 0;
+            GLenum type = GL_FLOAT;
+            GLboolean normalized = GL_FALSE;
+            GLsizei stride = 0;
+        };
+
+        // Mesh data handed to GL, either owned by the renderer or mapped from a compiled asset.
+        struct MeshView {
+            VertexAttrib position;
+            VertexAttrib normal;
+            VertexAttrib uv;
+            // Set by ReplicateMesh: index of the copy a vertex belongs to, as a float.
+            VertexAttrib copyIndex;
+            const GLvoid *indices = nullptr;
+            GLenum indexType = GL_UNSIGNED_SHORT;
+            // Each sub-mesh is drawn with one call, its indices relative to its first vertex.
+            const SubMesh *subMeshes = nullptr;
+            size_t subMeshCount = 0;
+            // Set when the attributes are QuantizedVertex fields, which the shader has to rescale.
+            const QuantizationParams *quantization = nullptr;
+            // Levels of detail, finest first. Without them all sub-meshes form a single level.
+            const MeshLod *lods = nullptr;
+            size_t lodCount = 0;
+            // Sphere around the vertices in model space: center and radius.
+            glm::vec3 boundsCenter = glm::vec3(0.0f);
+            float boundsRadius = 0.0f;
+            // Set by UploadMeshBuffers. The attribute pointers and indices are then offsets into them.
+            GLuint vertexBuffer = 0;
+            GLuint indexBuffer = 0;
+        };
+
+        /**
+         * Bytes of one index.
+         *
+         * @param indexType GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+         * @return Size of the index type.
+         */
+        size_t GetIndexSize(GLenum indexType);
+
+        /**
+         * Set the bounding sphere of a mesh view to the sphere around a bounding box.
+         *
+         * @param boundsMin Smallest coordinates of the vertices.
+         * @param boundsMax Largest coordinates of the vertices.
+         * @param outMesh Mesh view whose bounding sphere is set.
+         */
+        void SetMeshBounds(const float *boundsMin, const float *boundsMax, MeshView &outMesh);
+
+        /**
+         * Point a vertex attribute at the data of a sub-mesh, in the bound array buffer if there is one.
+         *
+         * @param location Location of the attribute in the shader program.
+         * @param attrib Layout and start of the attribute data.
+         * @param firstVertex Vertex the attribute data starts at.
+         */
+        void SetVertexAttribPointer(GLuint location, const VertexAttrib &attrib, GLuint firstVertex);
+
+        /**
+         * Point the attributes of a mesh view at interleaved quantized vertices.
+         *
+         * @param vertices First quantized vertex.
+         * @param quantization Dequantization parameters of the vertices.
+         * @param outMesh Mesh view whose position, normal and uv attributes are set.
+         */
+        void SetQuantizedVertexAttribs(const QuantizedVertex *vertices, const QuantizationParams &quantization,
+                                       MeshView &outMesh);
+
+        /**
+         * Largest number of copies of a mesh that ReplicateMesh can put in one sub-mesh per original
+         * sub-mesh, so that every copy stays addressable with 16-bit indices and the copies of all
+         * sub-meshes together fit the byte budget.
+         *
+         * @param mesh Mesh view reading client-side arrays.
+         * @param maxVertexBytes Largest size of the replicated vertex data.
+         * @return Number of copies, 0 if the mesh has no vertices or one copy does not fit.
+         */
+        size_t GetMaxMeshCopies(const MeshView &mesh, size_t maxVertexBytes);
+
+        /**
+         * Build a mesh holding copyCount copies of every sub-mesh of another one, one after the other,
+         * so several objects can be drawn with one call without instanced drawing. Each copy holds only
+         * the vertices the indices of its sub-mesh use. The vertices are interleaved and tagged with the
+         * index of their copy; the indices are 16-bit. Sub-mesh i of
+         * the output holds the copies of sub-mesh i of the input, so the levels of detail still apply.
+         *
+         * @param mesh Mesh view reading client-side arrays.
+         * @param copyCount Number of copies, at most GetMaxMeshCopies.
+         * @param outVertices Receives the interleaved vertices.
+         * @param outIndices Receives the indices.
+         * @param outSubMeshes Receives the sub-mesh ranges.
+         * @param outMesh Mesh view of the copies, pointing into the output arrays and sharing the
+         *                quantization and level tables of mesh.
+         * @return False if the copies do not fit 16-bit indices.
+         */
+        bool ReplicateMesh(const MeshView &mesh, size_t copyCount, std::vector<GLubyte> &outVertices,
+                           std::vector<GLushort> &outIndices, std::vector<SubMesh> &outSubMeshes,
+                           MeshView &outMesh);
+
+        /**
+         * Copy the vertices and indices of all sub-meshes of a mesh view into static buffer objects,
+         * and point the view at them. Interleaved attributes share one copy. Afterwards the memory the
+         * view pointed at may be released, except for the sub-mesh, level and quantization tables.
+         * Must be called on the GL thread.
+         *
+         * @param mesh Mesh view reading client-side arrays, updated in place.
+         * @return Number of bytes uploaded, which is what every draw from client-side arrays sent.
+         */
+        size_t UploadMeshBuffers(MeshView &mesh);
+
+        /**
+         * Delete the buffer objects of a mesh view. The view can no longer be drawn.
+         *
+         * @param mesh Mesh view filled by UploadMeshBuffers.
+         */
+        void DeleteMeshBuffers(MeshView &mesh);
+
+        /**
+         * Bind the buffer objects of a mesh view, or unbind buffers for a view of client-side arrays.
+         *
+         * @param mesh Mesh view about to be drawn.
+         */
+        void BindMeshBuffers(const MeshView &mesh);
+    }
+}
+#endif
@@ -0,0 +1,568 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "utils/obj_parser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "utils/log.h"
+#include "utils/mesh_optimizer.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Powers of ten that are exact in a double, so mantissa * 10^e rounds only once.
+            constexpr double EXACT_POWERS_OF_TEN[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+
+            // A uint64_t holds any 19 decimal digits.
+            constexpr int MAX_MANTISSA_DIGITS = 19;
+
+            // Longest token handed to strtof for the rare values the fast path does not accept.
+            constexpr int MAX_FALLBACK_TOKEN_LENGTH = 63;
+
+            // Smallest part of a file worth a thread of its own; smaller files are parsed serially.
+            constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+            inline bool IsSpace(char c)
+            {
+                return c == ' ' || c == '\t' || c == '\r';
+            }
+
+            inline bool IsDigit(char c)
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            inline bool IsDelimiter(const char *pos, const char *end)
+            {
+                return pos == end || IsSpace(*pos) || *pos == '/';
+            }
+
+            // True if the line starts with the keyword followed by whitespace.
+            inline bool HasKeyword(const char *pos, const char *end, const char *keyword)
+            {
+                size_t length = strlen(keyword);
+                return static_cast<size_t>(end - pos) > length && memcmp(pos, keyword, length) == 0 &&
+                    IsSpace(pos[length]);
+            }
+
+            inline void SkipSpaces(const char *&pos, const char *end)
+            {
+                while (pos != end && IsSpace(*pos)) {
+                    ++pos;
+                }
+            }
+
+            // Values such as "nan", "inf" or hexadecimal floats, parsed from a bounded copy of the token.
+            bool ParseFloatFallback(const char *&pos, const char *end, float &out)
+            {
+                const char *tokenEnd = pos;
+                while (!IsDelimiter(tokenEnd, end)) {
+                    ++tokenEnd;
+                }
+                if (tokenEnd == pos || tokenEnd - pos > MAX_FALLBACK_TOKEN_LENGTH) {
+                    return false;
+                }
+                char token[MAX_FALLBACK_TOKEN_LENGTH + 1];
+                memcpy(token, pos, tokenEnd - pos);
+                token[tokenEnd - pos] = '\0';
+                char *parsedEnd = nullptr;
+                out = strtof(token, &parsedEnd);
+                if (parsedEnd != token + (tokenEnd - pos)) {
+                    return false;
+                }
+                pos = tokenEnd;
+                return true;
+            }
+
+            // Parse a decimal float in place, in the manner of std::from_chars.
+            bool ParseFloat(const char *&pos, const char *end, float &out)
+            {
+                const char *cursor = pos;
+                bool negative = false;
+                if (cursor != end && (*cursor == '-' || *cursor == '+')) {
+                    negative = (*cursor == '-');
+                    ++cursor;
+                }
+
+                uint64_t mantissa = 0;
+                int digits = 0;
+                int exponent = 0;
+                bool hasDigits = false;
+                for (; cursor != end && IsDigit(*cursor); ++cursor) {
+                    hasDigits = true;
+                    if (digits < MAX_MANTISSA_DIGITS) {
+                        mantissa = mantissa * 10 + (*cursor - '0');
+                        digits += (mantissa != 0);
+                    } else {
+                        ++exponent;
+                    }
+                }
+                if (cursor != end && *cursor == '.') {
+                    for (++cursor; cursor != end && IsDigit(*cursor); ++cursor) {
+                        hasDigits = true;
+                        if (digits < MAX_MANTISSA_DIGITS) {
+                            mantissa = mantissa * 10 + (*cursor - '0');
+                            digits += (mantissa != 0);
+                            --exponent;
+                        }
+                    }
+                }
+                if (hasDigits && cursor != end && (*cursor == 'e' || *cursor == 'E')) {
+                    const char *exponentStart = cursor + 1;
+                    if (exponentStart != end && *exponentStart == '+') {
+                        ++exponentStart;
+                    }
+                    int explicitExponent = 0;
+                    auto result = std::from_chars(exponentStart, end, explicitExponent);
+                    if (result.ec == std::errc()) {
+                        exponent += explicitExponent;
+                        cursor = result.ptr;
+                    }
+                }
+                if (!hasDigits || !IsDelimiter(cursor, end)) {
+                    return ParseFloatFallback(pos, end, out);
+                }
+
+                double value = static_cast<double>(mantissa);
+                if (exponent < 0 && exponent >= -22) {
+                    value /= EXACT_POWERS_OF_TEN[-exponent];
+                } else if (exponent > 0 && exponent <= 22) {
+                    value *= EXACT_POWERS_OF_TEN[exponent];
+                } else if (exponent != 0) {
+                    value *= std::pow(10.0, exponent);
+                }
+                out = static_cast<float>(negative ? -value : value);
+                pos = cursor;
+                return true;
+            }
+
+            // Parse one OBJ index and resolve it to a zero-based position. Negative indices are
+            // relative to the end of the elements read so far.
+            bool ParseIndex(const char *&pos, const char *end, size_t elementCount, uint32_t &out)
+            {
+                long long index = 0;
+                auto result = std::from_chars(pos, end, index);
+                if (result.ec != std::errc() || index == 0) {
+                    return false;
+                }
+                pos = result.ptr;
+                long long resolved = index > 0 ? index - 1 : static_cast<long long>(elementCount) + index;
+                if (resolved < 0 || resolved >= static_cast<long long>(elementCount)) {
+                    return false;
+                }
+                out = static_cast<uint32_t>(resolved);
+                return true;
+            }
+
+            // Parse the floats that follow the line keyword; extra components such as w are ignored.
+            bool ParseFloats(const char *pos, const char *end, int count, std::vector<float> &out)
+            {
+                for (int i = 0; i < count; ++i) {
+                    SkipSpaces(pos, end);
+                    float value = 0.0f;
+                    if (!ParseFloat(pos, end, value)) {
+                        return false;
+                    }
+                    out.push_back(value);
+                }
+                return true;
+            }
+        }
+
+        static bool ParseNormal(const char *pos, const char *end, std::vector<float> &tempNormals)
+        {
+            // Vertex normal dimension is 3.
+            if (!ParseFloats(pos, end, 3, tempNormals)) {
+                LOGE("ParseObj: 'vn' requires three float values.");
+                return false;
+            }
+            return true;
+        }
+
+        static bool ParseTexture(const char *pos, const char *end, std::vector<float> &tempUvs)
+        {
+            // U V two quantities.
+            if (!ParseFloats(pos, end, 2, tempUvs)) {
+                LOGE("ParseObj: 'vt' requires two float values.");
+                return false;
+            }
+            return true;
+        }
+
+        static bool ParseVertex(const char *pos, const char *end, std::vector<float> &tempPositions)
+        {
+            // Vertex dimension is 3.
+            if (!ParseFloats(pos, end, 3, tempPositions)) {
+                LOGE("ParseObj: 'v' requires three float values.");
+                return false;
+            }
+            return true;
+        }
+
+        // Number of elements in an obj file, counted without parsing any value.
+        struct ObjCounts {
+            size_t positions = 0;
+            size_t normals = 0;
+            size_t uvs = 0;
+            size_t triangleCorners = 0;
+        };
+
+        // One face corner, as zero-based indices into the temporary attribute arrays.
+        struct FaceCorner {
+            uint32_t vertex = 0;
+            uint32_t uv = 0;
+            uint32_t normal = 0;
+            bool hasUv = false;
+            bool hasNormal = false;
+        };
+
+        // Each corner is 'v', 'v/vt', 'v//vn' or 'v/vt/vn'. Indices resolve against the elements read
+        // so far: those counted in base, which precede this part of the file, and those in drawTempData.
+        static bool ParseFaceCorner(const char *&pos, const char *end, const ObjCounts &base,
+                                    const DrawTempData &drawTempData, FaceCorner &corner)
+        {
+            corner = FaceCorner();
+            if (!ParseIndex(pos, end, base.positions + drawTempData.tempPositions.size() / 3, corner.vertex)) {
+                LOGE("ParseObj: invalid vertex index in face.");
+                return false;
+            }
+            if (pos != end && *pos == '/') {
+                ++pos;
+                if (pos != end && *pos != '/') {
+                    if (!ParseIndex(pos, end, base.uvs + drawTempData.tempUvs.size() / 2, corner.uv)) {
+                        LOGE("ParseObj: invalid texture index in face.");
+                        return false;
+                    }
+                    corner.hasUv = true;
+                }
+                if (pos != end && *pos == '/') {
+                    ++pos;
+                    if (!ParseIndex(pos, end, base.normals + drawTempData.tempNormals.size() / 3, corner.normal)) {
+                        LOGE("ParseObj: invalid normal index in face.");
+                        return false;
+                    }
+                    corner.hasNormal = true;
+                }
+            }
+            if (!IsDelimiter(pos, end) || (pos != end && *pos == '/')) {
+                LOGE("Format of 'f int/int/int int/int/int int/int/int "
+                     "(int/int/int)' "
+                     "or 'f int//int int//int int//int (int//int)' required for "
+                     "each face");
+                return false;
+            }
+            return true;
+        }
+
+        static void WriteCorner(const FaceCorner &corner, DrawTempData &drawTempData)
+        {
+            drawTempData.vertexIndices.push_back(corner.vertex);
+            if (corner.hasNormal) {
+                drawTempData.normalIndices.push_back(corner.normal);
+            }
+            if (corner.hasUv) {
+                drawTempData.uvIndices.push_back(corner.uv);
+            }
+        }
+
+        static bool WriteIndex(const char *pos, const char *end, const ObjCounts &base, DrawTempData &drawTempData)
+        {
+            // Faces are triangulated as a fan around the first corner. A fan only needs the first and
+            // the previous corner, so faces with any number of corners are assembled without a buffer.
+            FaceCorner first;
+            FaceCorner previous;
+            FaceCorner current;
+            int cornerCount = 0;
+            for (SkipSpaces(pos, end); pos != end; SkipSpaces(pos, end)) {
+                if (!ParseFaceCorner(pos, end, base, drawTempData, current)) {
+                    return false;
+                }
+                if (cornerCount == 0) {
+                    first = current;
+                } else if (current.hasUv != first.hasUv || current.hasNormal != first.hasNormal) {
+                    LOGE("ParseObj: all corners of a face must reference the same attributes.");
+                    return false;
+                }
+                if (cornerCount >= 2) {
+                    WriteCorner(first, drawTempData);
+                    WriteCorner(previous, drawTempData);
+                    WriteCorner(current, drawTempData);
+                }
+                previous = current;
+                ++cornerCount;
+            }
+            return true;
+        }
+
+        static bool WriteDrawOutData(const DrawTempData &drawTempData,
+                                     std::vector<float> &outVertices,
+                                     std::vector<float> &outNormals,
+                                     std::vector<float> &outUv,
+                                     std::vector<uint32_t> &outIndices,
+                                     ObjStats *outStats)
+        {
+            bool isNormalAvailable = (!drawTempData.normalIndices.empty());
+            bool isUvAvailable = (!drawTempData.uvIndices.empty());
+            if (isNormalAvailable && drawTempData.normalIndices.size() != drawTempData.vertexIndices.size()) {
+                LOGE("Object normal indices does not equal to vertex indices.");
+                return false;
+            }
+            if (isUvAvailable && drawTempData.uvIndices.size() != drawTempData.vertexIndices.size()) {
+                LOGE("Object UV indices does not equal to vertex indices.");
+                return false;
+            }
+
+            // Corners sharing position, normal and texture coordinate become one vertex. The vertex and
+            // normal dimensions are 3, the texture coordinate dimension is 2.
+            const size_t cornerCount = drawTempData.vertexIndices.size();
+            VertexWelder welder(outVertices, outNormals, outUv, cornerCount);
+            // Exporters usually write one position per welded vertex, which makes a good first guess.
+            outVertices.reserve(drawTempData.tempPositions.size());
+            outNormals.reserve(isNormalAvailable ? drawTempData.tempPositions.size() : 0);
+            outUv.reserve(isUvAvailable ? drawTempData.tempPositions.size() / 3 * 2 : 0);
+            outIndices.clear();
+            outIndices.reserve(cornerCount);
+            for (size_t i = 0; i < cornerCount; i++) {
+                const float *position = &drawTempData.tempPositions[drawTempData.vertexIndices[i] * 3];
+                const float *normal = isNormalAvailable ?
+                    &drawTempData.tempNormals[drawTempData.normalIndices[i] * 3] : nullptr;
+                const float *uv = isUvAvailable ? &drawTempData.tempUvs[drawTempData.uvIndices[i] * 2] : nullptr;
+                outIndices.push_back(welder.Insert(position, normal, uv));
+            }
+            if (outStats != nullptr) {
+                outStats->cornerCount = cornerCount;
+                outStats->vertexCount = welder.GetVertexCount();
+            }
+            return true;
+        }
+
+        static bool ParseLine(const char *pos, const char *end, const ObjCounts &base, DrawTempData &drawTempData)
+        {
+            SkipSpaces(pos, end);
+            if (HasKeyword(pos, end, "vn")) {
+                return ParseNormal(pos + 2, end, drawTempData.tempNormals);
+            } else if (HasKeyword(pos, end, "vt")) {
+                return ParseTexture(pos + 2, end, drawTempData.tempUvs);
+            } else if (HasKeyword(pos, end, "v")) {
+                return ParseVertex(pos + 1, end, drawTempData.tempPositions);
+            } else if (HasKeyword(pos, end, "f")) {
+                return WriteIndex(pos + 1, end, base, drawTempData);
+            }
+            // Comments, empty lines and keywords such as 'o', 'g' or 's' carry nothing we draw.
+            return true;
+        }
+
+        // Call lineFunction(lineStart, lineEnd) for every line of the buffer, in place; lines are never
+        // copied or truncated. Stops early and returns false when lineFunction does.
+        template <typename LineFunction>
+        static bool ForEachLine(const char *data, size_t size, LineFunction &&lineFunction)
+        {
+            const char *fileEnd = data + size;
+            for (const char *lineStart = data; lineStart < fileEnd;) {
+                const char *lineEnd = static_cast<const char *>(memchr(lineStart, '\n', fileEnd - lineStart));
+                if (lineEnd == nullptr) {
+                    lineEnd = fileEnd;
+                }
+                if (!lineFunction(lineStart, lineEnd)) {
+                    return false;
+                }
+                lineStart = lineEnd + 1;
+            }
+            return true;
+        }
+
+        static ObjCounts CountElements(const char *data, size_t size)
+        {
+            ObjCounts counts;
+            ForEachLine(data, size, [&counts](const char *pos, const char *end) {
+                SkipSpaces(pos, end);
+                if (HasKeyword(pos, end, "vn")) {
+                    ++counts.normals;
+                } else if (HasKeyword(pos, end, "vt")) {
+                    ++counts.uvs;
+                } else if (HasKeyword(pos, end, "v")) {
+                    ++counts.positions;
+                } else if (HasKeyword(pos, end, "f")) {
+                    size_t cornerCount = 0;
+                    for (++pos; pos != end; ++pos) {
+                        cornerCount += (IsSpace(pos[-1]) && !IsSpace(*pos));
+                    }
+                    // A fan of n corners has n - 2 triangles.
+                    counts.triangleCorners += cornerCount > 2 ? (cornerCount - 2) * 3 : 0;
+                }
+                return true;
+            });
+            return counts;
+        }
+
+        // A part of the file made of whole lines, parsed on its own thread.
+        struct ObjChunk {
+            const char *begin = nullptr;
+            const char *end = nullptr;
+            ObjCounts counts; // Elements in this chunk.
+            ObjCounts base; // Elements in all earlier chunks.
+            DrawTempData drawTempData;
+            bool isParsed = false;
+        };
+
+        static std::vector<ObjChunk> SplitIntoChunks(const char *data, size_t size, size_t threadCount)
+        {
+            const size_t chunkCount = std::max<size_t>(1, std::min(threadCount, size / MIN_CHUNK_SIZE));
+            std::vector<ObjChunk> chunks(chunkCount);
+            const char *fileEnd = data + size;
+            const char *chunkBegin = data;
+            for (size_t i = 0; i < chunkCount; ++i) {
+                const char *chunkEnd = fileEnd;
+                if (i + 1 < chunkCount) {
+                    // End each chunk after the first line break past its share of the file.
+                    const char *target = std::max(chunkBegin, data + size / chunkCount * (i + 1));
+                    const char *lineEnd = static_cast<const char *>(memchr(target, '\n', fileEnd - target));
+                    chunkEnd = (lineEnd == nullptr) ? fileEnd : lineEnd + 1;
+                }
+                chunks[i].begin = chunkBegin;
+                chunks[i].end = chunkEnd;
+                chunkBegin = chunkEnd;
+            }
+            return chunks;
+        }
+
+        // Call chunkFunction(i) for every chunk index, the first on the calling thread and the others
+        // on threads of their own.
+        template <typename ChunkFunction>
+        static void ForEachChunk(size_t chunkCount, ChunkFunction &&chunkFunction)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(chunkCount > 0 ? chunkCount - 1 : 0);
+            for (size_t i = 1; i < chunkCount; ++i) {
+                workers.emplace_back([&chunkFunction, i]() {
+                    chunkFunction(i);
+                });
+            }
+            if (chunkCount > 0) {
+                chunkFunction(0);
+            }
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        static bool ParseChunk(ObjChunk &chunk)
+        {
+            // Size every array once up front, so loading stays proportional to the file size.
+            const ObjCounts &counts = chunk.counts;
+            DrawTempData &drawTempData = chunk.drawTempData;
+            drawTempData.tempPositions.reserve(counts.positions * 3);
+            drawTempData.tempNormals.reserve(counts.normals * 3);
+            drawTempData.tempUvs.reserve(counts.uvs * 2);
+            drawTempData.vertexIndices.reserve(counts.triangleCorners);
+            drawTempData.normalIndices.reserve(chunk.base.normals + counts.normals > 0 ? counts.triangleCorners : 0);
+            drawTempData.uvIndices.reserve(chunk.base.uvs + counts.uvs > 0 ? counts.triangleCorners : 0);
+
+            return ForEachLine(chunk.begin, chunk.end - chunk.begin,
+                [&chunk](const char *lineStart, const char *lineEnd) {
+                    return ParseLine(lineStart, lineEnd, chunk.base, chunk.drawTempData);
+                });
+        }
+
+        // Concatenate the arrays of all chunks in file order. Each chunk copies its own part, at the
+        // offset given by the sizes of the chunks before it.
+        static void MergeChunks(std::vector<ObjChunk> &chunks, DrawTempData &outDrawTempData)
+        {
+            if (chunks.size() == 1) {
+                outDrawTempData = std::move(chunks[0].drawTempData);
+                return;
+            }
+            std::vector<float> DrawTempData::*const floatArrays[] = {
+                &DrawTempData::tempPositions, &DrawTempData::tempNormals, &DrawTempData::tempUvs
+            };
+            std::vector<uint32_t> DrawTempData::*const indexArrays[] = {
+                &DrawTempData::vertexIndices, &DrawTempData::normalIndices, &DrawTempData::uvIndices
+            };
+            constexpr size_t arrayCount = 3;
+            std::vector<size_t> floatOffsets(chunks.size() * arrayCount);
+            std::vector<size_t> indexOffsets(chunks.size() * arrayCount);
+            for (size_t array = 0; array < arrayCount; ++array) {
+                size_t floatTotal = 0;
+                size_t indexTotal = 0;
+                for (size_t i = 0; i < chunks.size(); ++i) {
+                    floatOffsets[i * arrayCount + array] = floatTotal;
+                    indexOffsets[i * arrayCount + array] = indexTotal;
+                    floatTotal += (chunks[i].drawTempData.*floatArrays[array]).size();
+                    indexTotal += (chunks[i].drawTempData.*indexArrays[array]).size();
+                }
+                (outDrawTempData.*floatArrays[array]).resize(floatTotal);
+                (outDrawTempData.*indexArrays[array]).resize(indexTotal);
+            }
+            ForEachChunk(chunks.size(), [&](size_t i) {
+                DrawTempData &chunkData = chunks[i].drawTempData;
+                for (size_t array = 0; array < arrayCount; ++array) {
+                    const std::vector<float> &floats = chunkData.*floatArrays[array];
+                    std::copy(floats.begin(), floats.end(),
+                              (outDrawTempData.*floatArrays[array]).begin() + floatOffsets[i * arrayCount + array]);
+                    const std::vector<uint32_t> &indices = chunkData.*indexArrays[array];
+                    std::copy(indices.begin(), indices.end(),
+                              (outDrawTempData.*indexArrays[array]).begin() + indexOffsets[i * arrayCount + array]);
+                }
+                chunkData = DrawTempData();
+            });
+        }
+
+        bool ParseObj(const char *data, size_t size,
+                      std::vector<float> &outVertices,
+                      std::vector<float> &outNormals,
+                      std::vector<float> &outUv,
+                      std::vector<uint32_t> &outIndices,
+                      ObjStats *outStats,
+                      size_t threadCount)
+        {
+            std::vector<ObjChunk> chunks = SplitIntoChunks(data, size, threadCount);
+
+            // Count the elements of every chunk first, so each chunk knows how many precede it and
+            // resolves its face indices exactly as a serial parse would.
+            ForEachChunk(chunks.size(), [&chunks](size_t i) {
+                chunks[i].counts = CountElements(chunks[i].begin, chunks[i].end - chunks[i].begin);
+            });
+            for (size_t i = 1; i < chunks.size(); ++i) {
+                const ObjChunk &previous = chunks[i - 1];
+                chunks[i].base.positions = previous.base.positions + previous.counts.positions;
+                chunks[i].base.normals = previous.base.normals + previous.counts.normals;
+                chunks[i].base.uvs = previous.base.uvs + previous.counts.uvs;
+            }
+
+            ForEachChunk(chunks.size(), [&chunks](size_t i) {
+                chunks[i].isParsed = ParseChunk(chunks[i]);
+            });
+            for (const ObjChunk &chunk : chunks) {
+                if (!chunk.isParsed) {
+                    return false;
+                }
+            }
+
+            DrawTempData drawTempData;
+            MergeChunks(chunks, drawTempData);
+            return WriteDrawOutData(drawTempData, outVertices, outNormals, outUv, outIndices, outStats);
+        }
+    }
+}
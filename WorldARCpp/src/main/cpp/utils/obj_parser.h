@@ -0,0 +1,67 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_OBJ_PARSER_H
+#define C_ARENGINE_HELLOE_AR_OBJ_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Platform independent OBJ parsing, shared by the app and the host-side mesh compiler.
+    namespace util {
+        using DrawTempData = struct {
+            std::vector<float> tempPositions;
+            std::vector<float> tempNormals;
+            std::vector<float> tempUvs;
+            // Zero-based indices into the temporary attribute arrays, three per triangle.
+            std::vector<uint32_t> vertexIndices;
+            std::vector<uint32_t> normalIndices;
+            std::vector<uint32_t> uvIndices;
+        };
+
+        // Vertex counts of a parsed obj file, before and after welding.
+        struct ObjStats {
+            size_t cornerCount = 0;
+            size_t vertexCount = 0;
+        };
+
+        /**
+         * Parse the content of an obj file that is already in memory, in a single pass and
+         * without copying it. Triangle corners with identical attributes share one output vertex.
+         *
+         * @param data Start of the obj file content.
+         * @param size Size of the obj file content in bytes.
+         * @param outVertices Output vertex.
+         * @param outNormals Output normal.
+         * @param outUv UV coordinate of the output texture.
+         * @param outIndices Output triangular exponent.
+         * @param outStats Optional vertex counts before and after welding.
+         * @param threadCount Largest number of threads the file is split across at line boundaries.
+         *                    The output does not depend on it.
+         * @return True if obj is parsed correctly, false otherwise.
+         */
+        bool ParseObj(const char *data, size_t size,
+                      std::vector<float> &outVertices,
+                      std::vector<float> &outNormals,
+                      std::vector<float> &outUv,
+                      std::vector<uint32_t> &outIndices,
+                      ObjStats *outStats = nullptr,
+                      size_t threadCount = 1);
+    }
+}
+#endif
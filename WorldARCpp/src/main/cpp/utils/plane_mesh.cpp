@@ -0,0 +1,116 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/plane_mesh.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <glm.hpp>
+
+#include "utils/mesh_optimizer.h"
+#include "utils/polygon_triangulator.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Distance the inner polygon is moved towards the center, at most this fraction of the
+            // distance of the point from the center.
+            constexpr float FEATHER_LENGTH = 0.2f;
+            constexpr float FEATHER_SCALE = 0.2f;
+        }
+
+        bool BuildPlaneMesh(const std::vector<glm::vec2> &polygon, std::vector<glm::vec3> &outVertices,
+                            std::vector<uint16_t> &outTriangles)
+        {
+            outVertices.clear();
+            outTriangles.clear();
+            // Every polygon point becomes two vertices.
+            const size_t pointCount = polygon.size();
+            if (pointCount == 0 || pointCount * 2 > MAX_VERTICES_16_BIT) {
+                return false;
+            }
+
+            // Outer vertices 0 to n - 1 have alpha 0, inner vertices n to 2n - 1 have alpha 1.
+            std::vector<glm::vec2> innerPolygon;
+            innerPolygon.reserve(pointCount);
+            outVertices.reserve(pointCount * 2);
+            for (const glm::vec2 &point : polygon) {
+                outVertices.emplace_back(point.x, point.y, 0.0f);
+            }
+            for (const glm::vec2 &point : polygon) {
+                const float scale = 1.0f - std::min((FEATHER_LENGTH / glm::length(point)), FEATHER_SCALE);
+                innerPolygon.push_back(scale * point);
+                outVertices.emplace_back(innerPolygon.back().x, innerPolygon.back().y, 1.0f);
+            }
+
+            // Floor outlines are often concave, where a fan would overlap itself and blend twice, so the
+            // inner polygon is ear clipped.
+            const uint16_t n = static_cast<uint16_t>(pointCount);
+            outTriangles.reserve((pointCount * 3 - 2) * 3);
+            TriangulatePolygon(innerPolygon, n, outTriangles);
+
+            // The band between the polygons; with 4 points (0, 1, 4), (4, 1, 5), (5, 1, 2), (5, 2, 6),
+            // (6, 2, 3), (6, 3, 7), (7, 3, 0) and (7, 0, 4).
+            for (uint16_t i = 0; i < n; ++i) {
+                const uint16_t next = static_cast<uint16_t>((i + 1) % n);
+                outTriangles.insert(outTriangles.end(), {i, next, static_cast<uint16_t>(i + n)});
+                outTriangles.insert(outTriangles.end(), {static_cast<uint16_t>(i + n), next,
+                    static_cast<uint16_t>(next + n)});
+            }
+            return true;
+        }
+
+        uint64_t HashPlanePolygon(const std::vector<glm::vec2> &polygon)
+        {
+            uint64_t hash = 14695981039346656037ull;
+            const auto *bytes = reinterpret_cast<const unsigned char *>(polygon.data());
+            for (size_t i = 0; i < polygon.size() * sizeof(glm::vec2); ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+            return hash;
+        }
+
+        void BakePlaneVertices(const std::vector<glm::vec3> &vertices, const glm::mat4 &modelMat,
+                               const glm::vec3 &normal, const glm::vec3 &color, std::vector<PlaneVertex> &outVertices)
+        {
+            // The mesh lies in the x-z plane of the pose, with the alpha in place of y.
+            outVertices.resize(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i) {
+                const glm::vec4 world = modelMat * glm::vec4(vertices[i].x, 0.0f, vertices[i].y, 1.0f);
+                outVertices[i] = {glm::vec4(glm::vec3(world), vertices[i].z), normal, color};
+            }
+        }
+
+        void AppendPlaneToBatch(const std::vector<PlaneVertex> &vertices, const std::vector<uint16_t> &triangles,
+                                std::vector<PlaneVertex> &batchVertices, std::vector<uint16_t> &batchIndices,
+                                std::vector<PlaneBatchRange> &ranges)
+        {
+            if (ranges.empty() || batchVertices.size() - ranges.back().firstVertex + vertices.size() >
+                MAX_VERTICES_16_BIT) {
+                ranges.push_back({batchVertices.size(), batchIndices.size(), 0});
+            }
+            PlaneBatchRange &range = ranges.back();
+            const auto base = static_cast<uint16_t>(batchVertices.size() - range.firstVertex);
+            batchVertices.insert(batchVertices.end(), vertices.begin(), vertices.end());
+            for (uint16_t index : triangles) {
+                batchIndices.push_back(static_cast<uint16_t>(base + index));
+            }
+            range.indexCount += triangles.size();
+        }
+    }
+}
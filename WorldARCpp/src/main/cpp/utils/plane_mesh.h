@@ -0,0 +1,99 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_PLANE_MESH_H
+#define C_ARENGINE_HELLOE_AR_PLANE_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <mat4x4.hpp>
+#include <vec2.hpp>
+#include <vec3.hpp>
+#include <vec4.hpp>
+
+namespace gWorldAr {
+    // Meshes of detected planes, shared by the app and the host-side benchmarks. Makes no GL calls.
+    namespace util {
+        // Vertex of a plane in world space, carrying what was a uniform of the plane, so planes with
+        // different poses and colors can be drawn with one call.
+        struct PlaneVertex {
+            // World position, and the alpha of the feathered edge in w.
+            glm::vec4 position;
+            glm::vec3 normal;
+            glm::vec3 color;
+        };
+
+        // Part of a plane batch drawn with one call. Its indices are relative to its first vertex, so
+        // every range stays addressable with 16-bit indices.
+        struct PlaneBatchRange {
+            size_t firstVertex;
+            size_t firstIndex;
+            size_t indexCount;
+        };
+
+        /**
+         * Build the mesh of a plane polygon: the polygon itself with alpha 0, and a copy moved towards
+         * the center with alpha 1, so the texture fades out at the edges. The inner copy is ear clipped,
+         * so concave polygons are covered once.
+         *
+         * @param polygon Points of the boundary in the x-z plane of the plane's center pose.
+         * @param outVertices Cleared first. Receives x and z of each vertex, and its alpha.
+         * @param outTriangles Cleared first. Receives three 16-bit indices per triangle.
+         * @return False if the mesh does not fit 16-bit indices or the polygon is empty.
+         */
+        bool BuildPlaneMesh(const std::vector<glm::vec2> &polygon, std::vector<glm::vec3> &outVertices,
+                            std::vector<uint16_t> &outTriangles);
+
+        /**
+         * Hash of the points of a plane polygon, to tell whether a plane reported as updated needs
+         * a new mesh or only moved.
+         *
+         * @param polygon Points of the boundary.
+         * @return 64-bit FNV-1a hash of the point coordinates.
+         */
+        uint64_t HashPlanePolygon(const std::vector<glm::vec2> &polygon);
+
+        /**
+         * Move the vertices of a plane mesh into world space.
+         *
+         * @param vertices Mesh from BuildPlaneMesh.
+         * @param modelMat Center pose of the plane.
+         * @param normal Normal of the plane in world space.
+         * @param color Color of the plane.
+         * @param outVertices Cleared first. Receives one world space vertex per mesh vertex.
+         */
+        void BakePlaneVertices(const std::vector<glm::vec3> &vertices, const glm::mat4 &modelMat,
+                               const glm::vec3 &normal, const glm::vec3 &color, std::vector<PlaneVertex> &outVertices);
+
+        /**
+         * Append a plane to a batch, starting a new range when the current one would exceed 16-bit
+         * indices. Planes are drawn in the order they are appended.
+         *
+         * @param vertices World space vertices from BakePlaneVertices.
+         * @param triangles Triangles from BuildPlaneMesh.
+         * @param batchVertices Vertices of the batch, appended to.
+         * @param batchIndices Indices of the batch, appended to.
+         * @param ranges Ranges of the batch, the last one extended or a new one added.
+         */
+        void AppendPlaneToBatch(const std::vector<PlaneVertex> &vertices, const std::vector<uint16_t> &triangles,
+                                std::vector<PlaneVertex> &batchVertices, std::vector<uint16_t> &batchIndices,
+                                std::vector<PlaneBatchRange> &ranges);
+    }
+}
+#endif
@@ -0,0 +1,115 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/plane_store.h"
+
+namespace gWorldAr {
+    namespace util {
+        TrackableHandle PlaneStore::Find(const void *key) const
+        {
+            const auto iter = slotsByKey.find(key);
+            if (iter == slotsByKey.end()) {
+                return {};
+            }
+            return {iter->second, slots[iter->second].generation};
+        }
+
+        TrackableHandle PlaneStore::Insert(const void *key, const glm::vec3 &color, uint32_t frame)
+        {
+            uint32_t slot = 0;
+            if (freeSlots.empty()) {
+                slot = static_cast<uint32_t>(slots.size());
+                slots.push_back({0, 1});
+            } else {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            slots[slot].denseIndex = static_cast<uint32_t>(keys.size());
+            slotsByKey[key] = slot;
+
+            keys.push_back(key);
+            slotIndices.push_back(slot);
+            colors.push_back(color);
+            centerPoses.emplace_back(1.0f);
+            normals.emplace_back(0.0f, 1.0f, 0.0f);
+            extents.emplace_back(0.0f);
+            lastSeenFrames.push_back(frame);
+            // Zero until the first pose is stored. Frames are counted from one.
+            updatedFrames.push_back(0);
+            isSubsumed.push_back(0);
+            return {slot, slots[slot].generation};
+        }
+
+        void PlaneStore::UpdatePose(TrackableHandle handle, const glm::mat4 &centerPose, const glm::vec3 &normal,
+                                    const glm::vec2 &extent, uint32_t frame)
+        {
+            const size_t index = GetIndex(handle);
+            centerPoses[index] = centerPose;
+            normals[index] = normal;
+            extents[index] = extent;
+            updatedFrames[index] = frame;
+        }
+
+        void PlaneStore::Compact(uint32_t frame, uint32_t maxUnseenFrames, std::vector<const void *> &outRemovedKeys)
+        {
+            outRemovedKeys.clear();
+            for (size_t index = 0; index < keys.size();) {
+                if (isSubsumed[index] == 0 && frame - lastSeenFrames[index] <= maxUnseenFrames) {
+                    ++index;
+                    continue;
+                }
+                outRemovedKeys.push_back(keys[index]);
+                // The entry moved into index is checked next.
+                RemoveAt(index);
+            }
+        }
+
+        void PlaneStore::RemoveAt(size_t index)
+        {
+            const uint32_t slot = slotIndices[index];
+            slotsByKey.erase(keys[index]);
+            // A new generation invalidates the handles of the removed plane; zero is skipped on wrap around.
+            if (++slots[slot].generation == 0) {
+                slots[slot].generation = 1;
+            }
+            freeSlots.push_back(slot);
+
+            const size_t last = keys.size() - 1;
+            if (index != last) {
+                keys[index] = keys[last];
+                slotIndices[index] = slotIndices[last];
+                colors[index] = colors[last];
+                centerPoses[index] = centerPoses[last];
+                normals[index] = normals[last];
+                extents[index] = extents[last];
+                lastSeenFrames[index] = lastSeenFrames[last];
+                updatedFrames[index] = updatedFrames[last];
+                isSubsumed[index] = isSubsumed[last];
+                slots[slotIndices[index]].denseIndex = static_cast<uint32_t>(index);
+            }
+            keys.pop_back();
+            slotIndices.pop_back();
+            colors.pop_back();
+            centerPoses.pop_back();
+            normals.pop_back();
+            extents.pop_back();
+            lastSeenFrames.pop_back();
+            updatedFrames.pop_back();
+            isSubsumed.pop_back();
+        }
+    }
+}
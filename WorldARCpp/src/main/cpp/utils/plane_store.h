@@ -0,0 +1,185 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_PLANE_STORE_H
+#define C_ARENGINE_HELLOE_AR_PLANE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <mat4x4.hpp>
+#include <vec2.hpp>
+#include <vec3.hpp>
+
+namespace gWorldAr {
+    // State kept across frames for tracked planes. Platform independent: planes are identified by the
+    // address of their engine handle, which the store never dereferences.
+    namespace util {
+        // Stable reference to a plane of a PlaneStore. It stays valid while the plane is stored and never
+        // refers to a later plane that reuses its slot.
+        struct TrackableHandle {
+            uint32_t index = 0;
+            // Zero never names a plane, so a default handle is invalid.
+            uint32_t generation = 0;
+        };
+
+        /**
+         * Per-plane state as parallel arrays, one entry per live plane, so renderers walk only the fields
+         * they read. Entries are removed on Compact, which moves the last entry into the gap, so dense
+         * indices change then and handles are what stays stable.
+         */
+        class PlaneStore {
+        public:
+            /**
+             * Look up the plane with an engine handle.
+             *
+             * @param key Engine handle of the plane.
+             * @return Handle of the plane, invalid if it is not stored.
+             */
+            TrackableHandle Find(const void *key) const;
+
+            /**
+             * Add a plane that is not stored yet, seen in this frame.
+             *
+             * @param key Engine handle of the plane.
+             * @param color Color the plane is drawn with.
+             * @param frame Current frame.
+             * @return Handle of the new plane.
+             */
+            TrackableHandle Insert(const void *key, const glm::vec3 &color, uint32_t frame);
+
+            bool IsValid(TrackableHandle handle) const
+            {
+                return handle.index < slots.size() && handle.generation != 0 &&
+                       slots[handle.index].generation == handle.generation;
+            }
+
+            /**
+             * Dense index of a valid handle into the arrays below, until the next Compact.
+             */
+            size_t GetIndex(TrackableHandle handle) const
+            {
+                return slots[handle.index].denseIndex;
+            }
+
+            TrackableHandle GetHandle(size_t index) const
+            {
+                return {slotIndices[index], slots[slotIndices[index]].generation};
+            }
+
+            size_t GetSize() const
+            {
+                return keys.size();
+            }
+
+            /**
+             * Store the pose of a plane queried from the engine.
+             *
+             * @param handle Valid handle of the plane.
+             * @param centerPose Model matrix of the center pose.
+             * @param normal Normal in world space.
+             * @param extent Extents along the x and z axes of the center pose.
+             * @param frame Current frame, stored as the frame the plane was last updated in.
+             */
+            void UpdatePose(TrackableHandle handle, const glm::mat4 &centerPose, const glm::vec3 &normal,
+                            const glm::vec2 &extent, uint32_t frame);
+
+            void MarkSeen(TrackableHandle handle, uint32_t frame)
+            {
+                lastSeenFrames[GetIndex(handle)] = frame;
+            }
+
+            // A subsumed plane is removed by the next Compact, however recently it was seen.
+            void MarkSubsumed(TrackableHandle handle)
+            {
+                isSubsumed[GetIndex(handle)] = 1;
+            }
+
+            /**
+             * Remove the planes that were subsumed or not seen for more than maxUnseenFrames frames. Their
+             * handles become invalid, and their slots are reused by later planes.
+             *
+             * @param frame Current frame.
+             * @param maxUnseenFrames Frames a plane that is no longer reported is kept, in case it returns.
+             * @param outRemovedKeys Cleared first. Receives the engine handles of the removed planes.
+             */
+            void Compact(uint32_t frame, uint32_t maxUnseenFrames, std::vector<const void *> &outRemovedKeys);
+
+            const std::vector<const void *> &GetKeys() const
+            {
+                return keys;
+            }
+
+            const std::vector<glm::vec3> &GetColors() const
+            {
+                return colors;
+            }
+
+            const std::vector<glm::mat4> &GetCenterPoses() const
+            {
+                return centerPoses;
+            }
+
+            const std::vector<glm::vec3> &GetNormals() const
+            {
+                return normals;
+            }
+
+            const std::vector<glm::vec2> &GetExtents() const
+            {
+                return extents;
+            }
+
+            const std::vector<uint32_t> &GetLastSeenFrames() const
+            {
+                return lastSeenFrames;
+            }
+
+            // Frame each plane's pose was last stored in; renderers compare it to tell whether to rebuild.
+            const std::vector<uint32_t> &GetUpdatedFrames() const
+            {
+                return updatedFrames;
+            }
+
+        private:
+            struct Slot {
+                uint32_t denseIndex = 0;
+                uint32_t generation = 0;
+            };
+
+            // Moves the last entry into index and drops the last entry.
+            void RemoveAt(size_t index);
+
+            std::vector<Slot> slots;
+            std::vector<uint32_t> freeSlots;
+            std::unordered_map<const void *, uint32_t> slotsByKey;
+
+            std::vector<const void *> keys;
+            std::vector<uint32_t> slotIndices;
+            std::vector<glm::vec3> colors;
+            std::vector<glm::mat4> centerPoses;
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec2> extents;
+            std::vector<uint32_t> lastSeenFrames;
+            std::vector<uint32_t> updatedFrames;
+            std::vector<uint8_t> isSubsumed;
+        };
+    }
+}
+#endif
@@ -0,0 +1,373 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/png_decoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            constexpr uint8_t PNG_SIGNATURE[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+            // Length, type and CRC around the chunk data.
+            constexpr size_t PNG_CHUNK_OVERHEAD = 12;
+
+            constexpr uint32_t PNG_COLOR_GRAY = 0;
+            constexpr uint32_t PNG_COLOR_RGB = 2;
+            constexpr uint32_t PNG_COLOR_PALETTE = 3;
+            constexpr uint32_t PNG_COLOR_GRAY_ALPHA = 4;
+            constexpr uint32_t PNG_COLOR_RGBA = 6;
+
+            constexpr uint8_t PNG_FILTER_NONE = 0;
+            constexpr uint8_t PNG_FILTER_SUB = 1;
+            constexpr uint8_t PNG_FILTER_UP = 2;
+            constexpr uint8_t PNG_FILTER_AVERAGE = 3;
+            constexpr uint8_t PNG_FILTER_PAETH = 4;
+
+            uint32_t ReadBigEndian32(const uint8_t *bytes)
+            {
+                return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+                       (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+            }
+
+            uint32_t ReadBigEndian16(const uint8_t *bytes)
+            {
+                return (static_cast<uint32_t>(bytes[0]) << 8) | bytes[1];
+            }
+
+            bool IsChunk(const uint8_t *type, const char *name)
+            {
+                return memcmp(type, name, 4) == 0;
+            }
+
+            // Channels stored per pixel in the file, 0 for invalid color types and bit depths.
+            uint32_t GetFileChannels(uint32_t colorType, uint32_t bitDepth)
+            {
+                switch (colorType) {
+                    case PNG_COLOR_GRAY:
+                        return (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 ||
+                                bitDepth == 16) ? 1 : 0;
+                    case PNG_COLOR_PALETTE:
+                        return (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8) ? 1 : 0;
+                    case PNG_COLOR_RGB:
+                        return (bitDepth == 8 || bitDepth == 16) ? 3 : 0;
+                    case PNG_COLOR_GRAY_ALPHA:
+                        return (bitDepth == 8 || bitDepth == 16) ? 2 : 0;
+                    case PNG_COLOR_RGBA:
+                        return (bitDepth == 8 || bitDepth == 16) ? 4 : 0;
+                    default:
+                        return 0;
+                }
+            }
+
+            // Sample at the given position of an unfiltered row, at the bit depth of the file.
+            uint32_t ReadSample(const uint8_t *row, size_t sample, uint32_t bitDepth)
+            {
+                if (bitDepth == 16) {
+                    return ReadBigEndian16(row + sample * 2);
+                }
+                if (bitDepth == 8) {
+                    return row[sample];
+                }
+                const size_t bit = sample * bitDepth;
+                return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1u << bitDepth) - 1);
+            }
+
+            // Sample scaled to 8 bits the way the other pixels are: high byte of 16-bit samples, and
+            // gray values below 8 bits stretched to the full range.
+            uint8_t To8BitSample(uint32_t value, uint32_t bitDepth)
+            {
+                if (bitDepth == 16) {
+                    return static_cast<uint8_t>(value >> 8);
+                }
+                return static_cast<uint8_t>(value * 255 / ((1u << bitDepth) - 1));
+            }
+
+            uint8_t Paeth(int a, int b, int c)
+            {
+                const int p = a + b - c;
+                const int pa = std::abs(p - a);
+                const int pb = std::abs(p - b);
+                const int pc = std::abs(p - c);
+                if (pa <= pb && pa <= pc) {
+                    return static_cast<uint8_t>(a);
+                }
+                return static_cast<uint8_t>(pb <= pc ? b : c);
+            }
+
+            // Undo the filter of a row in place. The first bytesPerPixel bytes have no left neighbour.
+            bool Unfilter(uint8_t filter, uint8_t *row, const uint8_t *above, size_t size, size_t bytesPerPixel)
+            {
+                switch (filter) {
+                    case PNG_FILTER_NONE:
+                        return true;
+                    case PNG_FILTER_SUB:
+                        for (size_t i = bytesPerPixel; i < size; ++i) {
+                            row[i] += row[i - bytesPerPixel];
+                        }
+                        return true;
+                    case PNG_FILTER_UP:
+                        for (size_t i = 0; i < size; ++i) {
+                            row[i] += above[i];
+                        }
+                        return true;
+                    case PNG_FILTER_AVERAGE:
+                        for (size_t i = 0; i < bytesPerPixel; ++i) {
+                            row[i] += above[i] >> 1;
+                        }
+                        for (size_t i = bytesPerPixel; i < size; ++i) {
+                            row[i] += (row[i - bytesPerPixel] + above[i]) >> 1;
+                        }
+                        return true;
+                    case PNG_FILTER_PAETH:
+                        for (size_t i = 0; i < bytesPerPixel; ++i) {
+                            row[i] += above[i];
+                        }
+                        for (size_t i = bytesPerPixel; i < size; ++i) {
+                            row[i] += Paeth(row[i - bytesPerPixel], above[i], above[i - bytesPerPixel]);
+                        }
+                        return true;
+                    default:
+                        return false;
+                }
+            }
+
+            // Releases the inflate state on every return path.
+            struct InflateStream {
+                z_stream stream = {};
+                bool isInitialized = false;
+
+                ~InflateStream()
+                {
+                    if (isInitialized) {
+                        inflateEnd(&stream);
+                    }
+                }
+            };
+        }
+
+        bool PngDecoder::Decode(const void *data, size_t size, PngImage &outImage)
+        {
+            const auto *bytes = static_cast<const uint8_t *>(data);
+            if (data == nullptr || size < sizeof(PNG_SIGNATURE) + PNG_CHUNK_OVERHEAD + 13 ||
+                memcmp(bytes, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0) {
+                LOGE("PngDecoder: not a PNG file.");
+                return false;
+            }
+
+            // The chunks before the image data describe it. Chunk CRCs are not checked: zlib checks the
+            // image data itself, and the header fields are validated below.
+            size_t offset = sizeof(PNG_SIGNATURE);
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t bitDepth = 0;
+            uint32_t colorType = 0;
+            uint32_t fileChannels = 0;
+            size_t paletteSize = 0;
+            bool hasTransparency = false;
+            // Transparent color of gray and RGB images, one sample per file channel.
+            uint32_t colorKey[3] = {};
+            palette.assign(256 * 4, 255);
+            while (true) {
+                if (size - offset < PNG_CHUNK_OVERHEAD) {
+                    LOGE("PngDecoder: image data is missing.");
+                    return false;
+                }
+                const uint32_t length = ReadBigEndian32(bytes + offset);
+                const uint8_t *type = bytes + offset + 4;
+                const uint8_t *chunk = bytes + offset + 8;
+                if (length > size - offset - PNG_CHUNK_OVERHEAD) {
+                    LOGE("PngDecoder: chunk is truncated.");
+                    return false;
+                }
+                if (offset == sizeof(PNG_SIGNATURE)) {
+                    if (!IsChunk(type, "IHDR") || length != 13) {
+                        LOGE("PngDecoder: header is missing.");
+                        return false;
+                    }
+                    width = ReadBigEndian32(chunk);
+                    height = ReadBigEndian32(chunk + 4);
+                    bitDepth = chunk[8];
+                    colorType = chunk[9];
+                    fileChannels = GetFileChannels(colorType, bitDepth);
+                    if (width == 0 || height == 0 || width > PNG_MAX_DIMENSION || height > PNG_MAX_DIMENSION ||
+                        fileChannels == 0 || chunk[10] != 0 || chunk[11] != 0) {
+                        LOGE("PngDecoder: unsupported header.");
+                        return false;
+                    }
+                    if (chunk[12] != 0) {
+                        LOGI("PngDecoder: interlaced images are not supported.");
+                        return false;
+                    }
+                } else if (IsChunk(type, "PLTE")) {
+                    paletteSize = std::min<size_t>(length / 3, 256);
+                    for (size_t i = 0; i < paletteSize; ++i) {
+                        memcpy(&palette[i * 4], chunk + i * 3, 3);
+                    }
+                } else if (IsChunk(type, "tRNS") && colorType == PNG_COLOR_PALETTE) {
+                    for (size_t i = 0; i < std::min<size_t>(length, 256); ++i) {
+                        palette[i * 4 + 3] = chunk[i];
+                    }
+                    hasTransparency = true;
+                } else if (IsChunk(type, "tRNS") && (colorType == PNG_COLOR_GRAY || colorType == PNG_COLOR_RGB)) {
+                    if (length != fileChannels * 2) {
+                        LOGE("PngDecoder: transparent color is malformed.");
+                        return false;
+                    }
+                    for (uint32_t i = 0; i < fileChannels; ++i) {
+                        colorKey[i] = ReadBigEndian16(chunk + i * 2);
+                    }
+                    hasTransparency = true;
+                } else if (IsChunk(type, "IDAT")) {
+                    break;
+                } else if (IsChunk(type, "IEND")) {
+                    LOGE("PngDecoder: image data is missing.");
+                    return false;
+                }
+                offset += length + PNG_CHUNK_OVERHEAD;
+            }
+            if (colorType == PNG_COLOR_PALETTE && paletteSize == 0) {
+                LOGE("PngDecoder: palette is missing.");
+                return false;
+            }
+
+            const size_t bitsPerPixel = fileChannels * bitDepth;
+            const size_t rowSize = (width * bitsPerPixel + 7) / 8;
+            const size_t bytesPerPixel = std::max<size_t>(1, bitsPerPixel / 8);
+            // The row above the first one is all zeros for the Up, Average and Paeth filters.
+            currentRow.assign(rowSize + 1, 0);
+            previousRow.assign(rowSize + 1, 0);
+            outImage.width = width;
+            outImage.height = height;
+            if (colorType == PNG_COLOR_PALETTE) {
+                outImage.channels = hasTransparency ? 4 : 3;
+            } else {
+                // The transparent color of gray and RGB images becomes an alpha channel.
+                outImage.channels = hasTransparency ? fileChannels + 1 : fileChannels;
+            }
+            const size_t outRowSize = static_cast<size_t>(width) * outImage.channels;
+            outImage.pixels.resize(outRowSize * height);
+
+            InflateStream inflater;
+            if (inflateInit(&inflater.stream) != Z_OK) {
+                LOGE("PngDecoder: could not initialize zlib.");
+                return false;
+            }
+            inflater.isInitialized = true;
+            z_stream &stream = inflater.stream;
+
+            // Consecutive IDAT chunks form one zlib stream, which is fed to zlib a chunk at a time.
+            auto nextImageData = [&]() {
+                while (size - offset >= PNG_CHUNK_OVERHEAD && IsChunk(bytes + offset + 4, "IDAT")) {
+                    const uint32_t length = ReadBigEndian32(bytes + offset);
+                    if (length > size - offset - PNG_CHUNK_OVERHEAD) {
+                        return false;
+                    }
+                    stream.next_in = const_cast<Bytef *>(bytes + offset + 8);
+                    stream.avail_in = length;
+                    offset += length + PNG_CHUNK_OVERHEAD;
+                    if (length > 0) {
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            int result = Z_OK;
+            for (uint32_t y = 0; y < height; ++y) {
+                stream.next_out = currentRow.data();
+                stream.avail_out = static_cast<uInt>(rowSize + 1);
+                while (stream.avail_out > 0) {
+                    if (stream.avail_in == 0 && !nextImageData()) {
+                        LOGE("PngDecoder: image data is truncated.");
+                        return false;
+                    }
+                    result = inflate(&stream, Z_NO_FLUSH);
+                    if (result != Z_OK && !(result == Z_STREAM_END && stream.avail_out == 0)) {
+                        LOGE("PngDecoder: image data is corrupt.");
+                        return false;
+                    }
+                }
+                const uint8_t filter = currentRow[0];
+                uint8_t *row = currentRow.data() + 1;
+                if (!Unfilter(filter, row, previousRow.data() + 1, rowSize, bytesPerPixel)) {
+                    LOGE("PngDecoder: unknown row filter %u.", filter);
+                    return false;
+                }
+
+                uint8_t *out = outImage.pixels.data() + outRowSize * y;
+                if (colorType == PNG_COLOR_PALETTE) {
+                    const uint32_t mask = (1u << bitDepth) - 1;
+                    for (uint32_t x = 0; x < width; ++x) {
+                        const size_t bit = static_cast<size_t>(x) * bitDepth;
+                        const uint32_t index = (row[bit / 8] >> (8 - bitDepth - bit % 8)) & mask;
+                        memcpy(out + x * outImage.channels, &palette[index * 4], outImage.channels);
+                    }
+                } else if (hasTransparency) {
+                    // Pixels whose samples all match the transparent color are fully transparent.
+                    for (uint32_t x = 0; x < width; ++x) {
+                        bool isTransparent = true;
+                        for (uint32_t channel = 0; channel < fileChannels; ++channel) {
+                            const uint32_t value = ReadSample(row, static_cast<size_t>(x) * fileChannels + channel,
+                                bitDepth);
+                            isTransparent = isTransparent && value == colorKey[channel];
+                            *out++ = To8BitSample(value, bitDepth);
+                        }
+                        *out++ = isTransparent ? 0 : 255;
+                    }
+                } else if (bitDepth == 8) {
+                    memcpy(out, row, rowSize);
+                } else if (bitDepth == 16) {
+                    for (size_t i = 0; i < outRowSize; ++i) {
+                        out[i] = row[i * 2];
+                    }
+                } else {
+                    const uint32_t mask = (1u << bitDepth) - 1;
+                    const uint32_t scale = 255 / mask;
+                    for (uint32_t x = 0; x < width; ++x) {
+                        const size_t bit = static_cast<size_t>(x) * bitDepth;
+                        out[x] = static_cast<uint8_t>(((row[bit / 8] >> (8 - bitDepth - bit % 8)) & mask) * scale);
+                    }
+                }
+                currentRow.swap(previousRow);
+            }
+
+            // zlib checks the Adler-32 checksum of the image data at the end of the stream.
+            while (result != Z_STREAM_END) {
+                uint8_t extra = 0;
+                stream.next_out = &extra;
+                stream.avail_out = 1;
+                if (stream.avail_in == 0 && !nextImageData()) {
+                    LOGE("PngDecoder: image data is truncated.");
+                    return false;
+                }
+                result = inflate(&stream, Z_NO_FLUSH);
+                if ((result != Z_OK && result != Z_STREAM_END) || stream.avail_out == 0) {
+                    LOGE("PngDecoder: image data is corrupt.");
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_PNG_DECODER_H
+#define C_ARENGINE_HELLOE_AR_PNG_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Platform independent PNG decoding on top of zlib, shared by the app and the host-side benchmarks.
+    namespace util {
+        // Largest width or height decoded, which keeps the pixel count well inside 32 bits.
+        constexpr uint32_t PNG_MAX_DIMENSION = 16384;
+
+        // Decoded pixels, 8 bits per channel, rows tightly packed from the top of the image.
+        struct PngImage {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            // 1 for gray, 2 for gray and alpha, 3 for RGB, 4 for RGBA.
+            uint32_t channels = 0;
+            std::vector<uint8_t> pixels;
+        };
+
+        /**
+         * Decodes non-interlaced PNG files of every color type and bit depth. Rows are inflated one
+         * at a time into scratch rows the decoder keeps for the next file, so the inflated image is
+         * never held in full and the pixels are the only large allocation.
+         * Palette images are expanded to RGB, or RGBA when they have transparency. Gray and RGB
+         * images with a transparent color get an alpha channel, 0 where a pixel matches it. 16-bit
+         * channels keep their high byte and gray values below 8 bits are scaled to the full range.
+         */
+        class PngDecoder {
+        public:
+            /**
+             * Decode the content of a PNG file that is already in memory.
+             *
+             * @param data Start of the PNG file content.
+             * @param size Size of the PNG file content in bytes.
+             * @param outImage Receives the pixels. Its pixel buffer is reused when large enough.
+             * @return True if the file was decoded, false if it is malformed or interlaced.
+             */
+            bool Decode(const void *data, size_t size, PngImage &outImage);
+
+        private:
+            // The row being inflated and the row above it, each after its filter byte.
+            std::vector<uint8_t> currentRow;
+            std::vector<uint8_t> previousRow;
+            // Palette expanded to RGBA, 256 entries.
+            std::vector<uint8_t> palette;
+        };
+    }
+}
+#endif
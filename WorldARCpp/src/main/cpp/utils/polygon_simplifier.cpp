@@ -0,0 +1,227 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/polygon_simplifier.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <glm.hpp>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Times the tolerance is doubled to reach the point limit, and halved to keep the polygon simple.
+            constexpr int MAX_TOLERANCE_STEPS = 16;
+
+            float Cross(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+            {
+                return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            }
+
+            float GetSquaredSegmentDistance(const glm::vec2 &point, const glm::vec2 &a, const glm::vec2 &b)
+            {
+                const glm::vec2 edge = b - a;
+                const float lengthSquared = glm::dot(edge, edge);
+                float t = 0.0f;
+                if (lengthSquared > 0.0f) {
+                    t = glm::clamp(glm::dot(point - a, edge) / lengthSquared, 0.0f, 1.0f);
+                }
+                const glm::vec2 offset = point - (a + edge * t);
+                return glm::dot(offset, offset);
+            }
+
+            // Whether c lies on segment (a, b), given that the three points are collinear.
+            bool IsOnSegment(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+            {
+                return std::min(a.x, b.x) <= c.x && c.x <= std::max(a.x, b.x) &&
+                       std::min(a.y, b.y) <= c.y && c.y <= std::max(a.y, b.y);
+            }
+
+            bool DoSegmentsIntersect(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c, const glm::vec2 &d)
+            {
+                const float abc = Cross(a, b, c);
+                const float abd = Cross(a, b, d);
+                const float cda = Cross(c, d, a);
+                const float cdb = Cross(c, d, b);
+                if (((abc > 0.0f && abd < 0.0f) || (abc < 0.0f && abd > 0.0f)) &&
+                    ((cda > 0.0f && cdb < 0.0f) || (cda < 0.0f && cdb > 0.0f))) {
+                    return true;
+                }
+                return (abc == 0.0f && IsOnSegment(a, b, c)) || (abd == 0.0f && IsOnSegment(a, b, d)) ||
+                       (cda == 0.0f && IsOnSegment(c, d, a)) || (cdb == 0.0f && IsOnSegment(c, d, b));
+            }
+
+            // Douglas-Peucker over the points from first to last, wrapping around the end of the polygon.
+            // Marks the points that are kept, without recursion.
+            void SimplifyChain(const std::vector<glm::vec2> &polygon, size_t first, size_t last, float toleranceSquared,
+                               std::vector<bool> &isKept, std::vector<std::pair<size_t, size_t>> &stack)
+            {
+                const size_t pointCount = polygon.size();
+                stack.clear();
+                stack.emplace_back(first, last);
+                while (!stack.empty()) {
+                    const size_t start = stack.back().first;
+                    const size_t end = stack.back().second;
+                    stack.pop_back();
+                    float farthestSquared = 0.0f;
+                    size_t farthest = start;
+                    for (size_t i = (start + 1) % pointCount; i != end; i = (i + 1) % pointCount) {
+                        const float distanceSquared = GetSquaredSegmentDistance(polygon[i], polygon[start],
+                                                                                polygon[end]);
+                        if (distanceSquared > farthestSquared) {
+                            farthestSquared = distanceSquared;
+                            farthest = i;
+                        }
+                    }
+                    if (farthestSquared > toleranceSquared) {
+                        isKept[farthest] = true;
+                        stack.emplace_back(start, farthest);
+                        stack.emplace_back(farthest, end);
+                    }
+                }
+            }
+
+            void Simplify(const std::vector<glm::vec2> &polygon, float tolerance, std::vector<glm::vec2> &outPolygon)
+            {
+                // The chains run between the first point and the point farthest from it, which both stay.
+                const size_t pointCount = polygon.size();
+                size_t opposite = 0;
+                float oppositeSquared = -1.0f;
+                for (size_t i = 1; i < pointCount; ++i) {
+                    const glm::vec2 offset = polygon[i] - polygon[0];
+                    if (glm::dot(offset, offset) > oppositeSquared) {
+                        oppositeSquared = glm::dot(offset, offset);
+                        opposite = i;
+                    }
+                }
+                std::vector<bool> isKept(pointCount, false);
+                std::vector<std::pair<size_t, size_t>> stack;
+                isKept[0] = true;
+                isKept[opposite] = true;
+                SimplifyChain(polygon, 0, opposite, tolerance * tolerance, isKept, stack);
+                SimplifyChain(polygon, opposite, 0, tolerance * tolerance, isKept, stack);
+
+                // A polygon thinner than the tolerance keeps the point farthest from its two ends, so it
+                // still has an area.
+                if (std::count(isKept.begin(), isKept.end(), true) < 3) {
+                    size_t farthest = 0;
+                    float farthestSquared = -1.0f;
+                    for (size_t i = 1; i < pointCount; ++i) {
+                        const float distanceSquared = GetSquaredSegmentDistance(polygon[i], polygon[0],
+                                                                                polygon[opposite]);
+                        if (i != opposite && distanceSquared > farthestSquared) {
+                            farthestSquared = distanceSquared;
+                            farthest = i;
+                        }
+                    }
+                    isKept[farthest] = true;
+                }
+
+                outPolygon.clear();
+                for (size_t i = 0; i < pointCount; ++i) {
+                    if (isKept[i]) {
+                        outPolygon.push_back(polygon[i]);
+                    }
+                }
+            }
+        }
+
+        float SimplifyPolygon(const std::vector<glm::vec2> &polygon, float tolerance, size_t maxPointCount,
+                              std::vector<glm::vec2> &outPolygon)
+        {
+            if (polygon.size() <= 3 || tolerance <= 0.0f) {
+                outPolygon = polygon;
+                return 0.0f;
+            }
+            const size_t pointLimit = std::max<size_t>(maxPointCount, 3);
+
+            // The requested tolerance, raised as far as the point limit needs.
+            float limitTolerance = tolerance;
+            Simplify(polygon, limitTolerance, outPolygon);
+            for (int step = 0; step < MAX_TOLERANCE_STEPS && outPolygon.size() > pointLimit; ++step) {
+                limitTolerance *= 2.0f;
+                Simplify(polygon, limitTolerance, outPolygon);
+            }
+            if (outPolygon.size() <= pointLimit) {
+                if (IsPolygonSimple(outPolygon)) {
+                    return limitTolerance;
+                }
+                // Smaller tolerances keep more points and are tried while they stay within the limit, then
+                // larger ones, which exceed the requested tolerance only to keep the polygon simple.
+                float candidate = limitTolerance;
+                for (int step = 0; step < MAX_TOLERANCE_STEPS; ++step) {
+                    candidate *= 0.5f;
+                    Simplify(polygon, candidate, outPolygon);
+                    if (outPolygon.size() > pointLimit) {
+                        break;
+                    }
+                    if (IsPolygonSimple(outPolygon)) {
+                        return candidate;
+                    }
+                }
+                candidate = limitTolerance;
+                for (int step = 0; step < MAX_TOLERANCE_STEPS; ++step) {
+                    candidate *= 2.0f;
+                    Simplify(polygon, candidate, outPolygon);
+                    if (IsPolygonSimple(outPolygon)) {
+                        return candidate;
+                    }
+                }
+            }
+
+            // No simple polygon meets the limit, so it gives way: the largest simple tolerance below it is used.
+            float candidate = limitTolerance;
+            for (int step = 0; step < MAX_TOLERANCE_STEPS; ++step) {
+                candidate *= 0.5f;
+                Simplify(polygon, candidate, outPolygon);
+                if (IsPolygonSimple(outPolygon)) {
+                    return candidate;
+                }
+            }
+            outPolygon = polygon;
+            return 0.0f;
+        }
+
+        bool IsPolygonSimple(const std::vector<glm::vec2> &polygon)
+        {
+            const size_t pointCount = polygon.size();
+            if (pointCount < 3) {
+                return false;
+            }
+            for (size_t i = 0; i < pointCount; ++i) {
+                const glm::vec2 &a = polygon[i];
+                const glm::vec2 &b = polygon[(i + 1) % pointCount];
+                // Neighbours share a point, and only overlap if the boundary folds back on itself there.
+                const glm::vec2 &c = polygon[(i + 2) % pointCount];
+                if (Cross(a, b, c) == 0.0f && glm::dot(b - a, c - b) <= 0.0f) {
+                    return false;
+                }
+                // Every other pair of edges is tested once; the last edge neighbours the first.
+                for (size_t j = i + 2; j < pointCount; ++j) {
+                    if (i == 0 && j == pointCount - 1) {
+                        continue;
+                    }
+                    if (DoSegmentsIntersect(a, b, polygon[j], polygon[(j + 1) % pointCount])) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_POLYGON_SIMPLIFIER_H
+#define C_ARENGINE_HELLOE_AR_POLYGON_SIMPLIFIER_H
+
+#include <cstddef>
+#include <vector>
+
+#include <vec2.hpp>
+
+namespace gWorldAr {
+    // Simplification of closed polygons, shared by the app and the host-side benchmarks.
+    namespace util {
+        /**
+         * Drop the points of a closed polygon that lie within a tolerance of the boundary of the others,
+         * by Douglas-Peucker. The output is a subset of the points in their order, so a convex polygon
+         * stays convex. A simple polygon stays simple: if the simplified one intersects itself, other
+         * tolerances within the point limit are tried, and the polygon is copied unchanged as a last resort.
+         *
+         * @param polygon Points of the boundary, without repeating the first point.
+         * @param tolerance Largest distance of a dropped point from the simplified boundary, unless it is
+         *                  raised to meet maxPointCount.
+         * @param maxPointCount The tolerance is raised until at most this many points remain. The limit is
+         *                      best effort: it gives way when no simple polygon meets it, so callers that
+         *                      need a bound must check the size of outPolygon. At least 3.
+         * @param outPolygon Cleared first. Receives the remaining points.
+         * @return Tolerance the output was simplified with, 0 if it was copied unchanged.
+         */
+        float SimplifyPolygon(const std::vector<glm::vec2> &polygon, float tolerance, size_t maxPointCount,
+                              std::vector<glm::vec2> &outPolygon);
+
+        /**
+         * Whether no two edges of a closed polygon cross or touch, other than neighbours at their shared
+         * point.
+         *
+         * @param polygon Points of the boundary, without repeating the first point.
+         * @return True if the polygon is simple.
+         */
+        bool IsPolygonSimple(const std::vector<glm::vec2> &polygon);
+    }
+}
+#endif
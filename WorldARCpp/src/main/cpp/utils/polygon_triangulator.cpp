@@ -0,0 +1,175 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/polygon_triangulator.h"
+
+#include <cstddef>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // Twice the signed area of triangle (a, b, c), positive when it turns counterclockwise.
+            float Cross(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+            {
+                return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            }
+
+            // Points still on the boundary, linked in both directions so clipping an ear is constant time.
+            class EarClipper {
+            public:
+                explicit EarClipper(const std::vector<glm::vec2> &points) : polygon(points)
+                {
+                    const size_t pointCount = polygon.size();
+                    float area = 0.0f;
+                    for (size_t i = 0, j = pointCount - 1; i < pointCount; j = i++) {
+                        area += polygon[j].x * polygon[i].y - polygon[i].x * polygon[j].y;
+                    }
+                    winding = (area < 0.0f) ? -1.0f : 1.0f;
+
+                    prev.resize(pointCount);
+                    next.resize(pointCount);
+                    isReflex.resize(pointCount);
+                    for (size_t i = 0; i < pointCount; ++i) {
+                        prev[i] = static_cast<uint32_t>((i + pointCount - 1) % pointCount);
+                        next[i] = static_cast<uint32_t>((i + 1) % pointCount);
+                    }
+                    for (uint32_t i = 0; i < pointCount; ++i) {
+                        UpdateReflex(i);
+                    }
+                }
+
+                void Triangulate(uint32_t baseIndex, std::vector<uint16_t> &outTriangles)
+                {
+                    size_t remaining = polygon.size();
+                    uint32_t point = 0;
+                    // Points visited since the last ear; a full round without one means the polygon is
+                    // degenerate or intersects itself, and a convex point is clipped regardless.
+                    size_t visited = 0;
+                    while (remaining > 3) {
+                        if (visited < remaining) {
+                            if (!IsEar(point)) {
+                                point = next[point];
+                                ++visited;
+                                continue;
+                            }
+                        } else {
+                            point = FindConvexPoint(point, remaining);
+                        }
+                        const uint32_t before = prev[point];
+                        const uint32_t after = next[point];
+                        Emit(before, point, after, baseIndex, outTriangles);
+                        next[before] = after;
+                        prev[after] = before;
+                        if (isReflex[point]) {
+                            --reflexCount;
+                        }
+                        UpdateReflex(before);
+                        UpdateReflex(after);
+                        --remaining;
+                        visited = 0;
+                        // Going back one point keeps the fan of ears around a convex run short and even.
+                        point = before;
+                    }
+                    Emit(prev[point], point, next[point], baseIndex, outTriangles);
+                }
+
+            private:
+                void UpdateReflex(uint32_t point)
+                {
+                    // Collinear points count as reflex: they are never clipped as ears of zero area.
+                    const bool isNowReflex =
+                        Cross(polygon[prev[point]], polygon[point], polygon[next[point]]) * winding <= 0.0f;
+                    if (isNowReflex && !isReflex[point]) {
+                        ++reflexCount;
+                    } else if (!isNowReflex && isReflex[point]) {
+                        --reflexCount;
+                    }
+                    isReflex[point] = isNowReflex;
+                }
+
+                // The first convex point from point on, or point itself if all are reflex.
+                uint32_t FindConvexPoint(uint32_t point, size_t remaining) const
+                {
+                    uint32_t candidate = point;
+                    for (size_t i = 0; i < remaining; ++i, candidate = next[candidate]) {
+                        if (!isReflex[candidate]) {
+                            return candidate;
+                        }
+                    }
+                    return point;
+                }
+
+                // A convex point is an ear if no reflex point lies in the triangle it forms with its
+                // neighbours. Convex points cannot lie in it without a reflex point lying in it too.
+                bool IsEar(uint32_t point) const
+                {
+                    if (isReflex[point]) {
+                        return false;
+                    }
+                    if (reflexCount == 0) {
+                        return true;
+                    }
+                    const uint32_t before = prev[point];
+                    const uint32_t after = next[point];
+                    const glm::vec2 &a = polygon[before];
+                    const glm::vec2 &b = polygon[point];
+                    const glm::vec2 &c = polygon[after];
+                    for (uint32_t other = next[after]; other != before; other = next[other]) {
+                        if (!isReflex[other]) {
+                            continue;
+                        }
+                        const glm::vec2 &p = polygon[other];
+                        // Points on the triangle's corners, such as a touching vertex, do not block it.
+                        if (p == a || p == b || p == c) {
+                            continue;
+                        }
+                        if (Cross(a, b, p) * winding >= 0.0f && Cross(b, c, p) * winding >= 0.0f &&
+                            Cross(c, a, p) * winding >= 0.0f) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                static void Emit(uint32_t a, uint32_t b, uint32_t c, uint32_t baseIndex,
+                                 std::vector<uint16_t> &outTriangles)
+                {
+                    outTriangles.insert(outTriangles.end(), {static_cast<uint16_t>(baseIndex + a),
+                        static_cast<uint16_t>(baseIndex + b), static_cast<uint16_t>(baseIndex + c)});
+                }
+
+                const std::vector<glm::vec2> &polygon;
+                std::vector<uint32_t> prev;
+                std::vector<uint32_t> next;
+                std::vector<bool> isReflex;
+                size_t reflexCount = 0;
+                float winding = 1.0f;
+            };
+        }
+
+        bool TriangulatePolygon(const std::vector<glm::vec2> &polygon, uint32_t baseIndex,
+                                std::vector<uint16_t> &outTriangles)
+        {
+            if (polygon.size() < 3) {
+                return false;
+            }
+            outTriangles.reserve(outTriangles.size() + (polygon.size() - 2) * 3);
+            EarClipper(polygon).Triangulate(baseIndex, outTriangles);
+            return true;
+        }
+    }
+}
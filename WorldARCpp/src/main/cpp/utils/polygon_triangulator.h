@@ -0,0 +1,43 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_POLYGON_TRIANGULATOR_H
+#define C_ARENGINE_HELLOE_AR_POLYGON_TRIANGULATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include <vec2.hpp>
+
+namespace gWorldAr {
+    // Triangulation of simple polygons, shared by the app and the host-side benchmarks.
+    namespace util {
+        /**
+         * Triangulate a simple polygon, convex or concave, by ear clipping. Every triangle keeps the
+         * winding of the polygon and no two triangles overlap. Polygons that are degenerate or intersect
+         * themselves still yield pointCount - 2 triangles, though these may overlap.
+         *
+         * @param polygon Points of the boundary, in either winding, without repeating the first point.
+         * @param baseIndex Added to the index of each point, at most 65536 minus the number of points.
+         * @param outTriangles Appended to. Receives three 16-bit indices per triangle.
+         * @return False if the polygon has fewer than three points.
+         */
+        bool TriangulatePolygon(const std::vector<glm::vec2> &polygon, uint32_t baseIndex,
+                                std::vector<uint16_t> &outTriangles);
+    }
+}
+#endif
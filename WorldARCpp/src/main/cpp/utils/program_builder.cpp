@@ -0,0 +1,188 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/program_builder.h"
+
+#include <chrono>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+#include "utils/gl_capabilities.h"
+#include "utils/log.h"
+#include "utils/program_cache.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // GL_KHR_parallel_shader_compile enums, missing from older headers.
+            constexpr GLenum COMPLETION_STATUS_KHR = 0x91B1;
+            constexpr GLuint MAX_SHADER_COMPILER_THREADS_ANY = 0xFFFFFFFF;
+
+            using MaxShaderCompilerThreadsFunction = void (GL_APIENTRYP)(GLuint count);
+
+            bool SupportsParallelCompile()
+            {
+                static const bool isSupported = []() {
+                    if (!HasGlExtension("GL_KHR_parallel_shader_compile")) {
+                        return false;
+                    }
+                    // Let the driver pick the number of compiler threads instead of its conservative default.
+                    auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsFunction>(
+                        eglGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+                    if (maxThreads != nullptr) {
+                        maxThreads(MAX_SHADER_COMPILER_THREADS_ANY);
+                    }
+                    return true;
+                }();
+                return isSupported;
+            }
+
+            GLuint SubmitShader(GLenum shaderType, const char *source)
+            {
+                GLuint shader = glCreateShader(shaderType);
+                if (shader) {
+                    glShaderSource(shader, 1, &source, nullptr);
+                    glCompileShader(shader);
+                }
+                return shader;
+            }
+
+            bool CheckShader(GLuint shader)
+            {
+                GLint compiled = 0;
+                glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+                if (compiled) {
+                    return true;
+                }
+                GLint infoLen = 0;
+                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
+                if (infoLen) {
+                    std::string buf(infoLen, '\0');
+                    glGetShaderInfoLog(shader, infoLen, nullptr, &buf[0]);
+                    LOGI("ProgramBuilder::CheckShader Could not compile shader:\n%s\n", buf.c_str());
+                }
+                return false;
+            }
+
+            bool CheckProgram(GLuint program)
+            {
+                GLint linkStatus = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+                if (linkStatus == GL_TRUE) {
+                    return true;
+                }
+                GLint bufLength = 0;
+                glGetProgramiv(program, GL_INFO_LOG_LENGTH, &bufLength);
+                if (bufLength) {
+                    std::string buf(bufLength, '\0');
+                    glGetProgramInfoLog(program, bufLength, nullptr, &buf[0]);
+                    LOGI("ProgramBuilder::CheckProgram Could not link program:\n%s\n", buf.c_str());
+                }
+                return false;
+            }
+
+            double GetMsSince(std::chrono::steady_clock::time_point start)
+            {
+                return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        size_t ProgramBuilder::Submit(const char *vertexSource, const char *fragmentSource)
+        {
+            PendingProgram pending;
+            pending.program = LoadCachedProgram(vertexSource, fragmentSource);
+            pending.isCached = (pending.program != 0);
+            if (!pending.isCached) {
+                const auto start = std::chrono::steady_clock::now();
+                SupportsParallelCompile();
+                pending.vertexSource = vertexSource;
+                pending.fragmentSource = fragmentSource;
+                // Compile errors are only read in Take, linking a program with a broken shader just fails.
+                pending.vertexShader = SubmitShader(GL_VERTEX_SHADER, vertexSource);
+                pending.fragmentShader = SubmitShader(GL_FRAGMENT_SHADER, fragmentSource);
+                pending.program = glCreateProgram();
+                if (pending.program) {
+                    glAttachShader(pending.program, pending.vertexShader);
+                    glAttachShader(pending.program, pending.fragmentShader);
+                    PrepareProgramForCache(pending.program);
+                    glLinkProgram(pending.program);
+                }
+                pending.submitMs = GetMsSince(start);
+            }
+            programs.push_back(std::move(pending));
+            return programs.size() - 1;
+        }
+
+        bool ProgramBuilder::IsReady(size_t id) const
+        {
+            const PendingProgram &pending = programs[id];
+            if (pending.isCached || pending.program == 0 || !SupportsParallelCompile()) {
+                return true;
+            }
+            GLint isComplete = GL_FALSE;
+            glGetProgramiv(pending.program, COMPLETION_STATUS_KHR, &isComplete);
+            return isComplete == GL_TRUE;
+        }
+
+        GLuint ProgramBuilder::Take(size_t id)
+        {
+            PendingProgram &pending = programs[id];
+            GLuint program = pending.program;
+            pending.program = 0;
+            if (pending.isCached || program == 0) {
+                return program;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            bool isLinked = CheckProgram(program);
+            if (!isLinked) {
+                // The link log rarely says which shader failed, so the compile logs are printed too.
+                CheckShader(pending.vertexShader);
+                CheckShader(pending.fragmentShader);
+                glDeleteProgram(program);
+                program = 0;
+            }
+            // Shaders attached to a program are deleted together with it.
+            glDeleteShader(pending.vertexShader);
+            glDeleteShader(pending.fragmentShader);
+            pending.vertexShader = 0;
+            pending.fragmentShader = 0;
+            if (isLinked) {
+                StoreCachedProgram(pending.vertexSource.c_str(), pending.fragmentSource.c_str(), program,
+                                   pending.submitMs + GetMsSince(start));
+            }
+            return program;
+        }
+
+        void ProgramBuilder::Clear()
+        {
+            // Zero names are ignored, so taken programs are skipped without checks.
+            for (const PendingProgram &pending : programs) {
+                glDeleteProgram(pending.program);
+                glDeleteShader(pending.vertexShader);
+                glDeleteShader(pending.fragmentShader);
+            }
+            programs.clear();
+        }
+
+        void ProgramBuilder::Reset()
+        {
+            programs.clear();
+        }
+    }
+}
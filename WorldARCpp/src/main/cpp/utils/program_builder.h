@@ -0,0 +1,99 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_PROGRAM_BUILDER_H
+#define C_ARENGINE_HELLOE_AR_PROGRAM_BUILDER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+namespace gWorldAr {
+    // Shader program creation shared by the app and the host-side benchmarks.
+    namespace util {
+        /**
+         * Builds several shader programs at once. Every program is submitted to the driver before the
+         * status of any of them is read, so the driver can compile them in the background, on several
+         * threads with GL_KHR_parallel_shader_compile. Programs come from the program cache when it
+         * holds their binary. All methods must be called on the GL thread.
+         */
+        class ProgramBuilder {
+        public:
+            ProgramBuilder() = default;
+
+            ~ProgramBuilder() = default;
+
+            /**
+             * Start compiling and linking a program, without waiting for the driver.
+             *
+             * @param vertexSource Vertex shader source.
+             * @param fragmentSource Fragment shader source.
+             * @return Id of the program, passed to IsReady and Take.
+             */
+            size_t Submit(const char *vertexSource, const char *fragmentSource);
+
+            /**
+             * Check without blocking whether the driver finished a program. Always true without
+             * GL_KHR_parallel_shader_compile, where Take waits for the driver.
+             *
+             * @param id Id returned by Submit.
+             * @return True if Take returns without waiting.
+             */
+            bool IsReady(size_t id) const;
+
+            /**
+             * Wait for a program, check that it compiled and linked, and hand it over to the caller.
+             * Programs compiled from source are stored in the program cache.
+             *
+             * @param id Id returned by Submit.
+             * @return Linked program, or 0 if it failed or was already taken.
+             */
+            GLuint Take(size_t id);
+
+            /**
+             * Delete the programs that were submitted and not taken.
+             */
+            void Clear();
+
+            /**
+             * Forget the submitted programs without GL calls, once the context they belong to is gone.
+             */
+            void Reset();
+
+            // Delete copy constructors.
+            ProgramBuilder(const ProgramBuilder &) = delete;
+
+            void operator=(const ProgramBuilder &) = delete;
+
+        private:
+            struct PendingProgram {
+                std::string vertexSource; // Kept for the program cache key.
+                std::string fragmentSource;
+                GLuint vertexShader = 0;
+                GLuint fragmentShader = 0;
+                GLuint program = 0;
+                bool isCached = false;
+                double submitMs = 0.0; // Time Submit spent on the program, for the program cache counters.
+            };
+
+            std::vector<PendingProgram> programs;
+        };
+    }
+}
+#endif
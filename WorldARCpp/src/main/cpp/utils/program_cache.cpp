@@ -0,0 +1,265 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/program_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+#include "utils/gl_capabilities.h"
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            // "WPRG", the start of every cache file.
+            constexpr uint32_t PROGRAM_CACHE_MAGIC = 0x47525057;
+            constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+
+            // OpenGL ES 3.0 enum, missing from the OpenGL ES 2.0 headers.
+            constexpr GLenum PROGRAM_BINARY_RETRIEVABLE_HINT = 0x8257;
+
+            // Header of a cache file, followed by the program binary.
+            struct ProgramCacheHeader {
+                uint32_t magic;
+                uint32_t version;
+                uint32_t binaryFormat;
+                uint32_t binarySize;
+            };
+
+            using ProgramParameteriFunction = void (GL_APIENTRYP)(GLuint program, GLenum name, GLint value);
+
+            // Entry points of OpenGL ES 3.0 or of GL_OES_get_program_binary, null if the context has neither.
+            struct ProgramBinaryFunctions {
+                PFNGLGETPROGRAMBINARYOESPROC getProgramBinary = nullptr;
+                PFNGLPROGRAMBINARYOESPROC programBinary = nullptr;
+                ProgramParameteriFunction programParameteri = nullptr;
+                std::vector<GLint> formats;
+            };
+
+            // Only touched on the GL thread.
+            struct ProgramCache {
+                std::string directory;
+                ProgramCacheStats stats;
+            };
+
+            ProgramCache &GetProgramCache()
+            {
+                static ProgramCache cache;
+                return cache;
+            }
+
+            const ProgramBinaryFunctions &GetProgramBinaryFunctions()
+            {
+                static const ProgramBinaryFunctions functions = []() {
+                    ProgramBinaryFunctions result;
+                    // Querying the formats without program binary support is a GL error, so it comes last.
+                    if (IsEs3Context()) {
+                        result.getProgramBinary =
+                            reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress("glGetProgramBinary"));
+                        result.programBinary =
+                            reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinary"));
+                        result.programParameteri =
+                            reinterpret_cast<ProgramParameteriFunction>(eglGetProcAddress("glProgramParameteri"));
+                    } else if (HasGlExtension("GL_OES_get_program_binary")) {
+                        result.getProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(
+                            eglGetProcAddress("glGetProgramBinaryOES"));
+                        result.programBinary =
+                            reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress("glProgramBinaryOES"));
+                    }
+                    if (result.getProgramBinary == nullptr || result.programBinary == nullptr) {
+                        return ProgramBinaryFunctions();
+                    }
+                    GLint formatCount = 0;
+                    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formatCount);
+                    if (formatCount <= 0) {
+                        LOGI("ProgramCache: the driver has no program binary format.");
+                        return ProgramBinaryFunctions();
+                    }
+                    result.formats.resize(formatCount);
+                    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS_OES, result.formats.data());
+                    return result;
+                }();
+                return functions;
+            }
+
+            bool IsCacheEnabled()
+            {
+                return !GetProgramCache().directory.empty() && GetProgramBinaryFunctions().programBinary != nullptr;
+            }
+
+            void HashString(const char *text, uint64_t &hash)
+            {
+                // FNV-1a, the terminating zero included so that moving text between strings changes the key.
+                const unsigned char *byte = reinterpret_cast<const unsigned char *>(text != nullptr ? text : "");
+                do {
+                    hash = (hash ^ *byte) * 1099511628211ull;
+                } while (*byte++ != '\0');
+            }
+
+            // Binaries only load on the driver that wrote them, so the renderer and version are part of the key.
+            std::string GetCachePath(const char *vertexSource, const char *fragmentSource)
+            {
+                uint64_t hash = 14695981039346656037ull;
+                HashString(vertexSource, hash);
+                HashString(fragmentSource, hash);
+                HashString(reinterpret_cast<const char *>(glGetString(GL_RENDERER)), hash);
+                HashString(reinterpret_cast<const char *>(glGetString(GL_VERSION)), hash);
+                char name[32];
+                snprintf(name, sizeof(name), "/program_%016llx.bin", static_cast<unsigned long long>(hash));
+                return GetProgramCache().directory + name;
+            }
+
+            bool ReadCacheFile(const std::string &path, std::vector<uint8_t> &outData)
+            {
+                FILE *file = fopen(path.c_str(), "rb");
+                if (file == nullptr) {
+                    return false;
+                }
+                bool isRead = fseek(file, 0, SEEK_END) == 0;
+                long size = isRead ? ftell(file) : -1;
+                isRead = size > 0 && fseek(file, 0, SEEK_SET) == 0;
+                if (isRead) {
+                    outData.resize(static_cast<size_t>(size));
+                    isRead = fread(outData.data(), 1, outData.size(), file) == outData.size();
+                }
+                fclose(file);
+                return isRead;
+            }
+
+            bool WriteCacheFile(const std::string &path, const std::vector<uint8_t> &data)
+            {
+                // Written next to the entry and renamed, so a crash never leaves a truncated entry behind.
+                const std::string temporaryPath = path + ".tmp";
+                FILE *file = fopen(temporaryPath.c_str(), "wb");
+                if (file == nullptr) {
+                    return false;
+                }
+                bool isWritten = fwrite(data.data(), 1, data.size(), file) == data.size();
+                isWritten = (fclose(file) == 0) && isWritten;
+                if (!isWritten || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+                    unlink(temporaryPath.c_str());
+                    return false;
+                }
+                return true;
+            }
+
+            double GetMsSince(std::chrono::steady_clock::time_point start)
+            {
+                return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
+
+        void SetProgramCacheDirectory(const std::string &directory)
+        {
+            GetProgramCache().directory = directory;
+        }
+
+        GLuint LoadCachedProgram(const char *vertexSource, const char *fragmentSource)
+        {
+            if (!IsCacheEnabled()) {
+                return 0;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            const std::string path = GetCachePath(vertexSource, fragmentSource);
+            std::vector<uint8_t> data;
+            if (!ReadCacheFile(path, data)) {
+                return 0;
+            }
+
+            ProgramCacheStats &stats = GetProgramCache().stats;
+            const ProgramBinaryFunctions &functions = GetProgramBinaryFunctions();
+            ProgramCacheHeader header = {};
+            if (data.size() >= sizeof(header)) {
+                memcpy(&header, data.data(), sizeof(header));
+            }
+            // An unknown format would be a GL error, so it is checked before the driver sees the binary.
+            bool isValid = header.magic == PROGRAM_CACHE_MAGIC && header.version == PROGRAM_CACHE_VERSION &&
+                           header.binarySize == data.size() - sizeof(header) &&
+                           std::find(functions.formats.begin(), functions.formats.end(),
+                                     static_cast<GLint>(header.binaryFormat)) != functions.formats.end();
+            GLuint program = isValid ? glCreateProgram() : 0;
+            if (program != 0) {
+                functions.programBinary(program, header.binaryFormat, data.data() + sizeof(header),
+                                        static_cast<GLint>(header.binarySize));
+                GLint linkStatus = GL_FALSE;
+                glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+                if (linkStatus != GL_TRUE) {
+                    glDeleteProgram(program);
+                    program = 0;
+                }
+            }
+            if (program == 0) {
+                // The entry is written again once the program is compiled from source.
+                LOGI("ProgramCache: %s was rejected.", path.c_str());
+                unlink(path.c_str());
+                ++stats.rejectCount;
+                return 0;
+            }
+            ++stats.hitCount;
+            stats.hitMs += GetMsSince(start);
+            return program;
+        }
+
+        void PrepareProgramForCache(GLuint program)
+        {
+            if (IsCacheEnabled() && GetProgramBinaryFunctions().programParameteri != nullptr) {
+                GetProgramBinaryFunctions().programParameteri(program, PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            }
+        }
+
+        void StoreCachedProgram(const char *vertexSource, const char *fragmentSource, GLuint program,
+                                double compileMs)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            ProgramCacheStats &stats = GetProgramCache().stats;
+            ++stats.missCount;
+            GLint length = 0;
+            if (IsCacheEnabled()) {
+                glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+            }
+            if (length > 0) {
+                std::vector<uint8_t> data(sizeof(ProgramCacheHeader) + length);
+                GLsizei binarySize = 0;
+                GLenum binaryFormat = 0;
+                GetProgramBinaryFunctions().getProgramBinary(program, length, &binarySize, &binaryFormat,
+                                                             data.data() + sizeof(ProgramCacheHeader));
+                ProgramCacheHeader header = {PROGRAM_CACHE_MAGIC, PROGRAM_CACHE_VERSION, binaryFormat,
+                                             static_cast<uint32_t>(binarySize)};
+                memcpy(data.data(), &header, sizeof(header));
+                data.resize(sizeof(header) + binarySize);
+                if (binarySize > 0 && WriteCacheFile(GetCachePath(vertexSource, fragmentSource), data)) {
+                    ++stats.storeCount;
+                }
+            }
+            stats.missMs += compileMs + GetMsSince(start);
+        }
+
+        ProgramCacheStats GetProgramCacheStats()
+        {
+            return GetProgramCache().stats;
+        }
+    }
+}
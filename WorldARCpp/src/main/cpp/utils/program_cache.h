@@ -0,0 +1,83 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_PROGRAM_CACHE_H
+#define C_ARENGINE_HELLOE_AR_PROGRAM_CACHE_H
+
+#include <cstddef>
+#include <string>
+
+#include <GLES2/gl2.h>
+
+namespace gWorldAr {
+    // Disk cache of linked shader programs, so a new surface does not compile them again.
+    namespace util {
+        // Counters of the program cache since the application started.
+        struct ProgramCacheStats {
+            size_t hitCount = 0; // Programs created from a cached binary.
+            size_t missCount = 0; // Programs compiled from source.
+            size_t rejectCount = 0; // Cached binaries the driver refused, compiled from source instead.
+            size_t storeCount = 0; // Binaries written to the cache.
+            double hitMs = 0.0; // Time spent creating programs from cached binaries.
+            double missMs = 0.0; // Time spent compiling, linking and storing programs.
+        };
+
+        /**
+         * Set the directory the program binaries are stored in. Call on the GL thread before the
+         * first program is created. The cache stays disabled while the directory is empty.
+         *
+         * @param directory App-private directory, such as the code cache directory of the context.
+         */
+        void SetProgramCacheDirectory(const std::string &directory);
+
+        /**
+         * Create a program from the binary cached for these shader sources and the current driver.
+         * Must be called on the GL thread.
+         *
+         * @param vertexSource Vertex shader source.
+         * @param fragmentSource Fragment shader source.
+         * @return Linked program, or 0 if nothing is cached or the driver refused the binary.
+         */
+        GLuint LoadCachedProgram(const char *vertexSource, const char *fragmentSource);
+
+        /**
+         * Ask the driver to keep the binary of a program. Call between attaching the shaders and
+         * linking the program.
+         *
+         * @param program Program that is not linked yet.
+         */
+        void PrepareProgramForCache(GLuint program);
+
+        /**
+         * Store the binary of a program linked from these shader sources. Fails silently when the
+         * driver cannot retrieve program binaries.
+         *
+         * @param vertexSource Vertex shader source.
+         * @param fragmentSource Fragment shader source.
+         * @param program Linked program.
+         * @param compileMs Time spent compiling and linking the program, added to the counters.
+         */
+        void StoreCachedProgram(const char *vertexSource, const char *fragmentSource, GLuint program,
+                                double compileMs);
+
+        /**
+         * Counters of the program cache. Must be called on the GL thread.
+         */
+        ProgramCacheStats GetProgramCacheStats();
+    }
+}
+#endif
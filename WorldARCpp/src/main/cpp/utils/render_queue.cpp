@@ -0,0 +1,90 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "utils/render_queue.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gWorldAr {
+    namespace util {
+        namespace {
+            constexpr uint32_t PASS_SHIFT = 62;
+            constexpr uint64_t STATE_MASK = 0xFFFF;
+            constexpr uint64_t DEPTH_MASK = (1u << 30) - 1;
+
+            // Non-negative floats order like their bit patterns. Dropping the lowest mantissa bit keeps
+            // every finite distance in 30 bits.
+            uint64_t GetDepthBits(float depth)
+            {
+                if (!(depth > 0.0f)) {
+                    return 0;
+                }
+                uint32_t bits = 0;
+                memcpy(&bits, &depth, sizeof(bits));
+                return std::min<uint64_t>(bits >> 1, DEPTH_MASK);
+            }
+        }
+
+        uint64_t MakeSortKey(RenderPass pass, uint32_t program, uint32_t texture, float depth)
+        {
+            const uint64_t passBits = static_cast<uint64_t>(pass) << PASS_SHIFT;
+            const uint64_t depthBits = GetDepthBits(depth);
+            if (pass == RenderPass::TRANSPARENT) {
+                // Depth comes first, inverted so the farthest draw has the smallest key. State only
+                // breaks ties, since blending needs the order.
+                return passBits | ((DEPTH_MASK - depthBits) << 32) | ((program & STATE_MASK) << 16) |
+                    (texture & STATE_MASK);
+            }
+            return passBits | ((program & STATE_MASK) << 46) | ((texture & STATE_MASK) << 30) | depthBits;
+        }
+
+        RenderPass GetSortKeyPass(uint64_t key)
+        {
+            return static_cast<RenderPass>(key >> PASS_SHIFT);
+        }
+
+        RenderQueue::RenderQueue(size_t initialCapacity)
+        {
+            packets.reserve(initialCapacity);
+        }
+
+        void RenderQueue::Clear()
+        {
+            packets.clear();
+        }
+
+        void RenderQueue::Submit(uint64_t key, PacketRenderer &renderer, uint32_t index)
+        {
+            packets.push_back({key, static_cast<uint32_t>(packets.size()), index, &renderer});
+        }
+
+        void RenderQueue::Sort()
+        {
+            std::sort(packets.begin(), packets.end(), [](const RenderPacket &a, const RenderPacket &b) {
+                return (a.key != b.key) ? (a.key < b.key) : (a.sequence < b.sequence);
+            });
+        }
+
+        void RenderQueue::Execute() const
+        {
+            for (const RenderPacket &packet : packets) {
+                packet.renderer->DrawPacket(packet.index);
+            }
+        }
+    }
+}
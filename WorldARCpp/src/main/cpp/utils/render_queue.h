@@ -0,0 +1,122 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_RENDER_QUEUE_H
+#define C_ARENGINE_HELLOE_AR_RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // Draw ordering of a frame, shared by the app and the host-side benchmarks. Makes no GL calls.
+    namespace util {
+        // Passes in the order they are drawn. The pass is stored in the top bits of a sort key.
+        enum class RenderPass : uint8_t {
+            // Geometry that writes depth, grouped by program and texture, then drawn front to back.
+            OPAQUE = 0,
+            // Blended geometry, drawn back to front so it blends over what lies behind it.
+            TRANSPARENT = 1,
+            // Geometry drawn over the transparent pass, sorted like the opaque pass.
+            OVERLAY = 2
+        };
+
+        /**
+         * Build the sort key of a draw. Opaque and overlay draws sort by program, texture and then
+         * front to back; transparent draws sort back to front only. Only the low 16 bits of the
+         * program and texture names are kept, which can only merge state groups, not misorder depth.
+         *
+         * @param pass Pass the draw belongs to.
+         * @param program Name of the shader program.
+         * @param texture Name of the texture, 0 if the draw reads none.
+         * @param depth Distance of the draw from the camera along the view direction. Negative
+         *              distances count as 0.
+         * @return Key that orders the draw in the render queue, smallest first.
+         */
+        uint64_t MakeSortKey(RenderPass pass, uint32_t program, uint32_t texture, float depth);
+
+        /**
+         * Pass of a sort key built by MakeSortKey.
+         */
+        RenderPass GetSortKeyPass(uint64_t key);
+
+        /**
+         * Draws the packets a renderer submitted to a RenderQueue.
+         */
+        class PacketRenderer {
+        public:
+            virtual ~PacketRenderer() = default;
+
+            /**
+             * Draw one submitted packet. Called on the GL thread in sort key order.
+             *
+             * @param index Index the renderer passed to RenderQueue::Submit.
+             */
+            virtual void DrawPacket(uint32_t index) = 0;
+        };
+
+        // One draw of a frame. The renderer keeps the draw data and looks it up by index.
+        struct RenderPacket {
+            uint64_t key;
+            // Submission order, so draws with equal keys keep it.
+            uint32_t sequence;
+            uint32_t index;
+            PacketRenderer *renderer;
+        };
+
+        /**
+         * Draws of a frame, sorted by their keys before they are issued. Clearing keeps the packet
+         * storage, so a queue reused every frame stops allocating once it has held the largest frame.
+         */
+        class RenderQueue {
+        public:
+            /**
+             * @param initialCapacity Number of packets the queue holds before it first grows.
+             */
+            explicit RenderQueue(size_t initialCapacity = 64);
+
+            ~RenderQueue() = default;
+
+            // Removes all packets and keeps their storage.
+            void Clear();
+
+            /**
+             * Add a draw to the frame.
+             *
+             * @param key Sort key from MakeSortKey.
+             * @param renderer Renderer whose DrawPacket issues the draw.
+             * @param index Index of the draw data kept by the renderer.
+             */
+            void Submit(uint64_t key, PacketRenderer &renderer, uint32_t index);
+
+            // Order the packets by key, and by submission order for equal keys. Does not allocate.
+            void Sort();
+
+            // Pass every packet to its renderer, in the current order.
+            void Execute() const;
+
+            const std::vector<RenderPacket> &GetPackets() const
+            {
+                return packets;
+            }
+
+        private:
+            std::vector<RenderPacket> packets;
+        };
+    }
+}
+#endif
@@ -16,120 +16,62 @@
 
 #include "utils/util.h"
 
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <thread>
 
 #include <unistd.h>
 
 #include "jni_interface.h"
+#include "utils/glb_format.h"
+#include "utils/ktx_format.h"
+#include "utils/mesh_format.h"
+#include "utils/obj_parser.h"
+#include "utils/program_builder.h"
 
 namespace gWorldAr {
     namespace util {
-        void CheckGlError(const char *operation)
-        {
-            for (GLint error = glGetError(); error; error = glGetError()) {
-                LOGE("after %s() glError (0x%x)\n", operation, error);
-                abort();
-            }
-        }
+        // Beyond this many threads the serial welding pass dominates obj loading.
+        constexpr size_t MAX_OBJ_PARSE_THREADS = 8;
 
-        // Convenient features used in the following creation program.
-        static GLuint LoadShader(GLenum shader_type, const char *shader_source)
+        bool SupportsUint32Indices()
         {
-            GLuint shader = glCreateShader(shader_type);
-            if (!shader) {
-                return shader;
-            }
-
-            glShaderSource(shader, 1, &shader_source, nullptr);
-            glCompileShader(shader);
-            GLint compiled = 0;
-            glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
-
-            if (!compiled) {
-                GLint infoLen = 0;
-
-                glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLen);
-                if (!infoLen) {
-                    return shader;
-                }
-
-                char *buf = reinterpret_cast<char *>(malloc(infoLen));
-                if (!buf) {
-                    return shader;
-                }
-
-                glGetShaderInfoLog(shader, infoLen, nullptr, buf);
-                LOGI("Util::LoadShader Could not compile shader %d:\n%s\n", shader_type,
-                     buf);
-                free(buf);
-                glDeleteShader(shader);
-                shader = 0;
-            }
-
-            return shader;
+            // Every context the app creates on a device has the same capabilities.
+            static const bool isSupported = IsEs3Context() || HasGlExtension("GL_OES_element_index_uint");
+            return isSupported;
         }
 
-        static void HandleErrorGlProgramLink(GLint linkStatus, GLuint &outProgram)
+        GLenum GetHalfFloatVertexType()
         {
-            if (linkStatus != GL_TRUE) {
-                GLint bufLength = 0;
-                glGetProgramiv(outProgram, GL_INFO_LOG_LENGTH, &bufLength);
-                if (bufLength) {
-                    char *buf = reinterpret_cast<char *>(malloc(bufLength));
-                    if (buf) {
-                        glGetProgramInfoLog(outProgram, bufLength, nullptr, buf);
-                        LOGI("Util::HandleErrorGlProgramLink Could not link program:\n%s\n", buf);
-                        free(buf);
-                    }
+            static const GLenum type = []() -> GLenum {
+                if (IsEs3Context()) {
+                    return HALF_FLOAT_ES3;
                 }
-                glDeleteProgram(outProgram);
-                outProgram = 0;
-            }
+                return HasGlExtension("GL_OES_vertex_half_float") ? GL_HALF_FLOAT_OES : 0;
+            }();
+            return type;
         }
 
         GLuint CreateProgram(const char *vertexSource, const char *fragmentSource)
         {
-            GLuint vertexShader = LoadShader(GL_VERTEX_SHADER, vertexSource);
-            if (!vertexShader) {
-                return 0;
-            }
-
-            GLuint fragmentShader = LoadShader(GL_FRAGMENT_SHADER, fragmentSource);
-            if (!fragmentShader) {
-                return 0;
-            }
-
-            GLuint program = glCreateProgram();
-            if (program) {
-                glAttachShader(program, vertexShader);
-                CheckGlError("Util::CreateProgram glAttachShader");
-                glAttachShader(program, fragmentShader);
-                CheckGlError("Util::CreateProgram glAttachShader");
-                glLinkProgram(program);
-                GLint linkStatus = GL_FALSE;
-                glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-
-                HandleErrorGlProgramLink(linkStatus, program);
-            }
-            return program;
+            ProgramBuilder builder;
+            return builder.Take(builder.Submit(vertexSource, fragmentSource));
         }
 
-        bool LoadPngFromAssetManager(int target, const std::string &path)
-        {
-            JNIEnv *env = GetJniEnv();
-            if (env == nullptr) {
-                return false;
-            }
+        // JNI values of the Java image helpers, looked up once.
+        struct ImageJniIds {
+            jclass helperClass;
+            jmethodID loadImageMethod;
+            jmethodID loadTextureMethod;
+        };
 
+        static const ImageJniIds &GetImageJniIds(JNIEnv *env)
+        {
             // Place all JNI values in the structure that is statically initialized when the method
             // is first called.
             // This makes it thread-safe when the likelihood of multiple threads calling the method is low.
-            static struct JNIData {
-                jclass helperClass;
-                jmethodID loadImageMethod;
-                jmethodID loadTextureMethod;
-            } jniIds = [env]() -> JNIData {
+            static const ImageJniIds jniIds = [env]() -> ImageJniIds {
                 constexpr char kHelperClassName[] =
                     "com/huawei/arengine/demos/cworld/JniInterface";
                 constexpr char kLoadImageMethodName[] = "loadImage";
@@ -147,12 +89,59 @@ namespace gWorldAr {
                         helperClass, kLoadTextureMethodName, kLoadTextureMethodSignature);
                     return {helperClass, loadImageMethod, loadTextureMethod};
                 }
-                LOGI("Util::LoadPngFromAssetManager Could not find Java helper class %s",
+                LOGI("Util::GetImageJniIds Could not find Java helper class %s",
                      kHelperClassName);
                 return {};
             }();
+            return jniIds;
+        }
+
+        bool SupportsCompressedTextureFormat(uint32_t internalFormat)
+        {
+            static const std::vector<GLint> formats = []() {
+                GLint formatCount = 0;
+                glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &formatCount);
+                std::vector<GLint> supportedFormats(std::max(0, formatCount));
+                if (formatCount > 0) {
+                    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, supportedFormats.data());
+                }
+                // OpenGL ES 3.0 reads ETC2, and some drivers only list ASTC as an extension.
+                if (IsEs3Context()) {
+                    supportedFormats.push_back(KTX_FORMAT_ETC2_RGB8);
+                    supportedFormats.push_back(KTX_FORMAT_ETC2_RGBA8);
+                }
+                if (HasGlExtension("GL_KHR_texture_compression_astc_ldr")) {
+                    for (uint32_t format = KTX_FORMAT_ASTC_4X4; format <= KTX_FORMAT_ASTC_12X12; ++format) {
+                        supportedFormats.push_back(static_cast<GLint>(format));
+                    }
+                }
+                return supportedFormats;
+            }();
+            if (std::find(formats.begin(), formats.end(), static_cast<GLint>(internalFormat)) != formats.end()) {
+                return true;
+            }
+            // ETC2 decoders read ETC1 blocks.
+            return internalFormat == KTX_FORMAT_ETC1_RGB8 && SupportsCompressedTextureFormat(KTX_FORMAT_ETC2_RGB8);
+        }
+
+        bool InitializeImageLoading()
+        {
+            SupportsCompressedTextureFormat(KTX_FORMAT_ETC2_RGB8);
+            JNIEnv *env = GetJniEnv();
+            return env != nullptr && GetImageJniIds(env).helperClass != nullptr;
+        }
+
+        // Decode a png file with BitmapFactory. Returns a global reference, as the bitmap is handed
+        // to the GL thread, which a local reference does not survive.
+        static jobject DecodeBitmap(const std::string &path)
+        {
+            JNIEnv *env = GetJniEnv();
+            if (env == nullptr) {
+                return nullptr;
+            }
+            const ImageJniIds &jniIds = GetImageJniIds(env);
             if (!jniIds.helperClass) {
-                return false;
+                return nullptr;
             }
 
             jstring jPath = env->NewStringUTF(path.c_str());
@@ -163,309 +152,291 @@ namespace gWorldAr {
             if (jPath) {
                 env->DeleteLocalRef(jPath);
             }
+            if (imageObj == nullptr) {
+                return nullptr;
+            }
 
-            env->CallStaticVoidMethod(jniIds.helperClass, jniIds.loadTextureMethod, target, imageObj);
-            return true;
+            jobject bitmap = env->NewGlobalRef(imageObj);
+            env->DeleteLocalRef(imageObj);
+            return bitmap;
         }
 
-        static bool ParseNormal(char lineHeader[], std::vector<GLfloat> &tempNormals)
+        // Upload a bitmap with GLUtils, then release its global reference.
+        static bool UploadBitmap(int target, jobject bitmap)
         {
-            // Parses the normal vertex status.
-            GLfloat normal[3];
-            if (lineHeader[0] != 'v' || lineHeader[1] != 'n') {
-                return false;
-            }
-            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
-            std::vector<std::string> stringVector;
-            std::string tempResult;
-            std::stringstream readData(tempDataString);
-            while (readData >> tempResult) {
-                stringVector.push_back(tempResult);
-            }
-            // Obj vn data size is 4, include vn symbol and 3 float coordinate position value.
-            if (stringVector.size() < 4) {
+            JNIEnv *env = GetJniEnv();
+            if (env == nullptr) {
                 return false;
             }
-            // Vertex normal dimension is 3.
-            for (int index = 0; index < 3; index++) {
-                // 'vn' takes a place.
-                normal[index] = atof(stringVector[index + 1].c_str());
-                tempNormals.push_back(normal[index]);
+            const ImageJniIds &jniIds = GetImageJniIds(env);
+            if (jniIds.helperClass) {
+                env->CallStaticVoidMethod(jniIds.helperClass, jniIds.loadTextureMethod, target, bitmap);
             }
-            return true;
+            env->DeleteGlobalRef(bitmap);
+            return jniIds.helperClass != nullptr;
         }
 
-        static bool ParseTexture(char lineHeader[], std::vector<GLfloat> &tempUvs)
+        bool DecodePngFromAssetManager(const FileInfor &fileInformation, StagedImage &outImage)
         {
-            // Parses texture coordinates.
-            GLfloat uv[2];
-            if (lineHeader[0] != 'v' || lineHeader[1] != 't') {
-                return false;
-            }
-            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
-            std::vector<std::string> stringVector;
-            std::string tempResult;
-            std::stringstream readData(tempDataString);
-            while (readData >> tempResult) {
-                stringVector.push_back(tempResult);
-            }
-            // Obj vt data size is 3, include vt symbol and 2 float coordinate position value.
-            if (stringVector.size() < 3) {
+            // Png files are stored uncompressed in the APK, so they are decoded straight from the
+            // mapping. The decoder keeps its row buffers for the next image decoded on this thread.
+            static thread_local PngDecoder decoder;
+            AssetBuffer fileBuffer;
+            if (fileBuffer.Open(fileInformation.mgr, fileInformation.fileName) &&
+                decoder.Decode(fileBuffer.GetData(), fileBuffer.GetSize(), outImage.pixels)) {
+                return true;
+            }
+
+            LOGI("Util::DecodePngFromAssetManager Decoding %s with the Android bitmap decoder.",
+                 fileInformation.fileName.c_str());
+            outImage.pixels = PngImage();
+            outImage.bitmap = DecodeBitmap(fileInformation.fileName);
+            if (outImage.bitmap == nullptr) {
+                LOGE("Util::DecodePngFromAssetManager Could not decode %s", fileInformation.fileName.c_str());
                 return false;
             }
-            // U V two quantities.
-            for (int index = 0; index < 2; index++) {
-                // 'vt' occupies one place.
-                uv[index] = atof(stringVector[index + 1].c_str());
-                tempUvs.push_back(uv[index]);
-            }
             return true;
         }
 
-        static bool ParseVertex(char lineHeader[], std::vector<GLfloat> &tempPositions)
+        // Map a compressed texture and check that the GL context can read it with all its mip levels.
+        static bool LoadKtxFile(const FileInfor &fileInformation, StagedImage &outImage)
         {
-            // Resolve the vertices.
-            GLfloat vertex[3];
-            if (lineHeader[0] != 'v' || lineHeader[1] != ' ') {
-                return false;
-            }
-            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
-            std::vector<std::string> stringVector;
-            std::string tempResult;
-            std::stringstream readData(tempDataString);
-            while (readData >> tempResult) {
-                stringVector.push_back(tempResult);
-            }
-            // Obj v data size is 4, include v symbol and 3 float coordinate position value.
-            if (stringVector.size() < 4) {
+            // Compressed textures deflate well, so they stay compressed in the APK and are inflated here.
+            if (!outImage.compressedFile.Open(fileInformation.mgr, fileInformation.fileName)) {
                 return false;
             }
-            // Vertex normal dimension is 3.
-            for (int index = 0; index < 3; index++) {
-                // 'v' take a position.
-                vertex[index] = atof(stringVector[index + 1].c_str());
-                tempPositions.push_back(vertex[index]);
-            }
-            return true;
+            KtxTexture &texture = outImage.compressedTexture;
+            if (ReadKtxFile(outImage.compressedFile.GetData(), outImage.compressedFile.GetSize(), texture) &&
+                texture.levels.size() == GetFullMipLevelCount(texture.levels[0].width, texture.levels[0].height) &&
+                SupportsCompressedTextureFormat(texture.internalFormat)) {
+                return true;
+            }
+            LOGI("Util::LoadKtxFile %s is not a full mip chain of a supported format.",
+                 fileInformation.fileName.c_str());
+            texture = KtxTexture();
+            outImage.compressedFile.Close();
+            return false;
         }
 
-        static bool WriteOneNormalAndVertValues(FileData fileData,
-                                                unsigned int vertexIndex[],
-                                                unsigned int normalIndex[],
-                                                unsigned int textureIndex[],
-                                                bool isNormalAndUvAvailable[])
+        bool LoadTextureFromAssetManager(const FileInfor &fileInformation, StagedImage &outImage)
         {
-            // Char* for call system API.
-            char *perVertInfo;
-            int perVertInforCount = 0;
-            bool isVertexNormalOnlyFace = (strstr(fileData.perVertInfoList[fileData.i], "//") != nullptr);
-            // Char* for call system API.
-            char *perVertInfoIter = fileData.perVertInfoList[fileData.i];
-            perVertInfo = strtok_r(perVertInfoIter, "/", &perVertInfoIter);
-            bool flag = perVertInfo;
-            while (flag) {
-                // Write only normal and vertical values.
-                switch (perVertInforCount) {
-                    case 0: // The vertex index is the first write in turn.
-                        // Write the vertex index.
-                        vertexIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
-                        break;
-                    case 1: // Write sequentially, the texture index will be written the second time.
-                        // Write the texture index.
-                        if (isVertexNormalOnlyFace) {
-                            normalIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
-                            isNormalAndUvAvailable[0] = true;
-                        } else {
-                            textureIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
-                            isNormalAndUvAvailable[1] = true;
-                        }
-                        break;
-                        // Whether to write a normal index.
-                    case 2: // Cyclic write: normal index write for the third time.
-                        // Write a common index.
-                        if (!isVertexNormalOnlyFace) {
-                            normalIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
-                            isNormalAndUvAvailable[0] = true;
-                            break;
-                        }
-
-                        // Deliberately falling into the default error condition due to the vertices,
-                        // the normal plane has only two values.
-                    default:
-                        // The format is incorrect.
-                        LOGE("Format of 'f int/int/int int/int/int int/int/int "
-                             "(int/int/int)' "
-                             "or 'f int//int int//int int//int (int//int)' required for "
-                             "each face");
-                        return false;
+            const std::string &fileName = fileInformation.fileName;
+            const std::string baseName = fileName.substr(0, fileName.rfind('.'));
+            for (const char *extension : {KTX_ASTC_FILE_EXTENSION, KTX_FILE_EXTENSION}) {
+                FileInfor compressedInformation;
+                compressedInformation.mgr = fileInformation.mgr;
+                compressedInformation.fileName = baseName + extension;
+                if (LoadKtxFile(compressedInformation, outImage)) {
+                    LOGI("Util::LoadTextureFromAssetManager loaded %s.", compressedInformation.fileName.c_str());
+                    return true;
                 }
-                perVertInforCount++;
-                flag = perVertInfo = strtok_r(perVertInfoIter, "/", &perVertInfoIter);
             }
-            return true;
+            return DecodePngFromAssetManager(fileInformation, outImage);
         }
 
-        static bool WriteNormalAndVertexValues(std::vector<char *> perVertexInfoList,
-                                               unsigned int vertexIndex[],
-                                               unsigned int normalIndex[],
-                                               unsigned int textureIndex[],
-                                               bool isNormalAndUvAvailable[])
+        bool UploadImage(int target, StagedImage &image)
         {
-            for (int i = 0; i < perVertexInfoList.size(); ++i) {
-                FileData fileData;
-                fileData.perVertInfoList = perVertexInfoList;
-                fileData.i = i;
-                if (!WriteOneNormalAndVertValues(
-                    fileData, vertexIndex, normalIndex, textureIndex, isNormalAndUvAvailable)) {
-                    return false;
+            KtxTexture &texture = image.compressedTexture;
+            if (!texture.levels.empty()) {
+                // ETC1 is read as ETC2 by contexts that only list the latter.
+                GLenum format = texture.internalFormat;
+                if (format == KTX_FORMAT_ETC1_RGB8 && !HasGlExtension("GL_OES_compressed_ETC1_RGB8_texture")) {
+                    format = KTX_FORMAT_ETC2_RGB8;
+                }
+                for (size_t level = 0; level < texture.levels.size(); ++level) {
+                    const KtxLevel &mipLevel = texture.levels[level];
+                    glCompressedTexImage2D(target, static_cast<GLint>(level), format, mipLevel.width,
+                                           mipLevel.height, 0, mipLevel.size, mipLevel.data);
                 }
+                texture = KtxTexture();
+                image.compressedFile.Close();
+                return true;
+            }
+            if (image.bitmap != nullptr) {
+                bool isUploaded = UploadBitmap(target, image.bitmap);
+                image.bitmap = nullptr;
+                if (isUploaded) {
+                    glGenerateMipmap(target);
+                }
+                return isUploaded;
             }
+            const PngImage &pixels = image.pixels;
+            if (pixels.pixels.empty()) {
+                return false;
+            }
+            // OpenGL ES 2.0 takes the internal format from the format, one per channel count.
+            constexpr GLenum FORMATS[] = {GL_LUMINANCE, GL_LUMINANCE_ALPHA, GL_RGB, GL_RGBA};
+            const GLenum format = FORMATS[pixels.channels - 1];
+            // Rows are tightly packed, which odd widths of 1 to 3 channel images need to be told.
+            const bool isRowAligned = (pixels.width * pixels.channels) % 4 == 0;
+            if (!isRowAligned) {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            }
+            glTexImage2D(target, 0, format, pixels.width, pixels.height, 0, format, GL_UNSIGNED_BYTE,
+                         pixels.pixels.data());
+            if (!isRowAligned) {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            }
+            glGenerateMipmap(target);
+            image.pixels = PngImage();
             return true;
         }
 
-        static bool WriteIndex(char &input,
-                               std::vector<GLushort> &vertexIndices,
-                               std::vector<GLushort> &normalIndices,
-                               std::vector<GLushort> &uvIndices)
+        bool LoadObjFile(FileInfor fileInfor,
+                         std::vector<GLfloat> &outVertices,
+                         std::vector<GLfloat> &outNormals,
+                         std::vector<GLfloat> &outUv,
+                         std::vector<GLuint> &outIndices)
         {
-            // The actual face information starts from the second digit.
-            unsigned int vertexIndex[4] = {}; // The dimension of the coordinate is 4(xyzw).
-            unsigned int normalIndex[4] = {}; // The dimension of normal vector is 4.
-            unsigned int textureIndex[4] = {}; // The dimension of texture is 4.
-
-            std::vector<char *> perVertInfoList;
-            char *perVertInfoListCstr;
-            char *faceLineIter = &input;
-            bool flag = perVertInfoListCstr = strtok_r(faceLineIter, " ", &faceLineIter);
-            while (flag) {
-                // Divide each piece of face information into each position.
-                perVertInfoList.push_back(perVertInfoListCstr);
-                flag = perVertInfoListCstr = strtok_r(faceLineIter, " ", &faceLineIter);
-            }
-            bool isNormalAvailable = false;
-            bool isUvAvailable = false;
-            // Input variable of the WriteNormalAndVertValues method.
-            bool isNormalAndUvAvailable[2] = {isNormalAvailable, isUvAvailable};
-
-            if (!WriteNormalAndVertexValues(
-                perVertInfoList, vertexIndex, normalIndex, textureIndex, isNormalAndUvAvailable)) {
+            // The obj file is parsed in place: uncompressed assets are mapped, compressed ones are
+            // inflated once by the asset manager.
+            AssetBuffer fileBuffer;
+            if (!fileBuffer.Open(fileInfor.mgr, fileInfor.fileName)) {
+                LOGE("Error opening asset %s", fileInfor.fileName.c_str());
                 return false;
             }
-            int verticesCount = perVertInfoList.size();
-            for (int i = 2; i < verticesCount; ++i) {
-                vertexIndices.push_back(vertexIndex[0] - 1);
-                vertexIndices.push_back(vertexIndex[i - 1] - 1);
-                vertexIndices.push_back(vertexIndex[i] - 1);
-                if (isNormalAndUvAvailable[0]) {
-                    normalIndices.push_back(normalIndex[0] - 1);
-                    normalIndices.push_back(normalIndex[i - 1] - 1);
-                    normalIndices.push_back(normalIndex[i] - 1);
-                }
-                if (isNormalAndUvAvailable[1]) {
-                    uvIndices.push_back(textureIndex[0] - 1);
-                    uvIndices.push_back(textureIndex[i - 1] - 1);
-                    uvIndices.push_back(textureIndex[i] - 1);
-                }
+
+            // Large files are split across the cores; ParseObj keeps small ones on this thread.
+            const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                        MAX_OBJ_PARSE_THREADS);
+            ObjStats stats;
+            if (!ParseObj(static_cast<const char *>(fileBuffer.GetData()), fileBuffer.GetSize(),
+                          outVertices, outNormals, outUv, outIndices, &stats, threadCount)) {
+                return false;
             }
+            LOGI("Util::LoadObjFile %s: welded %zu triangle corners into %zu vertices.",
+                 fileInfor.fileName.c_str(), stats.cornerCount, stats.vertexCount);
             return true;
         }
 
-        static bool WriteDrawOutData(DrawTempData drawTempData,
-                                     std::vector<GLfloat> &outVertices,
-                                     std::vector<GLfloat> &outNormals,
-                                     std::vector<GLfloat> &outUv,
-                                     std::vector<GLushort> &outIndices)
+        bool AssetBuffer::Open(AAssetManager *mgr, const std::string &fileName)
         {
-            bool isNormalAvailable = (!drawTempData.normalIndices.empty());
-            bool isUvAvailable = (!drawTempData.uvIndices.empty());
-            if (isNormalAvailable && drawTempData.normalIndices.size() != drawTempData.vertexIndices.size()) {
-                LOGE("Object normal indices does not equal to vertex indices.");
+            Close();
+            // AASSET_MODE_BUFFER lets AAsset_getBuffer map an uncompressed asset instead of inflating it.
+            asset = AAssetManager_open(mgr, fileName.c_str(), AASSET_MODE_BUFFER);
+            if (asset == nullptr) {
                 return false;
             }
-            if (isUvAvailable && drawTempData.uvIndices.size() != drawTempData.vertexIndices.size()) {
-                LOGE("Object UV indices does not equal to vertex indices.");
+            data = AAsset_getBuffer(asset);
+            size = static_cast<size_t>(AAsset_getLength(asset));
+            if (data == nullptr) {
+                LOGE("Util::AssetBuffer::Open could not map asset %s", fileName.c_str());
+                Close();
                 return false;
             }
-
-            for (unsigned int i = 0; i < drawTempData.vertexIndices.size(); i++) {
-                unsigned int vertex_index = drawTempData.vertexIndices[i];
-                // The vertex dimension is 3.
-                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3]);
-                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3 + 1]);
-                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3 + 2]);
-                outIndices.push_back(i);
-                if (isNormalAvailable) {
-                    unsigned int normal_index = drawTempData.normalIndices[i];
-                    // The vertex normal has three dimensions.
-                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3]);
-                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3 + 1]);
-                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3 + 2]);
-                }
-                if (isUvAvailable) {
-                    unsigned int uv_index = drawTempData.uvIndices[i];
-                    // U-axis and V-axis of the texture coordinate.
-                    outUv.push_back(drawTempData.tempUvs[uv_index * 2]);
-                    outUv.push_back(drawTempData.tempUvs[uv_index * 2 + 1]);
-                }
-            }
             return true;
         }
 
-        bool LoadObjFile(FileInfor fileInfor,
-                         std::vector<GLfloat> &outVertices,
-                         std::vector<GLfloat> &outNormals,
-                         std::vector<GLfloat> &outUv,
-                         std::vector<GLushort> &outIndices)
+        void AssetBuffer::Close()
         {
-            DrawTempData drawTempData;
+            if (asset != nullptr) {
+                AAsset_close(asset);
+            }
+            asset = nullptr;
+            data = nullptr;
+            size = 0;
+        }
 
-            // If the file has not been decompressed, it is loaded into internal storage.
-            // Note that AAsset_openFileDescriptor doesn't support compressed files (.obj).
-            AAsset *asset = AAssetManager_open(fileInfor.mgr, fileInfor.fileName.c_str(), AASSET_MODE_STREAMING);
-            if (asset == nullptr) {
-                LOGE("Error opening asset %s", fileInfor.fileName.c_str());
+        bool LoadCompiledMesh(const FileInfor &fileInfor, AssetBuffer &outBuffer, MeshView &outMesh)
+        {
+            if (!outBuffer.Open(fileInfor.mgr, fileInfor.fileName)) {
+                return false;
+            }
+            MeshFileView fileView;
+            if (!ReadMeshFile(outBuffer.GetData(), outBuffer.GetSize(), fileView)) {
+                LOGE("Util::LoadCompiledMesh %s is not a valid compiled mesh.", fileInfor.fileName.c_str());
+                outBuffer.Close();
                 return false;
             }
 
-            off_t fileSize = AAsset_getLength(asset);
-            std::string file_buffer;
-            file_buffer.resize(fileSize);
-            int ret = AAsset_read(asset, &file_buffer.front(), fileSize);
-            if (ret < 0 || ret == EOF) {
-                LOGE("Failed to open file: %s", fileInfor.fileName.c_str());
-                AAsset_close(asset);
+            const bool isUint32 = (fileView.header->indexSize == sizeof(uint32_t));
+            if (isUint32 && !SupportsUint32Indices()) {
+                LOGE("Util::LoadCompiledMesh %s needs 32-bit indices, which are not supported.",
+                     fileInfor.fileName.c_str());
+                outBuffer.Close();
                 return false;
             }
-            AAsset_close(asset);
 
-            std::stringstream fileStringStream(file_buffer);
-            while (!fileStringStream.eof()) {
-                // Sets the maximum number of characters to be read (128).
-                char line_header[128] = {};
-                fileStringStream.getline(line_header, 128);
-                if (line_header[0] == 'v' && line_header[1] == 'n') {
-                    if (!ParseNormal(line_header, drawTempData.tempNormals)) {
-                        return false;
-                    }
-                } else if (line_header[0] == 'v' && line_header[1] == 't') {
-                    if (!ParseTexture(line_header, drawTempData.tempUvs)) {
-                        return false;
-                    }
-                } else if (line_header[0] == 'v') {
-                    if (!ParseVertex(line_header, drawTempData.tempPositions)) {
-                        return false;
-                    }
-                } else if (line_header[0] == 'f') {
-                    if (!WriteIndex(
-                        line_header[1], drawTempData.vertexIndices,
-                        drawTempData.normalIndices, drawTempData.uvIndices)) {
-                        return false;
-                    }
-                }
+            if (fileView.quantizedVertices != nullptr) {
+                SetQuantizedVertexAttribs(fileView.quantizedVertices, fileView.header->quantization, outMesh);
+            } else {
+                const GLsizei stride = sizeof(MeshFileVertex);
+                const MeshFileVertex *vertices = fileView.vertices;
+                // The vertex and normal dimensions are 3, the texture coordinate dimension is 2.
+                outMesh.position = {vertices->position, 3, GL_FLOAT, GL_FALSE, stride};
+                outMesh.normal = {vertices->normal, 3, GL_FLOAT, GL_FALSE, stride};
+                outMesh.uv = {vertices->uv, 2, GL_FLOAT, GL_FALSE, stride};
+                outMesh.quantization = nullptr;
+            }
+            outMesh.indices = fileView.indices;
+            outMesh.indexType = isUint32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+            outMesh.subMeshes = fileView.subMeshes;
+            outMesh.subMeshCount = fileView.header->subMeshCount;
+            outMesh.lods = fileView.lods;
+            outMesh.lodCount = fileView.header->lodCount;
+            SetMeshBounds(fileView.header->boundsMin, fileView.header->boundsMax, outMesh);
+            return true;
+        }
+
+        bool LoadGlbFile(const FileInfor &fileInfor, AssetBuffer &outBuffer, std::vector<GLfloat> &outConverted,
+                         std::vector<SubMesh> &outSubMeshes, MeshView &outMesh)
+        {
+            if (!outBuffer.Open(fileInfor.mgr, fileInfor.fileName)) {
+                LOGE("Util::LoadGlbFile could not open %s.", fileInfor.fileName.c_str());
+                return false;
             }
-            if (!WriteDrawOutData(drawTempData, outVertices, outNormals, outUv, outIndices)) {
+            GlbPrimitive primitive;
+            if (!ReadGlbPrimitive(outBuffer.GetData(), outBuffer.GetSize(), primitive)) {
+                LOGE("Util::LoadGlbFile %s is not a supported glb model.", fileInfor.fileName.c_str());
+                outBuffer.Close();
                 return false;
             }
+            if (primitive.indices.componentType == GLB_COMPONENT_UNSIGNED_INT && !SupportsUint32Indices()) {
+                LOGE("Util::LoadGlbFile %s needs 32-bit indices, which are not supported.",
+                     fileInfor.fileName.c_str());
+                outBuffer.Close();
+                return false;
+            }
+
+            // glTF component types are GL enum values, so GL reads the buffer views in place. Only half
+            // floats of a context without half-float attributes are converted to floats first.
+            const GLenum halfFloatType = GetHalfFloatVertexType();
+            const GlbAccessor *accessors[] = {&primitive.position, &primitive.normal, &primitive.uv};
+            VertexAttrib *attribs[] = {&outMesh.position, &outMesh.normal, &outMesh.uv};
+            size_t convertedOffsets[] = {SIZE_MAX, SIZE_MAX, SIZE_MAX};
+            outConverted.clear();
+            for (size_t i = 0; i < 3; ++i) {
+                const GlbAccessor &accessor = *accessors[i];
+                const GLint size = static_cast<GLint>(accessor.componentCount);
+                if (accessor.componentType == GLB_COMPONENT_HALF_FLOAT && halfFloatType == 0) {
+                    std::vector<float> values;
+                    ReadGlbAccessor(accessor, values);
+                    convertedOffsets[i] = outConverted.size();
+                    outConverted.insert(outConverted.end(), values.begin(), values.end());
+                    *attribs[i] = {nullptr, size, GL_FLOAT, GL_FALSE, 0};
+                    continue;
+                }
+                const GLenum type = (accessor.componentType == GLB_COMPONENT_HALF_FLOAT) ?
+                    halfFloatType : static_cast<GLenum>(accessor.componentType);
+                *attribs[i] = {accessor.data, size, type, static_cast<GLboolean>(accessor.normalized),
+                               static_cast<GLsizei>(accessor.stride)};
+            }
+            // The converted arrays are pointed at once all of them are appended.
+            for (size_t i = 0; i < 3; ++i) {
+                if (convertedOffsets[i] != SIZE_MAX) {
+                    attribs[i]->pointer = outConverted.data() + convertedOffsets[i];
+                }
+            }
+
+            outMesh.indices = primitive.indices.data;
+            outMesh.indexType = static_cast<GLenum>(primitive.indices.componentType);
+            outSubMeshes = {{0, primitive.position.count, 0, primitive.indices.count}};
+            outMesh.subMeshes = outSubMeshes.data();
+            outMesh.subMeshCount = outSubMeshes.size();
+            outMesh.quantization = nullptr;
+            // Only a single level of detail is read, which needs no bounds to be selected.
+            outMesh.lods = nullptr;
+            outMesh.lodCount = 0;
             return true;
         }
 
@@ -20,10 +20,10 @@
 #include <cerrno>
 #include <cstdint>
 #include <cstdlib>
+#include <string>
 #include <vector>
 
 #include <android/asset_manager.h>
-#include <android/log.h>
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 #include <jni.h>
@@ -33,24 +33,17 @@
 #include <gtx/quaternion.hpp>
 
 #include "huawei_arengine_interface.h"
-
-#ifndef LOGI
-#define LOGI(...) \
-    __android_log_print(ANDROID_LOG_INFO, "worldArCPP", __VA_ARGS__)
-#endif
-
-#ifndef LOGE
-#define LOGE(...) \
-    __android_log_print(ANDROID_LOG_ERROR, "worldArCPP", __VA_ARGS__)
-#endif
-
-#ifndef CHECK
-#define CHECK(condition)                                                   \
-    if (!(condition)) {                                                      \
-        LOGE("*** CHECK FAILED at %d: %s", __LINE__, #condition); \
-        abort();                                                               \
-    }
-#endif
+#include "utils/gl_capabilities.h"
+#include "utils/gl_error.h"
+#include "utils/gl_state.h"
+#include "utils/ktx_format.h"
+#include "utils/log.h"
+#include "utils/mesh_optimizer.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/mesh_simplifier.h"
+#include "utils/mesh_view.h"
+#include "utils/png_decoder.h"
+#include "utils/program_builder.h"
 
 namespace gWorldAr {
     // Utilities for C hello AR project.
@@ -86,29 +79,70 @@ namespace gWorldAr {
             std::string fileName;
         };
 
-        using FileData = struct {
-            std::vector<char *> perVertInfoList;
-            int i;
+        /**
+         * Keeps an asset open and exposes its content in place.
+         * Uncompressed assets are memory-mapped straight out of the APK, so nothing is copied.
+         */
+        class AssetBuffer {
+        public:
+            AssetBuffer() = default;
+
+            ~AssetBuffer()
+            {
+                Close();
+            }
+
+            bool Open(AAssetManager *mgr, const std::string &fileName);
+
+            void Close();
+
+            const void *GetData() const
+            {
+                return data;
+            }
+
+            size_t GetSize() const
+            {
+                return size;
+            }
+
+            // Delete copy constructors.
+            AssetBuffer(const AssetBuffer &) = delete;
+
+            void operator=(const AssetBuffer &) = delete;
+
+        private:
+            AAsset *asset = nullptr;
+            const void *data = nullptr;
+            size_t size = 0;
         };
 
-        using DrawTempData = struct {
-            std::vector<GLfloat> tempPositions;
-            std::vector<GLfloat> tempNormals;
-            std::vector<GLfloat> tempUvs;
-            std::vector<GLushort> vertexIndices;
-            std::vector<GLushort> normalIndices;
-            std::vector<GLushort> uvIndices;
+        // An image loaded on the loading thread, waiting to be uploaded on the GL thread.
+        struct StagedImage {
+            AssetBuffer compressedFile; // Keeps the levels of compressedTexture in memory.
+            KtxTexture compressedTexture; // Set when a compressed texture with its mip levels was loaded.
+            PngImage pixels; // Set when the image was decoded natively.
+            jobject bitmap = nullptr; // Global reference to the bitmap decoded by the Java fallback.
         };
 
         /**
-         * Checks for GL errors and stops if any.
-         *
-         * @param operation Name of the GL function call.
+         * Check whether glDrawElements accepts GL_UNSIGNED_INT indices, which OpenGL ES 3.0 and the
+         * GL_OES_element_index_uint extension allow. The first call must be made with a current GL
+         * context; later calls on any thread return the cached result.
+         */
+        bool SupportsUint32Indices();
+
+        /**
+         * Vertex attribute type of half floats: GL_HALF_FLOAT on OpenGL ES 3.0, GL_HALF_FLOAT_OES with
+         * the GL_OES_vertex_half_float extension, 0 if the context has none. The first call must be
+         * made with a current GL context; later calls on any thread return the cached result.
          */
-        void CheckGlError(const char *operation);
+        GLenum GetHalfFloatVertexType();
 
         /**
-         * Create Shader Program ID.
+         * Create Shader Program ID. The linked binary is loaded from the program cache when it holds
+         * one for these sources, and stored there otherwise. Blocks until the driver has linked the
+         * program, so several programs are better built with one ProgramBuilder.
          *
          * @param vertexSource Vertex source, vertex coloring source.
          * @param fragmentSource Fragment Source, Fragment Shader Source.
@@ -131,7 +165,57 @@ namespace gWorldAr {
                                        const HwArPose &planePose,
                                        const HwArPose &cameraPose);
 
-        bool LoadPngFromAssetManager(int target, const std::string &path);
+        /**
+         * Whether textures of a compressed format can be uploaded. The first call must have a GL context.
+         *
+         * @param internalFormat One of the KTX_FORMAT values.
+         * @return True if the GL context reads the format, false otherwise.
+         */
+        bool SupportsCompressedTextureFormat(uint32_t internalFormat);
+
+        /**
+         * Query the compressed texture formats of the GL context and look up the Java image helpers
+         * that decode the png files the native decoder does not support. Must be called on the GL
+         * thread before images are loaded on a native thread, which has no GL context and whose class
+         * lookups only see system classes.
+         *
+         * @return True if the helpers are available, false otherwise.
+         */
+        bool InitializeImageLoading();
+
+        /**
+         * Load a texture from the assets folder. A compressed texture with the same name and the
+         * KTX_ASTC_FILE_EXTENSION or KTX_FILE_EXTENSION extension is preferred when the GL context
+         * supports its format; otherwise the png file is decoded.
+         * Safe to call on any thread once InitializeImageLoading has been called.
+         *
+         * @param fileInformation Pointer to the AAssetManager,the name of the png file.
+         * @param outImage Receives the texture, released by UploadImage.
+         * @return True if the texture was loaded, false otherwise.
+         */
+        bool LoadTextureFromAssetManager(const FileInfor &fileInformation, StagedImage &outImage);
+
+        /**
+         * Decode a png file from the assets folder. The file is decoded natively, straight from the
+         * mapped asset; interlaced or malformed files fall back to the Android bitmap decoder.
+         * Safe to call on any thread once InitializeImageLoading has been called.
+         *
+         * @param fileInformation Pointer to the AAssetManager,the name of the png file.
+         * @param outImage Receives the decoded image, released by UploadImage.
+         * @return True if the image was decoded, false otherwise.
+         */
+        bool DecodePngFromAssetManager(const FileInfor &fileInformation, StagedImage &outImage);
+
+        /**
+         * Upload an image with all its mip levels to the texture bound to target, then release the
+         * image. Compressed textures bring their levels; the levels of decoded images are generated.
+         * Must be called on the GL thread.
+         *
+         * @param target Texture target, such as GL_TEXTURE_2D.
+         * @param image Image filled by LoadTextureFromAssetManager or DecodePngFromAssetManager.
+         * @return True if the image was uploaded, false otherwise.
+         */
+        bool UploadImage(int target, StagedImage &image);
 
         /**
          * Load the obj file from the assets folder in the application.
@@ -140,14 +224,40 @@ namespace gWorldAr {
          * @param outVertices Output vertex.
          * @param outNormals Output normal.
          * @param outUv UV coordinate of the output texture.
-         * @param outIndices Output triangular exponent.
+         * @param outIndices Output triangular exponent, 32-bit so that any vertex count fits.
          * @return True if obj is loaded correctly, false otherwise.
          */
         bool LoadObjFile(FileInfor fileInformation,
                          std::vector<GLfloat> &outVertices,
                          std::vector<GLfloat> &outNormals,
                          std::vector<GLfloat> &outUv,
-                         std::vector<GLushort> &outIndices);
+                         std::vector<GLuint> &outIndices);
+
+        /**
+         * Map a binary glTF model from the assets folder and point GL straight at its buffer views.
+         * Positions, normals and texture coordinates may be floats, half floats or normalized integers.
+         *
+         * @param fileInformation Pointer to the AAssetManager,the name of the glb file.
+         * @param outBuffer Keeps the asset mapped for as long as outMesh is used.
+         * @param outConverted Receives the half-float attributes converted to floats when the GL
+         *                     context cannot read half floats, empty otherwise.
+         * @param outSubMeshes Receives the single sub-mesh outMesh points at.
+         * @param outMesh Points GL at the mapped vertex and index data.
+         * @return True if the model is supported by the loader and by the GL context, false otherwise.
+         */
+        bool LoadGlbFile(const FileInfor &fileInformation, AssetBuffer &outBuffer, std::vector<GLfloat> &outConverted,
+                         std::vector<SubMesh> &outSubMeshes, MeshView &outMesh);
+
+        /**
+         * Map a mesh compiled by the host-side mesh compiler from the assets folder.
+         *
+         * @param fileInformation Pointer to the AAssetManager,the name of the compiled mesh file.
+         * @param outBuffer Keeps the asset mapped for as long as outMesh is used.
+         * @param outMesh Points GL straight at the mapped vertex and index data.
+         * @return True if a compiled mesh of the supported version exists and its index size is
+         *         supported by the GL context, false otherwise.
+         */
+        bool LoadCompiledMesh(const FileInfor &fileInformation, AssetBuffer &outBuffer, MeshView &outMesh);
     }
 }
 #endif
\ No newline at end of file
@@ -27,6 +27,7 @@
 #include <gtx/quaternion.hpp>
 
 #include <rendering/world_render_manager.h>
+#include "utils/program_cache.h"
 #include "utils/util.h"
 
 namespace gWorldAr {
@@ -34,7 +35,8 @@ namespace gWorldAr {
         constexpr size_t K_MAX_NUMBER_OF_OBJECT_RENDERED = 10;
     }
 
-    WorldArApplication::WorldArApplication(AAssetManager *assetManager) : mAssetManager(assetManager)
+    WorldArApplication::WorldArApplication(AAssetManager *assetManager, const std::string &programCacheDirectory)
+        : mAssetManager(assetManager), mProgramCacheDirectory(programCacheDirectory)
     {
         LOGI("WorldArApplication::OnCreate()");
     }
@@ -84,6 +86,11 @@ namespace gWorldAr {
     void WorldArApplication::OnSurfaceCreated()
     {
         LOGI("WorldArApplication::OnSurfaceCreated()");
+        util::SetProgramCacheDirectory(mProgramCacheDirectory);
+
+        // The debug callback of the previous context was destroyed with it.
+        mAppliedGlErrorCheckMode = mRequestedGlErrorCheckMode;
+        util::SetGlErrorCheckMode(static_cast<util::GlErrorCheckMode>(mAppliedGlErrorCheckMode));
         mWorldRenderManager.Initialize(mAssetManager);
     }
 
@@ -103,7 +110,24 @@ namespace gWorldAr {
     void WorldArApplication::OnDrawFrame()
     {
         LOGI("WorldArApplication::OnDrawFrame()");
+        const int requestedMode = mRequestedGlErrorCheckMode;
+        if (requestedMode != mAppliedGlErrorCheckMode) {
+            mAppliedGlErrorCheckMode = requestedMode;
+            util::SetGlErrorCheckMode(static_cast<util::GlErrorCheckMode>(requestedMode));
+        }
         mWorldRenderManager.OnDrawFrame(mArSession, mArFrame, mColoredAnchors);
+        util::CheckGlFrameError("WorldArApplication::OnDrawFrame");
+    }
+
+    bool WorldArApplication::SetGlErrorCheckMode(int mode)
+    {
+        if (mode < static_cast<int>(util::GlErrorCheckMode::OFF) ||
+            mode > static_cast<int>(util::GlErrorCheckMode::KHR_DEBUG)) {
+            LOGE("WorldArApplication::SetGlErrorCheckMode unknown mode %d.", mode);
+            return false;
+        }
+        mRequestedGlErrorCheckMode = mode;
+        return true;
     }
 
     bool WorldArApplication::GetHitResult(HwArHitResult *&arHitResult, bool &hasHitFlag,
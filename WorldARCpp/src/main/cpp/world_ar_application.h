@@ -17,6 +17,7 @@
 #ifndef C_ARENGINE_HELLOE_AR_HELLO_AR_APPLICATION_H
 #define C_ARENGINE_HELLOE_AR_HELLO_AR_APPLICATION_H
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -43,7 +44,11 @@ namespace gWorldAr {
     public:
         WorldArApplication() = default;
 
-        explicit WorldArApplication(AAssetManager *assetManager);
+        /**
+         * @param assetManager Asset manager the models and textures are read from.
+         * @param programCacheDirectory App-private directory the linked shader programs are cached in.
+         */
+        WorldArApplication(AAssetManager *assetManager, const std::string &programCacheDirectory);
 
         ~WorldArApplication();
 
@@ -95,6 +100,15 @@ namespace gWorldAr {
          */
         bool HasDetectedPlanes();
 
+        /**
+         * Select how GL errors are detected. May be called on any thread; the mode is applied on the
+         * OpenGL thread before the next frame.
+         *
+         * @param mode Value of util::GlErrorCheckMode.
+         * @return False if the mode is unknown.
+         */
+        bool SetGlErrorCheckMode(int mode);
+
     private:
         HwArSession *mArSession = nullptr;
         HwArFrame *mArFrame = nullptr;
@@ -104,6 +118,11 @@ namespace gWorldAr {
         int mHeight = 1;
         int mDisplayRotation = 0;
         AAssetManager * const mAssetManager = nullptr;
+        const std::string mProgramCacheDirectory;
+
+        // GL error check mode set through SetGlErrorCheckMode, and the one last applied on the GL thread.
+        std::atomic<int> mRequestedGlErrorCheckMode {static_cast<int>(util::DEFAULT_GL_ERROR_CHECK_MODE)};
+        int mAppliedGlErrorCheckMode = -1;
 
         WorldRenderManager mWorldRenderManager = gWorldAr::WorldRenderManager();
 
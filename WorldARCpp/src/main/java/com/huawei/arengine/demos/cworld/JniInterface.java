@@ -34,6 +34,26 @@ import java.io.IOException;
  * @since 2020-09-21
  */
 public class JniInterface {
+    /**
+     * GL error check mode without any checks.
+     */
+    public static final int GL_ERROR_CHECK_OFF = 0;
+
+    /**
+     * GL error check mode with one glGetError check per frame, the default of release builds.
+     */
+    public static final int GL_ERROR_CHECK_PER_FRAME = 1;
+
+    /**
+     * GL error check mode with a glGetError check after every draw, the default of debug builds.
+     */
+    public static final int GL_ERROR_CHECK_PER_CALL = 2;
+
+    /**
+     * GL error check mode that receives errors through a GL_KHR_debug callback.
+     */
+    public static final int GL_ERROR_CHECK_KHR_DEBUG = 3;
+
     private static final String TAG = JniInterface.class.getSimpleName();
 
     /**
@@ -61,9 +81,10 @@ public class JniInterface {
      * Create a native app.
      *
      * @param assetManager Asset manager.
+     * @param programCacheDirectory App-private directory the linked shader programs are cached in.
      * @return A native pointer to a native app instance.
      */
-    public static native long createNativeApplication(AssetManager assetManager);
+    public static native long createNativeApplication(AssetManager assetManager, String programCacheDirectory);
 
     /**
      * Destroy the local app.
@@ -139,6 +160,15 @@ public class JniInterface {
      */
     public static native boolean hasDetectedPlanes(long nativeApplication);
 
+    /**
+     * Select how GL errors are detected. The mode is applied on the OpenGL thread before the next frame.
+     *
+     * @param nativeApplication Native application
+     * @param mode One of the GL_ERROR_CHECK_* modes
+     * @return Returns false if the mode is unknown
+     */
+    public static native boolean setGlErrorCheckMode(long nativeApplication, int mode);
+
     /**
      * Load image.
      *
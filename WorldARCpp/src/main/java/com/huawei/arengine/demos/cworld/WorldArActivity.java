@@ -51,6 +51,9 @@ public class WorldArActivity extends Activity {
 
     private static final int CONFIG_CHOOSER_STENCIL_SIZE = 0;
 
+    // Optional intent extra selecting the GL error check mode, one of JniInterface.GL_ERROR_CHECK_*.
+    private static final String EXTRA_GL_ERROR_CHECK_MODE = "glErrorCheckMode";
+
     private GLSurfaceView mSurfaceView;
 
     // Opaque native pointer to the native application instance.
@@ -91,9 +94,15 @@ public class WorldArActivity extends Activity {
         }
 
         JniInterface.setAssetManager(getAssets());
-        mNativeApplication = JniInterface.createNativeApplication(getAssets());
+        mNativeApplication = JniInterface.createNativeApplication(getAssets(),
+            getCodeCacheDir().getAbsolutePath());
         worldRenderManager.setDisplayRotationManage(mDisplayRotationManager);
         worldRenderManager.setNativeApplication(mNativeApplication);
+
+        int glErrorCheckMode = getIntent().getIntExtra(EXTRA_GL_ERROR_CHECK_MODE, -1);
+        if (glErrorCheckMode >= 0 && !JniInterface.setGlErrorCheckMode(mNativeApplication, glErrorCheckMode)) {
+            Log.w(TAG, "Unknown GL error check mode " + glErrorCheckMode);
+        }
     }
 
     /**
@@ -0,0 +1,554 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "etc_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace gWorldAr {
+    namespace host {
+        namespace {
+            // Intensity modifiers of the ETC1 modes, as {a, b}: selectors 0 to 3 add a, b, -a and -b.
+            constexpr int ETC_MODIFIER_TABLES[8][2] = {
+                {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+            };
+            // Distances between the paint colors of the T and H modes.
+            constexpr int ETC_DISTANCES[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+
+            // Pixels of a block, row by row, three channels each.
+            using BlockPixels = int[16][3];
+
+            int Clamp255(int value)
+            {
+                return std::min(255, std::max(0, value));
+            }
+
+            int Extend4(int value)
+            {
+                return (value << 4) | value;
+            }
+
+            int Extend5(int value)
+            {
+                return (value << 3) | (value >> 2);
+            }
+
+            int Extend6(int value)
+            {
+                return (value << 2) | (value >> 4);
+            }
+
+            int Extend7(int value)
+            {
+                return (value << 1) | (value >> 6);
+            }
+
+            int SignExtend3(uint32_t value)
+            {
+                return value >= 4 ? static_cast<int>(value) - 8 : static_cast<int>(value);
+            }
+
+            // Bits high to low of a block read as a big-endian 64-bit word.
+            uint32_t Bits(uint64_t block, int high, int low)
+            {
+                return static_cast<uint32_t>((block >> low) & ((1ull << (high - low + 1)) - 1));
+            }
+
+            uint64_t ReadBlock(const uint8_t *block)
+            {
+                uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i) {
+                    bits = (bits << 8) | block[i];
+                }
+                return bits;
+            }
+
+            void WriteBlock(uint64_t bits, uint8_t *outBlock)
+            {
+                for (int i = 7; i >= 0; --i) {
+                    outBlock[i] = static_cast<uint8_t>(bits);
+                    bits >>= 8;
+                }
+            }
+
+            // Pixel indices of a block are stored column by column: an MSB plane, then an LSB plane.
+            uint32_t ReadSelector(uint64_t block, int x, int y)
+            {
+                const int bit = x * 4 + y;
+                return (Bits(block, 16 + bit, 16 + bit) << 1) | Bits(block, bit, bit);
+            }
+
+            uint64_t SelectorBits(int x, int y, uint32_t selector)
+            {
+                const int bit = x * 4 + y;
+                return (static_cast<uint64_t>(selector >> 1) << (16 + bit)) |
+                       (static_cast<uint64_t>(selector & 1) << bit);
+            }
+
+            bool IsInSecondSubBlock(int x, int y, bool isFlipped)
+            {
+                return isFlipped ? y >= 2 : x >= 2;
+            }
+
+            int SquaredError(const int *a, const int *b)
+            {
+                const int dr = a[0] - b[0];
+                const int dg = a[1] - b[1];
+                const int db = a[2] - b[2];
+                return dr * dr + dg * dg + db * db;
+            }
+
+            // Best modifier table and selectors for the pixels of one sub-block around a base color.
+            struct SubBlockFit {
+                int error = std::numeric_limits<int>::max();
+                uint32_t table = 0;
+                uint32_t selectors[16] = {};
+            };
+
+            void FitSubBlock(const BlockPixels &pixels, bool isFlipped, int subBlock, const int *base,
+                             SubBlockFit &outFit)
+            {
+                for (uint32_t table = 0; table < 8; ++table) {
+                    const int modifiers[4] = {
+                        ETC_MODIFIER_TABLES[table][0], ETC_MODIFIER_TABLES[table][1],
+                        -ETC_MODIFIER_TABLES[table][0], -ETC_MODIFIER_TABLES[table][1]
+                    };
+                    int colors[4][3];
+                    for (int selector = 0; selector < 4; ++selector) {
+                        for (int channel = 0; channel < 3; ++channel) {
+                            colors[selector][channel] = Clamp255(base[channel] + modifiers[selector]);
+                        }
+                    }
+                    int error = 0;
+                    uint32_t selectors[16] = {};
+                    for (int i = 0; i < 16 && error < outFit.error; ++i) {
+                        if (IsInSecondSubBlock(i % 4, i / 4, isFlipped) != (subBlock == 1)) {
+                            continue;
+                        }
+                        int best = std::numeric_limits<int>::max();
+                        for (uint32_t selector = 0; selector < 4; ++selector) {
+                            const int candidate = SquaredError(colors[selector], pixels[i]);
+                            if (candidate < best) {
+                                best = candidate;
+                                selectors[i] = selector;
+                            }
+                        }
+                        error += best;
+                    }
+                    if (error < outFit.error) {
+                        outFit.error = error;
+                        outFit.table = table;
+                        std::copy(selectors, selectors + 16, outFit.selectors);
+                    }
+                }
+            }
+
+            void AverageSubBlock(const BlockPixels &pixels, bool isFlipped, int subBlock, float *outAverage)
+            {
+                outAverage[0] = outAverage[1] = outAverage[2] = 0.0f;
+                for (int i = 0; i < 16; ++i) {
+                    if (IsInSecondSubBlock(i % 4, i / 4, isFlipped) == (subBlock == 1)) {
+                        for (int channel = 0; channel < 3; ++channel) {
+                            outAverage[channel] += pixels[i][channel] / 8.0f;
+                        }
+                    }
+                }
+            }
+
+            // Try base colors around the quantized average of a sub-block, shifted in intensity, and
+            // keep the best. Differential mode passes the first sub-block's color to stay within reach.
+            void FitBaseColor(const BlockPixels &pixels, bool isFlipped, int subBlock, int bits,
+                              const int *reference, int *outQuantized, SubBlockFit &outFit)
+            {
+                const int maxValue = (1 << bits) - 1;
+                float average[3];
+                AverageSubBlock(pixels, isFlipped, subBlock, average);
+                for (int shift = -1; shift <= 1; ++shift) {
+                    int quantized[3];
+                    int base[3];
+                    for (int channel = 0; channel < 3; ++channel) {
+                        int value = static_cast<int>(std::lround(average[channel] * maxValue / 255.0f)) + shift;
+                        value = std::min(maxValue, std::max(0, value));
+                        if (reference != nullptr) {
+                            value = reference[channel] + std::min(3, std::max(-4, value - reference[channel]));
+                        }
+                        quantized[channel] = value;
+                        base[channel] = bits == 4 ? Extend4(value) : Extend5(value);
+                    }
+                    SubBlockFit fit;
+                    FitSubBlock(pixels, isFlipped, subBlock, base, fit);
+                    if (fit.error < outFit.error) {
+                        outFit = fit;
+                        std::copy(quantized, quantized + 3, outQuantized);
+                    }
+                }
+            }
+
+            // Best block in the ETC1 individual and differential modes.
+            int EncodeEtc1Block(const BlockPixels &pixels, uint64_t &outBits)
+            {
+                int bestError = std::numeric_limits<int>::max();
+                for (int flip = 0; flip < 2; ++flip) {
+                    const bool isFlipped = flip == 1;
+                    for (int differential = 0; differential < 2; ++differential) {
+                        const int bits = differential ? 5 : 4;
+                        int first[3] = {};
+                        int second[3] = {};
+                        SubBlockFit firstFit;
+                        SubBlockFit secondFit;
+                        FitBaseColor(pixels, isFlipped, 0, bits, nullptr, first, firstFit);
+                        FitBaseColor(pixels, isFlipped, 1, bits, differential ? first : nullptr, second, secondFit);
+                        const int error = firstFit.error + secondFit.error;
+                        if (error >= bestError) {
+                            continue;
+                        }
+                        bestError = error;
+                        uint64_t block = 0;
+                        if (differential) {
+                            block |= static_cast<uint64_t>(first[0]) << 59 | static_cast<uint64_t>(first[1]) << 51 |
+                                     static_cast<uint64_t>(first[2]) << 43;
+                            block |= static_cast<uint64_t>((second[0] - first[0]) & 7) << 56 |
+                                     static_cast<uint64_t>((second[1] - first[1]) & 7) << 48 |
+                                     static_cast<uint64_t>((second[2] - first[2]) & 7) << 40;
+                        } else {
+                            block |= static_cast<uint64_t>(first[0]) << 60 | static_cast<uint64_t>(second[0]) << 56 |
+                                     static_cast<uint64_t>(first[1]) << 52 | static_cast<uint64_t>(second[1]) << 48 |
+                                     static_cast<uint64_t>(first[2]) << 44 | static_cast<uint64_t>(second[2]) << 40;
+                        }
+                        block |= static_cast<uint64_t>(firstFit.table) << 37 |
+                                 static_cast<uint64_t>(secondFit.table) << 34 |
+                                 static_cast<uint64_t>(differential) << 33 | static_cast<uint64_t>(flip) << 32;
+                        for (int i = 0; i < 16; ++i) {
+                            const int x = i % 4;
+                            const int y = i / 4;
+                            const SubBlockFit &fit = IsInSecondSubBlock(x, y, isFlipped) ? secondFit : firstFit;
+                            block |= SelectorBits(x, y, fit.selectors[i]);
+                        }
+                        outBits = block;
+                    }
+                }
+                return bestError;
+            }
+
+            // Planar mode: the least-squares colors at the origin, the right and the bottom of the
+            // block, which the decoder interpolates linearly.
+            int EncodePlanarBlock(const BlockPixels &pixels, uint64_t &outBits)
+            {
+                // Normal equations of the weights (1 - x/4 - y/4, x/4, y/4), the same for every block.
+                static const auto inverse = []() {
+                    double matrix[3][3] = {};
+                    for (int i = 0; i < 16; ++i) {
+                        const double weights[3] = {1.0 - (i % 4) / 4.0 - (i / 4) / 4.0, (i % 4) / 4.0, (i / 4) / 4.0};
+                        for (int row = 0; row < 3; ++row) {
+                            for (int column = 0; column < 3; ++column) {
+                                matrix[row][column] += weights[row] * weights[column];
+                            }
+                        }
+                    }
+                    const double det =
+                        matrix[0][0] * (matrix[1][1] * matrix[2][2] - matrix[1][2] * matrix[2][1]) -
+                        matrix[0][1] * (matrix[1][0] * matrix[2][2] - matrix[1][2] * matrix[2][0]) +
+                        matrix[0][2] * (matrix[1][0] * matrix[2][1] - matrix[1][1] * matrix[2][0]);
+                    std::array<std::array<double, 3>, 3> result;
+                    for (int row = 0; row < 3; ++row) {
+                        for (int column = 0; column < 3; ++column) {
+                            // Cofactor of the transposed position, which is the adjugate.
+                            const int r0 = (column + 1) % 3;
+                            const int r1 = (column + 2) % 3;
+                            const int c0 = (row + 1) % 3;
+                            const int c1 = (row + 2) % 3;
+                            result[row][column] =
+                                (matrix[r0][c0] * matrix[r1][c1] - matrix[r0][c1] * matrix[r1][c0]) / det;
+                        }
+                    }
+                    return result;
+                }();
+
+                constexpr int channelBits[3] = {6, 7, 6};
+                int quantized[3][3]; // Origin, horizontal and vertical color, per channel.
+                int colors[3][3];
+                for (int channel = 0; channel < 3; ++channel) {
+                    double moments[3] = {};
+                    for (int i = 0; i < 16; ++i) {
+                        const double weights[3] = {1.0 - (i % 4) / 4.0 - (i / 4) / 4.0, (i % 4) / 4.0, (i / 4) / 4.0};
+                        for (int k = 0; k < 3; ++k) {
+                            moments[k] += weights[k] * pixels[i][channel];
+                        }
+                    }
+                    const int maxValue = (1 << channelBits[channel]) - 1;
+                    for (int k = 0; k < 3; ++k) {
+                        const double value = inverse[k][0] * moments[0] + inverse[k][1] * moments[1] +
+                                             inverse[k][2] * moments[2];
+                        quantized[k][channel] = std::min(maxValue,
+                            std::max(0, static_cast<int>(std::lround(value * maxValue / 255.0))));
+                        colors[k][channel] = channelBits[channel] == 7 ? Extend7(quantized[k][channel]) :
+                            Extend6(quantized[k][channel]);
+                    }
+                }
+                int error = 0;
+                for (int i = 0; i < 16; ++i) {
+                    int decoded[3];
+                    for (int channel = 0; channel < 3; ++channel) {
+                        const int origin = colors[0][channel];
+                        decoded[channel] = Clamp255(((i % 4) * (colors[1][channel] - origin) +
+                                                     (i / 4) * (colors[2][channel] - origin) + 4 * origin + 2) >> 2);
+                    }
+                    error += SquaredError(decoded, pixels[i]);
+                }
+
+                const uint64_t ro = quantized[0][0];
+                const uint64_t go = quantized[0][1];
+                const uint64_t bo = quantized[0][2];
+                const uint64_t rh = quantized[1][0];
+                uint64_t block = ro << 57 | (go >> 6) << 56 | (go & 63) << 49 | (bo >> 5) << 48 |
+                                 ((bo >> 3) & 3) << 43 | (bo & 7) << 39 | (rh >> 1) << 34 | 1ull << 33 |
+                                 (rh & 1) << 32 |
+                                 static_cast<uint64_t>(quantized[1][1]) << 25 |
+                                 static_cast<uint64_t>(quantized[1][2]) << 19 |
+                                 static_cast<uint64_t>(quantized[2][0]) << 13 |
+                                 static_cast<uint64_t>(quantized[2][1]) << 6 | static_cast<uint64_t>(quantized[2][2]);
+                // The decoder recognizes the planar mode when red and green stay in range in the
+                // differential interpretation and blue does not. The unused bits steer them there.
+                if (static_cast<int>(Bits(block, 63, 59)) + SignExtend3(Bits(block, 58, 56)) < 0) {
+                    block |= 1ull << 63;
+                }
+                if (static_cast<int>(Bits(block, 55, 51)) + SignExtend3(Bits(block, 50, 48)) < 0) {
+                    block |= 1ull << 55;
+                }
+                if (Bits(block, 44, 43) + Bits(block, 41, 40) >= 4) {
+                    block |= 7ull << 45;
+                } else {
+                    block |= 1ull << 42;
+                }
+                outBits = block;
+                return error;
+            }
+
+            void PaintBlock(uint64_t bits, const int (*paintColors)[3], uint8_t *outRgb)
+            {
+                for (int y = 0; y < 4; ++y) {
+                    for (int x = 0; x < 4; ++x) {
+                        const int *color = paintColors[ReadSelector(bits, x, y)];
+                        for (int channel = 0; channel < 3; ++channel) {
+                            outRgb[(y * 4 + x) * 3 + channel] = static_cast<uint8_t>(Clamp255(color[channel]));
+                        }
+                    }
+                }
+            }
+        }
+
+        void EncodeEtc2Rgb(const uint8_t *rgb, uint32_t width, uint32_t height, bool isEtc1Only,
+                           std::vector<uint8_t> &outBlocks)
+        {
+            const uint32_t blocksWide = (width + 3) / 4;
+            const uint32_t blocksHigh = (height + 3) / 4;
+            outBlocks.resize(static_cast<size_t>(blocksWide) * blocksHigh * ETC_BLOCK_SIZE);
+            for (uint32_t blockY = 0; blockY < blocksHigh; ++blockY) {
+                for (uint32_t blockX = 0; blockX < blocksWide; ++blockX) {
+                    BlockPixels pixels;
+                    for (int i = 0; i < 16; ++i) {
+                        const uint32_t x = std::min(width - 1, blockX * 4 + i % 4);
+                        const uint32_t y = std::min(height - 1, blockY * 4 + i / 4);
+                        for (int channel = 0; channel < 3; ++channel) {
+                            pixels[i][channel] = rgb[(static_cast<size_t>(y) * width + x) * 3 + channel];
+                        }
+                    }
+                    uint64_t bits = 0;
+                    const int etc1Error = EncodeEtc1Block(pixels, bits);
+                    uint64_t planarBits = 0;
+                    if (!isEtc1Only && etc1Error > 0 && EncodePlanarBlock(pixels, planarBits) < etc1Error) {
+                        bits = planarBits;
+                    }
+                    WriteBlock(bits, &outBlocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * ETC_BLOCK_SIZE]);
+                }
+            }
+        }
+
+        void DecodeEtc2Block(const uint8_t *block, uint8_t *outRgb)
+        {
+            const uint64_t bits = ReadBlock(block);
+            const bool isDifferential = Bits(bits, 33, 33) != 0;
+            if (isDifferential) {
+                const int red = static_cast<int>(Bits(bits, 63, 59)) + SignExtend3(Bits(bits, 58, 56));
+                const int green = static_cast<int>(Bits(bits, 55, 51)) + SignExtend3(Bits(bits, 50, 48));
+                const int blue = static_cast<int>(Bits(bits, 47, 43)) + SignExtend3(Bits(bits, 42, 40));
+                if (red < 0 || red > 31) {
+                    // T mode: one color, and three colors around the other one.
+                    const int first[3] = {
+                        Extend4(static_cast<int>((Bits(bits, 60, 59) << 2) | Bits(bits, 57, 56))),
+                        Extend4(static_cast<int>(Bits(bits, 55, 52))), Extend4(static_cast<int>(Bits(bits, 51, 48)))
+                    };
+                    const int second[3] = {
+                        Extend4(static_cast<int>(Bits(bits, 47, 44))), Extend4(static_cast<int>(Bits(bits, 43, 40))),
+                        Extend4(static_cast<int>(Bits(bits, 39, 36)))
+                    };
+                    const int distance = ETC_DISTANCES[(Bits(bits, 35, 34) << 1) | Bits(bits, 32, 32)];
+                    int paintColors[4][3];
+                    for (int channel = 0; channel < 3; ++channel) {
+                        paintColors[0][channel] = first[channel];
+                        paintColors[1][channel] = second[channel] + distance;
+                        paintColors[2][channel] = second[channel];
+                        paintColors[3][channel] = second[channel] - distance;
+                    }
+                    PaintBlock(bits, paintColors, outRgb);
+                    return;
+                }
+                if (green < 0 || green > 31) {
+                    // H mode: two colors around each of two base colors.
+                    const int first4[3] = {
+                        static_cast<int>(Bits(bits, 62, 59)),
+                        static_cast<int>((Bits(bits, 58, 56) << 1) | Bits(bits, 52, 52)),
+                        static_cast<int>((Bits(bits, 51, 51) << 3) | Bits(bits, 49, 47))
+                    };
+                    const int second4[3] = {
+                        static_cast<int>(Bits(bits, 46, 43)), static_cast<int>(Bits(bits, 42, 39)),
+                        static_cast<int>(Bits(bits, 38, 35))
+                    };
+                    // The order of the base colors stores the lowest bit of the distance index.
+                    const int firstValue = (first4[0] << 8) | (first4[1] << 4) | first4[2];
+                    const int secondValue = (second4[0] << 8) | (second4[1] << 4) | second4[2];
+                    const int distance = ETC_DISTANCES[(Bits(bits, 34, 34) << 2) | (Bits(bits, 32, 32) << 1) |
+                                                       (firstValue >= secondValue ? 1 : 0)];
+                    int paintColors[4][3];
+                    for (int channel = 0; channel < 3; ++channel) {
+                        paintColors[0][channel] = Extend4(first4[channel]) + distance;
+                        paintColors[1][channel] = Extend4(first4[channel]) - distance;
+                        paintColors[2][channel] = Extend4(second4[channel]) + distance;
+                        paintColors[3][channel] = Extend4(second4[channel]) - distance;
+                    }
+                    PaintBlock(bits, paintColors, outRgb);
+                    return;
+                }
+                if (blue < 0 || blue > 31) {
+                    // Planar mode: colors interpolated from the origin, the right and the bottom.
+                    const int origin[3] = {
+                        Extend6(static_cast<int>(Bits(bits, 62, 57))),
+                        Extend7(static_cast<int>((Bits(bits, 56, 56) << 6) | Bits(bits, 54, 49))),
+                        Extend6(static_cast<int>((Bits(bits, 48, 48) << 5) | (Bits(bits, 44, 43) << 3) |
+                                                 Bits(bits, 41, 39)))
+                    };
+                    const int horizontal[3] = {
+                        Extend6(static_cast<int>((Bits(bits, 38, 34) << 1) | Bits(bits, 32, 32))),
+                        Extend7(static_cast<int>(Bits(bits, 31, 25))), Extend6(static_cast<int>(Bits(bits, 24, 19)))
+                    };
+                    const int vertical[3] = {
+                        Extend6(static_cast<int>(Bits(bits, 18, 13))), Extend7(static_cast<int>(Bits(bits, 12, 6))),
+                        Extend6(static_cast<int>(Bits(bits, 5, 0)))
+                    };
+                    for (int y = 0; y < 4; ++y) {
+                        for (int x = 0; x < 4; ++x) {
+                            for (int channel = 0; channel < 3; ++channel) {
+                                const int value = (x * (horizontal[channel] - origin[channel]) +
+                                                   y * (vertical[channel] - origin[channel]) + 4 * origin[channel] +
+                                                   2) >> 2;
+                                outRgb[(y * 4 + x) * 3 + channel] = static_cast<uint8_t>(Clamp255(value));
+                            }
+                        }
+                    }
+                    return;
+                }
+            }
+
+            // ETC1 modes: two sub-blocks, each with a base color and a table of intensity modifiers.
+            int bases[2][3];
+            for (int channel = 0; channel < 3; ++channel) {
+                const int high = 63 - channel * 8;
+                if (isDifferential) {
+                    const int first = static_cast<int>(Bits(bits, high, high - 4));
+                    bases[0][channel] = Extend5(first);
+                    bases[1][channel] = Extend5(first + SignExtend3(Bits(bits, high - 5, high - 7)));
+                } else {
+                    bases[0][channel] = Extend4(static_cast<int>(Bits(bits, high, high - 3)));
+                    bases[1][channel] = Extend4(static_cast<int>(Bits(bits, high - 4, high - 7)));
+                }
+            }
+            const uint32_t tables[2] = {Bits(bits, 39, 37), Bits(bits, 36, 34)};
+            const bool isFlipped = Bits(bits, 32, 32) != 0;
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    const int subBlock = IsInSecondSubBlock(x, y, isFlipped) ? 1 : 0;
+                    const uint32_t selector = ReadSelector(bits, x, y);
+                    const int modifier = ETC_MODIFIER_TABLES[tables[subBlock]][selector & 1];
+                    for (int channel = 0; channel < 3; ++channel) {
+                        const int value = bases[subBlock][channel] + (selector >= 2 ? -modifier : modifier);
+                        outRgb[(y * 4 + x) * 3 + channel] = static_cast<uint8_t>(Clamp255(value));
+                    }
+                }
+            }
+        }
+
+        void DecodeEtc2Rgb(const uint8_t *blocks, uint32_t width, uint32_t height, std::vector<uint8_t> &outRgb)
+        {
+            const uint32_t blocksWide = (width + 3) / 4;
+            const uint32_t blocksHigh = (height + 3) / 4;
+            outRgb.resize(static_cast<size_t>(width) * height * 3);
+            uint8_t decoded[16 * 3];
+            for (uint32_t blockY = 0; blockY < blocksHigh; ++blockY) {
+                for (uint32_t blockX = 0; blockX < blocksWide; ++blockX) {
+                    DecodeEtc2Block(blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * ETC_BLOCK_SIZE,
+                                    decoded);
+                    for (uint32_t y = blockY * 4; y < std::min(height, blockY * 4 + 4); ++y) {
+                        for (uint32_t x = blockX * 4; x < std::min(width, blockX * 4 + 4); ++x) {
+                            std::copy_n(&decoded[((y % 4) * 4 + x % 4) * 3], 3,
+                                        &outRgb[(static_cast<size_t>(y) * width + x) * 3]);
+                        }
+                    }
+                }
+            }
+        }
+
+        void DownsampleRgb(const std::vector<uint8_t> &rgb, uint32_t width, uint32_t height,
+                           std::vector<uint8_t> &outRgb)
+        {
+            const uint32_t halfWidth = std::max(1u, width / 2);
+            const uint32_t halfHeight = std::max(1u, height / 2);
+            outRgb.resize(static_cast<size_t>(halfWidth) * halfHeight * 3);
+            for (uint32_t y = 0; y < halfHeight; ++y) {
+                const uint32_t y0 = std::min(height - 1, y * 2);
+                const uint32_t y1 = std::min(height - 1, y * 2 + 1);
+                for (uint32_t x = 0; x < halfWidth; ++x) {
+                    const uint32_t x0 = std::min(width - 1, x * 2);
+                    const uint32_t x1 = std::min(width - 1, x * 2 + 1);
+                    for (int channel = 0; channel < 3; ++channel) {
+                        const int sum = rgb[(static_cast<size_t>(y0) * width + x0) * 3 + channel] +
+                                        rgb[(static_cast<size_t>(y0) * width + x1) * 3 + channel] +
+                                        rgb[(static_cast<size_t>(y1) * width + x0) * 3 + channel] +
+                                        rgb[(static_cast<size_t>(y1) * width + x1) * 3 + channel];
+                        outRgb[(static_cast<size_t>(y) * halfWidth + x) * 3 + channel] =
+                            static_cast<uint8_t>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        double ComputePsnr(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b)
+        {
+            double squaredError = 0.0;
+            for (size_t i = 0; i < a.size(); ++i) {
+                const double difference = static_cast<double>(a[i]) - b[i];
+                squaredError += difference * difference;
+            }
+            if (squaredError == 0.0) {
+                return std::numeric_limits<double>::infinity();
+            }
+            return 10.0 * std::log10(255.0 * 255.0 * a.size() / squaredError);
+        }
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_ETC_CODEC_H
+#define C_ARENGINE_HELLOE_AR_ETC_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    namespace host {
+        // Bytes of an ETC1 or ETC2 RGB8 block of 4x4 pixels.
+        constexpr size_t ETC_BLOCK_SIZE = 8;
+
+        /**
+         * Encode RGB pixels into ETC2 RGB8 blocks. Each block is tried in the individual and
+         * differential modes of ETC1, with both sub-block orientations, and in the planar mode of
+         * ETC2, which suits smooth gradients; the mode with the smallest squared error is kept.
+         * Blocks past the image edge repeat its last row and column.
+         *
+         * @param rgb Pixels, three bytes each, rows tightly packed from the top.
+         * @param width Width of the image in pixels.
+         * @param height Height of the image in pixels.
+         * @param isEtc1Only Leave out the planar mode, so ETC1 decoders can read the blocks.
+         * @param outBlocks Receives the blocks, row by row.
+         */
+        void EncodeEtc2Rgb(const uint8_t *rgb, uint32_t width, uint32_t height, bool isEtc1Only,
+                           std::vector<uint8_t> &outBlocks);
+
+        /**
+         * Decode one ETC1 or ETC2 RGB8 block, in any of the five ETC2 modes.
+         *
+         * @param block Eight bytes of the block.
+         * @param outRgb Receives the 4x4 pixels, three bytes each, row by row.
+         */
+        void DecodeEtc2Block(const uint8_t *block, uint8_t *outRgb);
+
+        /**
+         * Decode ETC1 or ETC2 RGB8 blocks into RGB pixels.
+         *
+         * @param blocks Blocks of the image, row by row.
+         * @param width Width of the image in pixels.
+         * @param height Height of the image in pixels.
+         * @param outRgb Receives the pixels, three bytes each, rows tightly packed from the top.
+         */
+        void DecodeEtc2Rgb(const uint8_t *blocks, uint32_t width, uint32_t height, std::vector<uint8_t> &outRgb);
+
+        /**
+         * Halve an RGB image with a box filter, the way glGenerateMipmap does for power of two sizes.
+         *
+         * @param rgb Pixels, three bytes each.
+         * @param width Width of the image in pixels.
+         * @param height Height of the image in pixels.
+         * @param outRgb Receives the next mip level, of max(1, width / 2) by max(1, height / 2) pixels.
+         */
+        void DownsampleRgb(const std::vector<uint8_t> &rgb, uint32_t width, uint32_t height,
+                           std::vector<uint8_t> &outRgb);
+
+        /**
+         * Peak signal to noise ratio between two images of the same size, over all channels.
+         *
+         * @param a First image.
+         * @param b Second image.
+         * @return PSNR in dB, infinite for identical images.
+         */
+        double ComputePsnr(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b);
+    }
+}
+#endif
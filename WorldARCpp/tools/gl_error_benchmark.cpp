@@ -0,0 +1,135 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <GLES2/gl2.h>
+
+#include "host_gl.h"
+#include "utils/gl_error.h"
+#include "utils/log.h"
+#include "utils/program_builder.h"
+
+namespace {
+    constexpr char VERTEX_SHADER[] = R"(
+    attribute vec4 a_Position;
+    uniform vec4 u_Offset;
+    void main() {
+        gl_Position = a_Position + u_Offset;
+    })";
+
+    constexpr char FRAGMENT_SHADER[] = R"(
+    precision mediump float;
+    void main() {
+        gl_FragColor = vec4(1.0);
+    })";
+
+    const GLfloat TRIANGLE[] = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+
+    const char *GetModeName(gWorldAr::util::GlErrorCheckMode mode)
+    {
+        switch (mode) {
+            case gWorldAr::util::GlErrorCheckMode::OFF:
+                return "off";
+            case gWorldAr::util::GlErrorCheckMode::PER_FRAME:
+                return "per-frame";
+            case gWorldAr::util::GlErrorCheckMode::PER_CALL:
+                return "per-call";
+            case gWorldAr::util::GlErrorCheckMode::KHR_DEBUG:
+                return "KHR_debug";
+        }
+        return "unknown";
+    }
+
+    // Frames of draws with the error checks the renderers and the application make. The last frame is
+    // finished, so the time includes the work the checks may wait for. Returns the mean of the fastest
+    // of several rounds, since the host's other work only ever adds time.
+    double DrawFrames(GLint offsetLocation, size_t drawCount, int frameCount)
+    {
+        constexpr int ROUND_COUNT = 5;
+        double fastestMs = 0.0;
+        for (int round = 0; round < ROUND_COUNT; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; ++frame) {
+                glClear(GL_COLOR_BUFFER_BIT);
+                for (size_t draw = 0; draw < drawCount; ++draw) {
+                    glUniform4f(offsetLocation, static_cast<float>(draw % 7) * 0.01f, 0.0f, 0.0f, 0.0f);
+                    glDrawArrays(GL_TRIANGLES, 0, 3);
+                    gWorldAr::util::CheckGlError("DrawFrames");
+                }
+                gWorldAr::util::CheckGlFrameError("DrawFrames");
+            }
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double ms = elapsed.count() / frameCount;
+            fastestMs = (round == 0) ? ms : std::min(fastestMs, ms);
+        }
+        return fastestMs;
+    }
+}
+
+// Times frames of draws under every GL error check mode on the OpenGL ES driver of the host, and checks
+// that the GL_KHR_debug callback receives errors. The stall glGetError causes depends on the driver, so
+// the differences on a device can be far larger than on the host.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int frameCount = argc > 1 ? atoi(argv[1]) : 200;
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    util::ProgramBuilder builder;
+    GLuint program = builder.Take(builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER));
+    CHECK(program != 0);
+    glUseProgram(program);
+    const GLint offsetLocation = glGetUniformLocation(program, "u_Offset");
+    const GLint positionLocation = glGetAttribLocation(program, "a_Position");
+    glEnableVertexAttribArray(positionLocation);
+    glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, TRIANGLE);
+
+    const util::GlErrorCheckMode modes[] = {util::GlErrorCheckMode::OFF, util::GlErrorCheckMode::PER_FRAME,
+                                            util::GlErrorCheckMode::PER_CALL, util::GlErrorCheckMode::KHR_DEBUG};
+    for (size_t drawCount : {10, 100, 1000}) {
+        double offMs = 0.0;
+        for (util::GlErrorCheckMode mode : modes) {
+            util::GlErrorCheckMode appliedMode = util::SetGlErrorCheckMode(mode);
+            double ms = DrawFrames(offsetLocation, drawCount, frameCount);
+            if (mode == util::GlErrorCheckMode::OFF) {
+                offMs = ms;
+            }
+            printf("%4zu draws  %-9s (%-9s) %8.4f ms per frame  %+6.1f%%\n", drawCount, GetModeName(mode),
+                   GetModeName(appliedMode), ms, (ms / offMs - 1.0) * 100.0);
+        }
+    }
+
+    // Errors reach the debug callback, without a glGetError call.
+    if (util::SetGlErrorCheckMode(util::GlErrorCheckMode::KHR_DEBUG) == util::GlErrorCheckMode::KHR_DEBUG) {
+        const size_t errorCount = util::GetGlDebugErrorCount();
+        glEnable(GL_TEXTURE_2D);
+        glFinish();
+        CHECK(util::GetGlDebugErrorCount() == errorCount + 1);
+        printf("KHR_debug callback received the error\n");
+    }
+    util::SetGlErrorCheckMode(util::GlErrorCheckMode::OFF);
+    CHECK(util::GetGlErrorCheckMode() == util::GlErrorCheckMode::OFF);
+    return 0;
+}
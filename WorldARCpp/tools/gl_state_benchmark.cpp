@@ -0,0 +1,257 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <GLES2/gl2.h>
+
+#include "host_gl.h"
+#include "host_util.h"
+#include "utils/gl_state.h"
+#include "utils/log.h"
+#include "utils/program_builder.h"
+
+namespace {
+    constexpr char VERTEX_SHADER[] = R"(
+    attribute vec4 a_Position;
+    attribute vec2 a_TexCoord;
+    attribute vec3 a_Normal;
+    varying vec2 v_TexCoord;
+    void main() {
+        v_TexCoord = a_TexCoord + a_Normal.xy;
+        gl_Position = a_Position;
+    })";
+
+    constexpr char FRAGMENT_SHADER[] = R"(
+    precision mediump float;
+    uniform sampler2D u_Texture;
+    varying vec2 v_TexCoord;
+    void main() {
+        gl_FragColor = texture2D(u_Texture, v_TexCoord);
+    })";
+
+    const GLfloat TRIANGLE[] = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+
+    // Programs and textures standing in for the background, object, plane and point cloud renderers.
+    struct Scene {
+        GLuint programs[4] = {};
+        GLuint textures[2] = {};
+        size_t anchorCount = 0;
+        size_t planeCount = 0;
+    };
+
+    // GL calls of one draw: attribute pointers and the draw itself, identical in both variants.
+    void Draw(size_t attribCount)
+    {
+        for (GLuint index = 0; index < attribCount; ++index) {
+            glVertexAttribPointer(index, 3, GL_FLOAT, GL_FALSE, 0, TRIANGLE);
+        }
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // The state calls the renderers made before the state cache: each draw sets its state and resets it.
+    size_t DrawFrameDirectly(const Scene &scene)
+    {
+        size_t calls = 0;
+        auto count = [&calls](size_t callCount) { calls += callCount; };
+        glDepthMask(GL_TRUE);
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        glEnable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        count(5);
+
+        glUseProgram(scene.programs[0]);
+        glDepthMask(GL_FALSE);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, scene.textures[0]);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        Draw(2);
+        glUseProgram(0);
+        glDepthMask(GL_TRUE);
+        count(8);
+
+        for (size_t anchor = 0; anchor < scene.anchorCount; ++anchor) {
+            glUseProgram(scene.programs[1]);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, scene.textures[1]);
+            glEnableVertexAttribArray(0);
+            glEnableVertexAttribArray(1);
+            glEnableVertexAttribArray(2);
+            Draw(3);
+            glDisableVertexAttribArray(0);
+            glDisableVertexAttribArray(1);
+            glDisableVertexAttribArray(2);
+            glUseProgram(0);
+            count(10);
+        }
+        for (size_t plane = 0; plane < scene.planeCount; ++plane) {
+            glUseProgram(scene.programs[2]);
+            glDepthMask(GL_FALSE);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, scene.textures[1]);
+            glEnableVertexAttribArray(0);
+            Draw(1);
+            glUseProgram(0);
+            glDepthMask(GL_TRUE);
+            count(7);
+        }
+        glUseProgram(scene.programs[3]);
+        glEnableVertexAttribArray(0);
+        Draw(1);
+        glUseProgram(0);
+        count(3);
+        return calls;
+    }
+
+    // The same frame through the state cache, as the renderers draw it now.
+    void DrawFrameCached(const Scene &scene)
+    {
+        gWorldAr::util::GlStateCache &state = gWorldAr::util::GetGlState();
+        state.DepthMask(GL_TRUE);
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        state.SetCapability(GL_CULL_FACE, true);
+        state.SetCapability(GL_DEPTH_TEST, true);
+        state.SetCapability(GL_BLEND, true);
+        state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        state.UseProgram(scene.programs[0]);
+        state.DepthMask(GL_FALSE);
+        state.ActiveTexture(GL_TEXTURE1);
+        state.BindTexture(GL_TEXTURE_2D, scene.textures[0]);
+        state.SetVertexAttribArrays(0x3);
+        Draw(2);
+
+        for (size_t anchor = 0; anchor < scene.anchorCount; ++anchor) {
+            state.UseProgram(scene.programs[1]);
+            state.DepthMask(GL_TRUE);
+            state.ActiveTexture(GL_TEXTURE0);
+            state.BindTexture(GL_TEXTURE_2D, scene.textures[1]);
+            state.SetVertexAttribArrays(0x7);
+            Draw(3);
+        }
+        for (size_t plane = 0; plane < scene.planeCount; ++plane) {
+            state.UseProgram(scene.programs[2]);
+            state.DepthMask(GL_FALSE);
+            state.ActiveTexture(GL_TEXTURE0);
+            state.BindTexture(GL_TEXTURE_2D, scene.textures[1]);
+            state.SetVertexAttribArrays(0x1);
+            Draw(1);
+        }
+        state.UseProgram(scene.programs[3]);
+        state.DepthMask(GL_TRUE);
+        state.SetVertexAttribArrays(0x1);
+        Draw(1);
+    }
+
+    // The context must hold the values the cache skipped calls for.
+    void CheckContextState(const Scene &scene)
+    {
+        GLint value = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+        CHECK(static_cast<GLuint>(value) == scene.programs[3]);
+        GLboolean depthMask = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+        CHECK(depthMask == GL_TRUE);
+        CHECK(glIsEnabled(GL_BLEND) && glIsEnabled(GL_CULL_FACE) && glIsEnabled(GL_DEPTH_TEST));
+        for (GLuint index = 0; index < 3; ++index) {
+            glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &value);
+            CHECK((value != 0) == (index == 0));
+        }
+        glActiveTexture(GL_TEXTURE1);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+        CHECK(static_cast<GLuint>(value) == scene.textures[0]);
+        glActiveTexture(GL_TEXTURE0);
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+        CHECK(static_cast<GLuint>(value) == (scene.anchorCount + scene.planeCount > 0 ? scene.textures[1] : 0));
+        CHECK(glGetError() == GL_NO_ERROR);
+    }
+
+    void Compare(Scene &scene, size_t anchorCount, size_t planeCount, int iterations)
+    {
+        using namespace gWorldAr;
+        scene.anchorCount = anchorCount;
+        scene.planeCount = planeCount;
+        size_t directCalls = 0;
+        double directMs = host::MeasureMs(iterations, [&]() {
+            directCalls = DrawFrameDirectly(scene);
+        });
+        glFinish();
+
+        // The direct frame left the state unknown to the cache, and the active unit may differ.
+        util::GlStateCache &state = util::GetGlState();
+        state.Invalidate();
+        DrawFrameCached(scene);
+        state.ResetStats();
+        double cachedMs = host::MeasureMs(iterations, [&]() {
+            DrawFrameCached(scene);
+        });
+        glFinish();
+        CheckContextState(scene);
+        const util::GlStateStats &stats = state.GetStats();
+        double issued = static_cast<double>(stats.issuedCalls) / iterations;
+        double skipped = static_cast<double>(stats.skippedCalls) / iterations;
+        printf("%3zu anchors %3zu planes  direct %5zu calls %8.3f ms  cached %5.1f issued %6.1f skipped "
+               "%8.3f ms\n", anchorCount, planeCount, directCalls, directMs, issued, skipped, cachedMs);
+        CHECK(stats.issuedCalls + stats.skippedCalls >= directCalls / 2 * iterations);
+    }
+}
+
+// Counts the GL state calls of a frame with the state set and reset around every draw, as the renderers
+// did, and through the state cache, which skips every call that sets the current value. Runs on the
+// OpenGL ES driver of the host, so the times show the driver overhead of the calls on the CPU only.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    Scene scene;
+    util::ProgramBuilder builder;
+    size_t ids[4];
+    for (size_t &id : ids) {
+        id = builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER);
+    }
+    for (size_t program = 0; program < 4; ++program) {
+        scene.programs[program] = builder.Take(ids[program]);
+        CHECK(scene.programs[program] != 0);
+        // The attribute locations must match the masks of the draws.
+        glBindAttribLocation(scene.programs[program], 0, "a_Position");
+        glBindAttribLocation(scene.programs[program], 1, "a_TexCoord");
+        glBindAttribLocation(scene.programs[program], 2, "a_Normal");
+        glLinkProgram(scene.programs[program]);
+    }
+    const GLubyte pixel[4] = {255, 255, 255, 255};
+    glGenTextures(2, scene.textures);
+    for (GLuint texture : scene.textures) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    Compare(scene, 0, 0, iterations);
+    Compare(scene, 1, 1, iterations);
+    Compare(scene, 10, 5, iterations);
+    Compare(scene, 50, 20, iterations);
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "glb_writer.h"
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/glb_format.h"
+#include "utils/log.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    using namespace gWorldAr::util;
+
+    struct Mesh {
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<uint32_t> indices;
+    };
+
+    struct Encoding {
+        const char *name;
+        gWorldAr::host::GlbEncoding types;
+        float positionTolerance; // Relative to the largest coordinate.
+        float normalTolerance;
+        float uvTolerance;
+    };
+
+    float LargestDifference(const std::vector<float> &expected, const std::vector<float> &actual, float scale)
+    {
+        CHECK(expected.size() == actual.size());
+        float difference = 0.0f;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            difference = std::max(difference, std::fabs(expected[i] - actual[i] * scale));
+        }
+        return difference;
+    }
+
+    std::vector<uint32_t> ReadIndices(const GlbAccessor &accessor)
+    {
+        std::vector<uint32_t> indices(accessor.count);
+        const size_t size = GetGlbComponentSize(accessor.componentType);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            memcpy(&indices[i], static_cast<const uint8_t *>(accessor.data) + i * size, size);
+        }
+        return indices;
+    }
+
+    void Compare(const char *name, const std::string &obj, int iterations)
+    {
+        using namespace gWorldAr;
+        Mesh mesh;
+        double objMs = host::MeasureMs(iterations, [&]() {
+            mesh = Mesh();
+            CHECK(ParseObj(obj.data(), obj.size(), mesh.vertices, mesh.normals, mesh.uvs, mesh.indices));
+        });
+        printf("%-24s obj   %9zu bytes  parse %9.3f ms\n", name, obj.size(), objMs);
+
+        float extent = 0.0f;
+        for (float coordinate : mesh.vertices) {
+            extent = std::max(extent, std::fabs(coordinate));
+        }
+        const Encoding encodings[] = {
+            {"float", {GLB_COMPONENT_FLOAT, GLB_COMPONENT_FLOAT, GLB_COMPONENT_FLOAT}, 0.0f, 0.0f, 0.0f},
+            {"half", {GLB_COMPONENT_HALF_FLOAT, GLB_COMPONENT_HALF_FLOAT, GLB_COMPONENT_HALF_FLOAT},
+             1e-3f, 1e-3f, 1e-3f},
+            {"short/byte/ushort", {GLB_COMPONENT_SHORT, GLB_COMPONENT_BYTE, GLB_COMPONENT_UNSIGNED_SHORT},
+             1e-4f, 1e-2f, 1e-4f},
+        };
+        for (const Encoding &encoding : encodings) {
+            std::vector<uint8_t> file;
+            float positionScale = 1.0f;
+            CHECK(host::WriteGlbFile(mesh.vertices, mesh.normals, mesh.uvs, mesh.indices, encoding.types, file,
+                                     positionScale));
+            GlbPrimitive primitive;
+            double glbMs = host::MeasureMs(iterations, [&]() {
+                CHECK(ReadGlbPrimitive(file.data(), file.size(), primitive));
+            });
+
+            // The accessors point into the file and hold the mesh as it was written.
+            const auto *begin = file.data();
+            CHECK(primitive.position.data > begin && primitive.position.data < begin + file.size());
+            CHECK(primitive.position.count == mesh.vertices.size() / 3);
+            CHECK(ReadIndices(primitive.indices) == mesh.indices);
+            std::vector<float> values;
+            ReadGlbAccessor(primitive.position, values);
+            CHECK(LargestDifference(mesh.vertices, values, positionScale) <= encoding.positionTolerance * extent);
+            ReadGlbAccessor(primitive.normal, values);
+            CHECK(LargestDifference(mesh.normals, values, 1.0f) <= encoding.normalTolerance);
+            ReadGlbAccessor(primitive.uv, values);
+            CHECK(LargestDifference(mesh.uvs, values, 1.0f) <= encoding.uvTolerance);
+            printf("%-24s glb   %9zu bytes  read  %9.3f ms  %8.0fx  %s\n", "", file.size(), glbMs, objMs / glbMs,
+                   encoding.name);
+        }
+    }
+
+    // Files that would make GL read outside the buffer are rejected.
+    void CheckMalformed()
+    {
+        using namespace gWorldAr;
+        Mesh mesh;
+        std::string obj = host::GenerateSphereObj(8, 8);
+        CHECK(ParseObj(obj.data(), obj.size(), mesh.vertices, mesh.normals, mesh.uvs, mesh.indices));
+        std::vector<uint8_t> file;
+        float positionScale;
+        CHECK(host::WriteGlbFile(mesh.vertices, mesh.normals, mesh.uvs, mesh.indices,
+                                 {GLB_COMPONENT_FLOAT, GLB_COMPONENT_FLOAT, GLB_COMPONENT_FLOAT}, file, positionScale));
+        GlbPrimitive primitive;
+        CHECK(ReadGlbPrimitive(file.data(), file.size(), primitive));
+        CHECK(!ReadGlbPrimitive(file.data(), file.size() - 4, primitive));
+
+        std::vector<uint8_t> badMagic = file;
+        badMagic[0] = 'x';
+        CHECK(!ReadGlbPrimitive(badMagic.data(), badMagic.size(), primitive));
+
+        // Point the last index past the last vertex; indices are stored as bytes for this sphere.
+        CHECK(primitive.indices.componentType == GLB_COMPONENT_UNSIGNED_BYTE && mesh.vertices.size() / 3 < 255);
+        std::vector<uint8_t> badIndex = file;
+        size_t firstIndex = static_cast<const uint8_t *>(primitive.indices.data) - file.data();
+        badIndex[firstIndex + primitive.indices.count - 1] = 255;
+        CHECK(!ReadGlbPrimitive(badIndex.data(), badIndex.size(), primitive));
+    }
+}
+
+// Compares parsing obj text with mapping glb models, whose vertex data GL reads in place, and checks
+// every supported attribute type round-trips.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    Compare("AR_logo.obj", std::string(logo.begin(), logo.end()), iterations);
+    Compare("sphere 400x400", host::GenerateSphereObj(400, 400), iterations);
+    CheckMalformed();
+    return 0;
+}
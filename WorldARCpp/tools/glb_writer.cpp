@@ -0,0 +1,198 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "glb_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "utils/glb_format.h"
+
+namespace gWorldAr {
+    namespace host {
+        namespace {
+            using namespace gWorldAr::util;
+
+            size_t AlignTo4(size_t offset)
+            {
+                return (offset + 3) & ~static_cast<size_t>(3);
+            }
+
+            uint16_t FloatToHalf(float value)
+            {
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+                const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+                const uint32_t mantissa = bits & 0x7FFFFF;
+                if (exponent >= 0x1F) {
+                    return sign | 0x7C00;
+                }
+                if (exponent <= 0) {
+                    // Subnormal halves, rounded to the nearest multiple of 2^-24.
+                    return sign | static_cast<uint16_t>(std::lround(std::fabs(value) * 16777216.0f));
+                }
+                // Round to nearest; a carry out of the mantissa correctly bumps the exponent.
+                uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+                half += (mantissa >> 12) & 1;
+                return sign | static_cast<uint16_t>(std::min<uint32_t>(half, 0x7C00));
+            }
+
+            // Round a value to a normalized integer with the given largest value.
+            long Normalize(float value, float lowest, float largest)
+            {
+                return std::lround(std::max(lowest, std::min(1.0f, value)) * largest);
+            }
+
+            void WriteComponents(const float *values, uint32_t count, uint32_t componentType, float scale,
+                                 uint8_t *out)
+            {
+                for (uint32_t i = 0; i < count; ++i) {
+                    const float value = values[i] * scale;
+                    switch (componentType) {
+                        case GLB_COMPONENT_BYTE: {
+                            auto packed = static_cast<int8_t>(Normalize(value, -1.0f, 127.0f));
+                            memcpy(out + i, &packed, sizeof(packed));
+                            break;
+                        }
+                        case GLB_COMPONENT_UNSIGNED_BYTE:
+                            out[i] = static_cast<uint8_t>(Normalize(value, 0.0f, 255.0f));
+                            break;
+                        case GLB_COMPONENT_SHORT: {
+                            auto packed = static_cast<int16_t>(Normalize(value, -1.0f, 32767.0f));
+                            memcpy(out + i * 2, &packed, sizeof(packed));
+                            break;
+                        }
+                        case GLB_COMPONENT_UNSIGNED_SHORT: {
+                            auto packed = static_cast<uint16_t>(Normalize(value, 0.0f, 65535.0f));
+                            memcpy(out + i * 2, &packed, sizeof(packed));
+                            break;
+                        }
+                        case GLB_COMPONENT_HALF_FLOAT: {
+                            uint16_t packed = FloatToHalf(value);
+                            memcpy(out + i * 2, &packed, sizeof(packed));
+                            break;
+                        }
+                        default:
+                            memcpy(out + i * 4, &value, sizeof(value));
+                            break;
+                    }
+                }
+            }
+
+            bool IsInteger(uint32_t componentType)
+            {
+                return componentType != GLB_COMPONENT_FLOAT && componentType != GLB_COMPONENT_HALF_FLOAT;
+            }
+
+            std::string AccessorJson(uint32_t bufferView, size_t byteOffset, uint32_t componentType, size_t count,
+                                     const char *type, bool normalized)
+            {
+                char json[256];
+                snprintf(json, sizeof(json),
+                         R"({"bufferView":%u,"byteOffset":%zu,"componentType":%u,"count":%zu,"type":"%s"%s})",
+                         bufferView, byteOffset, componentType, count, type, normalized ? R"(,"normalized":true)" : "");
+                return json;
+            }
+        }
+
+        bool WriteGlbFile(const std::vector<float> &vertices,
+                          const std::vector<float> &normals,
+                          const std::vector<float> &uvs,
+                          const std::vector<uint32_t> &indices,
+                          const GlbEncoding &encoding,
+                          std::vector<uint8_t> &outFile,
+                          float &outPositionScale)
+        {
+            const size_t vertexCount = vertices.size() / 3;
+            if (vertexCount == 0 || indices.empty() || normals.size() != vertexCount * 3 ||
+                uvs.size() != vertexCount * 2) {
+                return false;
+            }
+
+            // Normalized integers only hold [-1, 1], so positions are divided by their largest coordinate.
+            outPositionScale = 1.0f;
+            if (IsInteger(encoding.position)) {
+                outPositionScale = 0.0f;
+                for (float coordinate : vertices) {
+                    outPositionScale = std::max(outPositionScale, std::fabs(coordinate));
+                }
+            }
+
+            // Each attribute starts 4-byte aligned within the vertex, as glTF requires.
+            const size_t positionSize = AlignTo4(3 * GetGlbComponentSize(encoding.position));
+            const size_t normalSize = AlignTo4(3 * GetGlbComponentSize(encoding.normal));
+            const size_t uvSize = AlignTo4(2 * GetGlbComponentSize(encoding.uv));
+            const size_t stride = positionSize + normalSize + uvSize;
+            const size_t vertexBytes = stride * vertexCount;
+
+            const uint32_t maxIndex = *std::max_element(indices.begin(), indices.end());
+            const uint32_t indexType = (maxIndex <= UINT8_MAX) ? GLB_COMPONENT_UNSIGNED_BYTE :
+                (maxIndex <= UINT16_MAX) ? GLB_COMPONENT_UNSIGNED_SHORT : GLB_COMPONENT_UNSIGNED_INT;
+            const size_t indexSize = GetGlbComponentSize(indexType);
+            const size_t indexOffset = AlignTo4(vertexBytes);
+            std::vector<uint8_t> binary(AlignTo4(indexOffset + indices.size() * indexSize), 0);
+
+            for (size_t i = 0; i < vertexCount; ++i) {
+                uint8_t *vertex = binary.data() + i * stride;
+                WriteComponents(&vertices[i * 3], 3, encoding.position, 1.0f / outPositionScale, vertex);
+                WriteComponents(&normals[i * 3], 3, encoding.normal, 1.0f, vertex + positionSize);
+                WriteComponents(&uvs[i * 2], 2, encoding.uv, 1.0f, vertex + positionSize + normalSize);
+            }
+            for (size_t i = 0; i < indices.size(); ++i) {
+                memcpy(binary.data() + indexOffset + i * indexSize, &indices[i], indexSize);
+            }
+
+            char views[256];
+            snprintf(views, sizeof(views),
+                     R"([{"buffer":0,"byteOffset":0,"byteLength":%zu,"byteStride":%zu,"target":34962},)"
+                     R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu,"target":34963}])",
+                     vertexBytes, stride, indexOffset, indices.size() * indexSize);
+            char scale[128];
+            snprintf(scale, sizeof(scale), "[%.9g,%.9g,%.9g]", outPositionScale, outPositionScale, outPositionScale);
+            std::string json = std::string(R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],)") +
+                R"("nodes":[{"mesh":0,"scale":)" + scale + "}]," +
+                R"("meshes":[{"primitives":[{"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},"indices":3}]}],)" +
+                R"("accessors":[)" +
+                AccessorJson(0, 0, encoding.position, vertexCount, "VEC3", IsInteger(encoding.position)) + "," +
+                AccessorJson(0, positionSize, encoding.normal, vertexCount, "VEC3", IsInteger(encoding.normal)) + "," +
+                AccessorJson(0, positionSize + normalSize, encoding.uv, vertexCount, "VEC2", IsInteger(encoding.uv)) +
+                "," + AccessorJson(1, 0, indexType, indices.size(), "SCALAR", false) + "]," +
+                R"("bufferViews":)" + views + "," +
+                R"("buffers":[{"byteLength":)" + std::to_string(binary.size()) + "}]}";
+            // The JSON chunk is padded with spaces so that the binary chunk stays aligned.
+            json.resize(AlignTo4(json.size()), ' ');
+
+            const uint32_t header[] = {
+                GLB_MAGIC, GLB_VERSION,
+                static_cast<uint32_t>(12 + 8 + json.size() + 8 + binary.size()),
+                static_cast<uint32_t>(json.size()), GLB_CHUNK_JSON,
+            };
+            const uint32_t binaryHeader[] = {static_cast<uint32_t>(binary.size()), GLB_CHUNK_BIN};
+            outFile.resize(header[2]);
+            uint8_t *out = outFile.data();
+            memcpy(out, header, sizeof(header));
+            memcpy(out + sizeof(header), json.data(), json.size());
+            memcpy(out + sizeof(header) + json.size(), binaryHeader, sizeof(binaryHeader));
+            memcpy(out + sizeof(header) + json.size() + sizeof(binaryHeader), binary.data(), binary.size());
+            return true;
+        }
+    }
+}
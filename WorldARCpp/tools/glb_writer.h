@@ -0,0 +1,57 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_GLB_WRITER_H
+#define C_ARENGINE_HELLOE_AR_GLB_WRITER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    namespace host {
+        // Component types of the vertex attributes in a written file, GLB_COMPONENT values.
+        // Integer types are stored normalized.
+        struct GlbEncoding {
+            uint32_t position;
+            uint32_t normal;
+            uint32_t uv;
+        };
+
+        /**
+         * Write a mesh as a binary glTF model with interleaved vertices, the way exporters lay out
+         * quantized models. Normalized integer positions are divided by the largest coordinate, and
+         * the model's node scales them back.
+         *
+         * @param vertices Vertex positions, three floats per vertex.
+         * @param normals Vertex normals, three floats per vertex.
+         * @param uvs Texture coordinates, two floats per vertex, within [0, 1] for unsigned encodings.
+         * @param indices Triangle indices, stored in the smallest type that fits them.
+         * @param encoding Component types of the attributes.
+         * @param outFile Output file content.
+         * @param outPositionScale Factor the stored positions are multiplied by to get the input.
+         * @return True if the mesh could be written, false otherwise.
+         */
+        bool WriteGlbFile(const std::vector<float> &vertices,
+                          const std::vector<float> &normals,
+                          const std::vector<float> &uvs,
+                          const std::vector<uint32_t> &indices,
+                          const GlbEncoding &encoding,
+                          std::vector<uint8_t> &outFile,
+                          float &outPositionScale);
+    }
+}
+#endif
@@ -0,0 +1,61 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#ifndef C_ARENGINE_HELLOE_AR_HOST_GL_H
+#define C_ARENGINE_HELLOE_AR_HOST_GL_H
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <EGL/egl.h>
+
+namespace gWorldAr {
+    // OpenGL ES context of the benchmarks that run on the GL driver of the host.
+    namespace host {
+        // Create an OpenGL ES 3 context with a small pbuffer surface and make it current. Without a display
+        // server Mesa only creates contexts on its surfaceless platform, which is picked unless set already.
+        inline bool CreateGlContext()
+        {
+            setenv("EGL_PLATFORM", "surfaceless", 0);
+            EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+            if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+                fprintf(stderr, "Could not initialize EGL.\n");
+                return false;
+            }
+            const EGLint configAttributes[] = {EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                               EGL_OPENGL_ES2_BIT, EGL_NONE};
+            EGLConfig config = nullptr;
+            EGLint configCount = 0;
+            if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0 ||
+                !eglBindAPI(EGL_OPENGL_ES_API)) {
+                fprintf(stderr, "Could not find an OpenGL ES configuration.\n");
+                return false;
+            }
+            const EGLint contextAttributes[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+            EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+            const EGLint surfaceAttributes[] = {EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+            EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+            if (context == EGL_NO_CONTEXT || surface == EGL_NO_SURFACE ||
+                !eglMakeCurrent(display, surface, surface, context)) {
+                fprintf(stderr, "Could not create an OpenGL ES context.\n");
+                return false;
+            }
+            return true;
+        }
+    }
+}
+#endif
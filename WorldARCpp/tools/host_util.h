@@ -0,0 +1,75 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_HOST_UTIL_H
+#define C_ARENGINE_HELLOE_AR_HOST_UTIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace gWorldAr {
+    // Helpers shared by the host-side tools and benchmarks.
+    namespace host {
+        inline bool ReadFile(const std::string &path, std::vector<char> &outData)
+        {
+            FILE *file = fopen(path.c_str(), "rb");
+            if (file == nullptr) {
+                fprintf(stderr, "Could not open %s\n", path.c_str());
+                return false;
+            }
+            fseek(file, 0, SEEK_END);
+            long size = ftell(file);
+            fseek(file, 0, SEEK_SET);
+            outData.resize(size > 0 ? static_cast<size_t>(size) : 0);
+            size_t read = fread(outData.data(), 1, outData.size(), file);
+            fclose(file);
+            return read == outData.size();
+        }
+
+        inline bool WriteFile(const std::string &path, const void *data, size_t size)
+        {
+            FILE *file = fopen(path.c_str(), "wb");
+            if (file == nullptr) {
+                fprintf(stderr, "Could not create %s\n", path.c_str());
+                return false;
+            }
+            size_t written = fwrite(data, 1, size, file);
+            fclose(file);
+            return written == size;
+        }
+
+        inline std::string AssetPath(const char *fileName)
+        {
+            return std::string(WORLD_AR_ASSET_DIR) + "/" + fileName;
+        }
+
+        // Run the function the given number of times and return the mean duration in milliseconds.
+        template <typename Function>
+        double MeasureMs(int iterations, Function &&function)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                function();
+            }
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / iterations;
+        }
+    }
+}
+#endif
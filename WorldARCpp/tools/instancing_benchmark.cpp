@@ -0,0 +1,315 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+
+#include "host_gl.h"
+#include "synthetic_models.h"
+#include "utils/gl_capabilities.h"
+#include "utils/gl_state.h"
+#include "utils/log.h"
+#include "utils/mesh_view.h"
+#include "utils/obj_parser.h"
+#include "utils/program_builder.h"
+
+namespace {
+    // The parameters of an object reach the shader as in the object renderer: six vectors, from
+    // per-instance attributes or from a uniform array indexed by the copy of the mesh.
+    constexpr char VERTEX_SHADER[] = R"(
+    uniform mat4 u_Projection;
+    attribute vec4 a_Position;
+    attribute vec3 a_Normal;
+    varying vec4 v_Color;
+    #ifdef INSTANCED_ARRAYS
+    attribute mat4 a_ModelView;
+    attribute vec4 a_ObjColor;
+    attribute vec4 a_LightingParameters;
+    #else
+    uniform vec4 u_Instances[INSTANCE_COUNT * 6];
+    attribute float a_InstanceIndex;
+    #endif
+    void main() {
+    #ifdef INSTANCED_ARRAYS
+        mat4 modelView = a_ModelView;
+        vec4 color = a_ObjColor;
+        vec4 lighting = a_LightingParameters;
+    #else
+        int instance = int(a_InstanceIndex) * 6;
+        mat4 modelView = mat4(u_Instances[instance], u_Instances[instance + 1], u_Instances[instance + 2],
+            u_Instances[instance + 3]);
+        vec4 color = u_Instances[instance + 4];
+        vec4 lighting = u_Instances[instance + 5];
+    #endif
+        vec3 normal = normalize((modelView * vec4(a_Normal, 0.0)).xyz);
+        v_Color = color * lighting.w * (0.5 + 0.5 * dot(normal, lighting.xyz));
+        gl_Position = u_Projection * modelView * a_Position;
+    })";
+
+    constexpr char FRAGMENT_SHADER[] = R"(
+    precision mediump float;
+    varying vec4 v_Color;
+    void main() {
+        gl_FragColor = v_Color;
+    })";
+
+    // Objects placed by the app at most, and a crowded scene.
+    constexpr size_t OBJECT_COUNTS[] = {10, 100};
+
+    // Largest uniform array the object renderer asks for.
+    constexpr size_t MAX_UNIFORM_INSTANCES = 32;
+    constexpr size_t MAX_REPLICATED_VERTEX_BYTES = 4 * 1024 * 1024;
+
+    struct ObjectInstance {
+        glm::mat4 mvMat;
+        float color[4];
+        glm::vec4 lightingParam;
+    };
+
+    struct Program {
+        GLuint name = 0;
+        GLint position = -1;
+        GLint normal = -1;
+        GLint modelView = -1;
+        GLint color = -1;
+        GLint lightingParam = -1;
+        GLint instanceIndex = -1;
+        GLint projection = -1;
+        GLint instances = -1;
+    };
+
+    Program BuildProgram(const std::string &define)
+    {
+        using namespace gWorldAr;
+        util::ProgramBuilder builder;
+        Program program;
+        program.name = builder.Take(builder.Submit((define + VERTEX_SHADER).c_str(), FRAGMENT_SHADER));
+        CHECK(program.name != 0);
+        program.position = glGetAttribLocation(program.name, "a_Position");
+        program.normal = glGetAttribLocation(program.name, "a_Normal");
+        program.modelView = glGetAttribLocation(program.name, "a_ModelView");
+        program.color = glGetAttribLocation(program.name, "a_ObjColor");
+        program.lightingParam = glGetAttribLocation(program.name, "a_LightingParameters");
+        program.instanceIndex = glGetAttribLocation(program.name, "a_InstanceIndex");
+        program.projection = glGetUniformLocation(program.name, "u_Projection");
+        program.instances = glGetUniformLocation(program.name, "u_Instances");
+        return program;
+    }
+
+    // Objects on a grid filling the view, each with its own color.
+    std::vector<ObjectInstance> PlaceObjects(size_t count)
+    {
+        std::vector<ObjectInstance> instances(count);
+        const size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+        for (size_t i = 0; i < count; ++i) {
+            const float x = (static_cast<float>(i % columns) + 0.5f) / columns * 2.0f - 1.0f;
+            const float y = (static_cast<float>(i / columns) + 0.5f) / columns * 2.0f - 1.0f;
+            instances[i].mvMat = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x, y, -2.0f)),
+                glm::vec3(1.0f / columns));
+            instances[i].color[0] = static_cast<float>(i % 3) * 0.5f;
+            instances[i].color[1] = static_cast<float>(i % 5) * 0.25f;
+            instances[i].color[2] = 1.0f;
+            instances[i].color[3] = 1.0f;
+            instances[i].lightingParam = glm::vec4(glm::normalize(glm::vec3(0.3f, 1.0f, 0.5f)), 0.8f);
+        }
+        return instances;
+    }
+
+    // How a frame is drawn, and how many draw calls it took.
+    struct FramePath {
+        const char *name;
+        const Program *program;
+        const gWorldAr::util::MeshView *mesh;
+        size_t objectsPerCall;
+        bool isInstanced;
+    };
+
+    size_t DrawFrame(const FramePath &path, const gWorldAr::util::InstancedArrays &instancedArrays,
+                     GLuint instanceBuffer, const std::vector<ObjectInstance> &instances)
+    {
+        using namespace gWorldAr;
+        util::GlStateCache &state = util::GetGlState();
+        const Program &program = *path.program;
+        const util::MeshView &mesh = *path.mesh;
+        const util::SubMesh &subMesh = mesh.subMeshes[0];
+        glClear(GL_COLOR_BUFFER_BIT);
+        state.UseProgram(program.name);
+        const glm::mat4 projection = glm::perspective(1.0f, 1.0f, 0.1f, 10.0f);
+        glUniformMatrix4fv(program.projection, 1, GL_FALSE, glm::value_ptr(projection));
+        uint32_t enabledMask = util::VertexAttribBit(program.position) | util::VertexAttribBit(program.normal);
+        size_t callCount = 0;
+        if (path.isInstanced) {
+            state.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances.size() * sizeof(ObjectInstance)),
+                instances.data(), GL_STREAM_DRAW);
+            const GLint attribs[] = {program.modelView, program.modelView + 1, program.modelView + 2,
+                                     program.modelView + 3, program.color, program.lightingParam};
+            for (size_t i = 0; i < 6; ++i) {
+                glVertexAttribPointer(attribs[i], 4, GL_FLOAT, GL_FALSE, sizeof(ObjectInstance),
+                    reinterpret_cast<const GLvoid *>(i * sizeof(glm::vec4)));
+                instancedArrays.vertexAttribDivisor(attribs[i], 1);
+                enabledMask |= util::VertexAttribBit(attribs[i]);
+            }
+            state.SetVertexAttribArrays(enabledMask);
+            util::BindMeshBuffers(mesh);
+            util::SetVertexAttribPointer(program.position, mesh.position, subMesh.firstVertex);
+            util::SetVertexAttribPointer(program.normal, mesh.normal, subMesh.firstVertex);
+            instancedArrays.drawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(subMesh.indexCount),
+                mesh.indexType, mesh.indices, static_cast<GLsizei>(instances.size()));
+            for (GLint attrib : attribs) {
+                instancedArrays.vertexAttribDivisor(attrib, 0);
+            }
+            return 1;
+        }
+
+        const bool isReplicated = mesh.copyIndex.pointer != nullptr;
+        if (isReplicated) {
+            enabledMask |= util::VertexAttribBit(program.instanceIndex);
+        } else {
+            glVertexAttrib1f(program.instanceIndex, 0.0f);
+        }
+        state.SetVertexAttribArrays(enabledMask);
+        util::BindMeshBuffers(mesh);
+        util::SetVertexAttribPointer(program.position, mesh.position, subMesh.firstVertex);
+        util::SetVertexAttribPointer(program.normal, mesh.normal, subMesh.firstVertex);
+        if (isReplicated) {
+            util::SetVertexAttribPointer(program.instanceIndex, mesh.copyIndex, subMesh.firstVertex);
+        }
+        const size_t copyIndexCount = subMesh.indexCount / path.objectsPerCall;
+        for (size_t first = 0; first < instances.size(); first += path.objectsPerCall) {
+            const size_t count = std::min(path.objectsPerCall, instances.size() - first);
+            glUniform4fv(program.instances, static_cast<GLsizei>(count * 6), glm::value_ptr(instances[first].mvMat));
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(copyIndexCount * count), mesh.indexType, mesh.indices);
+            ++callCount;
+        }
+        return callCount;
+    }
+
+    std::vector<GLubyte> ReadPixels()
+    {
+        GLint viewport[4] = {};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        std::vector<GLubyte> pixels(static_cast<size_t>(viewport[2]) * viewport[3] * 4);
+        glReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    }
+
+    // Mean frame time of the fastest of several rounds, including the GPU work.
+    double MeasureFrameMs(const FramePath &path, const gWorldAr::util::InstancedArrays &instancedArrays,
+                          GLuint instanceBuffer, const std::vector<ObjectInstance> &instances, int frameCount)
+    {
+        constexpr int ROUND_COUNT = 5;
+        double fastestMs = 0.0;
+        for (int round = 0; round < ROUND_COUNT; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; ++frame) {
+                DrawFrame(path, instancedArrays, instanceBuffer, instances);
+            }
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double ms = elapsed.count() / frameCount;
+            fastestMs = (round == 0) ? ms : std::min(fastestMs, ms);
+        }
+        return fastestMs;
+    }
+}
+
+// Draws a grid of objects once per object, with instanced arrays, and in batches from a uniform array
+// over copies of the mesh, the three ways the object renderer can draw. Checks that they draw the same
+// pixels and counts their draw calls.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int frameCount = argc > 1 ? atoi(argv[1]) : 100;
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    util::InstancedArrays instancedArrays;
+    CHECK(util::LoadInstancedArrays(instancedArrays));
+
+    std::string obj = host::GenerateSphereObj(24, 24);
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    CHECK(util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, indices));
+    std::vector<GLushort> indices16(indices.begin(), indices.end());
+    const util::SubMesh subMesh = {0, static_cast<uint32_t>(vertices.size() / 3), 0,
+                                   static_cast<uint32_t>(indices.size())};
+    util::MeshView mesh;
+    mesh.position = {vertices.data(), 3, GL_FLOAT, GL_FALSE, 0};
+    mesh.normal = {normals.data(), 3, GL_FLOAT, GL_FALSE, 0};
+    mesh.uv = {uvs.data(), 2, GL_FLOAT, GL_FALSE, 0};
+    mesh.indices = indices16.data();
+    mesh.subMeshes = &subMesh;
+    mesh.subMeshCount = 1;
+
+    // The replicated mesh is filled before the original one is moved into buffer objects.
+    const size_t copyCount = std::min(MAX_UNIFORM_INSTANCES, util::GetMaxMeshCopies(mesh, MAX_REPLICATED_VERTEX_BYTES));
+    std::vector<GLubyte> replicatedVertices;
+    std::vector<GLushort> replicatedIndices;
+    std::vector<util::SubMesh> replicatedSubMeshes;
+    util::MeshView replicatedMesh;
+    CHECK(copyCount > 1);
+    CHECK(util::ReplicateMesh(mesh, copyCount, replicatedVertices, replicatedIndices, replicatedSubMeshes,
+                              replicatedMesh));
+    CHECK(replicatedSubMeshes.size() == 1 && replicatedSubMeshes[0].indexCount == subMesh.indexCount * copyCount);
+    CHECK(replicatedVertices.size() <= MAX_REPLICATED_VERTEX_BYTES);
+    CHECK(util::UploadMeshBuffers(mesh) > 0 && util::UploadMeshBuffers(replicatedMesh) > 0);
+
+    const Program uniformProgram = BuildProgram("#define INSTANCE_COUNT " + std::to_string(copyCount) + "\n");
+    const Program instancedProgram = BuildProgram("#define INSTANCED_ARRAYS\n");
+    GLuint instanceBuffer = 0;
+    glGenBuffers(1, &instanceBuffer);
+    const FramePath paths[] = {
+        {"one call per object", &uniformProgram, &mesh, 1, false},
+        {"instanced arrays", &instancedProgram, &mesh, 0, true},
+        {"uniform array batches", &uniformProgram, &replicatedMesh, copyCount, false}
+    };
+
+    printf("%u triangles per object, %zu objects per uniform array batch\n", subMesh.indexCount / 3, copyCount);
+    for (size_t objectCount : OBJECT_COUNTS) {
+        const std::vector<ObjectInstance> instances = PlaceObjects(objectCount);
+        std::vector<GLubyte> referencePixels;
+        double referenceMs = 0.0;
+        for (const FramePath &path : paths) {
+            const size_t callCount = DrawFrame(path, instancedArrays, instanceBuffer, instances);
+            const std::vector<GLubyte> pixels = ReadPixels();
+            CHECK(glGetError() == GL_NO_ERROR);
+            const double ms = MeasureFrameMs(path, instancedArrays, instanceBuffer, instances, frameCount);
+            if (referencePixels.empty()) {
+                referencePixels = pixels;
+                referenceMs = ms;
+            }
+            CHECK(pixels == referencePixels);
+            printf("%4zu objects  %-22s %4zu draw calls  %7.3f ms  %5.2fx\n", objectCount, path.name, callCount, ms,
+                   referenceMs / ms);
+        }
+    }
+    return 0;
+}
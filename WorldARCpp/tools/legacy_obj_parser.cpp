@@ -0,0 +1,330 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "legacy_obj_parser.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "utils/log.h"
+
+namespace gWorldAr {
+    namespace legacy {
+        namespace {
+            using FileData = struct {
+                std::vector<char *> perVertInfoList;
+                size_t i;
+            };
+
+            using DrawTempData = struct {
+                std::vector<float> tempPositions;
+                std::vector<float> tempNormals;
+                std::vector<float> tempUvs;
+                std::vector<uint16_t> vertexIndices;
+                std::vector<uint16_t> normalIndices;
+                std::vector<uint16_t> uvIndices;
+            };
+        }
+
+        static bool ParseNormal(char lineHeader[], std::vector<float> &tempNormals)
+        {
+            // Parses the normal vertex status.
+            float normal[3];
+            if (lineHeader[0] != 'v' || lineHeader[1] != 'n') {
+                return false;
+            }
+            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
+            std::vector<std::string> stringVector;
+            std::string tempResult;
+            std::stringstream readData(tempDataString);
+            while (readData >> tempResult) {
+                stringVector.push_back(tempResult);
+            }
+            // Obj vn data size is 4, include vn symbol and 3 float coordinate position value.
+            if (stringVector.size() < 4) {
+                return false;
+            }
+            // Vertex normal dimension is 3.
+            for (int index = 0; index < 3; index++) {
+                // 'vn' takes a place.
+                normal[index] = atof(stringVector[index + 1].c_str());
+                tempNormals.push_back(normal[index]);
+            }
+            return true;
+        }
+
+        static bool ParseTexture(char lineHeader[], std::vector<float> &tempUvs)
+        {
+            // Parses texture coordinates.
+            float uv[2];
+            if (lineHeader[0] != 'v' || lineHeader[1] != 't') {
+                return false;
+            }
+            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
+            std::vector<std::string> stringVector;
+            std::string tempResult;
+            std::stringstream readData(tempDataString);
+            while (readData >> tempResult) {
+                stringVector.push_back(tempResult);
+            }
+            // Obj vt data size is 3, include vt symbol and 2 float coordinate position value.
+            if (stringVector.size() < 3) {
+                return false;
+            }
+            // U V two quantities.
+            for (int index = 0; index < 2; index++) {
+                // 'vt' occupies one place.
+                uv[index] = atof(stringVector[index + 1].c_str());
+                tempUvs.push_back(uv[index]);
+            }
+            return true;
+        }
+
+        static bool ParseVertex(char lineHeader[], std::vector<float> &tempPositions)
+        {
+            // Resolve the vertices.
+            float vertex[3];
+            if (lineHeader[0] != 'v' || lineHeader[1] != ' ') {
+                return false;
+            }
+            std::string tempDataString(lineHeader, lineHeader + strlen(lineHeader));
+            std::vector<std::string> stringVector;
+            std::string tempResult;
+            std::stringstream readData(tempDataString);
+            while (readData >> tempResult) {
+                stringVector.push_back(tempResult);
+            }
+            // Obj v data size is 4, include v symbol and 3 float coordinate position value.
+            if (stringVector.size() < 4) {
+                return false;
+            }
+            // Vertex normal dimension is 3.
+            for (int index = 0; index < 3; index++) {
+                // 'v' take a position.
+                vertex[index] = atof(stringVector[index + 1].c_str());
+                tempPositions.push_back(vertex[index]);
+            }
+            return true;
+        }
+
+        static bool WriteOneNormalAndVertValues(FileData fileData,
+                                                unsigned int vertexIndex[],
+                                                unsigned int normalIndex[],
+                                                unsigned int textureIndex[],
+                                                bool isNormalAndUvAvailable[])
+        {
+            // Char* for call system API.
+            char *perVertInfo;
+            int perVertInforCount = 0;
+            bool isVertexNormalOnlyFace = (strstr(fileData.perVertInfoList[fileData.i], "//") != nullptr);
+            // Char* for call system API.
+            char *perVertInfoIter = fileData.perVertInfoList[fileData.i];
+            perVertInfo = strtok_r(perVertInfoIter, "/", &perVertInfoIter);
+            bool flag = perVertInfo;
+            while (flag) {
+                // Write only normal and vertical values.
+                switch (perVertInforCount) {
+                    case 0: // The vertex index is the first write in turn.
+                        // Write the vertex index.
+                        vertexIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
+                        break;
+                    case 1: // Write sequentially, the texture index will be written the second time.
+                        // Write the texture index.
+                        if (isVertexNormalOnlyFace) {
+                            normalIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
+                            isNormalAndUvAvailable[0] = true;
+                        } else {
+                            textureIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
+                            isNormalAndUvAvailable[1] = true;
+                        }
+                        break;
+                        // Whether to write a normal index.
+                    case 2: // Cyclic write: normal index write for the third time.
+                        // Write a common index.
+                        if (!isVertexNormalOnlyFace) {
+                            normalIndex[fileData.i] = atoi(perVertInfo);  // NOLINT
+                            isNormalAndUvAvailable[0] = true;
+                            break;
+                        }
+
+                        // Deliberately falling into the default error condition due to the vertices,
+                        // the normal plane has only two values.
+                        [[fallthrough]];
+                    default:
+                        // The format is incorrect.
+                        LOGE("Format of 'f int/int/int int/int/int int/int/int "
+                             "(int/int/int)' "
+                             "or 'f int//int int//int int//int (int//int)' required for "
+                             "each face");
+                        return false;
+                }
+                perVertInforCount++;
+                flag = (perVertInfo = strtok_r(perVertInfoIter, "/", &perVertInfoIter)) != nullptr;
+            }
+            return true;
+        }
+
+        static bool WriteNormalAndVertexValues(std::vector<char *> perVertexInfoList,
+                                               unsigned int vertexIndex[],
+                                               unsigned int normalIndex[],
+                                               unsigned int textureIndex[],
+                                               bool isNormalAndUvAvailable[])
+        {
+            for (size_t i = 0; i < perVertexInfoList.size(); ++i) {
+                FileData fileData;
+                fileData.perVertInfoList = perVertexInfoList;
+                fileData.i = i;
+                if (!WriteOneNormalAndVertValues(
+                    fileData, vertexIndex, normalIndex, textureIndex, isNormalAndUvAvailable)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool WriteIndex(char &input,
+                               std::vector<uint16_t> &vertexIndices,
+                               std::vector<uint16_t> &normalIndices,
+                               std::vector<uint16_t> &uvIndices)
+        {
+            // The actual face information starts from the second digit.
+            unsigned int vertexIndex[4] = {}; // The dimension of the coordinate is 4(xyzw).
+            unsigned int normalIndex[4] = {}; // The dimension of normal vector is 4.
+            unsigned int textureIndex[4] = {}; // The dimension of texture is 4.
+
+            std::vector<char *> perVertInfoList;
+            char *perVertInfoListCstr;
+            char *faceLineIter = &input;
+            bool flag = (perVertInfoListCstr = strtok_r(faceLineIter, " ", &faceLineIter)) != nullptr;
+            while (flag) {
+                // Divide each piece of face information into each position.
+                perVertInfoList.push_back(perVertInfoListCstr);
+                flag = (perVertInfoListCstr = strtok_r(faceLineIter, " ", &faceLineIter)) != nullptr;
+            }
+            bool isNormalAvailable = false;
+            bool isUvAvailable = false;
+            // Input variable of the WriteNormalAndVertValues method.
+            bool isNormalAndUvAvailable[2] = {isNormalAvailable, isUvAvailable};
+
+            if (!WriteNormalAndVertexValues(
+                perVertInfoList, vertexIndex, normalIndex, textureIndex, isNormalAndUvAvailable)) {
+                return false;
+            }
+            int verticesCount = perVertInfoList.size();
+            for (int i = 2; i < verticesCount; ++i) {
+                vertexIndices.push_back(vertexIndex[0] - 1);
+                vertexIndices.push_back(vertexIndex[i - 1] - 1);
+                vertexIndices.push_back(vertexIndex[i] - 1);
+                if (isNormalAndUvAvailable[0]) {
+                    normalIndices.push_back(normalIndex[0] - 1);
+                    normalIndices.push_back(normalIndex[i - 1] - 1);
+                    normalIndices.push_back(normalIndex[i] - 1);
+                }
+                if (isNormalAndUvAvailable[1]) {
+                    uvIndices.push_back(textureIndex[0] - 1);
+                    uvIndices.push_back(textureIndex[i - 1] - 1);
+                    uvIndices.push_back(textureIndex[i] - 1);
+                }
+            }
+            return true;
+        }
+
+        static bool WriteDrawOutData(DrawTempData drawTempData,
+                                     std::vector<float> &outVertices,
+                                     std::vector<float> &outNormals,
+                                     std::vector<float> &outUv,
+                                     std::vector<uint16_t> &outIndices)
+        {
+            bool isNormalAvailable = (!drawTempData.normalIndices.empty());
+            bool isUvAvailable = (!drawTempData.uvIndices.empty());
+            if (isNormalAvailable && drawTempData.normalIndices.size() != drawTempData.vertexIndices.size()) {
+                LOGE("Object normal indices does not equal to vertex indices.");
+                return false;
+            }
+            if (isUvAvailable && drawTempData.uvIndices.size() != drawTempData.vertexIndices.size()) {
+                LOGE("Object UV indices does not equal to vertex indices.");
+                return false;
+            }
+
+            for (unsigned int i = 0; i < drawTempData.vertexIndices.size(); i++) {
+                unsigned int vertex_index = drawTempData.vertexIndices[i];
+                // The vertex dimension is 3.
+                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3]);
+                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3 + 1]);
+                outVertices.push_back(drawTempData.tempPositions[vertex_index * 3 + 2]);
+                outIndices.push_back(i);
+                if (isNormalAvailable) {
+                    unsigned int normal_index = drawTempData.normalIndices[i];
+                    // The vertex normal has three dimensions.
+                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3]);
+                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3 + 1]);
+                    outNormals.push_back(drawTempData.tempNormals[normal_index * 3 + 2]);
+                }
+                if (isUvAvailable) {
+                    unsigned int uv_index = drawTempData.uvIndices[i];
+                    // U-axis and V-axis of the texture coordinate.
+                    outUv.push_back(drawTempData.tempUvs[uv_index * 2]);
+                    outUv.push_back(drawTempData.tempUvs[uv_index * 2 + 1]);
+                }
+            }
+            return true;
+        }
+
+        bool ParseObj(const char *data, size_t size,
+                      std::vector<float> &outVertices,
+                      std::vector<float> &outNormals,
+                      std::vector<float> &outUv,
+                      std::vector<uint16_t> &outIndices)
+        {
+            DrawTempData drawTempData;
+
+            // The shipped loader copied the asset into a string before streaming it.
+            std::string file_buffer(data, size);
+            std::stringstream fileStringStream(file_buffer);
+            while (!fileStringStream.eof()) {
+                // Sets the maximum number of characters to be read (128).
+                char line_header[128] = {};
+                fileStringStream.getline(line_header, 128);
+                if (line_header[0] == 'v' && line_header[1] == 'n') {
+                    if (!ParseNormal(line_header, drawTempData.tempNormals)) {
+                        return false;
+                    }
+                } else if (line_header[0] == 'v' && line_header[1] == 't') {
+                    if (!ParseTexture(line_header, drawTempData.tempUvs)) {
+                        return false;
+                    }
+                } else if (line_header[0] == 'v') {
+                    if (!ParseVertex(line_header, drawTempData.tempPositions)) {
+                        return false;
+                    }
+                } else if (line_header[0] == 'f') {
+                    if (!WriteIndex(
+                        line_header[1], drawTempData.vertexIndices,
+                        drawTempData.normalIndices, drawTempData.uvIndices)) {
+                        return false;
+                    }
+                }
+            }
+            if (!WriteDrawOutData(drawTempData, outVertices, outNormals, outUv, outIndices)) {
+                return false;
+            }
+            return true;
+        }
+    }
+}
+
@@ -0,0 +1,34 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_LEGACY_OBJ_PARSER_H
+#define C_ARENGINE_HELLOE_AR_LEGACY_OBJ_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gWorldAr {
+    // The stringstream based obj loader the app shipped with, kept as the benchmark baseline.
+    namespace legacy {
+        bool ParseObj(const char *data, size_t size,
+                      std::vector<float> &outVertices,
+                      std::vector<float> &outNormals,
+                      std::vector<float> &outUv,
+                      std::vector<uint16_t> &outIndices);
+    }
+}
+#endif
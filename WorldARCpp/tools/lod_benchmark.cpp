@@ -0,0 +1,158 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/log.h"
+#include "utils/mesh_simplifier.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    // Largest distance of a triangle centroid from the unit sphere the synthetic models lie on.
+    float MaxSphereDeviation(const std::vector<float> &vertices, const std::vector<uint32_t> &indices)
+    {
+        float deviation = 0.0f;
+        for (size_t corner = 0; corner < indices.size(); corner += 3) {
+            float centroid[3] = {0.0f, 0.0f, 0.0f};
+            for (size_t k = 0; k < 3; ++k) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    centroid[axis] += vertices[indices[corner + k] * 3 + axis] / 3.0f;
+                }
+            }
+            float length = std::sqrt(centroid[0] * centroid[0] + centroid[1] * centroid[1] +
+                                     centroid[2] * centroid[2]);
+            deviation = std::max(deviation, std::fabs(1.0f - length));
+        }
+        return deviation;
+    }
+
+    void Simplify(const char *name, const std::string &obj, bool isSphere, int iterations)
+    {
+        using namespace gWorldAr;
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<uint32_t> indices;
+        CHECK(util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, indices));
+        util::OptimizeMesh(vertices, normals, uvs, indices);
+        const size_t vertexCount = vertices.size() / 3;
+
+        std::vector<std::vector<uint32_t>> lodIndices;
+        std::vector<float> lodErrors;
+        double generateMs = host::MeasureMs(iterations, [&]() {
+            util::GenerateLods(vertices, indices, util::MAX_LOD_COUNT, lodIndices, lodErrors);
+        });
+        CHECK(!lodIndices.empty() && lodIndices[0] == indices && lodErrors[0] == 0.0f);
+        printf("%-24s %7zu vertices, %zu levels generated in %.3f ms\n", name, vertexCount, lodIndices.size(),
+               generateMs);
+        for (size_t lod = 0; lod < lodIndices.size(); ++lod) {
+            const std::vector<uint32_t> &level = lodIndices[lod];
+            CHECK(!level.empty() && level.size() % 3 == 0);
+            CHECK(std::all_of(level.begin(), level.end(), [&](uint32_t index) { return index < vertexCount; }));
+            if (lod > 0) {
+                CHECK(level.size() < lodIndices[lod - 1].size() && lodErrors[lod] >= lodErrors[lod - 1]);
+            }
+            util::VertexCacheStats cache = util::AnalyzeVertexCache(level, vertexCount);
+            printf("%-24s level %zu: %7zu triangles (%5.1f%%), error %.5f, ACMR %.3f", "", lod, level.size() / 3,
+                   100.0 * level.size() / indices.size(), lodErrors[lod], cache.acmr);
+            if (isSphere) {
+                printf(", deviation from sphere %.5f", MaxSphereDeviation(vertices, level));
+            }
+            printf("\n");
+        }
+
+        // Levels share the vertices of models that fit 16-bit indices, and are split otherwise.
+        std::vector<float> combinedVertices;
+        std::vector<float> combinedNormals;
+        std::vector<float> combinedUvs;
+        std::vector<uint32_t> combinedIndices;
+        std::vector<util::SubMesh> subMeshes;
+        std::vector<util::MeshLod> lods;
+        util::CombineLods(vertices, normals, uvs, lodIndices, lodErrors, util::MAX_VERTICES_16_BIT,
+                          combinedVertices, combinedNormals, combinedUvs, combinedIndices, subMeshes, lods);
+        CHECK(lods.size() == lodIndices.size());
+        for (size_t lod = 0; lod < lods.size(); ++lod) {
+            size_t indexCount = 0;
+            for (uint32_t i = lods[lod].firstSubMesh; i < lods[lod].firstSubMesh + lods[lod].subMeshCount; ++i) {
+                const util::SubMesh &subMesh = subMeshes[i];
+                CHECK(subMesh.vertexCount <= util::MAX_VERTICES_16_BIT);
+                for (uint32_t k = 0; k < subMesh.indexCount; ++k) {
+                    CHECK(combinedIndices[subMesh.firstIndex + k] < subMesh.vertexCount);
+                }
+                indexCount += subMesh.indexCount;
+            }
+            CHECK(indexCount == lodIndices[lod].size());
+        }
+        printf("%-24s %zu sub-meshes, %zu vertices with all levels\n", "", subMeshes.size(),
+               combinedVertices.size() / 3);
+    }
+
+    // Objects walking away from the camera change level once per threshold, and sizes that jitter
+    // around a threshold keep the level they had.
+    void CheckSelection()
+    {
+        using namespace gWorldAr;
+        CHECK(util::SelectLod(1.0f, util::MAX_LOD_COUNT, 0) == 0);
+        CHECK(util::SelectLod(0.01f, util::MAX_LOD_COUNT, 0) == util::MAX_LOD_COUNT - 1);
+        CHECK(util::SelectLod(0.01f, 2, 0) == 1);
+        CHECK(util::SelectLod(0.01f, 1, 0) == 0);
+        CHECK(util::SelectLod(1.0f, util::MAX_LOD_COUNT, util::MAX_LOD_COUNT - 1) == 0);
+
+        size_t lod = 0;
+        size_t changes = 0;
+        for (float size = 1.0f; size > 0.01f; size *= 0.99f) {
+            size_t next = util::SelectLod(size, util::MAX_LOD_COUNT, lod);
+            CHECK(next >= lod);
+            changes += (next != lod);
+            lod = next;
+        }
+        CHECK(lod == util::MAX_LOD_COUNT - 1 && changes == util::MAX_LOD_COUNT - 1);
+
+        const float threshold = util::LOD_SCREEN_SIZES[0];
+        lod = util::SelectLod(threshold, util::MAX_LOD_COUNT, 0);
+        for (int frame = 0; frame < 100; ++frame) {
+            float jitter = (frame % 2 == 0 ? 1.0f : -1.0f) * util::LOD_HYSTERESIS * 0.5f;
+            CHECK(util::SelectLod(threshold * (1.0f + jitter), util::MAX_LOD_COUNT, lod) == lod);
+        }
+        printf("level selection: %zu changes from full size to 1%% of the screen, none while jittering\n", changes);
+    }
+}
+
+// Generates the levels of detail WorldObjectRenderer draws distant objects with, and checks how
+// far they are from the full mesh and that level selection does not flicker.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 3;
+
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    Simplify("AR_logo.obj", std::string(logo.begin(), logo.end()), false, iterations);
+    Simplify("sphere 64x64", host::GenerateSphereObj(64, 64), true, iterations);
+    Simplify("sphere 400x400", host::GenerateSphereObj(400, 400), true, 1);
+    CheckSelection();
+    return 0;
+}
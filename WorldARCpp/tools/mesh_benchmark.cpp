@@ -0,0 +1,146 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/log.h"
+#include "utils/mesh_format.h"
+#include "utils/mesh_optimizer.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    // Splits a model too large for 16-bit indices and checks that the sub-meshes draw exactly the
+    // triangles of the original.
+    void CheckSplit(int iterations)
+    {
+        using namespace gWorldAr;
+        std::string obj = host::GenerateSphereObj(400, 400);
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<uint32_t> indices;
+        CHECK(util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, indices));
+        CHECK(vertices.size() / 3 > util::MAX_VERTICES_16_BIT);
+
+        std::vector<float> splitVertices;
+        std::vector<float> splitNormals;
+        std::vector<float> splitUvs;
+        std::vector<uint16_t> splitIndices;
+        std::vector<util::SubMesh> subMeshes;
+        double splitMs = host::MeasureMs(iterations, [&]() {
+            util::SplitMesh(vertices, normals, uvs, indices, util::MAX_VERTICES_16_BIT,
+                            splitVertices, splitNormals, splitUvs, splitIndices, subMeshes);
+        });
+
+        CHECK(splitIndices.size() == indices.size());
+        size_t corner = 0;
+        for (const util::SubMesh &subMesh : subMeshes) {
+            CHECK(subMesh.vertexCount <= util::MAX_VERTICES_16_BIT);
+            CHECK(subMesh.firstIndex == corner);
+            for (uint32_t i = 0; i < subMesh.indexCount; ++i, ++corner) {
+                CHECK(splitIndices[corner] < subMesh.vertexCount);
+                size_t splitVertex = subMesh.firstVertex + splitIndices[corner];
+                size_t vertex = indices[corner];
+                for (int axis = 0; axis < 3; ++axis) {
+                    CHECK(splitVertices[splitVertex * 3 + axis] == vertices[vertex * 3 + axis]);
+                    CHECK(splitNormals[splitVertex * 3 + axis] == normals[vertex * 3 + axis]);
+                }
+                CHECK(splitUvs[splitVertex * 2] == uvs[vertex * 2]);
+                CHECK(splitUvs[splitVertex * 2 + 1] == uvs[vertex * 2 + 1]);
+            }
+        }
+        CHECK(corner == indices.size());
+
+        std::vector<uint8_t> meshFile;
+        CHECK(util::WriteMeshFile(splitVertices, splitNormals, splitUvs, splitIndices, subMeshes, {},
+                                  util::MESH_VERTEX_FORMAT_FLOAT, meshFile));
+        util::MeshFileView view;
+        CHECK(util::ReadMeshFile(meshFile.data(), meshFile.size(), view));
+        CHECK(view.header->subMeshCount == subMeshes.size() && view.header->indexSize == sizeof(uint16_t));
+
+        printf("sphere 400x400: %zu vertices split into %zu sub-meshes with %zu vertices in %.3f ms\n",
+               vertices.size() / 3, subMeshes.size(), splitVertices.size() / 3, splitMs);
+    }
+}
+
+// Compares parsing AR_logo.obj at runtime with mapping the compiled mesh, which is what
+// WorldObjectRenderer does on device when the compiled asset is shipped.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    const std::string objPath = host::AssetPath("AR_logo.obj");
+    const std::string meshPath = "AR_logo.benchmark.mesh";
+
+    std::vector<char> objFile;
+    if (!host::ReadFile(objPath, objFile)) {
+        return 1;
+    }
+
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    double parseMs = host::MeasureMs(iterations, [&]() {
+        vertices.clear();
+        normals.clear();
+        uvs.clear();
+        indices.clear();
+        CHECK(util::ParseObj(objFile.data(), objFile.size(), vertices, normals, uvs, indices));
+    });
+
+    CHECK(vertices.size() / 3 <= util::MAX_VERTICES_16_BIT);
+    std::vector<uint16_t> indices16(indices.begin(), indices.end());
+    std::vector<util::SubMesh> subMeshes = {
+        {0, static_cast<uint32_t>(vertices.size() / 3), 0, static_cast<uint32_t>(indices.size())}
+    };
+    std::vector<uint8_t> meshFile;
+    CHECK(util::WriteMeshFile(vertices, normals, uvs, indices16, subMeshes, {}, util::MESH_VERTEX_FORMAT_FLOAT,
+                              meshFile));
+    CHECK(host::WriteFile(meshPath, meshFile.data(), meshFile.size()));
+
+    uint32_t indexCount = 0;
+    double mapMs = host::MeasureMs(iterations, [&]() {
+        int fd = open(meshPath.c_str(), O_RDONLY);
+        CHECK(fd >= 0);
+        void *data = mmap(nullptr, meshFile.size(), PROT_READ, MAP_PRIVATE, fd, 0);
+        CHECK(data != MAP_FAILED);
+        util::MeshFileView view;
+        CHECK(util::ReadMeshFile(data, meshFile.size(), view));
+        indexCount = view.header->indexCount;
+        munmap(data, meshFile.size());
+        close(fd);
+    });
+    unlink(meshPath.c_str());
+    CHECK(indexCount == indices.size());
+
+    printf("AR_logo.obj: %zu bytes, %zu vertices, %zu indices\n", objFile.size(), vertices.size() / 3,
+           indices.size());
+    printf("AR_logo.mesh: %zu bytes\n", meshFile.size());
+    printf("parse obj:    %10.3f ms\n", parseMs);
+    printf("map mesh:     %10.3f ms (%.0fx faster)\n", mapMs, parseMs / mapMs);
+
+    CheckSplit(iterations);
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host_util.h"
+#include "utils/mesh_format.h"
+#include "utils/mesh_optimizer.h"
+#include "utils/mesh_simplifier.h"
+#include "utils/obj_parser.h"
+
+// Usage: mesh_compiler [--index32] [--quantize] [--lods <count>] <input.obj> <output.mesh>
+// Meshes with more vertices than 16-bit indices address are split into sub-meshes, which every
+// device can draw. With --index32 they are written with 32-bit indices instead, which needs
+// OpenGL ES 3.0 or GL_OES_element_index_uint on the device. With --quantize vertices are stored
+// as 16-byte QuantizedVertex instead of 32 bytes of floats. --lods sets the largest number of
+// levels of detail, from 1 to MAX_LOD_COUNT, which is the default.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    bool isIndex32Allowed = false;
+    util::MeshVertexFormat vertexFormat = util::MESH_VERTEX_FORMAT_FLOAT;
+    size_t lodCount = util::MAX_LOD_COUNT;
+    int argument = 1;
+    for (; argument < argc && argv[argument][0] == '-'; ++argument) {
+        std::string option = argv[argument];
+        if (option == "--index32") {
+            isIndex32Allowed = true;
+        } else if (option == "--quantize") {
+            vertexFormat = util::MESH_VERTEX_FORMAT_QUANTIZED;
+        } else if (option == "--lods" && argument + 1 < argc) {
+            lodCount = std::min(static_cast<size_t>(std::max(1, atoi(argv[++argument]))), util::MAX_LOD_COUNT);
+        } else {
+            break;
+        }
+    }
+    if (argc - argument != 2) {
+        fprintf(stderr, "Usage: %s [--index32] [--quantize] [--lods <count>] <input.obj> <output.mesh>\n",
+                argv[0]);
+        return 1;
+    }
+    const char *inputPath = argv[argument];
+    const char *outputPath = argv[argument + 1];
+
+    std::vector<char> objFile;
+    if (!host::ReadFile(inputPath, objFile)) {
+        return 1;
+    }
+
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    util::ObjStats stats;
+    if (!util::ParseObj(objFile.data(), objFile.size(), vertices, normals, uvs, indices, &stats,
+                        std::max(1u, std::thread::hardware_concurrency()))) {
+        fprintf(stderr, "Could not parse %s\n", inputPath);
+        return 1;
+    }
+
+    util::VertexCacheStats before = util::AnalyzeVertexCache(indices, stats.vertexCount);
+    util::OptimizeMesh(vertices, normals, uvs, indices);
+    // Vertices no triangle uses are dropped by the optimization.
+    const size_t vertexCount = vertices.size() / 3;
+    util::VertexCacheStats after = util::AnalyzeVertexCache(indices, vertexCount);
+    printf("vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+
+    std::vector<std::vector<uint32_t>> lodIndices;
+    std::vector<float> lodErrors;
+    util::GenerateLods(vertices, indices, lodCount, lodIndices, lodErrors);
+    for (size_t lod = 0; lod < lodIndices.size(); ++lod) {
+        printf("level of detail %zu: %zu triangles, error %g\n", lod, lodIndices[lod].size() / 3, lodErrors[lod]);
+    }
+
+    std::vector<float> lodVertices;
+    std::vector<float> lodNormals;
+    std::vector<float> lodUvs;
+    std::vector<uint32_t> lodIndexData;
+    std::vector<util::SubMesh> subMeshes;
+    std::vector<util::MeshLod> lods;
+    const bool isIndex32 = vertexCount > util::MAX_VERTICES_16_BIT && isIndex32Allowed;
+    util::CombineLods(vertices, normals, uvs, lodIndices, lodErrors, isIndex32 ? 0 : util::MAX_VERTICES_16_BIT,
+                      lodVertices, lodNormals, lodUvs, lodIndexData, subMeshes, lods);
+
+    std::vector<uint8_t> meshFile;
+    bool isWritten = false;
+    if (isIndex32) {
+        isWritten = util::WriteMeshFile(lodVertices, lodNormals, lodUvs, lodIndexData, subMeshes, lods,
+                                        vertexFormat, meshFile);
+    } else {
+        std::vector<uint16_t> indices16(lodIndexData.begin(), lodIndexData.end());
+        isWritten = util::WriteMeshFile(lodVertices, lodNormals, lodUvs, indices16, subMeshes, lods,
+                                        vertexFormat, meshFile);
+    }
+    if (!isWritten || !host::WriteFile(outputPath, meshFile.data(), meshFile.size())) {
+        fprintf(stderr, "Could not write %s\n", outputPath);
+        return 1;
+    }
+    printf("%s: %zu triangle corners welded into %zu vertices, %zu indices, %zu levels of detail in %zu "
+           "sub-meshes, %zu bytes\n", outputPath, stats.cornerCount, stats.vertexCount, lodIndexData.size(),
+           lods.size(), subMeshes.size(), meshFile.size());
+    return 0;
+}
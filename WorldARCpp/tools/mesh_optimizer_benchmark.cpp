@@ -0,0 +1,112 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/log.h"
+#include "utils/mesh_optimizer.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    using Triangle = std::array<float, 24>;
+
+    // The triangles of a mesh with their attributes, rotated to start at their smallest corner and
+    // sorted, so two meshes drawing the same triangles compare equal however they are ordered.
+    std::vector<Triangle> SortedTriangles(const std::vector<float> &vertices, const std::vector<float> &normals,
+                                          const std::vector<float> &uvs, const std::vector<uint32_t> &indices)
+    {
+        std::vector<Triangle> triangles(indices.size() / 3);
+        for (size_t triangle = 0; triangle < triangles.size(); ++triangle) {
+            std::array<std::array<float, 8>, 3> corners;
+            for (int corner = 0; corner < 3; ++corner) {
+                uint32_t index = indices[triangle * 3 + corner];
+                std::copy_n(&vertices[index * 3], 3, corners[corner].begin());
+                std::copy_n(&normals[index * 3], 3, corners[corner].begin() + 3);
+                std::copy_n(&uvs[index * 2], 2, corners[corner].begin() + 6);
+            }
+            std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+            for (int corner = 0; corner < 3; ++corner) {
+                std::copy(corners[corner].begin(), corners[corner].end(), triangles[triangle].begin() + corner * 8);
+            }
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    void Optimize(const char *name, const std::string &obj, bool isShuffled, int iterations)
+    {
+        using namespace gWorldAr;
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<uint32_t> indices;
+        CHECK(util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, indices));
+        if (isShuffled) {
+            // Stands in for exporters that write triangles in no particular order.
+            std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+            std::copy_n(indices.data(), indices.size(), triangles[0].data());
+            std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+            std::copy_n(triangles[0].data(), indices.size(), indices.data());
+        }
+        const std::vector<Triangle> expected = SortedTriangles(vertices, normals, uvs, indices);
+        util::VertexCacheStats before = util::AnalyzeVertexCache(indices, vertices.size() / 3);
+
+        std::vector<float> optimizedVertices;
+        std::vector<float> optimizedNormals;
+        std::vector<float> optimizedUvs;
+        std::vector<uint32_t> optimizedIndices;
+        double optimizeMs = host::MeasureMs(iterations, [&]() {
+            optimizedVertices = vertices;
+            optimizedNormals = normals;
+            optimizedUvs = uvs;
+            optimizedIndices = indices;
+            util::OptimizeMesh(optimizedVertices, optimizedNormals, optimizedUvs, optimizedIndices);
+        });
+        util::VertexCacheStats after = util::AnalyzeVertexCache(optimizedIndices, optimizedVertices.size() / 3);
+        CHECK(SortedTriangles(optimizedVertices, optimizedNormals, optimizedUvs, optimizedIndices) == expected);
+        CHECK(after.acmr <= before.acmr);
+
+        printf("%-26s %7zu triangles  ACMR %.3f -> %.3f  ATVR %.3f -> %.3f  %8.3f ms\n", name,
+               indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr, optimizeMs);
+    }
+}
+
+// Reports the vertex cache efficiency of meshes as loaded and after OptimizeMesh, with a FIFO cache
+// of VERTEX_CACHE_SIZE entries, and checks that the optimized meshes draw the same triangles.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 5;
+
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    const std::string logoObj(logo.begin(), logo.end());
+    const std::string sphereObj = host::GenerateSphereObj(128, 128);
+    Optimize("AR_logo.obj", logoObj, false, iterations);
+    Optimize("AR_logo.obj shuffled", logoObj, true, iterations);
+    Optimize("sphere 128x128", sphereObj, false, iterations);
+    Optimize("sphere 128x128 shuffled", sphereObj, true, iterations);
+    return 0;
+}
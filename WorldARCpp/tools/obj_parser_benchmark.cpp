@@ -0,0 +1,148 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host_util.h"
+#include "legacy_obj_parser.h"
+#include "synthetic_models.h"
+#include "utils/log.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    template <typename Index>
+    struct ParsedMesh {
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<Index> indices;
+    };
+
+    template <typename ParseFunction, typename Index>
+    double Parse(ParseFunction parse, const std::string &obj, int iterations, ParsedMesh<Index> &mesh)
+    {
+        return gWorldAr::host::MeasureMs(iterations, [&]() {
+            mesh = ParsedMesh<Index>();
+            CHECK(parse(obj.data(), obj.size(), mesh.vertices, mesh.normals, mesh.uvs, mesh.indices));
+        });
+    }
+
+    // Order independent fingerprint of the drawn triangles, so the comparison holds however the
+    // loader shares or orders vertices. The legacy loader wrote one vertex per corner and its 16-bit
+    // indices wrap on large models, so its corners are read in order instead.
+    template <typename Index>
+    double Fingerprint(const ParsedMesh<Index> &mesh, bool isUnrolled)
+    {
+        double sum = 0.0;
+        for (size_t corner = 0; corner < mesh.indices.size(); ++corner) {
+            size_t index = isUnrolled ? corner : mesh.indices[corner];
+            for (int axis = 0; axis < 3; ++axis) {
+                sum += mesh.vertices[index * 3 + axis] * (axis + 1);
+                sum += mesh.normals[index * 3 + axis] * (axis + 4);
+            }
+            sum += mesh.uvs[index * 2] * 7 + mesh.uvs[index * 2 + 1] * 8;
+        }
+        return sum;
+    }
+
+    void Compare(const char *name, const std::string &obj, int iterations)
+    {
+        ParsedMesh<uint16_t> legacyMesh;
+        ParsedMesh<uint32_t> mesh;
+        double legacyMs = Parse(gWorldAr::legacy::ParseObj, obj, iterations, legacyMesh);
+        auto parse = [](const char *data, size_t size, std::vector<float> &vertices, std::vector<float> &normals,
+                        std::vector<float> &uvs, std::vector<uint32_t> &indices) {
+            return gWorldAr::util::ParseObj(data, size, vertices, normals, uvs, indices);
+        };
+        double currentMs = Parse(parse, obj, iterations, mesh);
+        CHECK(legacyMesh.indices.size() == mesh.indices.size());
+        double legacyFingerprint = Fingerprint(legacyMesh, true);
+        CHECK(std::fabs(legacyFingerprint - Fingerprint(mesh, false)) <= 1e-6 * std::fabs(legacyFingerprint) + 1e-3);
+        printf("%-24s %8zu bytes %7zu triangles  legacy %9.3f ms  current %8.3f ms  %5.1fx\n", name, obj.size(),
+               mesh.indices.size() / 3, legacyMs, currentMs, legacyMs / currentMs);
+        printf("%-24s vertices: legacy %zu, welded %zu (%.1fx fewer)\n", "", legacyMesh.vertices.size() / 3,
+               mesh.vertices.size() / 3, static_cast<double>(legacyMesh.vertices.size()) / mesh.vertices.size());
+    }
+
+    template <typename T>
+    bool IsBitIdentical(const std::vector<T> &a, const std::vector<T> &b)
+    {
+        return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+    }
+
+    // Parses on 1 to 8 threads and checks every result is bit-identical to the serial one.
+    void CompareThreads(const char *name, const std::string &obj, int iterations)
+    {
+        ParsedMesh<uint32_t> serial;
+        double serialMs = 0.0;
+        printf("%-24s %8zu bytes, %u hardware threads\n", name, obj.size(), std::thread::hardware_concurrency());
+        for (size_t threadCount = 1; threadCount <= 8; threadCount *= 2) {
+            ParsedMesh<uint32_t> mesh;
+            double ms = gWorldAr::host::MeasureMs(iterations, [&]() {
+                mesh = ParsedMesh<uint32_t>();
+                CHECK(gWorldAr::util::ParseObj(obj.data(), obj.size(), mesh.vertices, mesh.normals, mesh.uvs,
+                                               mesh.indices, nullptr, threadCount));
+            });
+            if (threadCount == 1) {
+                serial = mesh;
+                serialMs = ms;
+            }
+            CHECK(IsBitIdentical(mesh.vertices, serial.vertices) && IsBitIdentical(mesh.normals, serial.normals) &&
+                  IsBitIdentical(mesh.uvs, serial.uvs) && IsBitIdentical(mesh.indices, serial.indices));
+            printf("%-24s %zu threads %9.3f ms  %5.2fx\n", "", threadCount, ms, serialMs / ms);
+        }
+    }
+}
+
+// Compares the single-pass obj tokenizer with the stringstream based loader it replaced, and the
+// number of vertices each of them sends to the GPU. Then measures how parsing scales with threads.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    Compare("AR_logo.obj", std::string(logo.begin(), logo.end()), iterations);
+    // The legacy loader stores 16-bit indices, so the largest model stays below 65536 positions.
+    Compare("sphere 64x64", host::GenerateSphereObj(64, 64), iterations);
+    Compare("sphere 250x250", host::GenerateSphereObj(250, 250), iterations);
+
+    // Lines longer than the 128 characters the legacy loader read are parsed in full.
+    std::string longLine = "v 1.0 2.0 " + std::string(200, ' ') + "3.0\nvt 0 0\nvn 0 1 0\nf 1/1/1 1/1/1 1/1/1\n";
+    ParsedMesh<uint32_t> mesh;
+    CHECK(util::ParseObj(longLine.data(), longLine.size(), mesh.vertices, mesh.normals, mesh.uvs, mesh.indices));
+    CHECK(!mesh.vertices.empty() && mesh.vertices[2] == 3.0f);
+
+    // Models with more vertices than 16-bit indices address load in full.
+    std::string largeSphere = host::GenerateSphereObj(400, 400);
+    CHECK(util::ParseObj(largeSphere.data(), largeSphere.size(), mesh.vertices, mesh.normals, mesh.uvs,
+                         mesh.indices));
+    CHECK(mesh.vertices.size() / 3 == 401 * 401);
+    CHECK(mesh.indices.size() == 400 * 400 * 6);
+
+    // Relative indices resolve against the elements of earlier chunks.
+    CompareThreads("sphere 400x400", largeSphere, iterations);
+    CompareThreads("sphere 400x400 relative", host::GenerateSphereObj(400, 400, true), iterations);
+    return 0;
+}
@@ -0,0 +1,384 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/type_ptr.hpp>
+
+#include "host_gl.h"
+#include "utils/gl_state.h"
+#include "utils/log.h"
+#include "utils/plane_mesh.h"
+#include "utils/program_builder.h"
+
+namespace {
+    // The plane shader before batching: plane space vertices, with the pose and color as uniforms.
+    constexpr char PER_PLANE_VERTEX_SHADER[] = R"(
+    precision highp float;
+    attribute vec3 vertex;
+    varying vec2 v_textureCoords;
+    varying float v_alpha;
+    varying vec3 v_color;
+    uniform mat4 mvp;
+    uniform mat4 model_mat;
+    uniform vec3 normal;
+    uniform vec3 color;
+    void main() {
+        v_alpha = vertex.z;
+        v_color = color;
+        vec4 local_pos = vec4(vertex.x, 0.0, vertex.y, 1.0);
+        gl_Position = mvp * local_pos;
+        vec4 world_pos = model_mat * local_pos;
+        const vec3 arbitrary = vec3(1.0, 1.0, 0.0);
+        vec3 vec_u = normalize(cross(normal, arbitrary));
+        vec3 vec_v = normalize(cross(normal, vec_u));
+        v_textureCoords = vec2(dot(world_pos.xyz, vec_u), dot(world_pos.xyz, vec_v));
+    })";
+
+    // The batched plane shader of the renderer.
+    constexpr char BATCHED_VERTEX_SHADER[] = R"(
+    precision highp float;
+    attribute vec4 vertex;
+    attribute vec3 normal;
+    attribute vec3 plane_color;
+    varying vec2 v_textureCoords;
+    varying float v_alpha;
+    varying vec3 v_color;
+    uniform mat4 view_projection;
+    void main() {
+        v_alpha = vertex.w;
+        v_color = plane_color;
+        vec4 world_pos = vec4(vertex.xyz, 1.0);
+        gl_Position = view_projection * world_pos;
+        const vec3 arbitrary = vec3(1.0, 1.0, 0.0);
+        vec3 vec_u = normalize(cross(normal, arbitrary));
+        vec3 vec_v = normalize(cross(normal, vec_u));
+        v_textureCoords = vec2(dot(world_pos.xyz, vec_u), dot(world_pos.xyz, vec_v));
+    })";
+
+    constexpr char FRAGMENT_SHADER[] = R"(
+    precision highp float;
+    uniform sampler2D texture;
+    varying vec2 v_textureCoords;
+    varying float v_alpha;
+    varying vec3 v_color;
+    void main() {
+        float r = texture2D(texture, v_textureCoords).r;
+        gl_FragColor = vec4(v_color, r * v_alpha);
+    })";
+
+    constexpr GLsizei TARGET_SIZE = 256;
+    constexpr GLsizei TIMING_SIZE = 4;
+
+    // Channel difference that counts a pixel as different. The two paths transform vertices in a
+    // different order, which moves some edges by a fraction of a pixel.
+    constexpr int PIXEL_TOLERANCE = 8;
+
+    // A plane of a room, with its mesh in plane space and in world space.
+    struct ScenePlane {
+        glm::mat4 modelMat;
+        glm::vec3 normal;
+        glm::vec3 color;
+        std::vector<glm::vec3> vertices;
+        std::vector<uint16_t> triangles;
+        std::vector<gWorldAr::util::PlaneVertex> worldVertices;
+        GLuint vertexBuffer = 0;
+        GLuint indexBuffer = 0;
+        float depth = 0.0f;
+    };
+
+    // Floors, tables and walls around the camera, with feathered 32-point polygons.
+    std::vector<ScenePlane> GenerateRoom(size_t planeCount, const glm::mat4 &viewMat, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> position(-2.0f, 2.0f);
+        std::uniform_real_distribution<float> height(-1.5f, 0.0f);
+        std::uniform_real_distribution<float> size(0.3f, 1.0f);
+        std::vector<ScenePlane> planes(planeCount);
+        for (size_t i = 0; i < planeCount; ++i) {
+            ScenePlane &plane = planes[i];
+            const bool isWall = (i % 3 == 2);
+            plane.modelMat = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), height(random),
+                position(random) - 3.0f));
+            if (isWall) {
+                plane.modelMat = glm::rotate(plane.modelMat, 1.5707963f, glm::vec3(1.0f, 0.0f, 0.0f));
+            }
+            plane.normal = glm::vec3(plane.modelMat * glm::vec4(0.0f, 1.0f, 0.0f, 0.0f));
+            plane.color = (i == 0) ? glm::vec3(255.0f, 255.0f, 255.0f) : glm::vec3(0.0f, 206.0f, 209.0f);
+            std::vector<glm::vec2> polygon;
+            const float radius = size(random);
+            for (int point = 0; point < 32; ++point) {
+                const float angle = 6.2831853f * static_cast<float>(point) / 32.0f;
+                polygon.emplace_back(std::cos(angle) * radius, std::sin(angle) * radius);
+            }
+            CHECK(gWorldAr::util::BuildPlaneMesh(polygon, plane.vertices, plane.triangles));
+            gWorldAr::util::BakePlaneVertices(plane.vertices, plane.modelMat, plane.normal, plane.color,
+                                              plane.worldVertices);
+            plane.depth = -(viewMat * plane.modelMat[3]).z;
+        }
+        // Both paths blend the planes back to front.
+        std::sort(planes.begin(), planes.end(), [](const ScenePlane &a, const ScenePlane &b) {
+            return a.depth > b.depth;
+        });
+        return planes;
+    }
+
+    struct Scene {
+        std::vector<ScenePlane> planes;
+        glm::mat4 viewMat;
+        glm::mat4 projectionMat;
+        GLuint texture;
+        GLuint perPlaneProgram;
+        GLuint batchedProgram;
+        GLuint batchVertexBuffer;
+        GLuint batchIndexBuffer;
+    };
+
+    void SetCommonState(GLuint program, GLuint texture)
+    {
+        gWorldAr::util::GlStateCache &state = gWorldAr::util::GetGlState();
+        state.UseProgram(program);
+        state.ActiveTexture(GL_TEXTURE0);
+        state.BindTexture(GL_TEXTURE_2D, texture);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // One draw per plane, as RenderPlanes did.
+    size_t DrawPerPlane(const Scene &scene)
+    {
+        using namespace gWorldAr;
+        util::GlStateCache &state = util::GetGlState();
+        const GLuint program = scene.perPlaneProgram;
+        SetCommonState(program, scene.texture);
+        const GLint vertex = glGetAttribLocation(program, "vertex");
+        state.SetVertexAttribArrays(util::VertexAttribBit(vertex));
+        for (const ScenePlane &plane : scene.planes) {
+            const glm::mat4 mvpMat = scene.projectionMat * scene.viewMat * plane.modelMat;
+            glUniformMatrix4fv(glGetUniformLocation(program, "mvp"), 1, GL_FALSE, glm::value_ptr(mvpMat));
+            glUniformMatrix4fv(glGetUniformLocation(program, "model_mat"), 1, GL_FALSE,
+                glm::value_ptr(plane.modelMat));
+            glUniform3fv(glGetUniformLocation(program, "normal"), 1, glm::value_ptr(plane.normal));
+            glUniform3fv(glGetUniformLocation(program, "color"), 1, glm::value_ptr(plane.color));
+            state.BindBuffer(GL_ARRAY_BUFFER, plane.vertexBuffer);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, plane.indexBuffer);
+            glVertexAttribPointer(vertex, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(plane.triangles.size()), GL_UNSIGNED_SHORT, nullptr);
+        }
+        return scene.planes.size();
+    }
+
+    // All planes from one buffer. The buffers are filled again when isRefilled is set, as when a plane
+    // moved or the order changed.
+    size_t DrawBatched(const Scene &scene, bool isRefilled)
+    {
+        using namespace gWorldAr;
+        util::GlStateCache &state = util::GetGlState();
+        static std::vector<util::PlaneVertex> batchVertices;
+        static std::vector<uint16_t> batchIndices;
+        static std::vector<util::PlaneBatchRange> ranges;
+        state.BindBuffer(GL_ARRAY_BUFFER, scene.batchVertexBuffer);
+        state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene.batchIndexBuffer);
+        if (isRefilled) {
+            batchVertices.clear();
+            batchIndices.clear();
+            ranges.clear();
+            for (const ScenePlane &plane : scene.planes) {
+                util::AppendPlaneToBatch(plane.worldVertices, plane.triangles, batchVertices, batchIndices, ranges);
+            }
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(batchVertices.size() * sizeof(util::PlaneVertex)),
+                batchVertices.data(), GL_DYNAMIC_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(batchIndices.size() * sizeof(uint16_t)),
+                batchIndices.data(), GL_DYNAMIC_DRAW);
+        }
+
+        const GLuint program = scene.batchedProgram;
+        SetCommonState(program, scene.texture);
+        const GLint vertex = glGetAttribLocation(program, "vertex");
+        const GLint normal = glGetAttribLocation(program, "normal");
+        const GLint color = glGetAttribLocation(program, "plane_color");
+        state.SetVertexAttribArrays(util::VertexAttribBit(vertex) | util::VertexAttribBit(normal) |
+                                    util::VertexAttribBit(color));
+        const glm::mat4 viewProjectionMat = scene.projectionMat * scene.viewMat;
+        glUniformMatrix4fv(glGetUniformLocation(program, "view_projection"), 1, GL_FALSE,
+            glm::value_ptr(viewProjectionMat));
+        const GLsizei stride = sizeof(util::PlaneVertex);
+        for (const util::PlaneBatchRange &range : ranges) {
+            const size_t offset = range.firstVertex * sizeof(util::PlaneVertex);
+            glVertexAttribPointer(vertex, 4, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(offset + offsetof(util::PlaneVertex, position)));
+            glVertexAttribPointer(normal, 3, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(offset + offsetof(util::PlaneVertex, normal)));
+            glVertexAttribPointer(color, 3, GL_FLOAT, GL_FALSE, stride,
+                reinterpret_cast<const GLvoid *>(offset + offsetof(util::PlaneVertex, color)));
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), GL_UNSIGNED_SHORT,
+                reinterpret_cast<const GLvoid *>(range.firstIndex * sizeof(uint16_t)));
+        }
+        return ranges.size();
+    }
+
+    std::vector<GLubyte> ReadPixels()
+    {
+        std::vector<GLubyte> pixels(static_cast<size_t>(TARGET_SIZE) * TARGET_SIZE * 4);
+        glReadPixels(0, 0, TARGET_SIZE, TARGET_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    }
+
+    double CountDifferentPixels(const std::vector<GLubyte> &a, const std::vector<GLubyte> &b)
+    {
+        size_t different = 0;
+        for (size_t i = 0; i < a.size(); i += 4) {
+            for (size_t channel = 0; channel < 4; ++channel) {
+                if (std::abs(a[i + channel] - b[i + channel]) > PIXEL_TOLERANCE) {
+                    ++different;
+                    break;
+                }
+            }
+        }
+        return static_cast<double>(different) / (a.size() / 4);
+    }
+
+    // Mean frame time of the fastest of several rounds, including the GPU work.
+    template <typename Function>
+    double MeasureFrameMs(int frameCount, Function &&drawFrame)
+    {
+        constexpr int ROUND_COUNT = 5;
+        double fastestMs = 0.0;
+        for (int round = 0; round < ROUND_COUNT; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; ++frame) {
+                drawFrame();
+            }
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double ms = elapsed.count() / frameCount;
+            fastestMs = (round == 0) ? ms : std::min(fastestMs, ms);
+        }
+        return fastestMs;
+    }
+
+    GLuint CreateTexture()
+    {
+        // Grid lines like trigrid.png, in the red channel the shader reads.
+        std::vector<GLubyte> texels(64 * 64 * 4, 0);
+        for (int y = 0; y < 64; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                texels[(y * 64 + x) * 4] = (x % 16 < 2 || y % 16 < 2) ? 255 : 40;
+            }
+        }
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        gWorldAr::util::GetGlState().BindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 64, 64, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return texture;
+    }
+}
+
+// Draws rooms of detected planes with one call per plane, as before, and batched in world space, as the
+// plane renderer does now. Checks that both draw the same pixels and counts the draw calls.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int frameCount = argc > 1 ? atoi(argv[1]) : 50;
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    // The pbuffer of the context is too small to compare pixels, so the planes are drawn offscreen.
+    GLuint framebuffer = 0;
+    GLuint renderbuffer = 0;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8_OES, TARGET_SIZE, TARGET_SIZE);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    CHECK(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    util::GlStateCache &state = util::GetGlState();
+    state.SetCapability(GL_BLEND, true);
+    state.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    Scene scene;
+    scene.viewMat = glm::lookAt(glm::vec3(0.0f, 1.0f, 1.0f), glm::vec3(0.0f, -0.5f, -3.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.projectionMat = glm::perspective(1.2f, 1.0f, 0.1f, 20.0f);
+    scene.texture = CreateTexture();
+    util::ProgramBuilder builder;
+    scene.perPlaneProgram = builder.Take(builder.Submit(PER_PLANE_VERTEX_SHADER, FRAGMENT_SHADER));
+    scene.batchedProgram = builder.Take(builder.Submit(BATCHED_VERTEX_SHADER, FRAGMENT_SHADER));
+    CHECK(scene.perPlaneProgram != 0 && scene.batchedProgram != 0);
+    GLuint batchBuffers[2] = {0, 0};
+    glGenBuffers(2, batchBuffers);
+    scene.batchVertexBuffer = batchBuffers[0];
+    scene.batchIndexBuffer = batchBuffers[1];
+
+    std::mt19937 random(5);
+    for (size_t planeCount : {4, 16, 48, 96}) {
+        scene.planes = GenerateRoom(planeCount, scene.viewMat, random);
+        for (ScenePlane &plane : scene.planes) {
+            GLuint buffers[2] = {0, 0};
+            glGenBuffers(2, buffers);
+            plane.vertexBuffer = buffers[0];
+            plane.indexBuffer = buffers[1];
+            state.BindBuffer(GL_ARRAY_BUFFER, plane.vertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(plane.vertices.size() * sizeof(glm::vec3)),
+                plane.vertices.data(), GL_STATIC_DRAW);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, plane.indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(plane.triangles.size() * sizeof(uint16_t)),
+                plane.triangles.data(), GL_STATIC_DRAW);
+        }
+
+        const size_t perPlaneCalls = DrawPerPlane(scene);
+        const std::vector<GLubyte> perPlanePixels = ReadPixels();
+        CHECK(std::count(perPlanePixels.begin(), perPlanePixels.end(), 0) < static_cast<long>(perPlanePixels.size()));
+        const size_t batchedCalls = DrawBatched(scene, true);
+        const double different = CountDifferentPixels(perPlanePixels, ReadPixels());
+        CHECK(glGetError() == GL_NO_ERROR);
+        CHECK(different < 0.002);
+
+        // Timed on a few pixels, so the frame time is the cost of submitting the planes rather than filling them.
+        glViewport(0, 0, TIMING_SIZE, TIMING_SIZE);
+        const double perPlaneMs = MeasureFrameMs(frameCount, [&]() { DrawPerPlane(scene); });
+        const double refilledMs = MeasureFrameMs(frameCount, [&]() { DrawBatched(scene, true); });
+        const double cachedMs = MeasureFrameMs(frameCount, [&]() { DrawBatched(scene, false); });
+        glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+        printf("%3zu planes  per plane %3zu calls %7.3f ms  batched %zu calls %7.3f ms refilled, %7.3f ms cached  "
+               "%.2f%% pixels differ\n", planeCount, perPlaneCalls, perPlaneMs, batchedCalls, refilledMs, cachedMs,
+               different * 100.0);
+
+        for (ScenePlane &plane : scene.planes) {
+            state.BindBuffer(GL_ARRAY_BUFFER, 0);
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            GLuint buffers[2] = {plane.vertexBuffer, plane.indexBuffer};
+            glDeleteBuffers(2, buffers);
+        }
+    }
+    return 0;
+}
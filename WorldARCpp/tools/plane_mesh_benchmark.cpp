@@ -0,0 +1,143 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/plane_mesh.h"
+
+namespace {
+    // A plane as the tracker reports it, and the mesh the renderer keeps for it.
+    struct TrackedPlane {
+        std::vector<glm::vec2> polygon;
+        std::vector<glm::vec3> vertices;
+        std::vector<uint16_t> triangles;
+        uint64_t polygonHash = 0;
+    };
+
+    // Convex polygon around the center, as detected planes are.
+    std::vector<glm::vec2> GeneratePolygon(size_t pointCount, float radius, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> jitter(0.9f, 1.1f);
+        std::vector<glm::vec2> polygon;
+        for (size_t i = 0; i < pointCount; ++i) {
+            const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(pointCount);
+            polygon.emplace_back(std::cos(angle) * radius * jitter(random), std::sin(angle) * radius * jitter(random));
+        }
+        return polygon;
+    }
+
+    size_t GetMeshBytes(const TrackedPlane &plane)
+    {
+        return plane.vertices.size() * sizeof(glm::vec3) + plane.triangles.size() * sizeof(uint16_t);
+    }
+
+    // Result of simulating frameCount frames.
+    struct FrameStats {
+        double ms;
+        double meshesPerFrame;
+        double bytesPerFrame;
+    };
+
+    // Every frame the tracker reports updatedCount planes, of which one in grownInterval has a new polygon;
+    // the others only have a refined pose. The renderer either meshes every plane every frame, as before,
+    // or only the reported planes whose polygon hash changed.
+    FrameStats Simulate(std::vector<TrackedPlane> &planes, size_t updatedCount, size_t grownInterval,
+                        bool isCached, int frameCount, std::mt19937 &random)
+    {
+        size_t meshCount = 0;
+        size_t byteCount = 0;
+        size_t updateIndex = 0;
+        std::vector<glm::vec2> grown;
+        double ms = gWorldAr::host::MeasureMs(frameCount, [&]() {
+            for (size_t i = 0; i < updatedCount; ++i, ++updateIndex) {
+                TrackedPlane &plane = planes[updateIndex % planes.size()];
+                if (updateIndex % grownInterval == 0) {
+                    grown = GeneratePolygon(plane.polygon.size(), 1.0f, random);
+                    plane.polygon.swap(grown);
+                }
+                if (isCached) {
+                    const uint64_t hash = gWorldAr::util::HashPlanePolygon(plane.polygon);
+                    if (hash != plane.polygonHash) {
+                        CHECK(gWorldAr::util::BuildPlaneMesh(plane.polygon, plane.vertices, plane.triangles));
+                        plane.polygonHash = hash;
+                        ++meshCount;
+                        byteCount += GetMeshBytes(plane);
+                    }
+                }
+            }
+            if (!isCached) {
+                for (TrackedPlane &plane : planes) {
+                    CHECK(gWorldAr::util::BuildPlaneMesh(plane.polygon, plane.vertices, plane.triangles));
+                    ++meshCount;
+                    byteCount += GetMeshBytes(plane);
+                }
+            }
+        });
+        return {ms, static_cast<double>(meshCount) / frameCount, static_cast<double>(byteCount) / frameCount};
+    }
+}
+
+// Compares meshing every plane every frame with the mesh cache of the plane renderer, which only meshes
+// planes reported as updated whose polygon changed. Checks that the cached meshes match fresh ones.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int frameCount = argc > 1 ? atoi(argv[1]) : 2000;
+    std::mt19937 random(7);
+
+    // Planes, points per polygon, planes updated per frame and how often an update changes the polygon.
+    const struct {
+        size_t planeCount;
+        size_t pointCount;
+        size_t updatedCount;
+        size_t grownInterval;
+    } SCENES[] = {{4, 32, 0, 1}, {4, 32, 1, 4}, {12, 64, 2, 4}, {12, 64, 12, 1}};
+
+    for (const auto &scene : SCENES) {
+        std::vector<TrackedPlane> planes(scene.planeCount);
+        // New planes are meshed when they are first drawn.
+        for (TrackedPlane &plane : planes) {
+            plane.polygon = GeneratePolygon(scene.pointCount, 1.0f, random);
+            CHECK(util::BuildPlaneMesh(plane.polygon, plane.vertices, plane.triangles));
+            plane.polygonHash = util::HashPlanePolygon(plane.polygon);
+        }
+        std::mt19937 rebuildRandom(11);
+        std::mt19937 cachedRandom(11);
+        std::vector<TrackedPlane> rebuiltPlanes = planes;
+        FrameStats rebuilt = Simulate(rebuiltPlanes, scene.updatedCount, scene.grownInterval, false, frameCount,
+                                      rebuildRandom);
+        FrameStats cached = Simulate(planes, scene.updatedCount, scene.grownInterval, true, frameCount,
+                                     cachedRandom);
+        for (size_t i = 0; i < planes.size(); ++i) {
+            CHECK(planes[i].polygon == rebuiltPlanes[i].polygon);
+            CHECK(planes[i].vertices == rebuiltPlanes[i].vertices && planes[i].triangles == rebuiltPlanes[i].triangles);
+        }
+        printf("%2zu planes x %2zu points, %2zu updated per frame, 1 in %zu with a new polygon\n",
+               scene.planeCount, scene.pointCount, scene.updatedCount, scene.grownInterval);
+        printf("    every frame %8.4f ms %6.2f meshes %8.0f bytes per frame\n", rebuilt.ms, rebuilt.meshesPerFrame,
+               rebuilt.bytesPerFrame);
+        printf("    cached      %8.4f ms %6.2f meshes %8.0f bytes per frame\n", cached.ms, cached.meshesPerFrame,
+               cached.bytesPerFrame);
+    }
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <glm.hpp>
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/plane_mesh.h"
+#include "utils/polygon_simplifier.h"
+
+namespace {
+    // Distance of a point from the boundary of a closed polygon.
+    float GetBoundaryDistance(const glm::vec2 &point, const std::vector<glm::vec2> &polygon)
+    {
+        float nearest = std::numeric_limits<float>::max();
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            const glm::vec2 &a = polygon[i];
+            const glm::vec2 edge = polygon[(i + 1) % polygon.size()] - a;
+            const float t = glm::clamp(glm::dot(point - a, edge) / std::max(glm::dot(edge, edge), 1e-12f), 0.0f, 1.0f);
+            nearest = std::min(nearest, glm::length(point - (a + edge * t)));
+        }
+        return nearest;
+    }
+
+    bool IsConvex(const std::vector<glm::vec2> &polygon)
+    {
+        bool hasLeftTurn = false;
+        bool hasRightTurn = false;
+        for (size_t i = 0; i < polygon.size(); ++i) {
+            const glm::vec2 &a = polygon[i];
+            const glm::vec2 &b = polygon[(i + 1) % polygon.size()];
+            const glm::vec2 &c = polygon[(i + 2) % polygon.size()];
+            const float cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            hasLeftTurn = hasLeftTurn || cross > 0.0f;
+            hasRightTurn = hasRightTurn || cross < 0.0f;
+        }
+        return !(hasLeftTurn && hasRightTurn);
+    }
+
+    // Boundary as a tracker reports it for a large plane: a point every few millimeters, with noise.
+    std::vector<glm::vec2> GenerateEllipse(size_t pointCount, float noise, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> jitter(-noise, noise);
+        std::vector<glm::vec2> polygon;
+        for (size_t i = 0; i < pointCount; ++i) {
+            const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(pointCount);
+            polygon.emplace_back(std::cos(angle) * 2.0f + jitter(random), std::sin(angle) * 1.5f + jitter(random));
+        }
+        return polygon;
+    }
+
+    // L-shaped floor of 6 by 4 meters, sampled along its walls.
+    std::vector<glm::vec2> GenerateLShapedRoom(float spacing, float noise, std::mt19937 &random)
+    {
+        const glm::vec2 corners[] = {{-3.0f, -2.0f}, {3.0f, -2.0f}, {3.0f, 0.0f}, {0.0f, 0.0f}, {0.0f, 2.0f},
+            {-3.0f, 2.0f}};
+        std::uniform_real_distribution<float> jitter(-noise, noise);
+        std::vector<glm::vec2> polygon;
+        for (size_t corner = 0; corner < 6; ++corner) {
+            const glm::vec2 &a = corners[corner];
+            const glm::vec2 &b = corners[(corner + 1) % 6];
+            const int stepCount = static_cast<int>(glm::length(b - a) / spacing);
+            for (int step = 0; step < stepCount; ++step) {
+                const glm::vec2 point = a + (b - a) * (static_cast<float>(step) / static_cast<float>(stepCount));
+                polygon.emplace_back(point.x + jitter(random), point.y + jitter(random));
+            }
+        }
+        return polygon;
+    }
+
+    // Comb whose teeth are closer than the coarser tolerances, which Douglas-Peucker alone would cross.
+    std::vector<glm::vec2> GenerateComb(size_t toothCount, float gap)
+    {
+        std::vector<glm::vec2> polygon;
+        for (size_t i = 0; i < toothCount; ++i) {
+            const float x = static_cast<float>(i) * gap * 2.0f;
+            polygon.emplace_back(x, 0.0f);
+            polygon.emplace_back(x, 1.0f);
+            polygon.emplace_back(x + gap, 1.0f);
+            polygon.emplace_back(x + gap, 0.0f);
+        }
+        const float width = static_cast<float>(toothCount) * gap * 2.0f;
+        polygon.emplace_back(width, 0.0f);
+        polygon.emplace_back(width, -0.1f);
+        polygon.emplace_back(0.0f, -0.1f);
+        return polygon;
+    }
+
+    void Compare(const char *name, const std::vector<glm::vec2> &polygon, float tolerance, size_t maxPointCount,
+                 int iterations)
+    {
+        using namespace gWorldAr;
+        std::vector<glm::vec2> simplified;
+        float usedTolerance = 0.0f;
+        const double simplifyMs = host::MeasureMs(iterations, [&]() {
+            usedTolerance = util::SimplifyPolygon(polygon, tolerance, maxPointCount, simplified);
+        });
+        CHECK(util::IsPolygonSimple(simplified));
+        CHECK(!IsConvex(polygon) || IsConvex(simplified));
+        float deviation = 0.0f;
+        for (const glm::vec2 &point : polygon) {
+            deviation = std::max(deviation, GetBoundaryDistance(point, simplified));
+        }
+        CHECK(deviation <= usedTolerance * 1.001f + 1e-6f);
+
+        std::vector<glm::vec3> vertices;
+        std::vector<uint16_t> triangles;
+        std::vector<uint16_t> rawTriangles;
+        bool isRawMeshed = false;
+        const double rawMeshMs = host::MeasureMs(iterations, [&]() {
+            isRawMeshed = util::BuildPlaneMesh(polygon, vertices, rawTriangles);
+        });
+        const double meshMs = host::MeasureMs(iterations, [&]() {
+            CHECK(util::BuildPlaneMesh(simplified, vertices, triangles));
+        });
+        // Room for the 20 digits of the largest size_t.
+        char limit[24] = "none";
+        if (maxPointCount != static_cast<size_t>(-1)) {
+            snprintf(limit, sizeof(limit), "%zu", maxPointCount);
+        }
+        printf("%-16s %5.3f m, limit %4s  %5zu -> %4zu points (%5.1fx)  used %6.4f m, off by %6.4f m  "
+               "simplify %7.3f ms\n", name, tolerance, limit, polygon.size(), simplified.size(),
+               static_cast<double>(polygon.size()) / simplified.size(), usedTolerance, deviation, simplifyMs);
+        if (isRawMeshed) {
+            printf("%-16s mesh %5zu -> %4zu triangles, %7.3f -> %6.3f ms\n", "", rawTriangles.size() / 3,
+                   triangles.size() / 3, rawMeshMs, meshMs);
+        } else {
+            printf("%-16s mesh too large for 16-bit indices -> %4zu triangles, %6.3f ms\n", "",
+                   triangles.size() / 3, meshMs);
+        }
+    }
+}
+
+// Simplifies dense plane boundaries before meshing, at the tolerances and point limit the plane renderer
+// can be configured with. Checks that the simplified polygons stay simple, that convex ones stay convex
+// and that no dropped point is farther from the boundary than the tolerance used.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 5;
+    const size_t noLimit = static_cast<size_t>(-1);
+    std::mt19937 random(13);
+
+    const std::vector<glm::vec2> ellipse = GenerateEllipse(4000, 0.0f, random);
+    const std::vector<glm::vec2> noisyEllipse = GenerateEllipse(4000, 0.003f, random);
+    const std::vector<glm::vec2> room = GenerateLShapedRoom(0.005f, 0.003f, random);
+    const std::vector<glm::vec2> largeRoom = GenerateLShapedRoom(0.0005f, 0.001f, random);
+    for (float tolerance : {0.005f, 0.01f, 0.02f, 0.05f}) {
+        Compare("convex ellipse", ellipse, tolerance, noLimit, iterations);
+        Compare("noisy ellipse", noisyEllipse, tolerance, noLimit, iterations);
+        Compare("L-shaped room", room, tolerance, noLimit, iterations);
+    }
+    // The point limit bounds the mesh however detailed the boundary is.
+    Compare("convex ellipse", ellipse, 0.001f, 64, iterations);
+    Compare("noisy ellipse", noisyEllipse, 0.001f, 256, iterations);
+    Compare("L-shaped room", largeRoom, 0.01f, 256, iterations);
+    // Teeth 1 cm apart stay apart at coarser tolerances.
+    for (float tolerance : {0.005f, 0.02f, 0.1f}) {
+        Compare("comb", GenerateComb(64, 0.01f), tolerance, noLimit, iterations);
+    }
+    // A notch reaching into a 5 cm bump of the opposite wall. Dropping the bump alone, as Douglas-Peucker
+    // would at 6 cm, makes the notch cross the wall, so the tolerance is lowered instead.
+    const std::vector<glm::vec2> notched = {{0.0f, 0.0f}, {0.45f, 0.0f}, {0.5f, 1.02f}, {0.55f, 0.0f}, {1.0f, 0.0f},
+        {1.0f, 1.0f}, {0.5f, 1.05f}, {0.0f, 1.0f}};
+    std::vector<glm::vec2> simplified;
+    CHECK(util::SimplifyPolygon(notched, 0.06f, noLimit, simplified) < 0.05f && simplified.size() == notched.size());
+    Compare("notch in a bump", notched, 0.06f, noLimit, iterations);
+    // Under a limit of 6 points the notch goes with the bump, rather than the limit giving way.
+    CHECK(util::SimplifyPolygon(notched, 0.06f, 6, simplified) > 0.0f && simplified.size() <= 6);
+    Compare("notch in a bump", notched, 0.06f, 6, iterations);
+    return 0;
+}
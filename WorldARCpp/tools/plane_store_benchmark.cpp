@@ -0,0 +1,205 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <glm.hpp>
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/plane_store.h"
+
+namespace {
+    // Same cadence as the render manager.
+    constexpr uint32_t PLANE_UNSEEN_FRAMES = 30;
+    constexpr uint32_t PLANE_COMPACT_INTERVAL = 30;
+
+    // A plane the simulated engine reports. Its address may be one a removed plane had.
+    struct EnginePlane {
+        const void *key;
+        uint32_t id;
+        uint32_t lastFrame;
+        bool isSubsumedAtEnd;
+        gWorldAr::util::TrackableHandle handle;
+    };
+
+    glm::vec3 GetPlaneColor(uint32_t id)
+    {
+        return glm::vec3(static_cast<float>(id), 0.0f, 0.0f);
+    }
+
+    // What the render manager and plane renderer kept before: the color and the cached pose of every
+    // plane ever seen, each in a map keyed by the plane's address and never pruned.
+    struct MapState {
+        std::unordered_map<const void *, glm::vec3> colors;
+        std::unordered_map<const void *, glm::mat4> poses;
+        size_t staleColorCount = 0;
+    };
+
+    struct SessionStats {
+        size_t planeCount = 0;
+        size_t peakLivePlanes = 0;
+        size_t recycledAddressCount = 0;
+    };
+
+    // Runs a session of frameCount frames in which planes appear, live for a while and are then either
+    // subsumed or no longer reported. The engine reuses the address of a plane once it is released.
+    SessionStats RunSession(uint32_t frameCount, size_t livePlanes, gWorldAr::util::PlaneStore &store, MapState &maps,
+                            std::vector<EnginePlane> &planes)
+    {
+        using namespace gWorldAr;
+        std::mt19937 random(17);
+        std::uniform_int_distribution<uint32_t> lifetime(100, 3000);
+        std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+        // Fresh addresses come from a large arena, released ones are handed out again half of the time.
+        static std::vector<unsigned char> arena(1 << 20);
+        size_t nextAddress = 0;
+        std::vector<const void *> releasedKeys;
+        std::vector<const void *> removedKeys;
+        SessionStats stats;
+
+        for (uint32_t frame = 1; frame <= frameCount; ++frame) {
+            if (planes.size() < livePlanes && chance(random) < 0.05f) {
+                EnginePlane plane = {};
+                if (!releasedKeys.empty() && chance(random) < 0.5f) {
+                    plane.key = releasedKeys.back();
+                    releasedKeys.pop_back();
+                    ++stats.recycledAddressCount;
+                } else {
+                    plane.key = &arena[nextAddress++ % arena.size()];
+                }
+                plane.id = static_cast<uint32_t>(++stats.planeCount);
+                plane.lastFrame = frame + lifetime(random);
+                plane.isSubsumedAtEnd = chance(random) < 0.5f;
+                planes.push_back(plane);
+            }
+            stats.peakLivePlanes = std::max(stats.peakLivePlanes, planes.size());
+
+            for (size_t i = 0; i < planes.size();) {
+                EnginePlane &plane = planes[i];
+                util::TrackableHandle handle = store.Find(plane.key);
+                // A subsumed plane is reported once more, as subsumed; a lost one is just no longer reported.
+                if (frame > plane.lastFrame) {
+                    if (plane.isSubsumedAtEnd && store.IsValid(handle)) {
+                        store.MarkSubsumed(handle);
+                    }
+                    planes[i] = planes.back();
+                    planes.pop_back();
+                    continue;
+                }
+                if (store.IsValid(handle)) {
+                    store.MarkSeen(handle, frame);
+                } else {
+                    handle = store.Insert(plane.key, GetPlaneColor(plane.id), frame);
+                }
+                CHECK(handle.generation == plane.handle.generation || plane.handle.generation == 0);
+                plane.handle = handle;
+                CHECK(store.GetColors()[store.GetIndex(handle)] == GetPlaneColor(plane.id));
+
+                // The maps find the color of an earlier plane at a reused address.
+                auto color = maps.colors.find(plane.key);
+                if (color == maps.colors.end()) {
+                    maps.colors.emplace(plane.key, GetPlaneColor(plane.id));
+                } else if (color->second != GetPlaneColor(plane.id)) {
+                    ++maps.staleColorCount;
+                    color->second = GetPlaneColor(plane.id);
+                }
+                maps.poses[plane.key] = glm::mat4(1.0f);
+                ++i;
+            }
+
+            if (frame % PLANE_COMPACT_INTERVAL == 0) {
+                std::vector<util::TrackableHandle> handles;
+                for (size_t index = 0; index < store.GetSize(); ++index) {
+                    handles.push_back(store.GetHandle(index));
+                }
+                store.Compact(frame, PLANE_UNSEEN_FRAMES, removedKeys);
+                releasedKeys.insert(releasedKeys.end(), removedKeys.begin(), removedKeys.end());
+                // Exactly the removed planes lose their handles, and the others keep theirs.
+                size_t invalidCount = 0;
+                for (const util::TrackableHandle &handle : handles) {
+                    invalidCount += store.IsValid(handle) ? 0 : 1;
+                }
+                CHECK(invalidCount == removedKeys.size() && store.GetSize() == handles.size() - invalidCount);
+            }
+        }
+        return stats;
+    }
+}
+
+// Simulates a long session of planes appearing and disappearing, and compares the plane store of the
+// render manager with the unpruned maps keyed by address it replaced: entries kept, colors inherited
+// through reused addresses and the cost of the per-frame lookups and of iterating the plane state.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const uint32_t frameCount = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 108000;
+    const size_t livePlanes = 24;
+
+    util::PlaneStore store;
+    MapState maps;
+    std::vector<EnginePlane> planes;
+    const SessionStats stats = RunSession(frameCount, livePlanes, store, maps, planes);
+    // Every live plane is stored, and no other plane outlives the unseen frames plus one compaction interval.
+    CHECK(store.GetSize() >= planes.size());
+    for (uint32_t lastSeenFrame : store.GetLastSeenFrames()) {
+        CHECK(frameCount - lastSeenFrame <= PLANE_UNSEEN_FRAMES + PLANE_COMPACT_INTERVAL);
+    }
+    printf("%u frames, %zu planes, at most %zu live, %zu reused addresses\n", frameCount, stats.planeCount,
+           stats.peakLivePlanes, stats.recycledAddressCount);
+    printf("    maps   %6zu entries  %4zu planes inherited a stale color\n", maps.colors.size(),
+           maps.staleColorCount);
+    printf("    store  %6zu entries     0 planes inherited a stale color\n", store.GetSize());
+
+    // One frame of the render manager and plane renderer: look up the live planes, then read their
+    // color and pose.
+    const int iterations = 20000;
+    float sum = 0.0f;
+    const double mapMs = host::MeasureMs(iterations, [&]() {
+        for (const EnginePlane &plane : planes) {
+            sum += maps.colors.find(plane.key)->second.x;
+            sum += maps.poses.find(plane.key)->second[3].z;
+        }
+    });
+    const double storeMs = host::MeasureMs(iterations, [&]() {
+        for (const EnginePlane &plane : planes) {
+            const util::TrackableHandle handle = store.Find(plane.key);
+            const size_t index = store.GetIndex(handle);
+            sum += store.GetColors()[index].x;
+            sum += store.GetCenterPoses()[index][3].z;
+        }
+    });
+    printf("    %zu live planes per frame: maps %.5f ms, store %.5f ms\n", planes.size(), mapMs, storeMs);
+
+    // Renderers walking every plane, as for depth sorting: the maps hold every plane ever seen.
+    const double mapIterateMs = host::MeasureMs(iterations / 10, [&]() {
+        for (const auto &pose : maps.poses) {
+            sum += pose.second[3].z;
+        }
+    });
+    const double storeIterateMs = host::MeasureMs(iterations / 10, [&]() {
+        for (const glm::mat4 &pose : store.GetCenterPoses()) {
+            sum += pose[3].z;
+        }
+    });
+    printf("    iterating the plane poses: maps %.5f ms, store %.5f ms\n", mapIterateMs, storeIterateMs);
+    return sum == -1.0f ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/plane_mesh.h"
+#include "utils/polygon_triangulator.h"
+
+namespace {
+    // Twice the signed area of a polygon, positive when it turns counterclockwise.
+    double GetPolygonArea(const std::vector<glm::vec2> &polygon)
+    {
+        double area = 0.0;
+        for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+            area += static_cast<double>(polygon[j].x) * polygon[i].y - static_cast<double>(polygon[i].x) * polygon[j].y;
+        }
+        return area;
+    }
+
+    double GetTriangleArea(const glm::vec2 &a, const glm::vec2 &b, const glm::vec2 &c)
+    {
+        return (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y) -
+               (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x);
+    }
+
+    // Sum of the unsigned areas of the triangles, and whether all of them turn the way the polygon does.
+    // Triangles that all turn the same way and add up to the area of the polygon cover it exactly once.
+    double GetCoveredArea(const std::vector<glm::vec2> &polygon, const std::vector<uint16_t> &triangles,
+                          uint32_t baseIndex, bool &isWindingKept)
+    {
+        const double winding = GetPolygonArea(polygon) < 0.0 ? -1.0 : 1.0;
+        double covered = 0.0;
+        isWindingKept = true;
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            const glm::vec2 &a = polygon[triangles[i] - baseIndex];
+            const glm::vec2 &b = polygon[triangles[i + 1] - baseIndex];
+            const double area = GetTriangleArea(a, b, polygon[triangles[i + 2] - baseIndex]) * winding;
+            isWindingKept = isWindingKept && area >= -1e-9;
+            covered += std::fabs(area);
+        }
+        return covered;
+    }
+
+    // The triangle fan around the first point that plane meshes used, correct for convex polygons only.
+    void TriangulateFan(const std::vector<glm::vec2> &polygon, std::vector<uint16_t> &outTriangles)
+    {
+        for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+            outTriangles.insert(outTriangles.end(), {0, static_cast<uint16_t>(i), static_cast<uint16_t>(i + 1)});
+        }
+    }
+
+    // Floor outline with a random radius per point: concave, but seen whole from its center like a room.
+    std::vector<glm::vec2> GenerateRoom(size_t pointCount, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> radius(0.4f, 1.0f);
+        std::vector<glm::vec2> polygon;
+        for (size_t i = 0; i < pointCount; ++i) {
+            const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(pointCount);
+            const float r = radius(random);
+            polygon.emplace_back(std::cos(angle) * r, std::sin(angle) * r);
+        }
+        return polygon;
+    }
+
+    // Star whose points alternate between two radii.
+    std::vector<glm::vec2> GenerateStar(size_t pointCount)
+    {
+        std::vector<glm::vec2> polygon;
+        for (size_t i = 0; i < pointCount; ++i) {
+            const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(pointCount);
+            const float r = (i % 2 == 0) ? 1.0f : 0.5f;
+            polygon.emplace_back(std::cos(angle) * r, std::sin(angle) * r);
+        }
+        return polygon;
+    }
+
+    // Comb of thin teeth on a bar, clockwise, where most points are reflex and most ears are blocked.
+    std::vector<glm::vec2> GenerateComb(size_t toothCount)
+    {
+        std::vector<glm::vec2> polygon;
+        const float width = 1.0f / static_cast<float>(toothCount);
+        for (size_t i = 0; i < toothCount; ++i) {
+            const float x = static_cast<float>(i) * width;
+            polygon.emplace_back(x, 0.0f);
+            polygon.emplace_back(x, 1.0f);
+            polygon.emplace_back(x + width * 0.5f, 1.0f);
+            polygon.emplace_back(x + width * 0.5f, 0.0f);
+        }
+        polygon.emplace_back(1.0f, 0.0f);
+        polygon.emplace_back(1.0f, -0.2f);
+        polygon.emplace_back(0.0f, -0.2f);
+        return polygon;
+    }
+
+    void Compare(const char *name, const std::vector<glm::vec2> &polygon, int iterations)
+    {
+        using namespace gWorldAr;
+        std::vector<uint16_t> triangles;
+        std::vector<uint16_t> fanTriangles;
+        const double earMs = host::MeasureMs(iterations, [&]() {
+            triangles.clear();
+            CHECK(util::TriangulatePolygon(polygon, 0, triangles));
+        });
+        const double fanMs = host::MeasureMs(iterations, [&]() {
+            fanTriangles.clear();
+            TriangulateFan(polygon, fanTriangles);
+        });
+
+        const double area = std::fabs(GetPolygonArea(polygon));
+        bool isWindingKept = false;
+        CHECK(triangles.size() == (polygon.size() - 2) * 3);
+        const double covered = GetCoveredArea(polygon, triangles, 0, isWindingKept);
+        CHECK(isWindingKept && std::fabs(covered - area) <= 1e-4 * area);
+        bool isFanWindingKept = false;
+        const double fanCovered = GetCoveredArea(polygon, fanTriangles, 0, isFanWindingKept);
+        printf("%-22s %5zu points  ear clipping %8.4f ms  fan %8.4f ms  fan covers %5.2fx the area%s\n", name,
+               polygon.size(), earMs, fanMs, fanCovered / area, isFanWindingKept ? "" : ", with flipped triangles");
+    }
+
+    // The inner polygon of a plane mesh covers its area once, and the band uses the same inner points.
+    void CheckPlaneMesh(const std::vector<glm::vec2> &polygon)
+    {
+        std::vector<glm::vec3> vertices;
+        std::vector<uint16_t> triangles;
+        CHECK(gWorldAr::util::BuildPlaneMesh(polygon, vertices, triangles));
+        const size_t pointCount = polygon.size();
+        CHECK(triangles.size() == (pointCount - 2 + pointCount * 2) * 3);
+        std::vector<glm::vec2> innerPolygon;
+        for (size_t i = pointCount; i < vertices.size(); ++i) {
+            innerPolygon.emplace_back(vertices[i].x, vertices[i].y);
+        }
+        const std::vector<uint16_t> innerTriangles(triangles.begin(), triangles.begin() + (pointCount - 2) * 3);
+        for (uint16_t index : innerTriangles) {
+            CHECK(index >= pointCount && index < pointCount * 2);
+        }
+        bool isWindingKept = false;
+        const double area = std::fabs(GetPolygonArea(innerPolygon));
+        const double covered = GetCoveredArea(innerPolygon, innerTriangles, static_cast<uint32_t>(pointCount),
+                                              isWindingKept);
+        CHECK(isWindingKept && std::fabs(covered - area) <= 1e-4 * area);
+    }
+}
+
+// Triangulates synthetic concave polygons by ear clipping, checks every triangle keeps the winding and
+// that together they cover the polygon exactly once, and compares with the triangle fan it replaced.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    std::mt19937 random(3);
+
+    // A convex polygon, which the fan already covered once.
+    std::vector<glm::vec2> circle;
+    for (int i = 0; i < 64; ++i) {
+        circle.emplace_back(std::cos(0.0981748f * i), std::sin(0.0981748f * i));
+    }
+    Compare("convex", circle, iterations);
+    for (size_t pointCount : {64, 256, 1024}) {
+        const std::vector<glm::vec2> room = GenerateRoom(pointCount, random);
+        Compare("room", room, iterations);
+        CheckPlaneMesh(room);
+    }
+    for (size_t pointCount : {64, 256, 1024}) {
+        const std::vector<glm::vec2> star = GenerateStar(pointCount);
+        Compare("star", star, iterations);
+        CheckPlaneMesh(star);
+    }
+    for (size_t toothCount : {16, 64, 256}) {
+        Compare("comb, clockwise", GenerateComb(toothCount), iterations);
+    }
+
+    // Too few points to triangulate.
+    std::vector<uint16_t> triangles;
+    CHECK(!util::TriangulatePolygon({glm::vec2(0.0f), glm::vec2(1.0f)}, 0, triangles) && triangles.empty());
+    // Points on a line give triangles of no area, but as many as any polygon.
+    CHECK(util::TriangulatePolygon({{0.0f, 0.0f}, {1.0f, 0.0f}, {2.0f, 0.0f}, {3.0f, 0.0f}}, 0, triangles));
+    CHECK(triangles.size() == 6);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+#ifdef WORLD_AR_HAS_LIBPNG
+#include <png.h>
+#endif
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/png_decoder.h"
+
+namespace {
+    void AppendBigEndian32(std::vector<uint8_t> &out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void AppendChunk(std::vector<uint8_t> &out, const char *type, const uint8_t *data, size_t size)
+    {
+        AppendBigEndian32(out, static_cast<uint32_t>(size));
+        const size_t typeOffset = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+        AppendBigEndian32(out, static_cast<uint32_t>(crc32(0, out.data() + typeOffset, size + 4)));
+    }
+
+    // Rows of file samples, with the filter of each row cycling through all five.
+    struct TestImage {
+        uint32_t width;
+        uint32_t height;
+        uint8_t bitDepth;
+        uint8_t colorType;
+        std::vector<std::vector<uint8_t>> rows;
+        std::vector<uint8_t> palette; // RGB entries.
+        std::vector<uint8_t> alphas; // tRNS entries of palette images, or the transparent color of others.
+    };
+
+    uint8_t Predict(uint8_t filter, int a, int b, int c)
+    {
+        switch (filter) {
+            case 1:
+                return static_cast<uint8_t>(a);
+            case 2:
+                return static_cast<uint8_t>(b);
+            case 3:
+                return static_cast<uint8_t>((a + b) / 2);
+            case 4: {
+                int p = a + b - c;
+                int pa = abs(p - a);
+                int pb = abs(p - b);
+                int pc = abs(p - c);
+                return static_cast<uint8_t>((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+            }
+            default:
+                return 0;
+        }
+    }
+
+    // Encode a test image, splitting the image data across IDAT chunks of chunkSize bytes.
+    std::vector<uint8_t> EncodePng(const TestImage &image, size_t chunkSize, bool isInterlaced = false)
+    {
+        const size_t channels = image.colorType == 2 ? 3 : image.colorType == 4 ? 2 : image.colorType == 6 ? 4 : 1;
+        const size_t bytesPerPixel = std::max<size_t>(1, channels * image.bitDepth / 8);
+        std::vector<uint8_t> filtered;
+        for (uint32_t y = 0; y < image.height; ++y) {
+            const std::vector<uint8_t> &row = image.rows[y];
+            const uint8_t filter = static_cast<uint8_t>(y % 5);
+            filtered.push_back(filter);
+            for (size_t i = 0; i < row.size(); ++i) {
+                int a = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+                int b = y > 0 ? image.rows[y - 1][i] : 0;
+                int c = (y > 0 && i >= bytesPerPixel) ? image.rows[y - 1][i - bytesPerPixel] : 0;
+                filtered.push_back(static_cast<uint8_t>(row[i] - Predict(filter, a, b, c)));
+            }
+        }
+        uLongf compressedSize = compressBound(filtered.size());
+        std::vector<uint8_t> compressed(compressedSize);
+        CHECK(compress2(compressed.data(), &compressedSize, filtered.data(), filtered.size(), 9) == Z_OK);
+        compressed.resize(compressedSize);
+
+        std::vector<uint8_t> file = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+        std::vector<uint8_t> header;
+        AppendBigEndian32(header, image.width);
+        AppendBigEndian32(header, image.height);
+        header.insert(header.end(), {image.bitDepth, image.colorType, 0, 0, static_cast<uint8_t>(isInterlaced)});
+        AppendChunk(file, "IHDR", header.data(), header.size());
+        if (!image.palette.empty()) {
+            AppendChunk(file, "PLTE", image.palette.data(), image.palette.size());
+        }
+        if (!image.alphas.empty()) {
+            AppendChunk(file, "tRNS", image.alphas.data(), image.alphas.size());
+        }
+        for (size_t offset = 0; offset < compressed.size(); offset += chunkSize) {
+            AppendChunk(file, "IDAT", compressed.data() + offset, std::min(chunkSize, compressed.size() - offset));
+        }
+        AppendChunk(file, "IEND", nullptr, 0);
+        return file;
+    }
+
+    // Sample of a row at the bit depth of the image.
+    uint32_t ReadSample(const TestImage &image, const std::vector<uint8_t> &row, size_t sample)
+    {
+        if (image.bitDepth == 16) {
+            return (static_cast<uint32_t>(row[sample * 2]) << 8) | row[sample * 2 + 1];
+        }
+        if (image.bitDepth == 8) {
+            return row[sample];
+        }
+        const size_t bit = sample * image.bitDepth;
+        return (row[bit / 8] >> (8 - image.bitDepth - bit % 8)) & ((1u << image.bitDepth) - 1);
+    }
+
+    // The 8-bit pixels the decoder has to produce for a test image.
+    std::vector<uint8_t> ExpectedPixels(const TestImage &image, uint32_t &outChannels)
+    {
+        const uint32_t fileChannels = image.colorType == 2 ? 3 : image.colorType == 4 ? 2 :
+            image.colorType == 6 ? 4 : 1;
+        const bool isPalette = image.colorType == 3;
+        outChannels = isPalette ? (image.alphas.empty() ? 3 : 4) : fileChannels + (image.alphas.empty() ? 0 : 1);
+        std::vector<uint8_t> pixels;
+        for (const std::vector<uint8_t> &row : image.rows) {
+            for (uint32_t x = 0; x < image.width; ++x) {
+                bool isTransparent = true;
+                for (uint32_t channel = 0; channel < fileChannels; ++channel) {
+                    const uint32_t value = ReadSample(image, row, static_cast<size_t>(x) * fileChannels + channel);
+                    if (isPalette) {
+                        pixels.insert(pixels.end(), &image.palette[value * 3], &image.palette[value * 3 + 3]);
+                        if (outChannels == 4) {
+                            pixels.push_back(value < image.alphas.size() ? image.alphas[value] : 255);
+                        }
+                        continue;
+                    }
+                    if (!image.alphas.empty()) {
+                        const uint32_t key = (image.alphas[channel * 2] << 8) | image.alphas[channel * 2 + 1];
+                        isTransparent = isTransparent && value == key;
+                    }
+                    if (image.bitDepth == 16) {
+                        pixels.push_back(static_cast<uint8_t>(value >> 8));
+                    } else {
+                        pixels.push_back(static_cast<uint8_t>(value * 255 / ((1u << image.bitDepth) - 1)));
+                    }
+                }
+                if (!isPalette && !image.alphas.empty()) {
+                    pixels.push_back(isTransparent ? 0 : 255);
+                }
+            }
+        }
+        return pixels;
+    }
+
+    // Give a gray or RGB image the color of one of its pixels as transparent color.
+    void SetColorKey(TestImage &image, uint32_t x, uint32_t y)
+    {
+        const uint32_t fileChannels = image.colorType == 2 ? 3 : 1;
+        image.alphas.clear();
+        for (uint32_t channel = 0; channel < fileChannels; ++channel) {
+            const uint32_t value = ReadSample(image, image.rows[y], static_cast<size_t>(x) * fileChannels + channel);
+            image.alphas.push_back(static_cast<uint8_t>(value >> 8));
+            image.alphas.push_back(static_cast<uint8_t>(value));
+        }
+    }
+
+    TestImage MakeTestImage(uint32_t width, uint32_t height, uint8_t bitDepth, uint8_t colorType, unsigned seed)
+    {
+        TestImage image = {width, height, bitDepth, colorType, {}, {}, {}};
+        const size_t channels = colorType == 2 ? 3 : colorType == 4 ? 2 : colorType == 6 ? 4 : 1;
+        const size_t rowSize = (width * channels * bitDepth + 7) / 8;
+        srand(seed);
+        const uint32_t paletteSize = colorType == 3 ? (1u << bitDepth) : 0;
+        for (uint32_t i = 0; i < paletteSize * 3; ++i) {
+            image.palette.push_back(static_cast<uint8_t>(rand()));
+        }
+        for (uint32_t i = 0; i < paletteSize / 2; ++i) {
+            image.alphas.push_back(static_cast<uint8_t>(rand()));
+        }
+        for (uint32_t y = 0; y < height; ++y) {
+            std::vector<uint8_t> row(rowSize);
+            for (size_t i = 0; i < rowSize; ++i) {
+                // Smooth gradients with some noise, so every filter sees neighbours that matter.
+                row[i] = static_cast<uint8_t>(i * 3 + y * 5 + rand() % 8);
+            }
+            // Bits past the last pixel are padding.
+            const size_t usedBits = static_cast<size_t>(width) * channels * bitDepth;
+            if (usedBits % 8 != 0) {
+                row.back() &= static_cast<uint8_t>(0xFF << (8 - usedBits % 8));
+            }
+            image.rows.push_back(row);
+        }
+        return image;
+    }
+
+    void CheckRoundTrips()
+    {
+        using namespace gWorldAr;
+        struct Format {
+            uint8_t bitDepth;
+            uint8_t colorType;
+        };
+        const Format formats[] = {
+            {1, 0}, {2, 0}, {4, 0}, {8, 0}, {16, 0}, {8, 2}, {16, 2}, {1, 3}, {2, 3}, {4, 3}, {8, 3},
+            {8, 4}, {16, 4}, {8, 6}, {16, 6}
+        };
+        util::PngDecoder decoder;
+        util::PngImage decoded;
+        size_t count = 0;
+        for (const Format &format : formats) {
+            // Odd widths leave partial bytes at the end of low bit depth rows.
+            for (uint32_t width : {1u, 7u, 33u}) {
+                TestImage image = MakeTestImage(width, 11, format.bitDepth, format.colorType, width);
+                std::vector<uint8_t> file = EncodePng(image, 17);
+                uint32_t channels = 0;
+                std::vector<uint8_t> expected = ExpectedPixels(image, channels);
+                CHECK(decoder.Decode(file.data(), file.size(), decoded));
+                CHECK(decoded.width == width && decoded.height == 11 && decoded.channels == channels);
+                CHECK(decoded.pixels == expected);
+                ++count;
+            }
+        }
+
+        // The transparent color of gray and RGB images becomes an alpha channel, as platform decoders do.
+        for (const Format &format : formats) {
+            if (format.colorType != 0 && format.colorType != 2) {
+                continue;
+            }
+            TestImage image = MakeTestImage(33, 11, format.bitDepth, format.colorType, 5);
+            // Low bit depth gray images repeat their values, so some other pixels match as well.
+            SetColorKey(image, 3, 4);
+            std::vector<uint8_t> file = EncodePng(image, 17);
+            uint32_t channels = 0;
+            std::vector<uint8_t> expected = ExpectedPixels(image, channels);
+            CHECK(decoder.Decode(file.data(), file.size(), decoded));
+            CHECK(decoded.channels == channels && decoded.pixels == expected);
+            CHECK(decoded.pixels[(4 * 33 + 3) * channels + channels - 1] == 0);
+            ++count;
+        }
+
+        // Malformed and unsupported files are rejected, so the app falls back to the platform decoder.
+        TestImage image = MakeTestImage(16, 16, 8, 6, 1);
+        std::vector<uint8_t> file = EncodePng(image, 64);
+        for (size_t size : {size_t(0), size_t(8), size_t(40), file.size() / 2, file.size() - 13}) {
+            CHECK(!decoder.Decode(file.data(), size, decoded));
+        }
+        std::vector<uint8_t> corrupt = file;
+        corrupt[corrupt.size() / 2] ^= 0x55;
+        CHECK(!decoder.Decode(corrupt.data(), corrupt.size(), decoded));
+        std::vector<uint8_t> interlaced = EncodePng(image, 64, true);
+        CHECK(!decoder.Decode(interlaced.data(), interlaced.size(), decoded));
+        CHECK(decoder.Decode(file.data(), file.size(), decoded));
+        printf("%zu synthetic images of every color type and bit depth decode exactly\n", count);
+    }
+
+#ifdef WORLD_AR_HAS_LIBPNG
+    // Decode with libpng into 8-bit channels, the way the native decoder lays them out.
+    bool DecodeWithLibpng(const std::vector<char> &file, gWorldAr::util::PngImage &outImage)
+    {
+        png_image image;
+        memset(&image, 0, sizeof(image));
+        image.version = PNG_IMAGE_VERSION;
+        if (!png_image_begin_read_from_memory(&image, file.data(), file.size())) {
+            return false;
+        }
+        const bool hasAlpha = (image.format & PNG_FORMAT_FLAG_ALPHA) != 0;
+        const bool hasColor = (image.format & PNG_FORMAT_FLAG_COLOR) != 0;
+        image.format = hasColor ? (hasAlpha ? PNG_FORMAT_RGBA : PNG_FORMAT_RGB) :
+            (hasAlpha ? PNG_FORMAT_GA : PNG_FORMAT_GRAY);
+        outImage.width = image.width;
+        outImage.height = image.height;
+        outImage.channels = PNG_IMAGE_SAMPLE_CHANNELS(image.format);
+        outImage.pixels.resize(PNG_IMAGE_SIZE(image));
+        return png_image_finish_read(&image, nullptr, outImage.pixels.data(), 0, nullptr) != 0;
+    }
+#endif
+
+    void Decode(const char *name, int iterations)
+    {
+        using namespace gWorldAr;
+        std::vector<char> file;
+        CHECK(host::ReadFile(host::AssetPath(name), file));
+        util::PngDecoder decoder;
+        util::PngImage image;
+        double decodeMs = host::MeasureMs(iterations, [&]() {
+            CHECK(decoder.Decode(file.data(), file.size(), image));
+        });
+        printf("%-12s %7zu bytes, %ux%u, %u channels  native %8.3f ms", name, file.size(), image.width,
+               image.height, image.channels, decodeMs);
+#ifdef WORLD_AR_HAS_LIBPNG
+        util::PngImage reference;
+        double libpngMs = host::MeasureMs(iterations, [&]() {
+            CHECK(DecodeWithLibpng(file, reference));
+        });
+        CHECK(reference.width == image.width && reference.height == image.height);
+        CHECK(reference.channels == image.channels && reference.pixels == image.pixels);
+        printf("  libpng %8.3f ms, identical pixels", libpngMs);
+#endif
+        printf("\n");
+    }
+}
+
+// Decodes the shipped textures the way WorldObjectRenderer and WorldPlaneRenderer do on device,
+// and checks the decoder against an encoder covering every PNG color type, bit depth and filter.
+// Where the host has libpng, the shipped textures are also compared with its output.
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    CheckRoundTrips();
+    Decode("AR_logo.png", iterations);
+    Decode("trigrid.png", iterations);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "host_util.h"
+#include "utils/log.h"
+#include "utils/render_queue.h"
+
+namespace {
+    using gWorldAr::util::RenderPass;
+
+    // A draw as the renderers submit it: its state, its distance and its pass.
+    struct SceneDraw {
+        uint32_t program;
+        uint32_t texture;
+        float depth;
+        RenderPass pass;
+    };
+
+    // Records the draws in the order the queue issues them.
+    class RecordingRenderer : public gWorldAr::util::PacketRenderer {
+    public:
+        explicit RecordingRenderer(const std::vector<SceneDraw> &draws) : draws(draws)
+        {
+        }
+
+        void DrawPacket(uint32_t index) override
+        {
+            issued.push_back(&draws[index]);
+        }
+
+        const std::vector<SceneDraw> &draws;
+        std::vector<const SceneDraw *> issued;
+    };
+
+    // Objects use two program variants and three textures, planes share one program and texture, and
+    // the point cloud is drawn last, as in the app. Draws arrive in random order.
+    std::vector<SceneDraw> GenerateScene(size_t objectCount, size_t planeCount, std::mt19937 &random)
+    {
+        std::uniform_real_distribution<float> depth(0.1f, 10.0f);
+        std::vector<SceneDraw> draws;
+        for (size_t i = 0; i < objectCount; ++i) {
+            draws.push_back({static_cast<uint32_t>(3 + random() % 2), static_cast<uint32_t>(1 + random() % 3),
+                depth(random), RenderPass::OPAQUE});
+        }
+        for (size_t i = 0; i < planeCount; ++i) {
+            draws.push_back({5, 4, depth(random), RenderPass::TRANSPARENT});
+        }
+        draws.push_back({6, 0, 0.0f, RenderPass::OVERLAY});
+        std::shuffle(draws.begin(), draws.end(), random);
+        return draws;
+    }
+
+    size_t CountStateChanges(const std::vector<const SceneDraw *> &order)
+    {
+        size_t changes = 0;
+        for (size_t i = 1; i < order.size(); ++i) {
+            changes += (order[i]->program != order[i - 1]->program) + (order[i]->texture != order[i - 1]->texture);
+        }
+        return changes;
+    }
+
+    // Passes are in order, state groups of the opaque pass are contiguous and drawn front to back,
+    // and the transparent pass is drawn back to front.
+    void CheckOrder(const std::vector<const SceneDraw *> &order)
+    {
+        for (size_t i = 1; i < order.size(); ++i) {
+            const SceneDraw &previous = *order[i - 1];
+            const SceneDraw &current = *order[i];
+            CHECK(previous.pass <= current.pass);
+            if (previous.pass != current.pass) {
+                continue;
+            }
+            if (current.pass == RenderPass::TRANSPARENT) {
+                CHECK(previous.depth >= current.depth);
+            } else if (previous.program == current.program && previous.texture == current.texture) {
+                CHECK(previous.depth <= current.depth);
+            }
+        }
+        size_t groupCount = 1;
+        for (size_t i = 1; i < order.size(); ++i) {
+            groupCount += (order[i]->program != order[i - 1]->program || order[i]->texture != order[i - 1]->texture);
+        }
+        // Two programs by three textures, one plane state, one point cloud state.
+        CHECK(groupCount <= 8);
+    }
+
+    void Compare(size_t objectCount, size_t planeCount, int iterations)
+    {
+        using namespace gWorldAr;
+        std::mt19937 random(static_cast<uint32_t>(objectCount * 31 + planeCount));
+        std::vector<SceneDraw> draws = GenerateScene(objectCount, planeCount, random);
+        RecordingRenderer renderer(draws);
+        renderer.issued.reserve(draws.size());
+        util::RenderQueue queue;
+
+        auto drawFrame = [&]() {
+            queue.Clear();
+            renderer.issued.clear();
+            for (size_t i = 0; i < draws.size(); ++i) {
+                const SceneDraw &draw = draws[i];
+                queue.Submit(util::MakeSortKey(draw.pass, draw.program, draw.texture, draw.depth), renderer,
+                    static_cast<uint32_t>(i));
+            }
+            queue.Sort();
+            queue.Execute();
+        };
+        drawFrame();
+        CheckOrder(renderer.issued);
+
+        // Once the queue has held the frame, further frames reuse its storage.
+        const util::RenderPacket *storage = queue.GetPackets().data();
+        double ms = host::MeasureMs(iterations, drawFrame);
+        CHECK(queue.GetPackets().data() == storage);
+
+        std::vector<const SceneDraw *> submitted;
+        for (const SceneDraw &draw : draws) {
+            submitted.push_back(&draw);
+        }
+        printf("%5zu objects %4zu planes  submit, sort and issue %8.4f ms  state changes: submitted %5zu, "
+               "sorted %2zu\n", objectCount, planeCount, ms, CountStateChanges(submitted),
+               CountStateChanges(renderer.issued));
+    }
+}
+
+// Sorts frames of objects, planes and a point cloud submitted in random order, checks the pass, state
+// and depth order of the issued draws and that the queue stops allocating, and counts the program and
+// texture changes the order saves.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 1000;
+
+    // Keys order passes first, and depth within a pass as documented.
+    CHECK(util::MakeSortKey(RenderPass::OPAQUE, 0xFFFF, 0xFFFF, 1e30f) <
+          util::MakeSortKey(RenderPass::TRANSPARENT, 0, 0, 1e30f));
+    CHECK(util::MakeSortKey(RenderPass::TRANSPARENT, 0, 0, 0.0f) <
+          util::MakeSortKey(RenderPass::OVERLAY, 0, 0, 0.0f));
+    CHECK(util::MakeSortKey(RenderPass::OPAQUE, 1, 1, 0.5f) < util::MakeSortKey(RenderPass::OPAQUE, 1, 1, 0.6f));
+    CHECK(util::MakeSortKey(RenderPass::TRANSPARENT, 1, 1, 0.6f) <
+          util::MakeSortKey(RenderPass::TRANSPARENT, 1, 1, 0.5f));
+    CHECK(util::MakeSortKey(RenderPass::OPAQUE, 1, 1, -2.0f) == util::MakeSortKey(RenderPass::OPAQUE, 1, 1, 0.0f));
+    CHECK(util::GetSortKeyPass(util::MakeSortKey(RenderPass::OVERLAY, 7, 9, 3.0f)) == RenderPass::OVERLAY);
+
+    Compare(1, 1, iterations);
+    Compare(10, 5, iterations);
+    Compare(50, 20, iterations);
+    Compare(1000, 100, iterations / 10 + 1);
+    return 0;
+}
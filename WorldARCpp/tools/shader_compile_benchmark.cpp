@@ -0,0 +1,296 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <GLES2/gl2.h>
+
+#include "host_gl.h"
+#include "host_util.h"
+#include "utils/gl_capabilities.h"
+#include "utils/log.h"
+#include "utils/program_builder.h"
+#include "utils/program_cache.h"
+
+namespace {
+    // Number of programs the app builds at startup: background, point cloud, plane and object.
+    constexpr int PROGRAM_COUNT = 4;
+
+    struct ShaderSources {
+        std::string vertex;
+        std::string fragment;
+    };
+
+    // Lit and textured programs about the size of the object shader of the app. The round number is
+    // part of the sources, so no round finds the programs of an earlier one in a driver cache.
+    std::vector<ShaderSources> GeneratePrograms(int round)
+    {
+        std::vector<ShaderSources> programs;
+        for (int program = 0; program < PROGRAM_COUNT; ++program) {
+            const std::string tag = "// round " + std::to_string(round) + " program " + std::to_string(program) + "\n";
+            ShaderSources sources;
+            sources.vertex = tag + R"(
+            uniform mat4 u_ModelView;
+            uniform mat4 u_ModelViewProjection;
+            attribute vec4 a_Position;
+            attribute vec3 a_Normal;
+            attribute vec2 a_TexCoord;
+            varying vec3 v_ViewPosition;
+            varying vec3 v_ViewNormal;
+            varying vec2 v_TexCoord;
+            void main() {
+                v_ViewPosition = (u_ModelView * a_Position).xyz;
+                v_ViewNormal = normalize((u_ModelView * vec4(a_Normal, 0.0)).xyz);
+                v_TexCoord = a_TexCoord;
+                gl_Position = u_ModelViewProjection * a_Position;
+            })";
+            sources.fragment = tag + "precision mediump float;\n#define LIGHT_COUNT " + std::to_string(program + 2) +
+                               "\n" + R"(
+            uniform sampler2D u_Texture;
+            uniform vec4 u_LightDirections[LIGHT_COUNT];
+            uniform vec4 u_MaterialParameters;
+            varying vec3 v_ViewPosition;
+            varying vec3 v_ViewNormal;
+            varying vec2 v_TexCoord;
+            void main() {
+                vec3 viewNormal = normalize(v_ViewNormal);
+                vec3 viewFragmentDirection = normalize(v_ViewPosition);
+                vec4 objectColor = texture2D(u_Texture, vec2(v_TexCoord.x, 1.0 - v_TexCoord.y));
+                objectColor.rgb = pow(objectColor.rgb, vec3(2.2));
+                vec3 color = objectColor.rgb * u_MaterialParameters.x;
+                for (int light = 0; light < LIGHT_COUNT; ++light) {
+                    vec3 direction = normalize(u_LightDirections[light].xyz);
+                    float diffuse = u_MaterialParameters.y * 0.5 * (dot(viewNormal, direction) + 1.0);
+                    vec3 reflected = reflect(direction, viewNormal);
+                    float specular = u_MaterialParameters.z *
+                        pow(max(0.0, dot(viewFragmentDirection, reflected)), u_MaterialParameters.w);
+                    color += (objectColor.rgb * diffuse + specular) * u_LightDirections[light].w;
+                }
+                gl_FragColor = vec4(pow(color, vec3(1.0 / 2.2)), objectColor.a);
+            })";
+            programs.push_back(sources);
+        }
+        return programs;
+    }
+
+    GLuint CompileShader(GLenum shaderType, const char *source)
+    {
+        GLuint shader = glCreateShader(shaderType);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        GLint compiled = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        CHECK(compiled);
+        return shader;
+    }
+
+    // The CreateProgram the app used before: it waits for each shader and for the link in turn.
+    GLuint LegacyCreateProgram(const ShaderSources &sources)
+    {
+        GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, sources.vertex.c_str());
+        GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, sources.fragment.c_str());
+        GLuint program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+        GLint linkStatus = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+        CHECK(linkStatus == GL_TRUE);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return program;
+    }
+
+    void DeletePrograms(std::vector<GLuint> &programs)
+    {
+        for (GLuint program : programs) {
+            glDeleteProgram(program);
+        }
+        programs.clear();
+    }
+
+    // Milliseconds until the first program, which the camera background needs, and until all of them.
+    struct StartupTimes {
+        double firstMs = 0.0;
+        double allMs = 0.0;
+    };
+
+    template <typename Build>
+    StartupTimes Measure(int iterations, int &round, Build build)
+    {
+        StartupTimes total;
+        for (int i = 0; i < iterations; ++i) {
+            std::vector<ShaderSources> sources = GeneratePrograms(round++);
+            std::vector<GLuint> programs;
+            double firstMs = 0.0;
+            total.allMs += gWorldAr::host::MeasureMs(1, [&]() {
+                build(sources, programs, firstMs);
+            });
+            total.firstMs += firstMs;
+            CHECK(programs.size() == PROGRAM_COUNT);
+            DeletePrograms(programs);
+        }
+        return {total.firstMs / iterations, total.allMs / iterations};
+    }
+
+    double MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void BuildSequentially(const std::vector<ShaderSources> &sources, std::vector<GLuint> &outPrograms,
+                           double &outFirstMs)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (const ShaderSources &program : sources) {
+            outPrograms.push_back(LegacyCreateProgram(program));
+            if (outPrograms.size() == 1) {
+                outFirstMs = MsSince(start);
+            }
+        }
+    }
+
+    // Submits every program before taking any.
+    void BuildBatched(const std::vector<ShaderSources> &sources, std::vector<GLuint> &outPrograms,
+                      double &outFirstMs)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        gWorldAr::util::ProgramBuilder builder;
+        std::vector<size_t> ids;
+        for (const ShaderSources &program : sources) {
+            ids.push_back(builder.Submit(program.vertex.c_str(), program.fragment.c_str()));
+        }
+        for (size_t id : ids) {
+            outPrograms.push_back(builder.Take(id));
+            CHECK(outPrograms.back() != 0);
+            if (outPrograms.size() == 1) {
+                outFirstMs = MsSince(start);
+            }
+        }
+    }
+
+    // The order of WorldRenderManager::Initialize: the background program first, then the others together.
+    void BuildBackgroundFirst(const std::vector<ShaderSources> &sources, std::vector<GLuint> &outPrograms,
+                              double &outFirstMs)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        gWorldAr::util::ProgramBuilder builder;
+        outPrograms.push_back(builder.Take(builder.Submit(sources[0].vertex.c_str(), sources[0].fragment.c_str())));
+        outFirstMs = MsSince(start);
+        std::vector<size_t> ids;
+        for (size_t program = 1; program < sources.size(); ++program) {
+            ids.push_back(builder.Submit(sources[program].vertex.c_str(), sources[program].fragment.c_str()));
+        }
+        for (size_t id : ids) {
+            outPrograms.push_back(builder.Take(id));
+            CHECK(outPrograms.back() != 0);
+        }
+    }
+
+    void Print(const char *name, const StartupTimes &times, const StartupTimes &baseline)
+    {
+        printf("%-34s first program %8.2f ms  all %8.2f ms  %5.2fx\n", name, times.firstMs, times.allMs,
+               baseline.allMs / times.allMs);
+    }
+}
+
+// Compares how long the startup programs take to build: one after the other as CreateProgram did,
+// submitted together to a ProgramBuilder, in the order the app uses, and loaded from the program
+// cache. Needs an EGL driver
+// that creates OpenGL ES contexts without a window, such as Mesa.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    // Mesa only reads program binaries with its disk cache of shaders enabled, so the cache is moved
+    // to an empty directory; every round compiles new sources, which the cache never holds.
+    char directory[] = "/tmp/program_cache_XXXXXX";
+    CHECK(mkdtemp(directory) != nullptr);
+    setenv("MESA_SHADER_CACHE_DIR", (std::string(directory) + "/mesa").c_str(), 1);
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    printf("GL_KHR_parallel_shader_compile: %s, %ld CPU cores\n",
+           util::HasGlExtension("GL_KHR_parallel_shader_compile") ? "yes" : "no", sysconf(_SC_NPROCESSORS_ONLN));
+
+    int round = 0;
+    // Warm up the driver, so the first measurement does not include loading the compiler.
+    Measure(1, round, BuildSequentially);
+    StartupTimes sequential = Measure(iterations, round, BuildSequentially);
+    StartupTimes batched = Measure(iterations, round, BuildBatched);
+    StartupTimes backgroundFirst = Measure(iterations, round, BuildBackgroundFirst);
+    Print("sequential CreateProgram", sequential, sequential);
+    Print("all batched", batched, sequential);
+    Print("background, then others batched", backgroundFirst, sequential);
+
+    // Each round stores its programs, then loads them the way the next surface does.
+    util::SetProgramCacheDirectory(directory);
+    const util::ProgramCacheStats uncached = util::GetProgramCacheStats();
+    StartupTimes cached;
+    for (int i = 0; i < iterations; ++i) {
+        std::vector<ShaderSources> sources = GeneratePrograms(round++);
+        std::vector<GLuint> programs;
+        double firstMs = 0.0;
+        BuildBackgroundFirst(sources, programs, firstMs);
+        DeletePrograms(programs);
+        util::ProgramCacheStats before = util::GetProgramCacheStats();
+        cached.allMs += host::MeasureMs(1, [&]() {
+            BuildBackgroundFirst(sources, programs, firstMs);
+        });
+        cached.firstMs += firstMs;
+        CHECK(util::GetProgramCacheStats().hitCount == before.hitCount + PROGRAM_COUNT);
+        DeletePrograms(programs);
+    }
+    cached.allMs /= iterations;
+    cached.firstMs /= iterations;
+    Print("background first, cache hits", cached, sequential);
+
+    util::ProgramCacheStats stats = util::GetProgramCacheStats();
+    printf("program cache: %zu hits in %.2f ms, %zu misses in %.2f ms, %zu rejected, %zu stored\n", stats.hitCount,
+           stats.hitMs, stats.missCount, stats.missMs, stats.rejectCount, stats.storeCount);
+    CHECK(stats.rejectCount == 0);
+    CHECK(stats.storeCount == stats.missCount - uncached.missCount);
+
+    // A corrupt entry is rejected and replaced by a program compiled from source.
+    std::vector<ShaderSources> sources = GeneratePrograms(round++);
+    std::vector<GLuint> programs;
+    double firstMs = 0.0;
+    BuildBatched(sources, programs, firstMs);
+    DeletePrograms(programs);
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() != ".bin") {
+            continue;
+        }
+        std::vector<char> data;
+        CHECK(host::ReadFile(entry.path().string(), data) && data.size() > 64);
+        data[data.size() / 2] ^= 0x5A;
+        CHECK(host::WriteFile(entry.path().string(), data.data(), data.size()));
+    }
+    BuildBatched(sources, programs, firstMs);
+    DeletePrograms(programs);
+    CHECK(util::GetProgramCacheStats().rejectCount == PROGRAM_COUNT);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/asset_loader.h"
+#include "utils/log.h"
+#include "utils/mesh_optimizer.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Display refresh the simulated GL thread waits for between frames.
+    constexpr std::chrono::microseconds FRAME_INTERVAL(16667);
+
+    // CPU side of the assets WorldRenderManager loads: the object mesh and the two textures.
+    struct SceneAssets {
+        std::vector<gWorldAr::util::QuantizedVertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<char> objectImage;
+        std::vector<char> planeImage;
+    };
+
+    struct StartupTimes {
+        double firstFrameMs = 0.0;
+        double loadedMs = 0.0;
+        int framesWhileLoading = 0;
+    };
+
+    double MsSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    bool LoadObject(const std::string &obj, SceneAssets &assets)
+    {
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        if (!gWorldAr::util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, assets.indices)) {
+            return false;
+        }
+        gWorldAr::util::OptimizeMesh(vertices, normals, uvs, assets.indices);
+        gWorldAr::util::QuantizationParams params;
+        gWorldAr::util::QuantizeVertices(vertices, normals, uvs, assets.vertices, params);
+        return true;
+    }
+
+    // Everything is loaded before the first frame, as Initialize did on the GL thread.
+    StartupTimes RunBlocking(const std::string &obj, SceneAssets &assets)
+    {
+        using namespace gWorldAr;
+        Clock::time_point start = Clock::now();
+        CHECK(host::ReadFile(host::AssetPath("trigrid.png"), assets.planeImage));
+        CHECK(LoadObject(obj, assets));
+        CHECK(host::ReadFile(host::AssetPath("AR_logo.png"), assets.objectImage));
+        StartupTimes times;
+        times.firstFrameMs = MsSince(start);
+        times.loadedMs = times.firstFrameMs;
+        return times;
+    }
+
+    // The GL thread draws a frame per display refresh and picks up one loaded asset per frame.
+    StartupTimes RunAsync(const std::string &obj, SceneAssets &assets)
+    {
+        using namespace gWorldAr;
+        Clock::time_point start = Clock::now();
+        util::AssetLoader loader;
+        loader.Start();
+        loader.Enqueue(nullptr, [](bool) {});
+        loader.Enqueue([&assets]() { return host::ReadFile(host::AssetPath("trigrid.png"), assets.planeImage); },
+                       [](bool isLoaded) { CHECK(isLoaded); });
+        loader.Enqueue([&]() {
+            return LoadObject(obj, assets) && host::ReadFile(host::AssetPath("AR_logo.png"), assets.objectImage);
+        }, [](bool isLoaded) { CHECK(isLoaded); });
+
+        StartupTimes times;
+        Clock::time_point nextFrame = start;
+        for (;;) {
+            bool isLoaded = loader.Poll(1);
+            if (times.framesWhileLoading == 0) {
+                times.firstFrameMs = MsSince(start);
+            }
+            if (isLoaded) {
+                times.loadedMs = MsSince(start);
+                break;
+            }
+            ++times.framesWhileLoading;
+            nextFrame += FRAME_INTERVAL;
+            std::this_thread::sleep_until(nextFrame);
+        }
+        return times;
+    }
+
+    void Compare(const char *name, const std::string &obj)
+    {
+        SceneAssets blockingAssets;
+        SceneAssets asyncAssets;
+        StartupTimes blocking = RunBlocking(obj, blockingAssets);
+        StartupTimes async = RunAsync(obj, asyncAssets);
+        CHECK(async.firstFrameMs < blocking.firstFrameMs);
+        CHECK(asyncAssets.vertices.size() == blockingAssets.vertices.size());
+        CHECK(asyncAssets.indices == blockingAssets.indices);
+        CHECK(asyncAssets.objectImage == blockingAssets.objectImage);
+        CHECK(asyncAssets.planeImage == blockingAssets.planeImage);
+        printf("%-24s blocking: first frame %8.3f ms, loaded %8.3f ms\n", name, blocking.firstFrameMs,
+               blocking.loadedMs);
+        printf("%-24s async:    first frame %8.3f ms, loaded %8.3f ms, %d frames drawn while loading\n", "",
+               async.firstFrameMs, async.loadedMs, async.framesWhileLoading);
+    }
+}
+
+// Time to the first camera frame and to a fully loaded scene, with the assets loaded before the
+// first frame and with the asset loader. GL uploads are not part of the host build, so only the
+// CPU side of loading is measured; frames are paced at 60 Hz.
+int main()
+{
+    using namespace gWorldAr;
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    Compare("AR_logo.obj", std::string(logo.begin(), logo.end()));
+    Compare("sphere 400x400", host::GenerateSphereObj(400, 400));
+    return 0;
+}
@@ -0,0 +1,61 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "synthetic_models.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace gWorldAr {
+    namespace host {
+        std::string GenerateSphereObj(int rings, int segments, bool isRelative)
+        {
+            const double pi = 3.14159265358979323846;
+            std::string obj = "# Synthetic sphere\no sphere\n";
+            char line[256];
+            const int stride = segments + 1;
+            for (int ring = 0; ring <= rings; ++ring) {
+                double theta = pi * ring / rings;
+                for (int segment = 0; segment <= segments; ++segment) {
+                    double phi = 2.0 * pi * segment / segments;
+                    double x = sin(theta) * cos(phi);
+                    double y = cos(theta);
+                    double z = sin(theta) * sin(phi);
+                    snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvn %.4f %.4f %.4f\nvt %.6f %.6f\n",
+                             x, y, z, x, y, z, static_cast<double>(segment) / segments,
+                             static_cast<double>(ring) / rings);
+                    obj += line;
+                }
+                if (ring == 0) {
+                    continue;
+                }
+                // Relative indices count back from the last element read, which is -1.
+                const int offset = isRelative ? -(ring + 1) * stride - 1 : 0;
+                for (int segment = 0; segment < segments; ++segment) {
+                    // One-based obj indices of the quad corners.
+                    int a = (ring - 1) * stride + segment + 1 + offset;
+                    int b = a + 1;
+                    int c = a + stride;
+                    int d = c + 1;
+                    snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d\nf %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                             a, a, a, c, c, c, b, b, b, b, b, b, c, c, c, d, d, d);
+                    obj += line;
+                }
+            }
+            return obj;
+        }
+    }
+}
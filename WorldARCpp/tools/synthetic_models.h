@@ -0,0 +1,37 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef C_ARENGINE_HELLOE_AR_SYNTHETIC_MODELS_H
+#define C_ARENGINE_HELLOE_AR_SYNTHETIC_MODELS_H
+
+#include <string>
+
+namespace gWorldAr {
+    namespace host {
+        /**
+         * Generate a UV sphere in obj format, standing in for large user-supplied models.
+         * Positions, normals and texture coordinates are written once per grid point and shared
+         * by the adjacent faces, like exporters do. The faces of each ring follow its vertices.
+         *
+         * @param rings Number of latitude rings.
+         * @param segments Number of longitude segments.
+         * @param isRelative Write faces with negative indices, relative to the vertices before them.
+         * @return Content of the obj file.
+         */
+        std::string GenerateSphereObj(int rings, int segments, bool isRelative = false);
+    }
+}
+#endif
@@ -0,0 +1,168 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "etc_codec.h"
+#include "host_util.h"
+#include "utils/ktx_format.h"
+#include "utils/log.h"
+#include "utils/png_decoder.h"
+
+namespace {
+    // Smallest PSNR of the finest level against the source png. ETC1 typically reaches 32 to 40 dB
+    // on photographs and artwork; below 30 dB blocking becomes visible.
+    constexpr double MIN_PSNR_DB = 30.0;
+
+    std::vector<uint8_t> ReadRgb(const char *name, uint32_t &outWidth, uint32_t &outHeight)
+    {
+        using namespace gWorldAr;
+        std::vector<char> file;
+        CHECK(host::ReadFile(host::AssetPath(name), file));
+        util::PngDecoder decoder;
+        util::PngImage image;
+        CHECK(decoder.Decode(file.data(), file.size(), image));
+        CHECK(image.channels == 3);
+        outWidth = image.width;
+        outHeight = image.height;
+        return image.pixels;
+    }
+
+    void Compress(const char *name, int iterations)
+    {
+        using namespace gWorldAr;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        const std::vector<uint8_t> rgb = ReadRgb(name, width, height);
+
+        for (bool isEtc1Only : {true, false}) {
+            std::vector<uint8_t> blocks;
+            double encodeMs = host::MeasureMs(iterations, [&]() {
+                host::EncodeEtc2Rgb(rgb.data(), width, height, isEtc1Only, blocks);
+            });
+            std::vector<uint8_t> decoded;
+            host::DecodeEtc2Rgb(blocks.data(), width, height, decoded);
+            const double psnr = host::ComputePsnr(rgb, decoded);
+            CHECK(psnr >= MIN_PSNR_DB);
+            printf("%-12s %s  encoded in %8.1f ms, PSNR %.2f dB\n", name, isEtc1Only ? "ETC1" : "ETC2", encodeMs,
+                   psnr);
+        }
+
+        // The shipped texture has to match the png it was compiled from.
+        const std::string ktxName = std::string(name).substr(0, strlen(name) - strlen(".png")) +
+                                    util::KTX_FILE_EXTENSION;
+        std::vector<char> ktxFile;
+        CHECK(host::ReadFile(host::AssetPath(ktxName.c_str()), ktxFile));
+        util::KtxTexture texture;
+        CHECK(util::ReadKtxFile(ktxFile.data(), ktxFile.size(), texture));
+        CHECK(texture.levels.size() == util::GetFullMipLevelCount(width, height));
+        CHECK(texture.levels[0].width == width && texture.levels[0].height == height);
+        std::vector<uint8_t> decoded;
+        host::DecodeEtc2Rgb(static_cast<const uint8_t *>(texture.levels[0].data), width, height, decoded);
+        const double psnr = host::ComputePsnr(rgb, decoded);
+        CHECK(psnr >= MIN_PSNR_DB);
+
+        // Drivers store RGB textures with four bytes per pixel; the mip chain adds a third.
+        const size_t uncompressedBytes = static_cast<size_t>(width) * height * 4 * 4 / 3;
+        size_t compressedBytes = 0;
+        for (const util::KtxLevel &level : texture.levels) {
+            compressedBytes += level.size;
+        }
+        printf("%-12s shipped %s: %zu levels, PSNR %.2f dB, GPU memory %zu KiB instead of %zu KiB (%.1fx less)\n",
+               "", ktxName.c_str(), texture.levels.size(), psnr, compressedBytes / 1024, uncompressedBytes / 1024,
+               static_cast<double>(uncompressedBytes) / compressedBytes);
+    }
+
+    // The planar mode reproduces gradients that the ETC1 modes band.
+    void CheckPlanarMode()
+    {
+        using namespace gWorldAr;
+        std::vector<uint8_t> gradient(16 * 16 * 3);
+        for (uint32_t y = 0; y < 16; ++y) {
+            for (uint32_t x = 0; x < 16; ++x) {
+                gradient[(y * 16 + x) * 3] = static_cast<uint8_t>(x * 16);
+                gradient[(y * 16 + x) * 3 + 1] = static_cast<uint8_t>(y * 12 + x * 3);
+                gradient[(y * 16 + x) * 3 + 2] = static_cast<uint8_t>(255 - y * 15);
+            }
+        }
+        std::vector<uint8_t> blocks;
+        std::vector<uint8_t> decoded;
+        host::EncodeEtc2Rgb(gradient.data(), 16, 16, true, blocks);
+        host::DecodeEtc2Rgb(blocks.data(), 16, 16, decoded);
+        const double etc1Psnr = host::ComputePsnr(gradient, decoded);
+        host::EncodeEtc2Rgb(gradient.data(), 16, 16, false, blocks);
+        host::DecodeEtc2Rgb(blocks.data(), 16, 16, decoded);
+        const double etc2Psnr = host::ComputePsnr(gradient, decoded);
+        CHECK(etc2Psnr > etc1Psnr + 3.0);
+        printf("gradient: ETC1 %.2f dB, ETC2 with planar mode %.2f dB\n", etc1Psnr, etc2Psnr);
+
+        // Sizes that are not multiples of the block size repeat the edge pixels.
+        std::vector<uint8_t> odd(7 * 5 * 3, 200);
+        host::EncodeEtc2Rgb(odd.data(), 7, 5, false, blocks);
+        CHECK(blocks.size() == 2 * 2 * host::ETC_BLOCK_SIZE);
+        host::DecodeEtc2Rgb(blocks.data(), 7, 5, decoded);
+        CHECK(decoded.size() == odd.size() && host::ComputePsnr(odd, decoded) > 40.0);
+    }
+
+    void CheckKtxFiles()
+    {
+        using namespace gWorldAr;
+        std::vector<std::vector<uint8_t>> levels;
+        for (uint32_t size = 8; size >= 1; size /= 2) {
+            levels.emplace_back(util::GetCompressedLevelSize(util::KTX_FORMAT_ETC2_RGB8, size, size),
+                                static_cast<uint8_t>(size));
+        }
+        std::vector<uint8_t> file;
+        CHECK(util::WriteKtxFile(util::KTX_FORMAT_ETC2_RGB8, 8, 8, levels, file));
+        util::KtxTexture texture;
+        CHECK(util::ReadKtxFile(file.data(), file.size(), texture));
+        CHECK(texture.internalFormat == util::KTX_FORMAT_ETC2_RGB8 && texture.levels.size() == 4);
+        CHECK(texture.levels[3].width == 1 && texture.levels[3].size == host::ETC_BLOCK_SIZE);
+        CHECK(*static_cast<const uint8_t *>(texture.levels[1].data) == 4);
+        CHECK(util::GetCompressedLevelSize(util::KTX_FORMAT_ASTC_12X12, 25, 13) == 3 * 2 * 16);
+
+        // Malformed files are rejected, so the app falls back to the png.
+        CHECK(!util::ReadKtxFile(file.data(), file.size() - 4, texture));
+        std::vector<uint8_t> wrongFormat = file;
+        uint32_t unknownFormat = 0x1234;
+        memcpy(&wrongFormat[offsetof(util::KtxHeader, glInternalFormat)], &unknownFormat, sizeof(unknownFormat));
+        CHECK(!util::ReadKtxFile(wrongFormat.data(), wrongFormat.size(), texture));
+        levels.push_back(levels.back());
+        CHECK(!util::WriteKtxFile(util::KTX_FORMAT_ETC2_RGB8, 8, 8, levels, file));
+        levels.pop_back();
+        levels[1].pop_back();
+        CHECK(!util::WriteKtxFile(util::KTX_FORMAT_ETC2_RGB8, 8, 8, levels, file));
+    }
+}
+
+// Compresses the shipped textures the way texture_compiler does, checks the decoded result against
+// the png within a PSNR threshold, and checks the compiled .ktx assets are in sync with the pngs.
+int main(int argc, char **argv)
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : 1;
+    CheckKtxFiles();
+    CheckPlanarMode();
+    Compress("AR_logo.png", iterations);
+    Compress("trigrid.png", iterations);
+    return 0;
+}
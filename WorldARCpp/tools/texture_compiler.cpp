@@ -0,0 +1,98 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "etc_codec.h"
+#include "host_util.h"
+#include "utils/ktx_format.h"
+#include "utils/png_decoder.h"
+
+// Usage: texture_compiler [--etc1] <input.png> <output.ktx>
+// Compresses a png texture into ETC2 RGB8 blocks with its full mip chain, stored in a KTX file
+// that the app uploads in place of the png. With --etc1 the planar mode of ETC2 is left out and
+// the file is marked ETC1, which OpenGL ES 2.0 devices with GL_OES_compressed_ETC1_RGB8_texture
+// read too. Textures with transparency are not compressed.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    bool isEtc1Only = false;
+    int argument = 1;
+    if (argument < argc && std::string(argv[argument]) == "--etc1") {
+        isEtc1Only = true;
+        ++argument;
+    }
+    if (argc - argument != 2) {
+        fprintf(stderr, "Usage: %s [--etc1] <input.png> <output.ktx>\n", argv[0]);
+        return 1;
+    }
+    const char *inputPath = argv[argument];
+    const char *outputPath = argv[argument + 1];
+
+    std::vector<char> pngFile;
+    util::PngDecoder decoder;
+    util::PngImage image;
+    if (!host::ReadFile(inputPath, pngFile) || !decoder.Decode(pngFile.data(), pngFile.size(), image)) {
+        fprintf(stderr, "Could not decode %s\n", inputPath);
+        return 1;
+    }
+
+    // Gray images are spread over the three channels. ETC2 RGB8 has no alpha.
+    std::vector<uint8_t> rgb(static_cast<size_t>(image.width) * image.height * 3);
+    const bool hasAlpha = image.channels == 2 || image.channels == 4;
+    const uint32_t colorChannels = hasAlpha ? image.channels - 1 : image.channels;
+    for (size_t pixel = 0; pixel < rgb.size() / 3; ++pixel) {
+        const uint8_t *source = &image.pixels[pixel * image.channels];
+        if (hasAlpha && source[colorChannels] != 255) {
+            fprintf(stderr, "%s has transparency, which ETC2 RGB8 cannot store\n", inputPath);
+            return 1;
+        }
+        for (int channel = 0; channel < 3; ++channel) {
+            rgb[pixel * 3 + channel] = source[colorChannels == 3 ? channel : 0];
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> levels;
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    std::vector<uint8_t> decoded;
+    std::vector<uint8_t> smaller;
+    for (uint32_t level = 0; level < util::GetFullMipLevelCount(image.width, image.height); ++level) {
+        levels.emplace_back();
+        host::EncodeEtc2Rgb(rgb.data(), width, height, isEtc1Only, levels.back());
+        host::DecodeEtc2Rgb(levels.back().data(), width, height, decoded);
+        printf("level %2u: %4ux%-4u %8zu bytes, PSNR %.2f dB\n", level, width, height, levels.back().size(),
+               host::ComputePsnr(rgb, decoded));
+        host::DownsampleRgb(rgb, width, height, smaller);
+        rgb.swap(smaller);
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+    }
+
+    std::vector<uint8_t> ktxFile;
+    const uint32_t format = isEtc1Only ? util::KTX_FORMAT_ETC1_RGB8 : util::KTX_FORMAT_ETC2_RGB8;
+    if (!util::WriteKtxFile(format, image.width, image.height, levels, ktxFile) ||
+        !host::WriteFile(outputPath, ktxFile.data(), ktxFile.size())) {
+        fprintf(stderr, "Could not write %s\n", outputPath);
+        return 1;
+    }
+    printf("%s: %zu levels, %zu bytes\n", outputPath, levels.size(), ktxFile.size());
+    return 0;
+}
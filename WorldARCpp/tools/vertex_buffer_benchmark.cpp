@@ -0,0 +1,203 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <GLES2/gl2.h>
+
+#include "host_gl.h"
+#include "synthetic_models.h"
+#include "utils/gl_state.h"
+#include "utils/log.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/mesh_view.h"
+#include "utils/obj_parser.h"
+#include "utils/program_builder.h"
+
+namespace {
+    // Normals and texture coordinates feed the color, so every attribute reaches the pixels compared.
+    constexpr char VERTEX_SHADER[] = R"(
+    attribute vec4 a_Position;
+    attribute vec3 a_Normal;
+    attribute vec2 a_TexCoord;
+    uniform vec3 u_PositionOffset;
+    uniform vec3 u_PositionScale;
+    uniform vec2 u_Translate;
+    varying vec4 v_Color;
+    void main() {
+        v_Color = vec4(abs(a_Normal), 1.0) * vec4(a_TexCoord, 1.0, 1.0);
+        vec3 position = u_PositionOffset + u_PositionScale * a_Position.xyz;
+        gl_Position = vec4(position.xy * 0.5 + u_Translate, position.z * 0.5, 1.0);
+    })";
+
+    constexpr char FRAGMENT_SHADER[] = R"(
+    precision mediump float;
+    varying vec4 v_Color;
+    void main() {
+        gl_FragColor = v_Color;
+    })";
+
+    // Objects drawn per frame, the most the app places.
+    constexpr size_t ANCHOR_COUNT = 10;
+
+    constexpr double FRAMES_PER_SECOND = 30.0;
+
+    struct Program {
+        GLuint name;
+        GLint position;
+        GLint normal;
+        GLint uv;
+        GLint positionOffset;
+        GLint positionScale;
+        GLint translate;
+    };
+
+    // Draw the mesh once per anchor, as the object renderer does.
+    void DrawFrame(const Program &program, const gWorldAr::util::MeshView &mesh)
+    {
+        using namespace gWorldAr;
+        glClear(GL_COLOR_BUFFER_BIT);
+        util::BindMeshBuffers(mesh);
+        const util::SubMesh &subMesh = mesh.subMeshes[0];
+        for (size_t anchor = 0; anchor < ANCHOR_COUNT; ++anchor) {
+            glUniform2f(program.translate, static_cast<float>(anchor % 5) * 0.1f - 0.2f,
+                static_cast<float>(anchor / 5) * 0.1f);
+            util::SetVertexAttribPointer(program.position, mesh.position, subMesh.firstVertex);
+            util::SetVertexAttribPointer(program.normal, mesh.normal, subMesh.firstVertex);
+            util::SetVertexAttribPointer(program.uv, mesh.uv, subMesh.firstVertex);
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(subMesh.indexCount), mesh.indexType,
+                static_cast<const GLubyte *>(mesh.indices) + subMesh.firstIndex * util::GetIndexSize(mesh.indexType));
+        }
+    }
+
+    // Mean frame time of the fastest of several rounds, including the GPU work.
+    double MeasureFrameMs(const Program &program, const gWorldAr::util::MeshView &mesh, int frameCount)
+    {
+        constexpr int ROUND_COUNT = 5;
+        double fastestMs = 0.0;
+        for (int round = 0; round < ROUND_COUNT; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frameCount; ++frame) {
+                DrawFrame(program, mesh);
+            }
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            double ms = elapsed.count() / frameCount;
+            fastestMs = (round == 0) ? ms : std::min(fastestMs, ms);
+        }
+        return fastestMs;
+    }
+
+    std::vector<GLubyte> ReadPixels()
+    {
+        GLint viewport[4] = {};
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        std::vector<GLubyte> pixels(static_cast<size_t>(viewport[2]) * viewport[3] * 4);
+        glReadPixels(0, 0, viewport[2], viewport[3], GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        return pixels;
+    }
+
+    void Compare(const char *name, const Program &program, gWorldAr::util::MeshView &mesh, int frameCount)
+    {
+        using namespace gWorldAr;
+        const util::MeshView clientMesh = mesh;
+        const double clientMs = MeasureFrameMs(program, clientMesh, frameCount);
+        DrawFrame(program, clientMesh);
+        const std::vector<GLubyte> clientPixels = ReadPixels();
+
+        const size_t uploadedBytes = util::UploadMeshBuffers(mesh);
+        CHECK(uploadedBytes > 0 && mesh.vertexBuffer != 0 && mesh.indexBuffer != 0);
+        const double bufferMs = MeasureFrameMs(program, mesh, frameCount);
+        DrawFrame(program, mesh);
+        CHECK(ReadPixels() == clientPixels);
+        CHECK(glGetError() == GL_NO_ERROR);
+
+        // Every draw from client-side arrays copies the vertices and indices the buffers hold.
+        const double savedMegabytes = uploadedBytes * ANCHOR_COUNT * FRAMES_PER_SECOND / 1e6;
+        printf("%-22s %7zu bytes per draw  client arrays %7.3f ms  buffers %7.3f ms  %5.2fx  "
+               "%.1f MB/s not copied at %.0f fps\n", name, uploadedBytes, clientMs, bufferMs, clientMs / bufferMs,
+               savedMegabytes, FRAMES_PER_SECOND);
+        util::DeleteMeshBuffers(mesh);
+    }
+}
+
+// Draws a 29k-vertex sphere ten times per frame, from client-side arrays and from the buffer objects
+// filled by UploadMeshBuffers, in the float layout and the quantized layout of the object renderer.
+// Checks that both draw the same pixels.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int frameCount = argc > 1 ? atoi(argv[1]) : 20;
+    if (!host::CreateGlContext()) {
+        return 1;
+    }
+    printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    std::string obj = host::GenerateSphereObj(170, 170);
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    CHECK(util::ParseObj(obj.data(), obj.size(), vertices, normals, uvs, indices));
+    const size_t vertexCount = vertices.size() / 3;
+    CHECK(vertexCount <= util::MAX_VERTICES_16_BIT);
+    std::vector<GLushort> indices16(indices.begin(), indices.end());
+    const util::SubMesh subMesh = {0, static_cast<uint32_t>(vertexCount), 0, static_cast<uint32_t>(indices.size())};
+
+    util::ProgramBuilder builder;
+    Program program = {};
+    program.name = builder.Take(builder.Submit(VERTEX_SHADER, FRAGMENT_SHADER));
+    CHECK(program.name != 0);
+    program.position = glGetAttribLocation(program.name, "a_Position");
+    program.normal = glGetAttribLocation(program.name, "a_Normal");
+    program.uv = glGetAttribLocation(program.name, "a_TexCoord");
+    program.positionOffset = glGetUniformLocation(program.name, "u_PositionOffset");
+    program.positionScale = glGetUniformLocation(program.name, "u_PositionScale");
+    program.translate = glGetUniformLocation(program.name, "u_Translate");
+    util::GlStateCache &state = util::GetGlState();
+    state.UseProgram(program.name);
+    state.SetVertexAttribArrays(util::VertexAttribBit(program.position) | util::VertexAttribBit(program.normal) |
+                                util::VertexAttribBit(program.uv));
+
+    util::MeshView floatMesh;
+    floatMesh.position = {vertices.data(), 3, GL_FLOAT, GL_FALSE, 0};
+    floatMesh.normal = {normals.data(), 3, GL_FLOAT, GL_FALSE, 0};
+    floatMesh.uv = {uvs.data(), 2, GL_FLOAT, GL_FALSE, 0};
+    floatMesh.indices = indices16.data();
+    floatMesh.subMeshes = &subMesh;
+    floatMesh.subMeshCount = 1;
+    glUniform3f(program.positionOffset, 0.0f, 0.0f, 0.0f);
+    glUniform3f(program.positionScale, 1.0f, 1.0f, 1.0f);
+    Compare("float arrays", program, floatMesh, frameCount);
+
+    std::vector<util::QuantizedVertex> quantizedVertices;
+    util::QuantizationParams quantization = {};
+    util::QuantizeVertices(vertices, normals, uvs, quantizedVertices, quantization);
+    util::MeshView quantizedMesh;
+    util::SetQuantizedVertexAttribs(quantizedVertices.data(), quantization, quantizedMesh);
+    quantizedMesh.indices = indices16.data();
+    quantizedMesh.subMeshes = &subMesh;
+    quantizedMesh.subMeshCount = 1;
+    glUniform3fv(program.positionOffset, 1, quantization.positionOffset);
+    glUniform3fv(program.positionScale, 1, quantization.positionScale);
+    Compare("quantized interleaved", program, quantizedMesh, frameCount);
+    return 0;
+}
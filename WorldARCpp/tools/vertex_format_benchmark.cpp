@@ -0,0 +1,144 @@
+/**
+ * Copyright 2022. Huawei Technologies Co., Ltd. All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "host_util.h"
+#include "synthetic_models.h"
+#include "utils/log.h"
+#include "utils/mesh_format.h"
+#include "utils/mesh_quantizer.h"
+#include "utils/obj_parser.h"
+
+namespace {
+    using gWorldAr::util::QuantizationParams;
+    using gWorldAr::util::QuantizedVertex;
+
+    struct FloatMesh {
+        std::vector<float> vertices;
+        std::vector<float> normals;
+        std::vector<float> uvs;
+        std::vector<uint32_t> indices;
+    };
+
+    // Largest difference between the float attributes and the quantized ones as the shader decodes them.
+    void MeasureError(const FloatMesh &mesh, const std::vector<QuantizedVertex> &quantized,
+                      const QuantizationParams &params, double &outPosition, double &outNormalDegrees,
+                      double &outUv)
+    {
+        double extent = 0.0;
+        for (int axis = 0; axis < 3; ++axis) {
+            extent = std::max(extent, 2.0 * params.positionScale[axis]);
+        }
+        outPosition = 0.0;
+        outNormalDegrees = 0.0;
+        outUv = 0.0;
+        for (size_t i = 0; i < quantized.size(); ++i) {
+            const QuantizedVertex &vertex = quantized[i];
+            const float *normal = &mesh.normals[i * 3];
+            float decoded[3];
+            gWorldAr::util::OctDecode(vertex.normal, decoded);
+            double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            double cosine = (normal[0] * decoded[0] + normal[1] * decoded[1] + normal[2] * decoded[2]) / length;
+            outNormalDegrees = std::max(outNormalDegrees,
+                                        std::acos(std::min(1.0, cosine)) * 180.0 / 3.14159265358979323846);
+            for (int axis = 0; axis < 3; ++axis) {
+                double position = params.positionOffset[axis] + params.positionScale[axis] * vertex.position[axis] /
+                    32767.0;
+                outPosition = std::max(outPosition, std::fabs(position - mesh.vertices[i * 3 + axis]) / extent);
+            }
+            for (int axis = 0; axis < 2; ++axis) {
+                double uv = params.uvOffset[axis] + params.uvScale[axis] * vertex.uv[axis] / 65535.0;
+                outUv = std::max(outUv, std::fabs(uv - mesh.uvs[i * 2 + axis]));
+            }
+        }
+    }
+
+    void Compare(const char *name, const std::string &obj, int iterations)
+    {
+        using namespace gWorldAr;
+        FloatMesh mesh;
+        CHECK(util::ParseObj(obj.data(), obj.size(), mesh.vertices, mesh.normals, mesh.uvs, mesh.indices));
+        std::vector<QuantizedVertex> quantized;
+        QuantizationParams params;
+        double quantizeMs = host::MeasureMs(iterations, [&]() {
+            util::QuantizeVertices(mesh.vertices, mesh.normals, mesh.uvs, quantized, params);
+        });
+
+        double positionError;
+        double normalError;
+        double uvError;
+        MeasureError(mesh, quantized, params, positionError, normalError, uvError);
+        CHECK(positionError < 1e-4 && normalError < 0.1 && uvError < 1e-4);
+
+        // Compiled meshes store exactly these vertices.
+        std::vector<uint8_t> meshFile;
+        std::vector<util::SubMesh> subMeshes = {
+            {0, static_cast<uint32_t>(mesh.vertices.size() / 3), 0, static_cast<uint32_t>(mesh.indices.size())}
+        };
+        CHECK(util::WriteMeshFile(mesh.vertices, mesh.normals, mesh.uvs, mesh.indices, subMeshes, {},
+                                  util::MESH_VERTEX_FORMAT_QUANTIZED, meshFile));
+        util::MeshFileView view;
+        CHECK(util::ReadMeshFile(meshFile.data(), meshFile.size(), view));
+        CHECK(view.quantizedVertices != nullptr && view.vertices == nullptr);
+        CHECK(memcmp(view.quantizedVertices, quantized.data(), quantized.size() * sizeof(QuantizedVertex)) == 0);
+
+        // Client-side vertex arrays are copied by the driver on every draw, like this copy into staging.
+        const size_t floatBytes = (mesh.vertices.size() + mesh.normals.size() + mesh.uvs.size()) * sizeof(float);
+        const size_t quantizedBytes = quantized.size() * sizeof(QuantizedVertex);
+        std::vector<uint8_t> staging(floatBytes);
+        double floatCopyMs = host::MeasureMs(iterations * 10, [&]() {
+            uint8_t *out = staging.data();
+            memcpy(out, mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+            out += mesh.vertices.size() * sizeof(float);
+            memcpy(out, mesh.normals.data(), mesh.normals.size() * sizeof(float));
+            out += mesh.normals.size() * sizeof(float);
+            memcpy(out, mesh.uvs.data(), mesh.uvs.size() * sizeof(float));
+        });
+        double quantizedCopyMs = host::MeasureMs(iterations * 10, [&]() {
+            memcpy(staging.data(), quantized.data(), quantizedBytes);
+        });
+
+        printf("%s: %zu vertices, quantized in %.3f ms\n", name, quantized.size(), quantizeMs);
+        printf("  vertex size   %4zu -> %zu bytes, %zu -> %zu bytes in total\n",
+               floatBytes / quantized.size(), sizeof(QuantizedVertex), floatBytes, quantizedBytes);
+        printf("  max error     position %.2e of the extent, normal %.4f degrees, uv %.2e\n",
+               positionError, normalError, uvError);
+        printf("  array copy    %8.3f -> %8.3f ms (%.1fx)\n", floatCopyMs, quantizedCopyMs,
+               floatCopyMs / quantizedCopyMs);
+    }
+}
+
+// Compares the separate float attribute arrays with interleaved QuantizedVertex: size, precision,
+// and the time to copy the vertex data.
+int main(int argc, char **argv)
+{
+    using namespace gWorldAr;
+    const int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    std::vector<char> logo;
+    if (!host::ReadFile(host::AssetPath("AR_logo.obj"), logo)) {
+        return 1;
+    }
+    Compare("AR_logo.obj", std::string(logo.begin(), logo.end()), iterations);
+    Compare("sphere 400x400", host::GenerateSphereObj(400, 400), iterations);
+    return 0;
+}